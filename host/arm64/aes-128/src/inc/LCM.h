@@ -2,6 +2,7 @@
 #include <string.h>
 #include <Taks.h>
 #include <time.h>
+#include "aes_ring.h"
 
 uint8_t LKC_0[COMPLEN];
 uint8_t LKC_1[COMPLEN];
@@ -12,12 +13,28 @@ void initNodes(void);
 int encryptMessage(message_t *output, const char *inputMessage);
 int decryptMessage(const char *output, message_t *msg);
 
+/* n messages of TAKS_PAYLOAD_LEN bytes, no stdio, see taks_encrypt_batch() / taks_decrypt_batch(). */
+int encryptMessages(message_t *output, const char *input, size_t n, int threads);
+int decryptMessages(char *output, const message_t *msg, size_t n, int *status, int threads);
+
+/* Completion of encryptMessageAsync(), on the thread reaping the ring. */
+typedef void (*lcm_done_t)(message_t *msg, int status, void *arg);
+
+typedef struct {
+    message_t *msg;
+    lcm_done_t done;
+    void *arg;
+} lcm_request_t;
+
+int encryptMessageAsync(aes_ring *ring, lcm_request_t *req, message_t *output, const char *inputMessage, lcm_done_t done, void *arg);
+
 void initNodes(void)
 {
     componentFromHexString(LKC_0, "1F598C9C83D8213F61975A621E10320CE4C182FDC07A92C55009A48209E63308");
     componentFromHexString(LKC_1,"9BC71C4CBD4B26CE9E5EBC3DD4C777FD42A81703C8DE3E717BF5200E622EA292");
     componentFromHexString(TKC_1_0,"5C16A98C1889BCA4BF9AA9C8042CD83A729FA9B4F71384668C793C7B2070C36D");
     componentFromHexString(TKC_0_1,"6034A63B434633E0F2AC5557917796405463B5410F273D82786DC845D7D15780");
+    taks_cache_init(TAKS_KCACHE_ENTRIES);
 }
 
 int encryptMessage(message_t *output, const char *inputMessage)
@@ -30,3 +47,59 @@ int decryptMessage(const char *output, message_t *msg)
 {
     return decrypt_pw((unsigned char*)output, msg->payload, TAKS_PAYLOAD_LEN, msg->mac, msg->kri, LKC_1);
 }
+
+int encryptMessages(message_t *output, const char *input, size_t n, int threads)
+{
+    return taks_encrypt_batch(output, (const uint8_t *)input, n, LKC_0, TKC_0_1, TKC_1_0, threads);
+}
+
+int decryptMessages(char *output, const message_t *msg, size_t n, int *status, int threads)
+{
+    return taks_decrypt_batch((uint8_t *)output, msg, n, LKC_1, status, threads);
+}
+
+static void lcm_encrypt_done(const aes_ring_job *job)
+{
+    lcm_request_t *req = (lcm_request_t *)job->arg;
+
+    if (job->status == 0)
+        authentication_tag(req->msg->mac, req->msg->payload, TAKS_PAYLOAD_LEN, (uint8_t *)job->key);
+    req->done(req->msg, job->status, req->arg);
+}
+
+/*  encryptMessageAsync():  encryptMessage() through an aes_ring
+ *
+ *  The nonce, KRI and shared secret are computed on the calling thread, the
+ *  payload is encrypted by the ring engine in place and the MAC is added on
+ *  completion, before done() is called. req and output must stay valid until
+ *  then. Blocks while the ring is full, someone has to reap it.
+ *
+ *  return 0 if submitted, -errno otherwise
+ */
+int encryptMessageAsync(aes_ring *ring, lcm_request_t *req, message_t *output, const char *inputMessage, lcm_done_t done, void *arg)
+{
+    uint8_t nonce[COMPLEN];
+    uint8_t alpha_LKC[COMPLEN];
+    aes_ring_job job;
+
+    memset(&job, 0, sizeof(job));
+    memcpy(&output->payload[0], inputMessage, TAKS_PAYLOAD_LEN);
+
+    getNonce(nonce);
+    elementwise_mult(alpha_LKC, nonce, LKC_0);
+    vector_mult(job.key, alpha_LKC, TKC_1_0);
+    elementwise_mult(output->kri, nonce, TKC_0_1);
+
+    req->msg = output;
+    req->done = done;
+    req->arg = arg;
+
+    job.op = AES_RING_CTR;
+    job.out = output->payload;
+    job.in = output->payload;
+    job.nblocks = TAKS_PAYLOAD_LEN / 16;
+    job.cb = lcm_encrypt_done;
+    job.arg = req;
+
+    return aes_ring_submit(ring, &job);
+}
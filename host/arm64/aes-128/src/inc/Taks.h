@@ -4,8 +4,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
 #include "aes.h"
 #include "aes256.h" //DM
+#include "aes_kcache.h"
+#include "taks_gf.h"
+#include "taks_nonce.h"
+#include "taks_log.h"
 
 
 #define TAKS_KEY_LEN 16
@@ -20,11 +27,16 @@
 #define TAKS_USE_AES
 //#define TAKS_SIMPLE
 
-
-#ifndef DEBUG
-#define DEBUG
+// Expanded shared-secret keys kept by symmetric_encrypt(), symmetric_decrypt()
+// and authentication_tag(), see taks_cache_init()
+#ifndef TAKS_KCACHE_ENTRIES
+#define TAKS_KCACHE_ENTRIES 16
 #endif
 
+// Batch API: at most one thread per TAKS_BATCH_MIN messages
+#define TAKS_BATCH_MIN 64
+#define TAKS_BATCH_MAX_THREADS 64
+
 typedef struct message {
     uint16_t counter;
     uint8_t payload[TAKS_PAYLOAD_LEN];
@@ -36,6 +48,7 @@ typedef struct message {
 uint8_t *tc_getY(uint8_t *data);
 uint32_t getSeed(void);
 void getNonce(uint8_t *out);
+void getNonceBBS(uint8_t *out);
 uint8_t galois_mult(uint8_t a, uint8_t b);
 void elementwise_mult(uint8_t *out, uint8_t *c1, uint8_t *c2);
 void vector_mult(uint8_t *out_ss, uint8_t *c1, uint8_t *c2);
@@ -43,6 +56,54 @@ void symmetric_encrypt(uint8_t *out, const uint8_t *in, size_t size, uint8_t *k)
 void symmetric_decrypt(uint8_t *out, const uint8_t *in, size_t size, uint8_t *k);
 void authentication_tag(uint8_t *out, const uint8_t *in, size_t size, uint8_t *k);
 void debug_printhex(uint8_t *d, size_t size, uint8_t flags);
+int taks_cache_init(int entries);
+const aes_fast_context *taks_key_context(const uint8_t *k);
+
+/*
+ * Silent cores of encrypt_pw() / decrypt_pw(): the same steps, no stdio.
+ * Keys come from cache (NULL: one expansion per message); out_ss and
+ * out_mac, if not NULL, get the shared secret and the computed MAC.
+ * taks_decrypt() returns -1 and leaves out_plaintext untouched when the MAC
+ * does not match.
+ */
+int taks_encrypt(aes_kcache *cache, uint8_t *out_ss, uint8_t *out_ciphertext, const uint8_t *plaintext, size_t size,
+                 uint8_t *out_mac, uint8_t *out_kri, uint8_t *src_LKC, uint8_t *src_TKC, uint8_t *dst_TKC);
+int taks_decrypt(aes_kcache *cache, uint8_t *out_ss, uint8_t *out_mac, uint8_t *out_plaintext, const uint8_t *ciphertext, size_t size,
+                 const uint8_t *mac, uint8_t *kri, uint8_t *node_LKC);
+
+/*
+ * Batch API: n messages of TAKS_PAYLOAD_LEN bytes into caller buffers, no
+ * stdio. threads > 1 splits the batch in contiguous slices, run by that
+ * many threads (the caller included, at most one per TAKS_BATCH_MIN
+ * messages), each with its own key-schedule cache.
+ *
+ * taks_encrypt_batch(): 0 or -errno.
+ * taks_decrypt_batch(): number of messages whose MAC did not match, their
+ * plaintext zeroed and status (if not NULL) -1, or -errno.
+ */
+int taks_encrypt_batch(message_t *out, const uint8_t *plaintext, size_t n,
+                       uint8_t *src_LKC, uint8_t *src_TKC, uint8_t *dst_TKC, int threads);
+int taks_decrypt_batch(uint8_t *out_plaintext, const message_t *in, size_t n,
+                       uint8_t *node_LKC, int *status, int threads);
+
+/*
+ * Key-schedule cache of the TAKS primitives, sized by taks_cache_init() (0:
+ * disabled, every call expands its key). Not thread-safe, the TAKS calls
+ * run on one thread.
+ */
+aes_kcache taks_kcache;
+
+int taks_cache_init(int entries)
+{
+    aes_kcache_destroy(&taks_kcache);
+    return aes_kcache_init(&taks_kcache, entries, aes_impl_get(), AES_RCON_FIXED);
+}
+
+/* Expanded k from the cache, NULL when disabled: the callee expands it. */
+const aes_fast_context *taks_key_context(const uint8_t *k)
+{
+    return aes_kcache_get(&taks_kcache, k);
+}
 
 uint32_t getSeed(void)
 {
@@ -50,7 +111,19 @@ uint32_t getSeed(void)
     return 0x11223344;
 }
 
+// Nonce scalars from the CTR_DRBG pool of the calling thread (taks_nonce.h),
+// the same non-zero byte for x and y
 void getNonce(uint8_t *out)
+{
+    if (taks_nonce_bytes(out, COMPLEN/2)) {
+        TAKS_LOG(TAKS_LOG_ERROR, "\n\t\t getNonce: no entropy for the nonce generator\n");
+        abort();
+    }
+    memcpy(tc_getY(out), out, COMPLEN/2);
+}
+
+// Blum-Blum-Shub generator of the first version, the baseline of noncebench
+void getNonceBBS(uint8_t *out)
 {
     int i, j;
     uint8_t p[4]; // TODO - increase size
@@ -127,67 +200,43 @@ int encrypt_pw(uint8_t *out_ciphertext, uint8_t *plaintext, size_t size,
                uint8_t *out_mac, uint8_t *out_kri, uint8_t *src_LKC,
                uint8_t *src_TKC, uint8_t *dst_TKC){
     uint8_t ss[TAKS_KEY_LEN];
-    uint8_t nonce[COMPLEN];
-    uint8_t alpha_LKC[COMPLEN];
 
-    printf("\n\n#################################### ENCRYPT #################################");
-    
-    printEncryptInputElements(out_ciphertext,plaintext,out_mac,out_kri,src_LKC,src_TKC,dst_TKC);
-    #ifdef DEBUG
-        printf("DONE: printEncryptInputElements(out_ciphertext,plaintext,out_mac,out_kri,src_LKC,src_TKC,dst_TKC)\n");
-    #endif
-    // 1. retrieve a nonce
-    getNonce(nonce);
-    #ifdef DEBUG
-        printf("DONE: getNonce(nonce);\n");
-    #endif
-    //print(nonce,sizeof(nonce),"ENCRYPT - nonce: ");
+    TAKS_LOG(TAKS_LOG_INFO, "\n\n#################################### ENCRYPT #################################");
 
-    // 2. obtain alpha*LKC
-    elementwise_mult(alpha_LKC, nonce, src_LKC);
-    #ifdef DEBUG
-        printf("DONE: elementwise_mult(alpha_LKC, nonce, src_LKC);\n");
-    #endif
-    // 3. obtain the SS
-    vector_mult(ss, alpha_LKC, dst_TKC);
-    print(ss,16,"ENCRYPT - SS: ");
-     #ifdef DEBUG
-        printf("DONE: vector_mult(ss, alpha_LKC, dst_TKC);\n");
-    #endif
+    if (TAKS_LOG_ON(TAKS_LOG_DEBUG))
+        printEncryptInputElements(out_ciphertext,plaintext,out_mac,out_kri,src_LKC,src_TKC,dst_TKC);
 
-    // 4. obtain the KRI
-    elementwise_mult(out_kri, nonce, src_TKC);
-     #ifdef DEBUG
-        printf("DONE: elementwise_mult(out_kri, nonce, src_TKC);\n");
-    #endif
-    //print(out_kri,32,"ENCRYPT - elementwise_mult - out_kri: ");
+    taks_encrypt(&taks_kcache, ss, out_ciphertext, plaintext, size, out_mac, out_kri, src_LKC, src_TKC, dst_TKC);
 
-    symmetric_encrypt(out_ciphertext, plaintext, size, ss);
-    print(out_ciphertext,16,"ENCRYPT - out_ciphertext: ");
+    if (TAKS_LOG_ON(TAKS_LOG_DEBUG)) {
+        print(ss,16,"ENCRYPT - SS: ");
+        print(out_ciphertext,16,"ENCRYPT - out_ciphertext: ");
+        print(out_mac,4,"ENCRYPT - out_mac: ");
+    }
 
-    authentication_tag(out_mac, out_ciphertext, size, ss);
-    print(out_mac,4,"ENCRYPT - out_mac: ");
+    TAKS_LOG(TAKS_LOG_INFO, "\n\n###################################################################################");
+
+    if (!TAKS_LOG_ON(TAKS_LOG_DEBUG))
+        return 0;
 
-    printf("\n\n###################################################################################");
-    
-    
-    
-    
-    
     printf("\n\n    ||----------------------------------------------------------------------------||"); //DM INIT
     aes256_context payloadTest;
     uint8_t plainTextTest[TAKS_PAYLOAD_LEN];
     uint8_t feedback[16];
     uint8_t macTest[TAKS_MAC_LEN];
+    const aes_fast_context *ss_ctx = taks_key_context(ss);
     print(NULL, 0, "        ENCRYPT - STARTING COMPATIBILITY TEST: ");
     //print(ss,TAKS_KEY_LEN,"        ENCRYPT - SS: ");
-    aes256_init(&payloadTest, ss);
     int i;
     for (i = 0; i < 16; ++i) {
         feedback[i]= 0;
     }
-    aes256_init(&payloadTest, ss);
-    aes256_encrypt_ecb(&payloadTest, feedback);
+    if (ss_ctx) {
+        aes_fast_encrypt(ss_ctx, feedback, feedback, 1);
+    } else {
+        aes256_init(&payloadTest, ss);
+        aes256_encrypt_ecb(&payloadTest, feedback);
+    }
     for (i = 0; i < 16; ++i) {
         plainTextTest[i]= plaintext[i] ^ feedback[i];
     }
@@ -200,61 +249,59 @@ int encrypt_pw(uint8_t *out_ciphertext, uint8_t *plaintext, size_t size,
 
 
     printf("\n\n    ||----------------------------------------------------------------------------||"); //DM END
-    
-    
-    
-    
-    
-    
-    
+
     return 0;
 }
 
 int decrypt_pw(uint8_t *out_plaintext, uint8_t *ciphertext, size_t size,
                uint8_t *mac, uint8_t *kri, uint8_t *node_LKC){
-    printf("\n\n#################################### DECRYPT #################################");
+    TAKS_LOG(TAKS_LOG_INFO, "\n\n#################################### DECRYPT #################################");
     int i;
     uint8_t ss[TAKS_KEY_LEN];
     uint8_t computed_mac[TAKS_MAC_LEN];
-    size_t minsize;
+    int r;
 
-    printDecryptInputElements(out_plaintext,ciphertext,mac,kri,node_LKC);
+    if (TAKS_LOG_ON(TAKS_LOG_DEBUG))
+        printDecryptInputElements(out_plaintext,ciphertext,mac,kri,node_LKC);
 
-    vector_mult(ss, kri, node_LKC);
-    print(ss,16,"DECRYPT - SS: ");
+    r = taks_decrypt(&taks_kcache, ss, computed_mac, out_plaintext, ciphertext, size, mac, kri, node_LKC);
 
-    authentication_tag(computed_mac, ciphertext, size, ss);
-    print(computed_mac,TAKS_MAC_LEN,"DECRYPT - computed_mac: ");
-    print(mac,TAKS_MAC_LEN,"DECRYPT - mac: ");
+    if (TAKS_LOG_ON(TAKS_LOG_DEBUG)) {
+        print(ss,16,"DECRYPT - SS: ");
+        print(computed_mac,TAKS_MAC_LEN,"DECRYPT - computed_mac: ");
+        print(mac,TAKS_MAC_LEN,"DECRYPT - mac: ");
+    }
 
-    for (i = 0; i < TAKS_MAC_LEN; ++i) {
-        if (computed_mac[i] != mac[i]) {
-            printf("\n\nDECRYPT - SRC_MAC != DES_MAC");
-            return -1;
-        }
+    if (r) {
+        TAKS_LOG(TAKS_LOG_ERROR, "\n\nDECRYPT - SRC_MAC != DES_MAC");
+        return -1;
     }
-    symmetric_decrypt(out_plaintext, ciphertext, size, ss);
-    printf("\n\nDECRYPT - MESSAGE DECRYPTED: %s",out_plaintext);
-    printf("\n\n###################################################################################");
+    TAKS_LOG(TAKS_LOG_INFO, "\n\nDECRYPT - MESSAGE DECRYPTED: %.*s", (int)size, out_plaintext);
+    TAKS_LOG(TAKS_LOG_INFO, "\n\n###################################################################################");
+
+    if (!TAKS_LOG_ON(TAKS_LOG_DEBUG))
+        return 0;
 
-    
-    
-    
     printf("\n\n    ||----------------------------------------------------------------------------||"); //DM INIT
     aes256_context payloadTest;
     uint8_t plainTextTest[TAKS_PAYLOAD_LEN];
     uint8_t feedback[16];
+    const aes_fast_context *ss_ctx = taks_key_context(ss);
     print(NULL ,0,"        DECRYPT - STARTING COMPATIBILITY TEST: ");
         
     for (i = 0; i < 16; ++i) {
 	feedback[i]= 0;
     }
-    aes256_init(&payloadTest, ss);
-    aes256_encrypt_ecb(&payloadTest, feedback);
+    if (ss_ctx) {
+        aes_fast_encrypt(ss_ctx, feedback, feedback, 1);
+    } else {
+        aes256_init(&payloadTest, ss);
+        aes256_encrypt_ecb(&payloadTest, feedback);
+    }
     for (i = 0; i < 16; ++i) {
 	plainTextTest[i]= ciphertext[i] ^ feedback[i];
     }
-    printf("\n\n        DECRYPT - MESSAGE DECRYPTED: %s",plainTextTest);
+    printf("\n\n        DECRYPT - MESSAGE DECRYPTED: %.*s", TAKS_PAYLOAD_LEN, plainTextTest);
 
 
     printf("\n\n    ||----------------------------------------------------------------------------||"); //DM END
@@ -268,7 +315,8 @@ uint8_t *tc_getY(uint8_t *data) {
 
 void componentFromHexString(uint8_t *data, const char *s){
     int i;
-    uint8_t subs[2];
+    uint8_t subs[3];
+    subs[2] = 0; // strtoul() reads up to the terminator
     for (i = 0; i < COMPLEN; ++i) {
         uint8_t value;
         subs[0] = s[2*i];
@@ -278,42 +326,22 @@ void componentFromHexString(uint8_t *data, const char *s){
     }
 }
 
+// GF(2^8) products through the engine of taks_gf_get(), see taks_gf.h
 uint8_t galois_mult(uint8_t a, uint8_t b){
-    uint8_t p = 0;
-    while (a && b) {
-        if (b & 1)
-            p ^= a;
-        if (a & 0x80)
-            a = (a << 1) ^ POLY;
-        else
-            a <<= 1;
-        b >>= 1;
-    }
-    return p;
+    return taks_gf_mul(a, b);
 }
 
 void elementwise_mult(uint8_t *out, uint8_t *c1, uint8_t *c2){
-    int i;
-    for (i = 0; i < COMPLEN; ++i) {
-        out[i] = galois_mult(c1[i], c2[i]);
-    }
+    taks_gf_mul_n(taks_gf_get(), out, c1, c2, COMPLEN);
 }
 
 void vector_mult(uint8_t *out_ss, uint8_t *c1, uint8_t *c2){
-    int i;
-    uint8_t *ss = out_ss;
-    uint8_t *p1x = c1;
-    uint8_t *p1y = tc_getY(c1);
-    uint8_t *p2x = c2;
-    uint8_t *p2y = tc_getY(c2);
-    for (i = 0; i < TAKS_KEY_LEN; ++i) {
-        ss[i] = galois_mult(p1x[i], p2x[i]) ^ galois_mult(p1y[i], p2y[i]);
-    }
+    taks_gf_dot2(taks_gf_get(), out_ss, c1, c2, tc_getY(c1), tc_getY(c2), TAKS_KEY_LEN);
 }
 
 void symmetric_encrypt(uint8_t *out, const uint8_t *in, size_t size, uint8_t *k){
 #if defined(TAKS_USE_AES)
-    AES_Encrypt_CTR(out, k, in, size);
+    AES_Encrypt_CTR_Ctx(out, taks_key_context(k), k, in, size);
 #elif defined(TAKS_SIMPLE)
     int i;
     for (i = 0; i < size; ++i) {
@@ -326,7 +354,7 @@ void symmetric_encrypt(uint8_t *out, const uint8_t *in, size_t size, uint8_t *k)
 
 void symmetric_decrypt(uint8_t *out, const uint8_t *in, size_t size, uint8_t *k){
 #if defined(TAKS_USE_AES)
-    AES_Decrypt_CTR(out, k, in, size);
+    AES_Decrypt_CTR_Ctx(out, taks_key_context(k), k, in, size);
 #elif defined(TAKS_SIMPLE)
     int i;
     for (i = 0; i < size; ++i) {
@@ -339,7 +367,7 @@ void symmetric_decrypt(uint8_t *out, const uint8_t *in, size_t size, uint8_t *k)
 
 void authentication_tag(uint8_t *out, const uint8_t *in, size_t size, uint8_t *k){
 #if defined(TAKS_USE_AES)
-    AES_CBC_MAC(out, k, in, size);
+    AES_CBC_MAC_Ctx(out, taks_key_context(k), k, in, size);
 #elif defined(TAKS_SIMPLE)
     int i;
     uint8_t checksum = 0;
@@ -357,6 +385,228 @@ void authentication_tag(uint8_t *out, const uint8_t *in, size_t size, uint8_t *k
 #endif
 }
 
+/* -------------------------------------------------------------------------- */
+/*  Batch and silent API                                                      */
+/* -------------------------------------------------------------------------- */
+
+static const aes_fast_context *taks_context(aes_kcache *cache, const uint8_t *k, aes_fast_context *local)
+{
+    if (cache && cache->entries)
+        return aes_kcache_get(cache, k);
+    if (aes_fast_init(local, k, aes_impl_get(), AES_RCON_FIXED) == 0)
+        return local;
+    return NULL;
+}
+
+/* symmetric_encrypt() / symmetric_decrypt() without the trace: CTR is its own inverse. */
+static void taks_ctr(const aes_fast_context *fast, uint8_t *out, const uint8_t *in, size_t size, uint8_t *k)
+{
+#if defined(TAKS_USE_AES) && !defined(HARDWARE)
+    uint8_t ctr[16], block[16];
+    size_t b;
+    int i;
+
+    memset(ctr, 0, 16);
+    if (fast) {
+        aes_fast_ctr(fast, out, in, size / 16, ctr);
+        return;
+    }
+    for (b = 0; b < size / 16; ++b) {
+        AES_Encrypt_Block(block, k, ctr);
+        for (i = 0; i < 16; ++i)
+            out[b*16 + i] = in[b*16 + i] ^ block[i];
+        AES_Util_Increment(ctr, 16);
+    }
+#elif defined(TAKS_USE_AES)
+    // Not symmetric_encrypt(): its key lookup goes through the global
+    // taks_kcache, which the batch workers must not touch
+    AES_Encrypt_CTR_Ctx(out, fast, k, in, size);
+#else
+    symmetric_encrypt(out, in, size, k);
+#endif
+}
+
+static void taks_tag(const aes_fast_context *fast, uint8_t *out, const uint8_t *in, size_t size, uint8_t *k)
+{
+#if defined(TAKS_USE_AES)
+    AES_CBC_MAC_Ctx(out, fast, k, in, size);
+#else
+    authentication_tag(out, in, size, k);
+#endif
+}
+
+int taks_encrypt(aes_kcache *cache, uint8_t *out_ss, uint8_t *out_ciphertext, const uint8_t *plaintext, size_t size,
+                 uint8_t *out_mac, uint8_t *out_kri, uint8_t *src_LKC, uint8_t *src_TKC, uint8_t *dst_TKC)
+{
+    uint8_t ss[TAKS_KEY_LEN];
+    uint8_t nonce[COMPLEN];
+    uint8_t alpha_LKC[COMPLEN];
+    aes_fast_context local;
+    const aes_fast_context *fast;
+
+    // 1. retrieve a nonce
+    getNonce(nonce);
+    // 2. obtain alpha*LKC
+    elementwise_mult(alpha_LKC, nonce, src_LKC);
+    // 3. obtain the SS
+    vector_mult(ss, alpha_LKC, dst_TKC);
+    // 4. obtain the KRI
+    elementwise_mult(out_kri, nonce, src_TKC);
+
+    fast = taks_context(cache, ss, &local);
+    taks_ctr(fast, out_ciphertext, plaintext, size, ss);
+    taks_tag(fast, out_mac, out_ciphertext, size, ss);
+
+    if (out_ss)
+        memcpy(out_ss, ss, TAKS_KEY_LEN);
+    return 0;
+}
+
+int taks_decrypt(aes_kcache *cache, uint8_t *out_ss, uint8_t *out_mac, uint8_t *out_plaintext, const uint8_t *ciphertext, size_t size,
+                 const uint8_t *mac, uint8_t *kri, uint8_t *node_LKC)
+{
+    uint8_t ss[TAKS_KEY_LEN];
+    uint8_t computed_mac[TAKS_MAC_LEN];
+    uint8_t diff = 0;
+    aes_fast_context local;
+    const aes_fast_context *fast;
+    int i;
+
+    vector_mult(ss, kri, node_LKC);
+    fast = taks_context(cache, ss, &local);
+    taks_tag(fast, computed_mac, ciphertext, size, ss);
+
+    if (out_ss)
+        memcpy(out_ss, ss, TAKS_KEY_LEN);
+    if (out_mac)
+        memcpy(out_mac, computed_mac, TAKS_MAC_LEN);
+
+    for (i = 0; i < TAKS_MAC_LEN; ++i)
+        diff |= computed_mac[i] ^ mac[i];
+    if (diff)
+        return -1;
+
+    taks_ctr(fast, out_plaintext, ciphertext, size, ss);
+    return 0;
+}
+
+typedef struct {
+    message_t *msg;         // encrypt: out, decrypt: in
+    uint8_t *text;          // encrypt: in, decrypt: out
+    size_t n;
+    uint8_t *LKC;           // src_LKC / node_LKC
+    uint8_t *src_TKC;
+    uint8_t *dst_TKC;
+    int *status;
+    int decrypt;
+    int result;             // failed MACs or -errno
+} taks_batch_job;
+
+static void *taks_batch_worker(void *arg)
+{
+    taks_batch_job *job = (taks_batch_job *)arg;
+    aes_kcache cache;
+    size_t i;
+    int r;
+
+    job->result = aes_kcache_init(&cache, TAKS_KCACHE_ENTRIES, aes_impl_get(), AES_RCON_FIXED);
+    if (job->result)
+        return NULL;
+
+    for (i = 0; i < job->n; ++i) {
+        message_t *m = &job->msg[i];
+        uint8_t *t = &job->text[TAKS_PAYLOAD_LEN * i];
+
+        if (!job->decrypt) {
+            taks_encrypt(&cache, NULL, m->payload, t, TAKS_PAYLOAD_LEN, m->mac, m->kri,
+                         job->LKC, job->src_TKC, job->dst_TKC);
+            continue;
+        }
+        r = taks_decrypt(&cache, NULL, NULL, t, m->payload, TAKS_PAYLOAD_LEN, m->mac, m->kri, job->LKC);
+        if (r) {
+            memset(t, 0, TAKS_PAYLOAD_LEN);
+            job->result++;
+        }
+        if (job->status)
+            job->status[i] = r;
+    }
+
+    aes_kcache_destroy(&cache);
+    return NULL;
+}
+
+static int taks_batch_run(taks_batch_job *all, int threads)
+{
+    taks_batch_job job[TAKS_BATCH_MAX_THREADS];
+    pthread_t tid[TAKS_BATCH_MAX_THREADS];
+    int started[TAKS_BATCH_MAX_THREADS];
+    int k, result = 0;
+
+    if (threads > TAKS_BATCH_MAX_THREADS)
+        threads = TAKS_BATCH_MAX_THREADS;
+    if ((size_t)threads > all->n / TAKS_BATCH_MIN)
+        threads = (int)(all->n / TAKS_BATCH_MIN);
+    if (threads < 1)
+        threads = 1;
+
+    for (k = 0; k < threads; ++k) {
+        const size_t first = all->n * k / threads;
+
+        job[k] = *all;
+        job[k].msg = &all->msg[first];
+        job[k].text = &all->text[TAKS_PAYLOAD_LEN * first];
+        job[k].status = all->status ? &all->status[first] : NULL;
+        job[k].n = all->n * (k + 1) / threads - first;
+        // slice 0 on the caller, the others on their own thread if it starts
+        started[k] = k > 0 && pthread_create(&tid[k], NULL, taks_batch_worker, &job[k]) == 0;
+    }
+    for (k = 0; k < threads; ++k)
+        if (!started[k])
+            taks_batch_worker(&job[k]);
+    for (k = 0; k < threads; ++k) {
+        if (started[k])
+            pthread_join(tid[k], NULL);
+        if (job[k].result < 0)
+            result = job[k].result;
+        else if (result >= 0)
+            result += job[k].result;
+    }
+
+    return result;
+}
+
+int taks_encrypt_batch(message_t *out, const uint8_t *plaintext, size_t n,
+                       uint8_t *src_LKC, uint8_t *src_TKC, uint8_t *dst_TKC, int threads)
+{
+    taks_batch_job all;
+
+    memset(&all, 0, sizeof(all));
+    all.msg = out;
+    all.text = (uint8_t *)plaintext;
+    all.n = n;
+    all.LKC = src_LKC;
+    all.src_TKC = src_TKC;
+    all.dst_TKC = dst_TKC;
+
+    return taks_batch_run(&all, threads);
+}
+
+int taks_decrypt_batch(uint8_t *out_plaintext, const message_t *in, size_t n,
+                       uint8_t *node_LKC, int *status, int threads)
+{
+    taks_batch_job all;
+
+    memset(&all, 0, sizeof(all));
+    all.msg = (message_t *)in;
+    all.text = out_plaintext;
+    all.n = n;
+    all.LKC = node_LKC;
+    all.status = status;
+    all.decrypt = 1;
+
+    return taks_batch_run(&all, threads);
+}
+
 void debug_printhex(uint8_t *d, size_t size, uint8_t flags){
     printf("\n\n PRINTHEX: \n");
     int i;
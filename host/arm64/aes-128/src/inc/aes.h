@@ -2,6 +2,9 @@
 #define WT_CRYPTO_AES_H
 
 #include "axis_aes128_drivers/axis_aes128.c"
+#include "axis_aes128_drivers/axis_aes128_kc.c"
+#include "aes_fast.h"
+#include "taks_log.h"
 #include <time.h>
 
 #define KEYLEN 128
@@ -9,7 +12,9 @@
 #define TAKS_MAC_LEN 4
 
 //#define HARDWARE
+#if TAKS_LOG_ON(TAKS_LOG_DEBUG)
 #define TIMING
+#endif
 
 struct AES_Context {
 	uint8_t key[KEYLEN];
@@ -72,6 +77,10 @@ static uint8_t Table_InvMixColumn[16] = {
 void AES_CBC_MAC(uint8_t *output, const uint8_t *key, const uint8_t *text, uint16_t plen);
 void AES_Decrypt_CTR(uint8_t *output, const uint8_t *key/*, const uint8_t *iv*/, const uint8_t *cipher, uint16_t clen);
 void AES_Encrypt_CTR(uint8_t *output, const uint8_t *key/*, const uint8_t *iv*/, const uint8_t *plain, uint16_t plen);;
+// Same with the key already expanded, e.g. by aes_kcache_get(); fast == NULL expands key
+void AES_CBC_MAC_Ctx(uint8_t *output, const aes_fast_context *fast, const uint8_t *key, const uint8_t *text, uint16_t plen);
+void AES_Decrypt_CTR_Ctx(uint8_t *output, const aes_fast_context *fast, const uint8_t *key, const uint8_t *cipher, uint16_t clen);
+void AES_Encrypt_CTR_Ctx(uint8_t *output, const aes_fast_context *fast, const uint8_t *key, const uint8_t *plain, uint16_t plen);
 void AES_Util_Increment(uint8_t *number, size_t size);
 void AES_Decrypt_Block(uint8_t *output, const uint8_t *key, const uint8_t *cblock);
 void AES_Encrypt_Block(uint8_t *output, const uint8_t *key, const uint8_t *block);
@@ -213,6 +222,13 @@ void AES_Encrypt_Block(uint8_t *output, const uint8_t *key, const uint8_t *block
 	uint8_t *state = output;
 	int i, R;
 
+	if (aes_impl_get() != AES_IMPL_REF) {
+		aes_fast_context fast;
+		aes_fast_init(&fast, key, aes_impl_get(), AES_RCON_FIXED);
+		aes_fast_encrypt(&fast, output, block, 1);
+		return;
+	}
+
 	for (i = 0; i < 16; ++i)
 		state[i] = block[i];
 	InitKey(&context, key);
@@ -234,6 +250,13 @@ void AES_Decrypt_Block(uint8_t *output, const uint8_t *key, const uint8_t *cbloc
 	uint8_t *state = output;
 	int i, R;
 
+	if (aes_impl_get() != AES_IMPL_REF) {
+		aes_fast_context fast;
+		aes_fast_init(&fast, key, aes_impl_get(), AES_RCON_FIXED);
+		aes_fast_decrypt(&fast, output, cblock, 1);
+		return;
+	}
+
 	for (i = 0; i < 16; ++i)
 		state[i] = cblock[i];
 	InitKey(&context, key);
@@ -252,7 +275,7 @@ void AES_Decrypt_Block(uint8_t *output, const uint8_t *key, const uint8_t *cbloc
 void AES_Util_Increment(uint8_t *number, size_t size)
 {
 	int i = size - 1;
-	while (number[i] == 0xFF && i >= 0) {
+	while (i >= 0 && number[i] == 0xFF) {
 		number[i] = 0;
 		i--;
 	}
@@ -268,6 +291,11 @@ void printOwn(uint8_t *input, int size, const char *message){
         printf("%02x", input[i]);
 }
 void AES_Encrypt_CTR(uint8_t *output, const uint8_t *key, const uint8_t *plain, uint16_t plen)
+{
+	AES_Encrypt_CTR_Ctx(output, NULL, key, plain, plen);
+}
+
+void AES_Encrypt_CTR_Ctx(uint8_t *output, const aes_fast_context *fast, const uint8_t *key, const uint8_t *plain, uint16_t plen)
 {
 	#ifdef HARDWARE // use the hardware accelerator
 		axis_aes128_load("axis_aes128_drivers/axis_aes128_design_1_wrapper.bin");
@@ -294,6 +322,42 @@ void AES_Encrypt_CTR(uint8_t *output, const uint8_t *key, const uint8_t *plain,
 	//	feedback[i] = iv[i];
 
 	
+	#ifdef HARDWARE
+	{
+		// All counter blocks in one DMA transaction
+		uint8_t ctr[256*16];
+		for (b = 0; b < nblocks; ++b) {
+			memcpy(&ctr[b*16], feedback, 16);
+			AES_Util_Increment(feedback, 16);
+		}
+		axis_aes128_encrypt_bulk(&axis_aes128_addr, ctr, ctr, nblocks, key, rc, AES128_BEAT_WORD);
+		for (b = 0; b < nblocks; ++b) {
+			for (i = 0; i < 16; ++i)
+				output[b*16 + i] = plain[b*16 + i] ^ ctr[b*16 + i];
+			if (TAKS_LOG_ON(TAKS_LOG_DEBUG)) {
+	    		printOwn(&ctr[b*16],16,"        ENCRYPT - FEEDBACK: ");
+	    		printf("\n\n\t\t NBLOCKS:\t%d\n\n", nblocks);
+			}
+		}
+		nblocks = 0;
+	}
+	#else
+	aes_fast_context local;
+	if (fast == NULL && aes_fast_init(&local, key, aes_impl_get(), AES_RCON_FIXED) == 0)
+		fast = &local;
+	if (fast) {
+		// One key schedule, counter blocks through the multi-block engine
+		aes_fast_ctr(fast, output, plain, nblocks, feedback);
+		for (b = 0; TAKS_LOG_ON(TAKS_LOG_DEBUG) && b < nblocks; ++b) {
+			for (i = 0; i < 16; ++i)
+				block[i] = output[b*16 + i] ^ plain[b*16 + i];
+	    	printOwn(block,16,"        ENCRYPT - FEEDBACK: ");
+	    	printf("\n\n\t\t NBLOCKS:\t%d\n\n", nblocks);
+		}
+		nblocks = 0;
+	}
+	#endif
+
 	for (b = 0; b < nblocks; ++b) {
 		#ifdef HARDWARE // use the hardware accelerator
         // 2. send data to the accelerator
@@ -309,8 +373,10 @@ void AES_Encrypt_CTR(uint8_t *output, const uint8_t *key, const uint8_t *plain,
 		for (i = 0; i < 16; ++i)
 			output[b*16+i] = plain[b*16 + i] ^ block[i];
 		AES_Util_Increment(feedback, 16);
-    	printOwn(block,16,"        ENCRYPT - FEEDBACK: ");
-    	printf("\n\n\t\t NBLOCKS:\t%d\n\n", nblocks);
+		if (TAKS_LOG_ON(TAKS_LOG_DEBUG)) {
+    		printOwn(block,16,"        ENCRYPT - FEEDBACK: ");
+    		printf("\n\n\t\t NBLOCKS:\t%d\n\n", nblocks);
+		}
 	}
 	#ifdef TIMING
 	end = clock();
@@ -331,6 +397,11 @@ void AES_Encrypt_CTR(uint8_t *output, const uint8_t *key, const uint8_t *plain,
 }
 
 void AES_Decrypt_CTR(uint8_t *output, const uint8_t *key, const uint8_t *cipher, uint16_t clen)
+{
+	AES_Decrypt_CTR_Ctx(output, NULL, key, cipher, clen);
+}
+
+void AES_Decrypt_CTR_Ctx(uint8_t *output, const aes_fast_context *fast, const uint8_t *key, const uint8_t *cipher, uint16_t clen)
 {
 	#ifdef HARDWARE // use the hardware accelerator
 		axis_aes128_load("axis_aes128_drivers/axis_aes128_design_1_wrapper.bin");
@@ -356,6 +427,29 @@ void AES_Decrypt_CTR(uint8_t *output, const uint8_t *key, const uint8_t *cipher,
 		feedback[i] = 0; // TODO
 		//feedback[i] = iv[i];
 
+	#ifdef HARDWARE
+	{
+		// All counter blocks in one DMA transaction
+		uint8_t ctr[256*16];
+		for (b = 0; b < nblocks; ++b) {
+			memcpy(&ctr[b*16], feedback, 16);
+			AES_Util_Increment(feedback, 16);
+		}
+		axis_aes128_encrypt_bulk(&axis_aes128_addr, ctr, ctr, nblocks, key, rc, AES128_BEAT_WORD);
+		for (b = 0; b < nblocks*16; ++b)
+			output[b] = cipher[b] ^ ctr[b];
+		nblocks = 0;
+	}
+	#else
+	aes_fast_context local;
+	if (fast == NULL && aes_fast_init(&local, key, aes_impl_get(), AES_RCON_FIXED) == 0)
+		fast = &local;
+	if (fast) {
+		aes_fast_ctr(fast, output, cipher, nblocks, feedback);
+		nblocks = 0;
+	}
+	#endif
+
 	for (b = 0; b < nblocks; ++b) {
 		#ifdef HARDWARE // use the hardware accelerator
         // 2. send data to the accelerator
@@ -392,20 +486,35 @@ void AES_Decrypt_CTR(uint8_t *output, const uint8_t *key, const uint8_t *cipher,
 }
 
 void AES_CBC_MAC(uint8_t *output, const uint8_t *key, const uint8_t *text, uint16_t plen)
+{
+	AES_CBC_MAC_Ctx(output, NULL, key, text, plen);
+}
+
+void AES_CBC_MAC_Ctx(uint8_t *output, const aes_fast_context *fast, const uint8_t *key, const uint8_t *text, uint16_t plen)
 {
 	uint8_t nblocks = (plen >> 4); // length should be a multiple of the blocksize (16)
 	uint8_t block[16];
 	uint8_t feedback[16];
 	int i, b;
 
+	aes_fast_context local;
+	if (fast == NULL && aes_fast_init(&local, key, aes_impl_get(), AES_RCON_FIXED) == 0)
+		fast = &local;
+
 	// NONCE
 	for (i = 0; i < 16; ++i)
 		feedback[i] = 0;
-	AES_Encrypt_Block(feedback, key, feedback);
+	if (fast)
+		aes_fast_encrypt(fast, feedback, feedback, 1);
+	else
+		AES_Encrypt_Block(feedback, key, feedback);
 	for (b = 0; b < nblocks; ++b) {
 		for (i = 0; i < 16; ++i)
 			block[i] = text[b*16 + i] ^ feedback[i];
-		AES_Encrypt_Block(feedback, key, block);
+		if (fast)
+			aes_fast_encrypt(fast, feedback, block, 1);
+		else
+			AES_Encrypt_Block(feedback, key, block);
 	}
 
 	for (i = 0; i < TAKS_MAC_LEN; ++i)
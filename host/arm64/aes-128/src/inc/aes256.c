@@ -17,6 +17,7 @@
 *   ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
 *   OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
+#include <string.h>
 #include "aes256.h"
 
 #define FD(x)  (((x) >> 1) ^ (((x) & 1) ? 0x8d : 0))
@@ -219,7 +220,7 @@ static void aes_addRoundKey_cpy(uint8_t *buf, uint8_t *key, uint8_t *cpk)
 {
     register uint8_t i = 16;
 
-    while (i--)  buf[i] ^= (cpk[i] = key[i]), cpk[16 + i] = key[16 + i];
+    while (i--)  buf[i] ^= (cpk[i] = key[i]);
 } /* aes_addRoundKey_cpy */
 
 
@@ -324,22 +325,14 @@ void aes_expandDecKey(uint8_t *k, uint8_t *rc)
 {
     uint8_t i;
 
-    for(i = 28; i > 16; i -= 4) k[i + 0] ^= k[i - 4], k[i + 1] ^= k[i - 3],
-                                                k[i + 2] ^= k[i - 2], k[i + 3] ^= k[i - 1];
-
-    k[16] ^= rj_sbox(k[12]);
-    k[17] ^= rj_sbox(k[13]);
-    k[18] ^= rj_sbox(k[14]);
-    k[19] ^= rj_sbox(k[15]);
-
+    // Inverse of aes_expandEncKey() on the 16 B key, rcon kept as is.
     for(i = 12; i > 0; i -= 4)  k[i + 0] ^= k[i - 4], k[i + 1] ^= k[i - 3],
                                                 k[i + 2] ^= k[i - 2], k[i + 3] ^= k[i - 1];
 
-    *rc = FD(*rc);
-    k[0] ^= rj_sbox(k[29]) ^ (*rc);
-    k[1] ^= rj_sbox(k[30]);
-    k[2] ^= rj_sbox(k[31]);
-    k[3] ^= rj_sbox(k[28]);
+    k[0] ^= rj_sbox(k[13]) ^ (*rc);
+    k[1] ^= rj_sbox(k[14]);
+    k[2] ^= rj_sbox(k[15]);
+    k[3] ^= rj_sbox(k[12]);
 } /* aes_expandDecKey */
 
 
@@ -350,7 +343,10 @@ void aes256_init(aes256_context *ctx, uint8_t *k)
     register uint8_t i;
 
     for (i = 0; i < sizeof(ctx->key); i++) ctx->enckey[i] = ctx->deckey[i] = k[i];
-    for (i = 8; --i;) aes_expandEncKey(ctx->deckey, &rcon);
+    // Last round key of the 10 round schedule, aes256_encrypt_ecb()
+    for (i = 0; i < 10; i++) aes_expandEncKey(ctx->deckey, &rcon);
+
+    aes_fast_init(&ctx->fast, k, aes_impl_get(), AES_RCON_FIXED);
 } /* aes256_init */
 
 /* -------------------------------------------------------------------------- */
@@ -360,6 +356,7 @@ void aes256_done(aes256_context *ctx)
 
     for (i = 0; i < sizeof(ctx->key); i++)
         ctx->key[i] = ctx->enckey[i] = ctx->deckey[i] = 0;
+    memset(&ctx->fast, 0, sizeof(ctx->fast));
 } /* aes256_done */
 
 /* -------------------------------------------------------------------------- */
@@ -373,6 +370,11 @@ void aes256_encrypt_ecb(aes256_context *ctx, uint8_t *buf)
 {
     uint8_t i, rcon;
 
+    if (ctx->fast.impl != AES_IMPL_REF) {
+        aes_fast_encrypt(&ctx->fast, buf, buf, 1);
+        return;
+    }
+
     aes_addRoundKey_cpy(buf, ctx->enckey, ctx->key);
     /*for(i = 1, rcon = 1; i < 14; ++i)
     {
@@ -426,21 +428,24 @@ void aes256_decrypt_ecb(aes256_context *ctx, uint8_t *buf)
 {
     uint8_t i, rcon;
 
+    if (ctx->fast.impl != AES_IMPL_REF) {
+        aes_fast_decrypt(&ctx->fast, buf, buf, 1);
+        return;
+    }
+
+    // Inverse of aes256_encrypt_ecb(), round keys walked back from deckey
     aes_addRoundKey_cpy(buf, ctx->deckey, ctx->key);
     aes_shiftRows_inv(buf);
     aes_subBytes_inv(buf);
 
-    for (i = 14, rcon = 0x80; --i;)
+    for (i = 0, rcon = 1; i < 10 - 1; ++i)
     {
-        if( ( i & 1 ) )
-        {
-            aes_expandDecKey(ctx->key, &rcon);
-            aes_addRoundKey(buf, &ctx->key[16]);
-        }
-        else aes_addRoundKey(buf, ctx->key);
+        aes_expandDecKey(ctx->key, &rcon);
+        aes_addRoundKey(buf, ctx->key);
         aes_mixColumns_inv(buf);
         aes_shiftRows_inv(buf);
         aes_subBytes_inv(buf);
     }
-    aes_addRoundKey( buf, ctx->key);
+    aes_expandDecKey(ctx->key, &rcon);
+    aes_addRoundKey(buf, ctx->key);
 } /* aes256_decrypt */
@@ -21,6 +21,8 @@
 #ifndef AES_256_H
 #define AES_256_H
 
+#include "aes_fast.h"
+
 #ifndef uint8_t
 #define uint8_t  unsigned char
 #endif
@@ -37,6 +39,7 @@ extern "C" {
         uint8_t key[16]; 	//DM
         uint8_t enckey[16]; 	//DM
         uint8_t deckey[16];	//DM
+        aes_fast_context fast;  // engine from aes_impl_get(), unused for AES_IMPL_REF
     } aes256_context; 
 
 
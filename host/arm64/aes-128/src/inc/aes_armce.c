@@ -0,0 +1,175 @@
+/*
+*   AES-128 on the ARMv8 Cryptography Extensions (AESE/AESMC, AESD/AESIMC).
+*
+*   Built with -march=armv8-a+crypto (see CMakeLists.txt) and only called
+*   when aes_impl_available(AES_IMPL_ARMCE) found the instructions at run
+*   time. Round keys are the byte-order schedules of aes_fast_context.
+*
+*   Four independent blocks are kept in flight: on the A53 an AESE/AESMC
+*   pair issues every cycle but has a few cycles of latency, so one block
+*   alone leaves the unit mostly idle.
+*/
+
+#include "aes_fast.h"
+
+#ifdef __aarch64__
+
+#include <arm_neon.h>
+
+#define AES_CE_LANES    4
+
+/* -------------------------------------------------------------------------- */
+static inline uint8x16_t aes_ce_enc1(const uint8x16_t *k, uint8x16_t s)
+{
+    int r;
+
+    for (r = 0; r < 9; r++)
+        s = vaesmcq_u8(vaeseq_u8(s, k[r]));
+
+    return veorq_u8(vaeseq_u8(s, k[9]), k[10]);
+}
+
+static inline uint8x16_t aes_ce_dec1(const uint8x16_t *k, uint8x16_t s)
+{
+    int r;
+
+    for (r = 0; r < 9; r++)
+        s = vaesimcq_u8(vaesdq_u8(s, k[r]));
+
+    return veorq_u8(vaesdq_u8(s, k[9]), k[10]);
+}
+
+/* 4 blocks through the rounds side by side. */
+static inline void aes_ce_enc4(const uint8x16_t *k, uint8x16_t *s0, uint8x16_t *s1, uint8x16_t *s2, uint8x16_t *s3)
+{
+    uint8x16_t a = *s0, b = *s1, c = *s2, d = *s3;
+    int r;
+
+    for (r = 0; r < 9; r++) {
+        a = vaesmcq_u8(vaeseq_u8(a, k[r]));
+        b = vaesmcq_u8(vaeseq_u8(b, k[r]));
+        c = vaesmcq_u8(vaeseq_u8(c, k[r]));
+        d = vaesmcq_u8(vaeseq_u8(d, k[r]));
+    }
+
+    *s0 = veorq_u8(vaeseq_u8(a, k[9]), k[10]);
+    *s1 = veorq_u8(vaeseq_u8(b, k[9]), k[10]);
+    *s2 = veorq_u8(vaeseq_u8(c, k[9]), k[10]);
+    *s3 = veorq_u8(vaeseq_u8(d, k[9]), k[10]);
+}
+
+static inline void aes_ce_load_keys(uint8x16_t *k, const uint8_t *rk)
+{
+    int r;
+
+    for (r = 0; r < 11; r++) k[r] = vld1q_u8(rk + 16 * r);
+}
+
+/* -------------------------------------------------------------------------- */
+void aes_armce_encrypt(const uint8_t *rk, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+    uint8x16_t k[11], s0, s1, s2, s3;
+
+    aes_ce_load_keys(k, rk);
+
+    for (; nblocks >= AES_CE_LANES; nblocks -= AES_CE_LANES, in += 64, out += 64) {
+        s0 = vld1q_u8(in);
+        s1 = vld1q_u8(in + 16);
+        s2 = vld1q_u8(in + 32);
+        s3 = vld1q_u8(in + 48);
+        aes_ce_enc4(k, &s0, &s1, &s2, &s3);
+        vst1q_u8(out, s0);
+        vst1q_u8(out + 16, s1);
+        vst1q_u8(out + 32, s2);
+        vst1q_u8(out + 48, s3);
+    }
+
+    for (; nblocks > 0; nblocks--, in += 16, out += 16)
+        vst1q_u8(out, aes_ce_enc1(k, vld1q_u8(in)));
+} /* aes_armce_encrypt */
+
+/* -------------------------------------------------------------------------- */
+void aes_armce_decrypt(const uint8_t *rk, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+    uint8x16_t k[11], a, b, c, d;
+    int r;
+
+    aes_ce_load_keys(k, rk);
+
+    for (; nblocks >= AES_CE_LANES; nblocks -= AES_CE_LANES, in += 64, out += 64) {
+        a = vld1q_u8(in);
+        b = vld1q_u8(in + 16);
+        c = vld1q_u8(in + 32);
+        d = vld1q_u8(in + 48);
+        for (r = 0; r < 9; r++) {
+            a = vaesimcq_u8(vaesdq_u8(a, k[r]));
+            b = vaesimcq_u8(vaesdq_u8(b, k[r]));
+            c = vaesimcq_u8(vaesdq_u8(c, k[r]));
+            d = vaesimcq_u8(vaesdq_u8(d, k[r]));
+        }
+        vst1q_u8(out, veorq_u8(vaesdq_u8(a, k[9]), k[10]));
+        vst1q_u8(out + 16, veorq_u8(vaesdq_u8(b, k[9]), k[10]));
+        vst1q_u8(out + 32, veorq_u8(vaesdq_u8(c, k[9]), k[10]));
+        vst1q_u8(out + 48, veorq_u8(vaesdq_u8(d, k[9]), k[10]));
+    }
+
+    for (; nblocks > 0; nblocks--, in += 16, out += 16)
+        vst1q_u8(out, aes_ce_dec1(k, vld1q_u8(in)));
+} /* aes_armce_decrypt */
+
+/* -------------------------------------------------------------------------- */
+/*  Counter blocks are built from the 128-bit big-endian counter in two
+ *  64-bit halves, the keystream of 4 counters is computed side by side.
+ */
+static inline uint8x16_t aes_ce_ctr_block(uint64_t hi, uint64_t lo)
+{
+    uint64_t be[2];
+
+    be[0] = __builtin_bswap64(hi);
+    be[1] = __builtin_bswap64(lo);
+
+    return vld1q_u8((const uint8_t *)be);
+}
+
+void aes_armce_ctr(const uint8_t *rk, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *ctr)
+{
+    uint8x16_t k[11], s0, s1, s2, s3;
+    uint64_t hi = 0, lo = 0;
+    int i;
+
+    aes_ce_load_keys(k, rk);
+    for (i = 0; i < 8; i++) {
+        hi = (hi << 8) | ctr[i];
+        lo = (lo << 8) | ctr[8 + i];
+    }
+
+#define CTR_NEXT(s)     do { s = aes_ce_ctr_block(hi, lo); if (++lo == 0) hi++; } while (0)
+
+    for (; nblocks >= AES_CE_LANES; nblocks -= AES_CE_LANES, in += 64, out += 64) {
+        CTR_NEXT(s0);
+        CTR_NEXT(s1);
+        CTR_NEXT(s2);
+        CTR_NEXT(s3);
+        aes_ce_enc4(k, &s0, &s1, &s2, &s3);
+        vst1q_u8(out, veorq_u8(vld1q_u8(in), s0));
+        vst1q_u8(out + 16, veorq_u8(vld1q_u8(in + 16), s1));
+        vst1q_u8(out + 32, veorq_u8(vld1q_u8(in + 32), s2));
+        vst1q_u8(out + 48, veorq_u8(vld1q_u8(in + 48), s3));
+    }
+
+    for (; nblocks > 0; nblocks--, in += 16, out += 16) {
+        CTR_NEXT(s0);
+        vst1q_u8(out, veorq_u8(vld1q_u8(in), aes_ce_enc1(k, s0)));
+    }
+
+#undef CTR_NEXT
+
+    for (i = 7; i >= 0; i--) {
+        ctr[i] = (uint8_t)hi;
+        ctr[8 + i] = (uint8_t)lo;
+        hi >>= 8;
+        lo >>= 8;
+    }
+} /* aes_armce_ctr */
+
+#endif /* __aarch64__ */
@@ -0,0 +1,876 @@
+/*
+*   AES-128 engines for the software baseline - T-table and bitsliced, and
+*   the dispatch to the Crypto Extensions engine in aes_armce.c.
+*
+*   - T-table: SubBytes, ShiftRows and MixColumns folded into one 1 KB
+*     table per direction, the other three columns by rotation (free on
+*     AArch64). Lookups are key and data dependent, i.e. not constant time.
+*   - Bitsliced: 4 blocks at once, bit b of the 64 state bytes in q[b]. The
+*     S-box is the Boyar-Peralta circuit (113 gates), ShiftRows and
+*     MixColumns are shifts and masks. No secret-dependent lookup or branch.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "aes_fast.h"
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_AES
+#define HWCAP_AES       (1 << 3)
+#endif
+#endif
+
+#ifdef __aarch64__
+/* aes_armce.c */
+void aes_armce_encrypt(const uint8_t *, uint8_t *, const uint8_t *, size_t);
+void aes_armce_decrypt(const uint8_t *, uint8_t *, const uint8_t *, size_t);
+void aes_armce_ctr(const uint8_t *, uint8_t *, const uint8_t *, size_t, uint8_t *);
+#endif
+
+const char * const aes_impl_names[AES_IMPL_N] = { "ref", "ttable", "bitslice", "armce" };
+
+static const uint8_t aes_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+static const uint8_t aes_isbox[256] = {
+    0x52, 0x09, 0x6a, 0xd5, 0x30, 0x36, 0xa5, 0x38, 0xbf, 0x40, 0xa3, 0x9e, 0x81, 0xf3, 0xd7, 0xfb,
+    0x7c, 0xe3, 0x39, 0x82, 0x9b, 0x2f, 0xff, 0x87, 0x34, 0x8e, 0x43, 0x44, 0xc4, 0xde, 0xe9, 0xcb,
+    0x54, 0x7b, 0x94, 0x32, 0xa6, 0xc2, 0x23, 0x3d, 0xee, 0x4c, 0x95, 0x0b, 0x42, 0xfa, 0xc3, 0x4e,
+    0x08, 0x2e, 0xa1, 0x66, 0x28, 0xd9, 0x24, 0xb2, 0x76, 0x5b, 0xa2, 0x49, 0x6d, 0x8b, 0xd1, 0x25,
+    0x72, 0xf8, 0xf6, 0x64, 0x86, 0x68, 0x98, 0x16, 0xd4, 0xa4, 0x5c, 0xcc, 0x5d, 0x65, 0xb6, 0x92,
+    0x6c, 0x70, 0x48, 0x50, 0xfd, 0xed, 0xb9, 0xda, 0x5e, 0x15, 0x46, 0x57, 0xa7, 0x8d, 0x9d, 0x84,
+    0x90, 0xd8, 0xab, 0x00, 0x8c, 0xbc, 0xd3, 0x0a, 0xf7, 0xe4, 0x58, 0x05, 0xb8, 0xb3, 0x45, 0x06,
+    0xd0, 0x2c, 0x1e, 0x8f, 0xca, 0x3f, 0x0f, 0x02, 0xc1, 0xaf, 0xbd, 0x03, 0x01, 0x13, 0x8a, 0x6b,
+    0x3a, 0x91, 0x11, 0x41, 0x4f, 0x67, 0xdc, 0xea, 0x97, 0xf2, 0xcf, 0xce, 0xf0, 0xb4, 0xe6, 0x73,
+    0x96, 0xac, 0x74, 0x22, 0xe7, 0xad, 0x35, 0x85, 0xe2, 0xf9, 0x37, 0xe8, 0x1c, 0x75, 0xdf, 0x6e,
+    0x47, 0xf1, 0x1a, 0x71, 0x1d, 0x29, 0xc5, 0x89, 0x6f, 0xb7, 0x62, 0x0e, 0xaa, 0x18, 0xbe, 0x1b,
+    0xfc, 0x56, 0x3e, 0x4b, 0xc6, 0xd2, 0x79, 0x20, 0x9a, 0xdb, 0xc0, 0xfe, 0x78, 0xcd, 0x5a, 0xf4,
+    0x1f, 0xdd, 0xa8, 0x33, 0x88, 0x07, 0xc7, 0x31, 0xb1, 0x12, 0x10, 0x59, 0x27, 0x80, 0xec, 0x5f,
+    0x60, 0x51, 0x7f, 0xa9, 0x19, 0xb5, 0x4a, 0x0d, 0x2d, 0xe5, 0x7a, 0x9f, 0x93, 0xc9, 0x9c, 0xef,
+    0xa0, 0xe0, 0x3b, 0x4d, 0xae, 0x2a, 0xf5, 0xb0, 0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61,
+    0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d
+};
+
+static const uint32_t aes_te[256] = {
+    0xc66363a5, 0xf87c7c84, 0xee777799, 0xf67b7b8d, 0xfff2f20d, 0xd66b6bbd,
+    0xde6f6fb1, 0x91c5c554, 0x60303050, 0x02010103, 0xce6767a9, 0x562b2b7d,
+    0xe7fefe19, 0xb5d7d762, 0x4dababe6, 0xec76769a, 0x8fcaca45, 0x1f82829d,
+    0x89c9c940, 0xfa7d7d87, 0xeffafa15, 0xb25959eb, 0x8e4747c9, 0xfbf0f00b,
+    0x41adadec, 0xb3d4d467, 0x5fa2a2fd, 0x45afafea, 0x239c9cbf, 0x53a4a4f7,
+    0xe4727296, 0x9bc0c05b, 0x75b7b7c2, 0xe1fdfd1c, 0x3d9393ae, 0x4c26266a,
+    0x6c36365a, 0x7e3f3f41, 0xf5f7f702, 0x83cccc4f, 0x6834345c, 0x51a5a5f4,
+    0xd1e5e534, 0xf9f1f108, 0xe2717193, 0xabd8d873, 0x62313153, 0x2a15153f,
+    0x0804040c, 0x95c7c752, 0x46232365, 0x9dc3c35e, 0x30181828, 0x379696a1,
+    0x0a05050f, 0x2f9a9ab5, 0x0e070709, 0x24121236, 0x1b80809b, 0xdfe2e23d,
+    0xcdebeb26, 0x4e272769, 0x7fb2b2cd, 0xea75759f, 0x1209091b, 0x1d83839e,
+    0x582c2c74, 0x341a1a2e, 0x361b1b2d, 0xdc6e6eb2, 0xb45a5aee, 0x5ba0a0fb,
+    0xa45252f6, 0x763b3b4d, 0xb7d6d661, 0x7db3b3ce, 0x5229297b, 0xdde3e33e,
+    0x5e2f2f71, 0x13848497, 0xa65353f5, 0xb9d1d168, 0x00000000, 0xc1eded2c,
+    0x40202060, 0xe3fcfc1f, 0x79b1b1c8, 0xb65b5bed, 0xd46a6abe, 0x8dcbcb46,
+    0x67bebed9, 0x7239394b, 0x944a4ade, 0x984c4cd4, 0xb05858e8, 0x85cfcf4a,
+    0xbbd0d06b, 0xc5efef2a, 0x4faaaae5, 0xedfbfb16, 0x864343c5, 0x9a4d4dd7,
+    0x66333355, 0x11858594, 0x8a4545cf, 0xe9f9f910, 0x04020206, 0xfe7f7f81,
+    0xa05050f0, 0x783c3c44, 0x259f9fba, 0x4ba8a8e3, 0xa25151f3, 0x5da3a3fe,
+    0x804040c0, 0x058f8f8a, 0x3f9292ad, 0x219d9dbc, 0x70383848, 0xf1f5f504,
+    0x63bcbcdf, 0x77b6b6c1, 0xafdada75, 0x42212163, 0x20101030, 0xe5ffff1a,
+    0xfdf3f30e, 0xbfd2d26d, 0x81cdcd4c, 0x180c0c14, 0x26131335, 0xc3ecec2f,
+    0xbe5f5fe1, 0x359797a2, 0x884444cc, 0x2e171739, 0x93c4c457, 0x55a7a7f2,
+    0xfc7e7e82, 0x7a3d3d47, 0xc86464ac, 0xba5d5de7, 0x3219192b, 0xe6737395,
+    0xc06060a0, 0x19818198, 0x9e4f4fd1, 0xa3dcdc7f, 0x44222266, 0x542a2a7e,
+    0x3b9090ab, 0x0b888883, 0x8c4646ca, 0xc7eeee29, 0x6bb8b8d3, 0x2814143c,
+    0xa7dede79, 0xbc5e5ee2, 0x160b0b1d, 0xaddbdb76, 0xdbe0e03b, 0x64323256,
+    0x743a3a4e, 0x140a0a1e, 0x924949db, 0x0c06060a, 0x4824246c, 0xb85c5ce4,
+    0x9fc2c25d, 0xbdd3d36e, 0x43acacef, 0xc46262a6, 0x399191a8, 0x319595a4,
+    0xd3e4e437, 0xf279798b, 0xd5e7e732, 0x8bc8c843, 0x6e373759, 0xda6d6db7,
+    0x018d8d8c, 0xb1d5d564, 0x9c4e4ed2, 0x49a9a9e0, 0xd86c6cb4, 0xac5656fa,
+    0xf3f4f407, 0xcfeaea25, 0xca6565af, 0xf47a7a8e, 0x47aeaee9, 0x10080818,
+    0x6fbabad5, 0xf0787888, 0x4a25256f, 0x5c2e2e72, 0x381c1c24, 0x57a6a6f1,
+    0x73b4b4c7, 0x97c6c651, 0xcbe8e823, 0xa1dddd7c, 0xe874749c, 0x3e1f1f21,
+    0x964b4bdd, 0x61bdbddc, 0x0d8b8b86, 0x0f8a8a85, 0xe0707090, 0x7c3e3e42,
+    0x71b5b5c4, 0xcc6666aa, 0x904848d8, 0x06030305, 0xf7f6f601, 0x1c0e0e12,
+    0xc26161a3, 0x6a35355f, 0xae5757f9, 0x69b9b9d0, 0x17868691, 0x99c1c158,
+    0x3a1d1d27, 0x279e9eb9, 0xd9e1e138, 0xebf8f813, 0x2b9898b3, 0x22111133,
+    0xd26969bb, 0xa9d9d970, 0x078e8e89, 0x339494a7, 0x2d9b9bb6, 0x3c1e1e22,
+    0x15878792, 0xc9e9e920, 0x87cece49, 0xaa5555ff, 0x50282878, 0xa5dfdf7a,
+    0x038c8c8f, 0x59a1a1f8, 0x09898980, 0x1a0d0d17, 0x65bfbfda, 0xd7e6e631,
+    0x844242c6, 0xd06868b8, 0x824141c3, 0x299999b0, 0x5a2d2d77, 0x1e0f0f11,
+    0x7bb0b0cb, 0xa85454fc, 0x6dbbbbd6, 0x2c16163a
+};
+
+static const uint32_t aes_td[256] = {
+    0x51f4a750, 0x7e416553, 0x1a17a4c3, 0x3a275e96, 0x3bab6bcb, 0x1f9d45f1,
+    0xacfa58ab, 0x4be30393, 0x2030fa55, 0xad766df6, 0x88cc7691, 0xf5024c25,
+    0x4fe5d7fc, 0xc52acbd7, 0x26354480, 0xb562a38f, 0xdeb15a49, 0x25ba1b67,
+    0x45ea0e98, 0x5dfec0e1, 0xc32f7502, 0x814cf012, 0x8d4697a3, 0x6bd3f9c6,
+    0x038f5fe7, 0x15929c95, 0xbf6d7aeb, 0x955259da, 0xd4be832d, 0x587421d3,
+    0x49e06929, 0x8ec9c844, 0x75c2896a, 0xf48e7978, 0x99583e6b, 0x27b971dd,
+    0xbee14fb6, 0xf088ad17, 0xc920ac66, 0x7dce3ab4, 0x63df4a18, 0xe51a3182,
+    0x97513360, 0x62537f45, 0xb16477e0, 0xbb6bae84, 0xfe81a01c, 0xf9082b94,
+    0x70486858, 0x8f45fd19, 0x94de6c87, 0x527bf8b7, 0xab73d323, 0x724b02e2,
+    0xe31f8f57, 0x6655ab2a, 0xb2eb2807, 0x2fb5c203, 0x86c57b9a, 0xd33708a5,
+    0x302887f2, 0x23bfa5b2, 0x02036aba, 0xed16825c, 0x8acf1c2b, 0xa779b492,
+    0xf307f2f0, 0x4e69e2a1, 0x65daf4cd, 0x0605bed5, 0xd134621f, 0xc4a6fe8a,
+    0x342e539d, 0xa2f355a0, 0x058ae132, 0xa4f6eb75, 0x0b83ec39, 0x4060efaa,
+    0x5e719f06, 0xbd6e1051, 0x3e218af9, 0x96dd063d, 0xdd3e05ae, 0x4de6bd46,
+    0x91548db5, 0x71c45d05, 0x0406d46f, 0x605015ff, 0x1998fb24, 0xd6bde997,
+    0x894043cc, 0x67d99e77, 0xb0e842bd, 0x07898b88, 0xe7195b38, 0x79c8eedb,
+    0xa17c0a47, 0x7c420fe9, 0xf8841ec9, 0x00000000, 0x09808683, 0x322bed48,
+    0x1e1170ac, 0x6c5a724e, 0xfd0efffb, 0x0f853856, 0x3daed51e, 0x362d3927,
+    0x0a0fd964, 0x685ca621, 0x9b5b54d1, 0x24362e3a, 0x0c0a67b1, 0x9357e70f,
+    0xb4ee96d2, 0x1b9b919e, 0x80c0c54f, 0x61dc20a2, 0x5a774b69, 0x1c121a16,
+    0xe293ba0a, 0xc0a02ae5, 0x3c22e043, 0x121b171d, 0x0e090d0b, 0xf28bc7ad,
+    0x2db6a8b9, 0x141ea9c8, 0x57f11985, 0xaf75074c, 0xee99ddbb, 0xa37f60fd,
+    0xf701269f, 0x5c72f5bc, 0x44663bc5, 0x5bfb7e34, 0x8b432976, 0xcb23c6dc,
+    0xb6edfc68, 0xb8e4f163, 0xd731dcca, 0x42638510, 0x13972240, 0x84c61120,
+    0x854a247d, 0xd2bb3df8, 0xaef93211, 0xc729a16d, 0x1d9e2f4b, 0xdcb230f3,
+    0x0d8652ec, 0x77c1e3d0, 0x2bb3166c, 0xa970b999, 0x119448fa, 0x47e96422,
+    0xa8fc8cc4, 0xa0f03f1a, 0x567d2cd8, 0x223390ef, 0x87494ec7, 0xd938d1c1,
+    0x8ccaa2fe, 0x98d40b36, 0xa6f581cf, 0xa57ade28, 0xdab78e26, 0x3fadbfa4,
+    0x2c3a9de4, 0x5078920d, 0x6a5fcc9b, 0x547e4662, 0xf68d13c2, 0x90d8b8e8,
+    0x2e39f75e, 0x82c3aff5, 0x9f5d80be, 0x69d0937c, 0x6fd52da9, 0xcf2512b3,
+    0xc8ac993b, 0x10187da7, 0xe89c636e, 0xdb3bbb7b, 0xcd267809, 0x6e5918f4,
+    0xec9ab701, 0x834f9aa8, 0xe6956e65, 0xaaffe67e, 0x21bccf08, 0xef15e8e6,
+    0xbae79bd9, 0x4a6f36ce, 0xea9f09d4, 0x29b07cd6, 0x31a4b2af, 0x2a3f2331,
+    0xc6a59430, 0x35a266c0, 0x744ebc37, 0xfc82caa6, 0xe090d0b0, 0x33a7d815,
+    0xf104984a, 0x41ecdaf7, 0x7fcd500e, 0x1791f62f, 0x764dd68d, 0x43efb04d,
+    0xccaa4d54, 0xe49604df, 0x9ed1b5e3, 0x4c6a881b, 0xc12c1fb8, 0x4665517f,
+    0x9d5eea04, 0x018c355d, 0xfa877473, 0xfb0b412e, 0xb3671d5a, 0x92dbd252,
+    0xe9105633, 0x6dd64713, 0x9ad7618c, 0x37a10c7a, 0x59f8148e, 0xeb133c89,
+    0xcea927ee, 0xb761c935, 0xe11ce5ed, 0x7a47b13c, 0x9cd2df59, 0x55f2733f,
+    0x1814ce79, 0x73c737bf, 0x53f7cdea, 0x5ffdaa5b, 0xdf3d6f14, 0x7844db86,
+    0xcaaff381, 0xb968c43e, 0x3824342c, 0xc2a3405f, 0x161dc372, 0xbce2250c,
+    0x283c498b, 0xff0d9541, 0x39a80171, 0x080cb3de, 0xd8b4e49c, 0x6456c190,
+    0x7bcb8461, 0xd532b670, 0x486c5c74, 0xd0b85742
+};
+
+#define ROTR32(x, n)    (((x) >> (n)) | ((x) << ((32 - (n)) & 31)))
+
+#define GETU32(p)       (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) \
+                        | ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3])
+#define PUTU32(p, v)    ((p)[0] = (uint8_t)((v) >> 24), (p)[1] = (uint8_t)((v) >> 16), \
+                         (p)[2] = (uint8_t)((v) >> 8), (p)[3] = (uint8_t)(v))
+
+#define TE(i, x)        ROTR32(aes_te[(x) & 0xff], 8 * (i))
+#define TD(i, x)        ROTR32(aes_td[(x) & 0xff], 8 * (i))
+
+static int aes_impl_current = -1;
+
+/* -------------------------------------------------------------------------- */
+int aes_impl_parse(const char *name)
+{
+    int i;
+
+    if (name == NULL) return -1;
+    for (i = 0; i < AES_IMPL_N; i++)
+        if (strcmp(name, aes_impl_names[i]) == 0) return i;
+
+    return -1;
+} /* aes_impl_parse */
+
+/* -------------------------------------------------------------------------- */
+int aes_impl_available(int impl)
+{
+    if (impl < 0 || impl >= AES_IMPL_N) return 0;
+    if (impl != AES_IMPL_ARMCE) return 1;
+
+#if defined(__aarch64__) && defined(__linux__)
+    return (getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+#else
+    return 0;
+#endif
+} /* aes_impl_available */
+
+/* -------------------------------------------------------------------------- */
+int aes_impl_get(void)
+{
+    int cur = __atomic_load_n(&aes_impl_current, __ATOMIC_ACQUIRE), unset = -1;
+
+    // Read by worker threads: racing first calls pick the same engine, a
+    // concurrent aes_impl_select() wins
+    if (cur < 0) {
+        int impl = aes_impl_parse(getenv("AES_IMPL"));
+        if (impl < 0) impl = AES_IMPL;
+        cur = aes_impl_available(impl) ? impl : AES_IMPL_TTABLE;
+        if (!__atomic_compare_exchange_n(&aes_impl_current, &unset, cur, 0,
+                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            cur = unset;
+    }
+
+    return cur;
+} /* aes_impl_get */
+
+/* -------------------------------------------------------------------------- */
+int aes_impl_select(int impl)
+{
+    if (!aes_impl_available(impl)) return -1;
+    __atomic_store_n(&aes_impl_current, impl, __ATOMIC_RELEASE);
+
+    return 0;
+} /* aes_impl_select */
+
+/* -------------------------------------------------------------------------- */
+/*  Key schedule, 44 big-endian words. With AES_RCON_FIXED the round constant
+ *  stays at 0x01, as in aes.h GenerateRoundKey() and aes256.c aes_expandEncKey().
+ */
+static void aes_expand_key(uint32_t *w, const uint8_t *key, int rcon_mode)
+{
+    uint32_t rcon = 0x01, t;
+    int i;
+
+    for (i = 0; i < 4; i++) w[i] = GETU32(key + 4 * i);
+
+    for (i = 4; i < 44; i++) {
+        t = w[i - 1];
+        if ((i & 3) == 0) {
+            t = ((uint32_t)aes_sbox[(t >> 16) & 0xff] << 24)
+                | ((uint32_t)aes_sbox[(t >> 8) & 0xff] << 16)
+                | ((uint32_t)aes_sbox[t & 0xff] << 8)
+                | (uint32_t)aes_sbox[t >> 24];
+            t ^= rcon << 24;
+            if (rcon_mode == AES_RCON_FIPS)
+                rcon = (rcon << 1) ^ ((rcon & 0x80) ? 0x11b : 0);
+        }
+        w[i] = w[i - 4] ^ t;
+    }
+} /* aes_expand_key */
+
+/* -------------------------------------------------------------------------- */
+/*  T-table                                                                   */
+/* -------------------------------------------------------------------------- */
+
+/* Equivalent inverse cipher keys: reversed, InvMixColumns on rounds 1..9. */
+static void aes_ttable_dec_key(uint32_t *dk, const uint32_t *ek)
+{
+    int r, c;
+
+    for (r = 0; r <= 10; r++)
+        for (c = 0; c < 4; c++) {
+            uint32_t w = ek[4 * (10 - r) + c];
+            if (r > 0 && r < 10)
+                w = TD(0, aes_sbox[w >> 24]) ^ TD(1, aes_sbox[(w >> 16) & 0xff])
+                    ^ TD(2, aes_sbox[(w >> 8) & 0xff]) ^ TD(3, aes_sbox[w & 0xff]);
+            dk[4 * r + c] = w;
+        }
+} /* aes_ttable_dec_key */
+
+/* -------------------------------------------------------------------------- */
+static void aes_ttable_encrypt(const uint32_t *rk, uint8_t *out, const uint8_t *in)
+{
+    uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+    int r;
+
+    s0 = GETU32(in) ^ rk[0];
+    s1 = GETU32(in + 4) ^ rk[1];
+    s2 = GETU32(in + 8) ^ rk[2];
+    s3 = GETU32(in + 12) ^ rk[3];
+
+    for (r = 1; r < 10; r++) {
+        rk += 4;
+        t0 = TE(0, s0 >> 24) ^ TE(1, s1 >> 16) ^ TE(2, s2 >> 8) ^ TE(3, s3) ^ rk[0];
+        t1 = TE(0, s1 >> 24) ^ TE(1, s2 >> 16) ^ TE(2, s3 >> 8) ^ TE(3, s0) ^ rk[1];
+        t2 = TE(0, s2 >> 24) ^ TE(1, s3 >> 16) ^ TE(2, s0 >> 8) ^ TE(3, s1) ^ rk[2];
+        t3 = TE(0, s3 >> 24) ^ TE(1, s0 >> 16) ^ TE(2, s1 >> 8) ^ TE(3, s2) ^ rk[3];
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+    }
+
+    rk += 4;
+#define SB(x, n)        ((uint32_t)aes_sbox[((x) >> (n)) & 0xff] << (n))
+    t0 = SB(s0, 24) ^ SB(s1, 16) ^ SB(s2, 8) ^ SB(s3, 0) ^ rk[0];
+    t1 = SB(s1, 24) ^ SB(s2, 16) ^ SB(s3, 8) ^ SB(s0, 0) ^ rk[1];
+    t2 = SB(s2, 24) ^ SB(s3, 16) ^ SB(s0, 8) ^ SB(s1, 0) ^ rk[2];
+    t3 = SB(s3, 24) ^ SB(s0, 16) ^ SB(s1, 8) ^ SB(s2, 0) ^ rk[3];
+#undef SB
+
+    PUTU32(out, t0);
+    PUTU32(out + 4, t1);
+    PUTU32(out + 8, t2);
+    PUTU32(out + 12, t3);
+} /* aes_ttable_encrypt */
+
+/* -------------------------------------------------------------------------- */
+static void aes_ttable_decrypt(const uint32_t *rk, uint8_t *out, const uint8_t *in)
+{
+    uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+    int r;
+
+    s0 = GETU32(in) ^ rk[0];
+    s1 = GETU32(in + 4) ^ rk[1];
+    s2 = GETU32(in + 8) ^ rk[2];
+    s3 = GETU32(in + 12) ^ rk[3];
+
+    for (r = 1; r < 10; r++) {
+        rk += 4;
+        t0 = TD(0, s0 >> 24) ^ TD(1, s3 >> 16) ^ TD(2, s2 >> 8) ^ TD(3, s1) ^ rk[0];
+        t1 = TD(0, s1 >> 24) ^ TD(1, s0 >> 16) ^ TD(2, s3 >> 8) ^ TD(3, s2) ^ rk[1];
+        t2 = TD(0, s2 >> 24) ^ TD(1, s1 >> 16) ^ TD(2, s0 >> 8) ^ TD(3, s3) ^ rk[2];
+        t3 = TD(0, s3 >> 24) ^ TD(1, s2 >> 16) ^ TD(2, s1 >> 8) ^ TD(3, s0) ^ rk[3];
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+    }
+
+    rk += 4;
+#define ISB(x, n)       ((uint32_t)aes_isbox[((x) >> (n)) & 0xff] << (n))
+    t0 = ISB(s0, 24) ^ ISB(s3, 16) ^ ISB(s2, 8) ^ ISB(s1, 0) ^ rk[0];
+    t1 = ISB(s1, 24) ^ ISB(s0, 16) ^ ISB(s3, 8) ^ ISB(s2, 0) ^ rk[1];
+    t2 = ISB(s2, 24) ^ ISB(s1, 16) ^ ISB(s0, 8) ^ ISB(s3, 0) ^ rk[2];
+    t3 = ISB(s3, 24) ^ ISB(s2, 16) ^ ISB(s1, 8) ^ ISB(s0, 0) ^ rk[3];
+#undef ISB
+
+    PUTU32(out, t0);
+    PUTU32(out + 4, t1);
+    PUTU32(out + 8, t2);
+    PUTU32(out + 12, t3);
+} /* aes_ttable_decrypt */
+
+/* -------------------------------------------------------------------------- */
+/*  Bitsliced                                                                 */
+/* -------------------------------------------------------------------------- */
+
+/*  State of 4 blocks, 64 bytes in memory order: bit p of q[b] is bit b of
+ *  byte p = 16 * block + 4 * column + row. A 16-bit lane is a block, a nibble
+ *  a column, so ShiftRows rotates within lanes and MixColumns within nibbles.
+ */
+
+#define BS_ROW0         0x1111111111111111ULL
+#define BS_ROW1         0x2222222222222222ULL
+#define BS_ROW2         0x4444444444444444ULL
+#define BS_ROW3         0x8888888888888888ULL
+
+/* Rotate each 16-bit lane right by n. */
+#define BS_ROTR16(x, n) ((((x) >> (n)) & (0xffffULL >> (n)) * 0x0001000100010001ULL) \
+                        | (((x) << (16 - (n))) & ((0xffffULL << (16 - (n))) & 0xffffULL) * 0x0001000100010001ULL))
+
+/* Rotate each nibble right by n, i.e. row r takes row r + n. */
+#define BS_ROTR4(x, n)  ((((x) >> (n)) & (0xfULL >> (n)) * 0x1111111111111111ULL) \
+                        | (((x) << (4 - (n))) & ((0xfULL << (4 - (n))) & 0xfULL) * 0x1111111111111111ULL))
+
+static inline uint64_t bs_load64(const uint8_t *p)
+{
+    return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) | ((uint64_t)p[3] << 24)
+        | ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) | ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+}
+
+static inline void bs_store64(uint8_t *p, uint64_t x)
+{
+    int i;
+
+    for (i = 0; i < 8; i++) p[i] = (uint8_t)(x >> (8 * i));
+}
+
+/* 8x8 bit transpose within each word: bit b of byte i <-> bit i of byte b. */
+static inline uint64_t bs_transpose8(uint64_t x)
+{
+    uint64_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;  x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL; x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL; x ^= t ^ (t << 28);
+
+    return x;
+}
+
+/* 8x8 byte transpose across words: byte j of w[i] <-> byte i of w[j]. */
+static void bs_transpose_bytes(uint64_t *w)
+{
+    uint64_t a, b;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        a = w[i]; b = w[i + 4];
+        w[i] = (a & 0x00000000FFFFFFFFULL) | (b << 32);
+        w[i + 4] = (a >> 32) | (b & 0xFFFFFFFF00000000ULL);
+    }
+    for (i = 0; i < 8; i += (i & 1) ? 3 : 1) {
+        a = w[i]; b = w[i + 2];
+        w[i] = (a & 0x0000FFFF0000FFFFULL) | ((b & 0x0000FFFF0000FFFFULL) << 16);
+        w[i + 2] = ((a >> 16) & 0x0000FFFF0000FFFFULL) | (b & 0xFFFF0000FFFF0000ULL);
+    }
+    for (i = 0; i < 8; i += 2) {
+        a = w[i]; b = w[i + 1];
+        w[i] = (a & 0x00FF00FF00FF00FFULL) | ((b & 0x00FF00FF00FF00FFULL) << 8);
+        w[i + 1] = ((a >> 8) & 0x00FF00FF00FF00FFULL) | (b & 0xFF00FF00FF00FF00ULL);
+    }
+}
+
+static void bs_pack(uint64_t *q, const uint8_t *in)
+{
+    int i;
+
+    for (i = 0; i < 8; i++) q[i] = bs_transpose8(bs_load64(in + 8 * i));
+    bs_transpose_bytes(q);
+}
+
+static void bs_unpack(uint8_t *out, uint64_t *q)
+{
+    int i;
+
+    bs_transpose_bytes(q);
+    for (i = 0; i < 8; i++) bs_store64(out + 8 * i, bs_transpose8(q[i]));
+}
+
+/* -------------------------------------------------------------------------- */
+/*  S-box circuit by J. Boyar and R. Peralta, "A depth-16 circuit for the AES
+ *  S-box" (2011), 32 AND/XOR-only stages in 113 gates. q[7] is the MSB.
+ */
+static void bs_sbox(uint64_t *q)
+{
+    uint64_t x0, x1, x2, x3, x4, x5, x6, x7;
+    uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9;
+    uint64_t y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+    uint64_t y20, y21;
+    uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    uint64_t z10, z11, z12, z13, z14, z15, z16, z17;
+    uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    uint64_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    uint64_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    uint64_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    uint64_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    uint64_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    uint64_t t60, t61, t62, t63, t64, t65, t66, t67;
+    uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7]; x1 = q[6]; x2 = q[5]; x3 = q[4];
+    x4 = q[3]; x5 = q[2]; x6 = q[1]; x7 = q[0];
+
+    /* Top linear transformation */
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9 = x0 ^ x3;
+    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y1 = t0 ^ x7;
+    y4 = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;
+    y5 = y1 ^ x6;
+    y3 = y5 ^ y8;
+    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6 = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7 = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    /* Non-linear section */
+    t2 = y12 & y15;
+    t3 = y3 & y6;
+    t4 = t3 ^ t2;
+    t5 = y4 & x7;
+    t6 = t5 ^ t2;
+    t7 = y13 & y16;
+    t8 = y5 & y1;
+    t9 = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;
+    z1 = t37 & y6;
+    z2 = t33 & x7;
+    z3 = t43 & y16;
+    z4 = t40 & y1;
+    z5 = t29 & y7;
+    z6 = t42 & y11;
+    z7 = t45 & y17;
+    z8 = t41 & y10;
+    z9 = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    /* Bottom linear transformation */
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;
+    s6 = t56 ^ ~t62;
+    s7 = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = t64 ^ ~s3;
+    s2 = t55 ^ ~t67;
+
+    q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+    q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+} /* bs_sbox */
+
+/* -------------------------------------------------------------------------- */
+/*  Inverse S-box through the forward one: InvS = G o S o G, with G the
+ *  inverse affine map y -> rotl1(y) ^ rotl3(y) ^ rotl6(y) ^ 0x05.
+ */
+static void bs_affine_inv(uint64_t *q)
+{
+    uint64_t r[8];
+    int i;
+
+    for (i = 0; i < 8; i++)
+        r[i] = q[(i + 7) & 7] ^ q[(i + 5) & 7] ^ q[(i + 2) & 7];
+    r[0] = ~r[0];
+    r[2] = ~r[2];
+    memcpy(q, r, sizeof(r));
+} /* bs_affine_inv */
+
+static void bs_sbox_inv(uint64_t *q)
+{
+    bs_affine_inv(q);
+    bs_sbox(q);
+    bs_affine_inv(q);
+} /* bs_sbox_inv */
+
+/* -------------------------------------------------------------------------- */
+static void bs_shift_rows(uint64_t *q)
+{
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        uint64_t x = q[i];
+        q[i] = (x & BS_ROW0)
+            | (BS_ROTR16(x & BS_ROW1, 4))
+            | (BS_ROTR16(x & BS_ROW2, 8))
+            | (BS_ROTR16(x & BS_ROW3, 12));
+    }
+} /* bs_shift_rows */
+
+static void bs_shift_rows_inv(uint64_t *q)
+{
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        uint64_t x = q[i];
+        q[i] = (x & BS_ROW0)
+            | (BS_ROTR16(x & BS_ROW1, 12))
+            | (BS_ROTR16(x & BS_ROW2, 8))
+            | (BS_ROTR16(x & BS_ROW3, 4));
+    }
+} /* bs_shift_rows_inv */
+
+/* -------------------------------------------------------------------------- */
+/* Multiplication by x in GF(2^8): shift the planes up, fold q[7] into 0x1b. */
+static inline void bs_xtime(uint64_t *r, const uint64_t *a)
+{
+    uint64_t hi = a[7];
+
+    r[7] = a[6];
+    r[6] = a[5];
+    r[5] = a[4];
+    r[4] = a[3] ^ hi;
+    r[3] = a[2] ^ hi;
+    r[2] = a[1];
+    r[1] = a[0] ^ hi;
+    r[0] = hi;
+}
+
+/*  out_r = 2 a_r ^ 3 a_{r+1} ^ a_{r+2} ^ a_{r+3}
+ *        = xtime(t_r) ^ a_{r+1} ^ t_{r+2},   t = a ^ R1(a)
+ */
+static void bs_mix_columns(uint64_t *q)
+{
+    uint64_t t[8], x[8];
+    int i;
+
+    for (i = 0; i < 8; i++) t[i] = q[i] ^ BS_ROTR4(q[i], 1);
+    bs_xtime(x, t);
+    for (i = 0; i < 8; i++) q[i] = x[i] ^ BS_ROTR4(q[i], 1) ^ BS_ROTR4(t[i], 2);
+} /* bs_mix_columns */
+
+/*  InvMixColumns = MixColumns o circ(5, 0, 4, 0): a ^ 4 (a ^ R2(a)) first. */
+static void bs_mix_columns_inv(uint64_t *q)
+{
+    uint64_t t[8], x[8];
+    int i;
+
+    for (i = 0; i < 8; i++) t[i] = q[i] ^ BS_ROTR4(q[i], 2);
+    bs_xtime(x, t);
+    bs_xtime(t, x);
+    for (i = 0; i < 8; i++) q[i] ^= t[i];
+    bs_mix_columns(q);
+} /* bs_mix_columns_inv */
+
+static inline void bs_add_round_key(uint64_t *q, const uint64_t *rk)
+{
+    int i;
+
+    for (i = 0; i < 8; i++) q[i] ^= rk[i];
+}
+
+/* -------------------------------------------------------------------------- */
+/* Round keys broadcast to the 4 blocks and packed like the state. */
+static void bs_key(uint64_t bk[11][8], const uint32_t *ek)
+{
+    uint8_t buf[64];
+    int r, c, b;
+
+    for (r = 0; r <= 10; r++) {
+        for (b = 0; b < 4; b++)
+            for (c = 0; c < 4; c++)
+                PUTU32(buf + 16 * b + 4 * c, ek[4 * r + c]);
+        bs_pack(bk[r], buf);
+    }
+} /* bs_key */
+
+/* -------------------------------------------------------------------------- */
+static void bs_encrypt4(const uint64_t bk[11][8], uint8_t *out, const uint8_t *in)
+{
+    uint64_t q[8];
+    int r;
+
+    bs_pack(q, in);
+    bs_add_round_key(q, bk[0]);
+    for (r = 1; r < 10; r++) {
+        bs_sbox(q);
+        bs_shift_rows(q);
+        bs_mix_columns(q);
+        bs_add_round_key(q, bk[r]);
+    }
+    bs_sbox(q);
+    bs_shift_rows(q);
+    bs_add_round_key(q, bk[10]);
+    bs_unpack(out, q);
+} /* bs_encrypt4 */
+
+static void bs_decrypt4(const uint64_t bk[11][8], uint8_t *out, const uint8_t *in)
+{
+    uint64_t q[8];
+    int r;
+
+    bs_pack(q, in);
+    bs_add_round_key(q, bk[10]);
+    for (r = 9; r > 0; r--) {
+        bs_shift_rows_inv(q);
+        bs_sbox_inv(q);
+        bs_add_round_key(q, bk[r]);
+        bs_mix_columns_inv(q);
+    }
+    bs_shift_rows_inv(q);
+    bs_sbox_inv(q);
+    bs_add_round_key(q, bk[0]);
+    bs_unpack(out, q);
+} /* bs_decrypt4 */
+
+/* -------------------------------------------------------------------------- */
+/*  Public API                                                                */
+/* -------------------------------------------------------------------------- */
+
+int aes_fast_init(aes_fast_context *ctx, const uint8_t *key, int impl, int rcon)
+{
+    int i;
+
+    if (impl <= AES_IMPL_REF || impl >= AES_IMPL_N) {
+        ctx->impl = AES_IMPL_REF;
+        return -1;
+    }
+    if (!aes_impl_available(impl))
+        impl = AES_IMPL_TTABLE;
+
+    ctx->impl = impl;
+    aes_expand_key(ctx->ek, key, rcon);
+    if (impl == AES_IMPL_BITSLICE) {
+        bs_key(ctx->bk, ctx->ek);
+        return 0;
+    }
+
+    aes_ttable_dec_key(ctx->dk, ctx->ek);
+    if (impl == AES_IMPL_ARMCE)
+        for (i = 0; i < 44; i++) {
+            PUTU32(&ctx->rk8[0][4 * i], ctx->ek[i]);
+            PUTU32(&ctx->rk8[1][4 * i], ctx->dk[i]);
+        }
+
+    return 0;
+} /* aes_fast_init */
+
+/* -------------------------------------------------------------------------- */
+void aes_fast_encrypt(const aes_fast_context *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+    uint8_t tail[64];
+
+#ifdef __aarch64__
+    if (ctx->impl == AES_IMPL_ARMCE) {
+        aes_armce_encrypt(ctx->rk8[0], out, in, nblocks);
+        return;
+    }
+#endif
+    if (ctx->impl != AES_IMPL_BITSLICE) {
+        for (; nblocks > 0; nblocks--, in += 16, out += 16)
+            aes_ttable_encrypt(ctx->ek, out, in);
+        return;
+    }
+
+    for (; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+        bs_encrypt4(ctx->bk, out, in);
+    if (nblocks > 0) {
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, in, 16 * nblocks);
+        bs_encrypt4(ctx->bk, tail, tail);
+        memcpy(out, tail, 16 * nblocks);
+    }
+} /* aes_fast_encrypt */
+
+/* -------------------------------------------------------------------------- */
+void aes_fast_decrypt(const aes_fast_context *ctx, uint8_t *out, const uint8_t *in, size_t nblocks)
+{
+    uint8_t tail[64];
+
+#ifdef __aarch64__
+    if (ctx->impl == AES_IMPL_ARMCE) {
+        aes_armce_decrypt(ctx->rk8[1], out, in, nblocks);
+        return;
+    }
+#endif
+    if (ctx->impl != AES_IMPL_BITSLICE) {
+        for (; nblocks > 0; nblocks--, in += 16, out += 16)
+            aes_ttable_decrypt(ctx->dk, out, in);
+        return;
+    }
+
+    for (; nblocks >= 4; nblocks -= 4, in += 64, out += 64)
+        bs_decrypt4(ctx->bk, out, in);
+    if (nblocks > 0) {
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, in, 16 * nblocks);
+        bs_decrypt4(ctx->bk, tail, tail);
+        memcpy(out, tail, 16 * nblocks);
+    }
+} /* aes_fast_decrypt */
+
+/* -------------------------------------------------------------------------- */
+/*  Counter blocks in batches of AES_CTR_BATCH through aes_fast_encrypt(),
+ *  so the bitsliced engine always gets full 4-block passes.
+ */
+#define AES_CTR_BATCH   16
+
+void aes_fast_ctr(const aes_fast_context *ctx, uint8_t *out, const uint8_t *in, size_t nblocks, uint8_t *ctr)
+{
+    uint8_t ks[16 * AES_CTR_BATCH];
+    size_t n, b;
+    int i;
+
+#ifdef __aarch64__
+    if (ctx->impl == AES_IMPL_ARMCE) {
+        aes_armce_ctr(ctx->rk8[0], out, in, nblocks, ctr);
+        return;
+    }
+#endif
+
+    while (nblocks > 0) {
+        n = (nblocks < AES_CTR_BATCH) ? nblocks : AES_CTR_BATCH;
+        for (b = 0; b < n; b++) {
+            memcpy(&ks[16 * b], ctr, 16);
+            for (i = 15; i >= 0 && ++ctr[i] == 0; i--)
+                ;
+        }
+        aes_fast_encrypt(ctx, ks, ks, n);
+        for (b = 0; b < 16 * n; b++)
+            out[b] = in[b] ^ ks[b];
+        in += 16 * n;
+        out += 16 * n;
+        nblocks -= n;
+    }
+} /* aes_fast_ctr */
+
+/* -------------------------------------------------------------------------- */
+int aes_fast_selftest(void)
+{
+    uint8_t buf[256], sb[256];
+    uint64_t q[8];
+    int i, err = 0;
+
+    /* S-box circuits, all 256 inputs in 4 packed states */
+    for (i = 0; i < 256; i++) buf[i] = (uint8_t)i;
+    for (i = 0; i < 256; i += 64) {
+        bs_pack(q, buf + i);
+        bs_sbox(q);
+        bs_unpack(sb + i, q);
+    }
+    for (i = 0; i < 256; i++) err += (sb[i] != aes_sbox[i]);
+
+    for (i = 0; i < 256; i += 64) {
+        bs_pack(q, buf + i);
+        bs_sbox_inv(q);
+        bs_unpack(sb + i, q);
+    }
+    for (i = 0; i < 256; i++) err += (sb[i] != aes_isbox[i]);
+
+    return err;
+} /* aes_fast_selftest */
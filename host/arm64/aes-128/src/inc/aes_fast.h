@@ -0,0 +1,84 @@
+/*
+*   AES-128 engines for the software baseline - T-table, constant-time
+*   bitsliced and ARMv8 Crypto Extensions, behind the byte-oriented reference
+*   in aes.h / aes256.c.
+*
+*   All are bit-exact with the reference, including its key schedule with
+*   the round constant kept at 0x01 (AES_RCON_FIXED), which the accelerator
+*   implements too. AES_RCON_FIPS gives the FIPS-197 schedule, e.g. to check
+*   against the standard test vectors.
+*
+*   Engine selection:
+*   - build time: -DAES_IMPL=AES_IMPL_REF|AES_IMPL_TTABLE|AES_IMPL_BITSLICE|AES_IMPL_ARMCE
+*   - run time:   AES_IMPL=ref|ttable|bitslice|armce in the environment, or
+*                 aes_impl_select()
+*   AES_IMPL_ARMCE needs the AES instructions (HWCAP_AES), checked at run
+*   time: without them the T-table engine is used instead.
+*/
+
+#ifndef AES_FAST_H
+#define AES_FAST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    enum aes_impl {
+        AES_IMPL_REF = 0,   // byte-oriented reference, aes.h / aes256.c
+        AES_IMPL_TTABLE,    // 32-bit T-table, one 1 KB table per direction
+        AES_IMPL_BITSLICE,  // 64-bit bitsliced, 4 blocks at once, no lookups
+        AES_IMPL_ARMCE,     // AESE/AESMC, 4 blocks in flight
+        AES_IMPL_N
+    };
+
+#ifndef AES_IMPL
+#define AES_IMPL AES_IMPL_ARMCE
+#endif
+
+    enum aes_rcon {
+        AES_RCON_FIXED = 0, // rcon = 0x01 in every round, as aes.h / aes256.c
+        AES_RCON_FIPS       // 0x01, 0x02, ... 0x36
+    };
+
+    extern const char * const aes_impl_names[AES_IMPL_N];
+
+    typedef struct {
+        uint32_t ek[44];        // encryption round keys, big-endian columns
+        uint32_t dk[44];        // decryption round keys, equivalent inverse cipher
+        uint64_t bk[11][8];     // bitsliced encryption round keys
+        uint8_t rk8[2][176];    // ek, dk in byte order for the crypto extensions
+        int impl;
+    } aes_fast_context;
+
+    /* Engine name to enum aes_impl, -1 if unknown. */
+    int aes_impl_parse(const char * /* name */);
+
+    /* 1 if impl runs on this CPU. */
+    int aes_impl_available(int /* impl */);
+
+    /* Current engine - AES_IMPL, unless overridden by the environment or aes_impl_select(). */
+    int aes_impl_get(void);
+    int aes_impl_select(int /* impl */);
+
+    /* Key expansion for impl, -1 for AES_IMPL_REF or unknown. AES_IMPL_ARMCE
+     * falls back to AES_IMPL_TTABLE when not available, see ctx->impl. */
+    int aes_fast_init(aes_fast_context *, const uint8_t * /* key */, int /* impl */, int /* rcon */);
+
+    /* ECB over nblocks 16 B blocks, in place allowed. */
+    void aes_fast_encrypt(const aes_fast_context *, uint8_t * /* out */, const uint8_t * /* in */, size_t /* nblocks */);
+    void aes_fast_decrypt(const aes_fast_context *, uint8_t * /* out */, const uint8_t * /* in */, size_t /* nblocks */);
+
+    /* CTR over nblocks, 128-bit big-endian counter as AES_Util_Increment(), advanced in place. */
+    void aes_fast_ctr(const aes_fast_context *, uint8_t * /* out */, const uint8_t * /* in */, size_t /* nblocks */, uint8_t * /* ctr */);
+
+    /* Bitsliced S-box and inverse against the tables, all 256 inputs. Number of mismatches. */
+    int aes_fast_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
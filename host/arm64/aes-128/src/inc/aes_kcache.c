@@ -0,0 +1,77 @@
+/*
+*   Key-schedule cache for the AES-128 engines, see aes_kcache.h.
+*
+*   Lookups are a linear scan: the cache holds the keys of a few peers, a
+*   16 B compare per entry costs far less than one key expansion.
+*/
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aes_kcache.h"
+
+/* -------------------------------------------------------------------------- */
+int aes_kcache_init(aes_kcache *c, int entries, int impl, int rcon)
+{
+    memset(c, 0, sizeof(*c));
+    c->impl = impl;
+    c->rcon = rcon;
+
+    if (entries <= 0 || impl == AES_IMPL_REF)
+        return entries < 0 ? -EINVAL : 0;
+
+    c->entry = (aes_kcache_entry *)calloc(entries, sizeof(aes_kcache_entry));
+    if (c->entry == NULL)
+        return -ENOMEM;
+    c->entries = entries;
+
+    return 0;
+} /* aes_kcache_init */
+
+/* -------------------------------------------------------------------------- */
+void aes_kcache_destroy(aes_kcache *c)
+{
+    if (c->entry) {
+        memset(c->entry, 0, sizeof(aes_kcache_entry) * c->entries);
+        free(c->entry);
+    }
+    c->entry = NULL;
+    c->entries = 0;
+} /* aes_kcache_destroy */
+
+/* -------------------------------------------------------------------------- */
+void aes_kcache_flush(aes_kcache *c)
+{
+    if (c->entry)
+        memset(c->entry, 0, sizeof(aes_kcache_entry) * c->entries);
+} /* aes_kcache_flush */
+
+/* -------------------------------------------------------------------------- */
+const aes_fast_context *aes_kcache_get(aes_kcache *c, const uint8_t *key)
+{
+    aes_kcache_entry *e, *lru;
+    int i;
+
+    if (c->entries == 0)
+        return NULL;
+
+    c->clock++;
+    lru = &c->entry[0];
+    for (i = 0; i < c->entries; i++) {
+        e = &c->entry[i];
+        if (e->used && memcmp(e->key, key, 16) == 0) {
+            e->used = c->clock;
+            c->hits++;
+            return &e->fast;
+        }
+        if (e->used < lru->used)
+            lru = e;
+    }
+
+    c->misses++;
+    memcpy(lru->key, key, 16);
+    lru->used = c->clock;
+    aes_fast_init(&lru->fast, key, c->impl, c->rcon);
+
+    return &lru->fast;
+} /* aes_kcache_get */
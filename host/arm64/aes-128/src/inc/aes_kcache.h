@@ -0,0 +1,61 @@
+/*
+*   Key-schedule cache for the AES-128 engines.
+*
+*   Keeps the expanded key (aes_fast_context) of the last used keys, so that
+*   the callers encrypting many messages under the same few keys expand each
+*   key once instead of once per call. The number of entries is set at init,
+*   the least recently used entry is replaced on a miss.
+*
+*   A cache is not thread-safe: use one per thread. A context returned by
+*   aes_kcache_get() is valid until the next aes_kcache_get() or
+*   aes_kcache_flush() on the same cache, which may replace it.
+*/
+
+#ifndef AES_KCACHE_H
+#define AES_KCACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "aes_fast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    typedef struct {
+        uint8_t key[16];
+        uint64_t used;          // last lookup, 0: empty
+        aes_fast_context fast;
+    } aes_kcache_entry;
+
+    typedef struct {
+        aes_kcache_entry *entry;
+        int entries;            // 0: disabled, every lookup misses
+        int impl;
+        int rcon;
+        uint64_t clock;         // lookups so far
+        uint64_t hits;
+        uint64_t misses;        // key expansions
+    } aes_kcache;
+
+    /*
+     * entries contexts for the aes_fast engine impl and the round constant
+     * schedule rcon (enum aes_rcon). With 0 entries or AES_IMPL_REF the cache
+     * is disabled and aes_kcache_get() returns NULL. 0 or -errno.
+     */
+    int aes_kcache_init(aes_kcache *, int /* entries */, int /* impl */, int /* rcon */);
+
+    /* Wipe the keys and free the entries, the cache is disabled afterwards. */
+    void aes_kcache_destroy(aes_kcache *);
+
+    /* Drop every key, the statistics are kept. */
+    void aes_kcache_flush(aes_kcache *);
+
+    /* Expanded key, from the cache or expanded into the LRU entry. NULL if disabled. */
+    const aes_fast_context *aes_kcache_get(aes_kcache *, const uint8_t * /* key */);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
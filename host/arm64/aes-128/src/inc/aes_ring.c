@@ -0,0 +1,229 @@
+/*
+*   Asynchronous submission ring for the AES-128 engines, see aes_ring.h.
+*
+*   head, done and tail only grow, slot i % AES_RING_SLOTS holds job i. The
+*   worker reads its slot without the lock: the slot is not reused before
+*   tail passes it, and tail never passes done.
+*/
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include "aes_ring.h"
+#include "aes_fast.h"
+
+/* -------------------------------------------------------------------------- */
+static void *aes_ring_worker(void *arg)
+{
+    aes_ring *r = (aes_ring *)arg;
+    aes_ring_job *job;
+
+    pthread_mutex_lock(&r->lock);
+    for (;;) {
+        while (r->done == r->head && !r->stop)
+            pthread_cond_wait(&r->has_work, &r->lock);
+        if (r->done == r->head)
+            break;
+
+        job = &r->slot[r->done % AES_RING_SLOTS];
+        pthread_mutex_unlock(&r->lock);
+
+        job->status = r->engine->run(r->engine->ctx, job);
+
+        pthread_mutex_lock(&r->lock);
+        r->done++;
+        pthread_cond_broadcast(&r->has_done);
+    }
+    pthread_mutex_unlock(&r->lock);
+
+    return NULL;
+} /* aes_ring_worker */
+
+/* -------------------------------------------------------------------------- */
+int aes_ring_init(aes_ring *r, const aes_ring_engine *engine)
+{
+    int err;
+
+    memset(r, 0, sizeof(*r));
+    r->engine = engine;
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->not_full, NULL);
+    pthread_cond_init(&r->has_work, NULL);
+    pthread_cond_init(&r->has_done, NULL);
+
+    err = pthread_create(&r->worker, NULL, aes_ring_worker, r);
+    if (err) {
+        pthread_cond_destroy(&r->has_done);
+        pthread_cond_destroy(&r->has_work);
+        pthread_cond_destroy(&r->not_full);
+        pthread_mutex_destroy(&r->lock);
+        return -err;
+    }
+
+    return 0;
+} /* aes_ring_init */
+
+/* -------------------------------------------------------------------------- */
+void aes_ring_destroy(aes_ring *r)
+{
+    pthread_mutex_lock(&r->lock);
+    r->stop = 1;
+    pthread_cond_broadcast(&r->has_work);
+    pthread_cond_broadcast(&r->not_full);
+    pthread_mutex_unlock(&r->lock);
+
+    pthread_join(r->worker, NULL);
+    while (aes_ring_poll(r, AES_RING_SLOTS) > 0)
+        ;
+
+    pthread_cond_destroy(&r->has_done);
+    pthread_cond_destroy(&r->has_work);
+    pthread_cond_destroy(&r->not_full);
+    pthread_mutex_destroy(&r->lock);
+} /* aes_ring_destroy */
+
+/* -------------------------------------------------------------------------- */
+static int aes_ring_push(aes_ring *r, const aes_ring_job *job, int block)
+{
+    aes_ring_job *s;
+
+    if (job->nblocks == 0 || (job->op != AES_RING_ECB && job->op != AES_RING_CTR))
+        return -EINVAL;
+
+    pthread_mutex_lock(&r->lock);
+    while (r->head - r->tail == AES_RING_SLOTS && !r->stop) {
+        if (!block) {
+            pthread_mutex_unlock(&r->lock);
+            return -EAGAIN;
+        }
+        pthread_cond_wait(&r->not_full, &r->lock);
+    }
+    if (r->stop) {
+        pthread_mutex_unlock(&r->lock);
+        return -EPIPE;
+    }
+
+    s = &r->slot[r->head % AES_RING_SLOTS];
+    *s = *job;
+    s->seq = r->head;
+    s->status = 0;
+    r->head++;
+    pthread_cond_signal(&r->has_work);
+    pthread_mutex_unlock(&r->lock);
+
+    return 0;
+} /* aes_ring_push */
+
+int aes_ring_submit(aes_ring *r, const aes_ring_job *job)
+{
+    return aes_ring_push(r, job, 1);
+}
+
+int aes_ring_try_submit(aes_ring *r, const aes_ring_job *job)
+{
+    return aes_ring_push(r, job, 0);
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Completed jobs are copied out so the slots are free before the callbacks
+ *  run: a callback may submit again.
+ */
+static int aes_ring_reap(aes_ring *r, int max)
+{
+    aes_ring_job job[AES_RING_SLOTS];
+    int i, n;
+
+    n = (int)(r->done - r->tail);
+    if (n > max)
+        n = max;
+    if (n > AES_RING_SLOTS)
+        n = AES_RING_SLOTS;
+    for (i = 0; i < n; i++)
+        job[i] = r->slot[(r->tail + i) % AES_RING_SLOTS];
+    r->tail += n;
+    if (n > 0)
+        pthread_cond_broadcast(&r->not_full);
+    pthread_mutex_unlock(&r->lock);
+
+    for (i = 0; i < n; i++)
+        if (job[i].cb)
+            job[i].cb(&job[i]);
+
+    return n;
+} /* aes_ring_reap */
+
+int aes_ring_poll(aes_ring *r, int max)
+{
+    pthread_mutex_lock(&r->lock);
+    return aes_ring_reap(r, max);
+}
+
+int aes_ring_wait(aes_ring *r, int min, int max)
+{
+    pthread_mutex_lock(&r->lock);
+    while (r->done - r->tail < (uint64_t)min && r->done != r->head)
+        pthread_cond_wait(&r->has_done, &r->lock);
+    return aes_ring_reap(r, max);
+}
+
+void aes_ring_drain(aes_ring *r)
+{
+    uint64_t last;
+
+    pthread_mutex_lock(&r->lock);
+    last = r->head;
+    while (r->tail < last) {
+        while (r->done == r->tail)
+            pthread_cond_wait(&r->has_done, &r->lock);
+        aes_ring_reap(r, AES_RING_SLOTS);
+        pthread_mutex_lock(&r->lock);
+    }
+    pthread_mutex_unlock(&r->lock);
+} /* aes_ring_drain */
+
+int aes_ring_pending(aes_ring *r)
+{
+    int n;
+
+    pthread_mutex_lock(&r->lock);
+    n = (int)(r->head - r->tail);
+    pthread_mutex_unlock(&r->lock);
+
+    return n;
+}
+
+/* -------------------------------------------------------------------------- */
+static int aes_ring_sw_run(void *arg, aes_ring_job *job)
+{
+    aes_ring_sw *sw = (aes_ring_sw *)arg;
+    aes_fast_context fast;
+    struct timespec ts;
+
+    if (aes_fast_init(&fast, job->key, sw->impl, AES_RCON_FIXED))
+        return -EINVAL;
+
+    if (job->op == AES_RING_CTR)
+        aes_fast_ctr(&fast, job->out, job->in, job->nblocks, job->ctr);
+    else
+        aes_fast_encrypt(&fast, job->out, job->in, job->nblocks);
+
+    if (sw->latency_us) {
+        ts.tv_sec = sw->latency_us / 1000000;
+        ts.tv_nsec = (long)(sw->latency_us % 1000000) * 1000;
+        while (nanosleep(&ts, &ts) && errno == EINTR)
+            ;
+    }
+
+    return 0;
+} /* aes_ring_sw_run */
+
+const aes_ring_engine *aes_ring_sw_engine(aes_ring_sw *sw, int impl, unsigned latency_us)
+{
+    sw->impl = (impl == AES_IMPL_REF) ? AES_IMPL_TTABLE : impl;
+    sw->latency_us = latency_us;
+    sw->engine.name = "sw";
+    sw->engine.ctx = sw;
+    sw->engine.run = aes_ring_sw_run;
+
+    return &sw->engine;
+}
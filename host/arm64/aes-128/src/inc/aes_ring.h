@@ -0,0 +1,117 @@
+/*
+*   Asynchronous submission ring for the AES-128 engines.
+*
+*   A fixed number of jobs (AES_RING_SLOTS) can be in flight. Jobs are copied
+*   into the ring by aes_ring_submit() and run in submission order by one
+*   worker thread through an engine: the accelerator (axis_aes128_ring_engine()
+*   in the driver) or the software stand-in below, so the callers can keep
+*   preparing messages while a transaction is on the DMA.
+*
+*   Completed jobs are reaped by aes_ring_poll() / aes_ring_wait(), which run
+*   the job callbacks on the calling thread, in submission order when a single
+*   thread reaps. A slot is free again once its job has been reaped: with all
+*   slots in flight aes_ring_submit() blocks until another thread reaps, a
+*   single-threaded caller uses aes_ring_try_submit() and reaps on -EAGAIN.
+*/
+
+#ifndef AES_RING_H
+#define AES_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef AES_RING_SLOTS
+#define AES_RING_SLOTS 16
+#endif
+
+    enum aes_ring_op {
+        AES_RING_ECB = 0,   // out = E(in)
+        AES_RING_CTR        // out = in ^ E(ctr++), as AES_Encrypt_CTR()
+    };
+
+    typedef struct aes_ring_job aes_ring_job;
+
+    /* Completion, job is the ring's copy: status, ctr and seq are filled in. */
+    typedef void (*aes_ring_cb)(const aes_ring_job * /* job */);
+
+    struct aes_ring_job {
+        int op;                 // enum aes_ring_op
+        uint8_t *out;           // nblocks * 16 B, untouched until completion
+        const uint8_t *in;      // nblocks * 16 B, must stay valid until completion
+        size_t nblocks;
+        uint8_t key[16];
+        uint8_t ctr[16];        // CTR: first counter block, the next one on completion
+        aes_ring_cb cb;         // NULL: no callback
+        void *arg;
+        uint64_t seq;           // set by aes_ring_submit()
+        int status;             // engine return value, 0 on success
+    };
+
+    typedef struct {
+        const char *name;
+        void *ctx;
+        int (*run)(void * /* ctx */, aes_ring_job *);   // blocking, on the worker thread
+    } aes_ring_engine;
+
+    typedef struct {
+        const aes_ring_engine *engine;
+        aes_ring_job slot[AES_RING_SLOTS];
+        uint64_t head;          // jobs submitted
+        uint64_t done;          // jobs run by the engine
+        uint64_t tail;          // jobs reaped, tail <= done <= head
+        int stop;
+        pthread_mutex_t lock;
+        pthread_cond_t not_full;
+        pthread_cond_t has_work;
+        pthread_cond_t has_done;
+        pthread_t worker;
+    } aes_ring;
+
+    /* Start the worker. engine must outlive the ring. 0 or -errno. */
+    int aes_ring_init(aes_ring *, const aes_ring_engine *);
+
+    /* Run what is queued, reap it (callbacks included) and stop the worker. */
+    void aes_ring_destroy(aes_ring *);
+
+    /* Queue a copy of job, blocks while all slots are in flight. 0 or -errno. */
+    int aes_ring_submit(aes_ring *, const aes_ring_job *);
+
+    /* As aes_ring_submit(), -EAGAIN instead of blocking. */
+    int aes_ring_try_submit(aes_ring *, const aes_ring_job *);
+
+    /* Reap up to max completed jobs without blocking. Number reaped. */
+    int aes_ring_poll(aes_ring *, int /* max */);
+
+    /* Block until min jobs completed (or all in flight, if fewer), then reap up to max. */
+    int aes_ring_wait(aes_ring *, int /* min */, int /* max */);
+
+    /* Reap until every job submitted so far has completed. */
+    void aes_ring_drain(aes_ring *);
+
+    /* Jobs submitted and not reaped yet. */
+    int aes_ring_pending(aes_ring *);
+
+    /*
+     * Software stand-in for the accelerator: the aes_fast engine impl
+     * (AES_IMPL_REF runs as AES_IMPL_TTABLE) with the fixed-rcon schedule of
+     * the hardware, and latency_us of sleep per job to model a DMA round trip
+     * that leaves the CPU free.
+     */
+    typedef struct {
+        aes_ring_engine engine;
+        int impl;
+        unsigned latency_us;
+    } aes_ring_sw;
+
+    const aes_ring_engine *aes_ring_sw_engine(aes_ring_sw *, int /* impl */, unsigned /* latency_us */);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
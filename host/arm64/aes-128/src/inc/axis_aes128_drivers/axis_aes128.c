@@ -12,11 +12,14 @@
 #include <sys/mman.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <time.h>
 
 #ifndef DEBUG
 //#define DEBUG 
 #endif
 
+const char * const aes128_beat_names[AES128_N_BEATS] = { "word", "packed" };
+
 /*  load_axis_aes128():    load the accelerator using fpgautil
  *
  *	char *accelerator:          the accelerator file name to load
@@ -189,6 +192,8 @@ int axis_aes128_init(aes128_addr_t *addr){
 	dma_s2mm_status_print(addr->dma_ENCRYPTED_virtual_addr);
 	#endif 
 
+	addr->bulk_key_blocks = 0;
+
 	return 0;
 }
 
@@ -265,6 +270,7 @@ void axis_aes128_send(aes128_addr_t *addr, uint8_t *text_data, uint8_t *key_data
 		addr->virtual_src_KEY_addr[i] = (uint32_t)key_data[i];
 	}
 	addr->virtual_src_RC_addr[0] = (uint32_t)rc_data[0];
+	addr->bulk_key_blocks = 0;	// the bulk key copies start at word 0
 	
 
 	// run the MM2S channel(s)
@@ -353,3 +359,291 @@ void axis_aes128_send_wait(aes128_addr_t *addr, uint8_t *encrypted_text, uint8_t
 
 	axis_aes128_wait(addr, encrypted_text);
 }
+
+/************************************************************************
+ * Bulk transfers: N blocks per DMA transaction
+ ************************************************************************/
+
+static size_t aes128_block_bytes(int beat){
+	return (beat == AES128_BEAT_WORD) ? 16 * 4 : 16;
+}
+
+/*  aes128_pack():    			copy bytes into a DMA buffer
+ *
+ *  The buffers are mapped from /dev/mem with O_SYNC, i.e. as device memory:
+ *  only aligned 32-bit stores, no memcpy().
+ */
+static void aes128_pack(uint32_t *dst, const uint8_t *src, size_t nbytes, int beat){
+	size_t i;
+
+	if (beat == AES128_BEAT_WORD) {
+		for (i = 0; i < nbytes; ++i)
+			dst[i] = (uint32_t)src[i];
+		return;
+	}
+
+	for (i = 0; i < nbytes / 4; ++i, src += 4)
+		dst[i] = (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static void aes128_unpack(uint8_t *dst, const uint32_t *src, size_t nbytes, int beat){
+	size_t i;
+
+	if (beat == AES128_BEAT_WORD) {
+		for (i = 0; i < nbytes; ++i)
+			dst[i] = (uint8_t)src[i];
+		return;
+	}
+
+	for (i = 0; i < nbytes / 4; ++i, dst += 4) {
+		uint32_t w = src[i];
+		dst[0] = (uint8_t)w;
+		dst[1] = (uint8_t)(w >> 8);
+		dst[2] = (uint8_t)(w >> 16);
+		dst[3] = (uint8_t)(w >> 24);
+	}
+}
+
+/*  axis_aes128_max_blocks():   blocks per DMA transaction
+ *
+ *  int beat:					AES128_BEAT_WORD or AES128_BEAT_PACKED
+ *
+ * 	return the largest N for axis_aes128_send_bulk(), bounded by the mapped
+ * 	buffers and by the DMA length register
+ */
+size_t axis_aes128_max_blocks(int beat){
+	size_t max_bytes = ((size_t)1 << AES128_DMA_LEN_WIDTH) - 1;
+
+	if (max_bytes > AES128_BUF_BYTES)
+		max_bytes = AES128_BUF_BYTES;
+
+	return max_bytes / aes128_block_bytes(beat);
+}
+
+/*  axis_aes128_send_bulk():    send N blocks in one DMA transaction
+ *
+ *	const uint8_t *text_data    N * 128-bit text
+ *	size_t nblocks:				N, at most axis_aes128_max_blocks(beat)
+ *  const uint8_t *key_data:	128-bit key, the same for all blocks
+ *  const uint8_t *rc_data:		8-bit round_const
+ *  int beat:					layout of the buffers, enum aes128_beat
+ *
+ * 	return -1 					N out of range
+ *  return  0  					transfers started
+ */
+int axis_aes128_send_bulk(aes128_addr_t *addr, const uint8_t *text_data, size_t nblocks, const uint8_t *key_data, const uint8_t *rc_data, int beat){
+	const size_t block_bytes = aes128_block_bytes(beat);
+	size_t b;
+
+	if (nblocks == 0 || nblocks > axis_aes128_max_blocks(beat))
+		return -1;
+
+	// write source data, the key copies only when the key changes
+	if (addr->bulk_beat != beat || addr->bulk_rc != rc_data[0]
+		|| memcmp(addr->bulk_key, key_data, 16) != 0) {
+		memcpy(addr->bulk_key, key_data, 16);
+		addr->bulk_rc = rc_data[0];
+		addr->bulk_beat = beat;
+		addr->bulk_key_blocks = 0;
+	}
+	for (b = addr->bulk_key_blocks; b < nblocks; ++b) {
+		aes128_pack(addr->virtual_src_KEY_addr + b * block_bytes / 4, key_data, 16, beat);
+		addr->virtual_src_RC_addr[b] = (uint32_t)rc_data[0];
+	}
+	if (nblocks > addr->bulk_key_blocks)
+		addr->bulk_key_blocks = nblocks;
+
+	aes128_pack(addr->virtual_src_TEXT_addr, text_data, 16 * nblocks, beat);
+
+	// run the MM2S and S2MM channel(s)
+	// -------------------------------------------------------------------
+	write_dma(addr->dma_RC_virtual_addr, MM2S_CONTROL_REGISTER, RUN_DMA);
+	write_dma(addr->dma_KEY_virtual_addr, MM2S_CONTROL_REGISTER, RUN_DMA);
+	write_dma(addr->dma_TEXT_virtual_addr, MM2S_CONTROL_REGISTER, RUN_DMA);
+	write_dma(addr->dma_ENCRYPTED_virtual_addr, S2MM_CONTROL_REGISTER, RUN_DMA);
+
+	// writing the transfer lengths
+	// -------------------------------------------------------------------
+	write_dma(addr->dma_TEXT_virtual_addr, MM2S_TRNSFR_LENGTH_REGISTER, nblocks * block_bytes);
+	write_dma(addr->dma_KEY_virtual_addr, MM2S_TRNSFR_LENGTH_REGISTER, nblocks * block_bytes);
+	write_dma(addr->dma_RC_virtual_addr, MM2S_TRNSFR_LENGTH_REGISTER, nblocks * 4);
+	write_dma(addr->dma_ENCRYPTED_virtual_addr, S2MM_BUFF_LENGTH_REGISTER, nblocks * block_bytes);
+	#ifdef DEBUG
+		dma_mm2s_status_print(addr->dma_TEXT_virtual_addr);
+		dma_mm2s_status_print(addr->dma_KEY_virtual_addr);
+		dma_mm2s_status_print(addr->dma_RC_virtual_addr);
+		dma_s2mm_status_print(addr->dma_ENCRYPTED_virtual_addr);
+	#endif
+
+	return 0;
+}
+
+/*  axis_aes128_wait_bulk():    wait the transaction of axis_aes128_send_bulk()
+ *
+ * 	uint8_t *encrypted_text:	N * 128-bit output
+ *	size_t nblocks:				N, as sent
+ *  int beat:					as sent
+ */
+void axis_aes128_wait_bulk(aes128_addr_t *addr, uint8_t *encrypted_text, size_t nblocks, int beat){
+
+	dma_mm2s_sync(addr->dma_TEXT_virtual_addr);
+	dma_mm2s_sync(addr->dma_KEY_virtual_addr);
+	dma_mm2s_sync(addr->dma_RC_virtual_addr);
+	dma_s2mm_sync(addr->dma_ENCRYPTED_virtual_addr);
+
+	aes128_unpack(encrypted_text, addr->virtual_dst_ENCRYPTED_addr, 16 * nblocks, beat);
+}
+
+/*  axis_aes128_encrypt_bulk(): encrypt N blocks, any N
+ *
+ *  Split in transactions of axis_aes128_max_blocks(beat) blocks.
+ *
+ * 	return -1 					bad arguments
+ *  return  0  					done
+ */
+int axis_aes128_encrypt_bulk(aes128_addr_t *addr, uint8_t *encrypted_text, const uint8_t *text_data, size_t nblocks, const uint8_t *key_data, const uint8_t *rc_data, int beat){
+	const size_t max_blocks = axis_aes128_max_blocks(beat);
+
+	if (beat < 0 || beat >= AES128_N_BEATS)
+		return -1;
+
+	while (nblocks > 0) {
+		size_t n = (nblocks < max_blocks) ? nblocks : max_blocks;
+
+		if (axis_aes128_send_bulk(addr, text_data, n, key_data, rc_data, beat))
+			return -1;
+		axis_aes128_wait_bulk(addr, encrypted_text, n, beat);
+
+		text_data += 16 * n;
+		encrypted_text += 16 * n;
+		nblocks -= n;
+	}
+
+	return 0;
+}
+
+/*  axis_aes128_bench_bulk():   MB/s from 16 B to max_bytes messages
+ *
+ *  Message sizes grow by 4x. Each size is repeated for at least ~1 MB of
+ *  data, the single-block axis_aes128_send_wait() loop is measured up to
+ *  64 KB.
+ *
+ *  size_t max_bytes:			largest message, e.g. 16 MB
+ *
+ * 	return -1 					out of memory
+ *  return  0  					done
+ */
+int axis_aes128_bench_bulk(aes128_addr_t *addr, const uint8_t *key_data, const uint8_t *rc_data, int beat, size_t max_bytes){
+	struct timespec t0, t1;
+	uint8_t *in, *out;
+	size_t bytes, reps, r, b;
+	double us_bulk, us_block;
+
+	in = (uint8_t *)malloc(max_bytes);
+	out = (uint8_t *)malloc(max_bytes);
+	if (in == NULL || out == NULL) {
+		free(in);
+		free(out);
+		return -1;
+	}
+	for (b = 0; b < max_bytes; ++b)
+		in[b] = (uint8_t)(b * 31 + 7);
+
+	printf("\n  - axis_aes128 bulk transfers (%s, %zu blocks per DMA transaction)\n",
+		aes128_beat_names[beat], axis_aes128_max_blocks(beat));
+	printf("\n  %10s  %8s  %12s  %12s  %12s\n", "bytes", "DMA", "bulk MB/s", "us/msg", "block MB/s");
+
+	for (bytes = 16; bytes <= max_bytes; bytes *= 4) {
+		const size_t nblocks = bytes / 16;
+		const size_t max_blocks = axis_aes128_max_blocks(beat);
+
+		reps = (bytes < (1 << 20)) ? (1 << 20) / bytes : 1;
+
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		for (r = 0; r < reps; ++r)
+			axis_aes128_encrypt_bulk(addr, out, in, nblocks, key_data, rc_data, beat);
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		us_bulk = ((t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3) / reps;
+
+		printf("  %10zu  %8zu  %12.2f  %12.2f", bytes, (nblocks + max_blocks - 1) / max_blocks,
+			bytes / us_bulk, us_bulk);
+
+		if (bytes <= (1 << 16)) {
+			reps = (bytes < (1 << 16)) ? (1 << 16) / bytes : 1;
+			clock_gettime(CLOCK_MONOTONIC, &t0);
+			for (r = 0; r < reps; ++r)
+				for (b = 0; b < nblocks; ++b)
+					axis_aes128_send_wait(addr, &out[16 * b], &in[16 * b], (uint8_t *)key_data, (uint8_t *)rc_data);
+			clock_gettime(CLOCK_MONOTONIC, &t1);
+			us_block = ((t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3) / reps;
+			printf("  %12.2f\n", bytes / us_block);
+		} else {
+			printf("  %12s\n", "-");
+		}
+	}
+	printf("\n");
+
+	free(in);
+	free(out);
+
+	return 0;
+}
+
+/*  axis_aes128_ring_run():     aes_ring engine on the accelerator
+ *
+ *  Runs on the ring worker, the only user of addr while the ring is up.
+ *  ECB is one bulk call, CTR encrypts the counter blocks AES128_RING_CTR_BLOCKS
+ *  at a time and XORs the input.
+ *
+ *	void *ctx:					aes128_addr_t of an initialised accelerator
+ *
+ * 	return -1 					bad job
+ *  return  0  					done
+ */
+#define AES128_RING_CTR_BLOCKS 256
+
+int axis_aes128_ring_run(void *ctx, aes_ring_job *job){
+	aes128_addr_t *addr = (aes128_addr_t *)ctx;
+	const uint8_t rc[] = {0x01};
+	uint8_t ks[AES128_RING_CTR_BLOCKS * 16];
+	const uint8_t *in = job->in;
+	uint8_t *out = job->out;
+	size_t nblocks = job->nblocks;
+	size_t n, b;
+	int i;
+
+	if (job->op == AES_RING_ECB)
+		return axis_aes128_encrypt_bulk(addr, out, in, nblocks, job->key, rc, AES128_BEAT_WORD);
+
+	while (nblocks > 0) {
+		n = (nblocks < AES128_RING_CTR_BLOCKS) ? nblocks : AES128_RING_CTR_BLOCKS;
+
+		for (b = 0; b < n; ++b) {
+			memcpy(&ks[16 * b], job->ctr, 16);
+			for (i = 15; i >= 0 && ++job->ctr[i] == 0; --i)
+				;
+		}
+		if (axis_aes128_encrypt_bulk(addr, ks, ks, n, job->key, rc, AES128_BEAT_WORD))
+			return -1;
+		for (b = 0; b < 16 * n; ++b)
+			out[b] = in[b] ^ ks[b];
+
+		in += 16 * n;
+		out += 16 * n;
+		nblocks -= n;
+	}
+
+	return 0;
+}
+
+/*  axis_aes128_ring_engine():  fill an aes_ring engine for addr
+ *
+ * 	return engine, to pass to aes_ring_init()
+ */
+const aes_ring_engine *axis_aes128_ring_engine(aes_ring_engine *engine, aes128_addr_t *addr){
+	engine->name = "axis_aes128";
+	engine->ctx = addr;
+	engine->run = axis_aes128_ring_run;
+
+	return engine;
+}
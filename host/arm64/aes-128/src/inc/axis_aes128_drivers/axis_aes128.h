@@ -16,7 +16,18 @@
 
 #define SIZE_VIRTUAL_ADDR 65535 //64K
 
+// Usable bytes of each mapped source/destination buffer
+#define AES128_BUF_BYTES 0x10000
+
+// Width of the AXI DMA buffer length register (c_sg_length_width), the
+// largest simple-mode transfer is 2^width - 1 bytes. 14 is the IP default.
+#ifndef AES128_DMA_LEN_WIDTH
+#define AES128_DMA_LEN_WIDTH 14
+#endif
+
 #include <stdint.h>
+#include <stddef.h>
+#include "../aes_ring.h"
  
 
 /************************* Struct Definitions **************************/
@@ -33,7 +44,30 @@ typedef struct aes128_addr{
 	uint32_t *virtual_src_KEY_addr;			// key addr
 	uint32_t *virtual_src_RC_addr;			// rc addr
 	uint32_t *virtual_dst_ENCRYPTED_addr;	// encrypted text addr
+
+	// bulk: KEY and RC buffers already hold bulk_key_blocks copies of this key
+	uint8_t bulk_key[16];
+	uint8_t bulk_rc;
+	int bulk_beat;
+	size_t bulk_key_blocks;
 } aes128_addr_t;
+
+/*
+ * Layout of TEXT, KEY and ENCRYPTED in the DMA buffers for the bulk API:
+ * - AES128_BEAT_WORD:   one byte per 32-bit word, 64 B per block, as the
+ *                       single-block axis_aes128_send()
+ * - AES128_BEAT_PACKED: the bytes as they are, 16 B per block. Byte 0 is in
+ *                       lane 0, so this serves a 32-bit stream (4 beats per
+ *                       block) and a 128-bit stream (1 beat per block).
+ * RC stays one 32-bit word per block in both.
+ */
+enum aes128_beat {
+	AES128_BEAT_WORD = 0,
+	AES128_BEAT_PACKED,
+	AES128_N_BEATS
+};
+
+extern const char * const aes128_beat_names[AES128_N_BEATS];
 		
 
 /************************ Function Definitions *************************/
@@ -51,5 +85,19 @@ void axis_aes128_send(aes128_addr_t *addr, uint8_t *text_data, uint8_t *key_data
 void axis_aes128_wait(aes128_addr_t *addr, uint8_t *encrypted_text);
 
 void axis_aes128_send_wait(aes128_addr_t *addr, uint8_t *encrypted_text, uint8_t *text_data, uint8_t *key_data, uint8_t *rc_data);
+
+size_t axis_aes128_max_blocks(int beat);
+
+int axis_aes128_send_bulk(aes128_addr_t *addr, const uint8_t *text_data, size_t nblocks, const uint8_t *key_data, const uint8_t *rc_data, int beat);
+
+void axis_aes128_wait_bulk(aes128_addr_t *addr, uint8_t *encrypted_text, size_t nblocks, int beat);
+
+int axis_aes128_encrypt_bulk(aes128_addr_t *addr, uint8_t *encrypted_text, const uint8_t *text_data, size_t nblocks, const uint8_t *key_data, const uint8_t *rc_data, int beat);
+
+int axis_aes128_bench_bulk(aes128_addr_t *addr, const uint8_t *key_data, const uint8_t *rc_data, int beat, size_t max_bytes);
+
+int axis_aes128_ring_run(void *ctx, aes_ring_job *job);
+
+const aes_ring_engine *axis_aes128_ring_engine(aes_ring_engine *engine, aes128_addr_t *addr);
  
 #endif
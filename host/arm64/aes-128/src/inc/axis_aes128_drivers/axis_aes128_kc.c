@@ -0,0 +1,334 @@
+/************************************************************************
+ * Filename:        axis_aes128_kc.c
+ * Description:     AES 128 Key-Context Accelerator Driver
+ * Date:            19/10/2026
+ ************************************************************************/
+
+#include "axi_dma_driver.h"
+#include "axis_aes128_kc.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+/*  axis_aes128_kc_init():    	init the accelerator
+ *
+ *  aes128_kc_t *kc:			the pointer to the addresses
+ *
+ * 	return -1 					an error occurs
+ *  return  0  					accelerator initiated, key table empty
+ */
+int axis_aes128_kc_init(aes128_kc_t *kc){
+
+	// open the ddr
+	// -------------------------------------------------------------------
+	if((kc->ddr_memory = open("/dev/mem", O_RDWR | O_SYNC)) < 0){
+		printf("Error opening the DDR memory.\n");
+		return -1;
+	}
+
+	// mapping the dma, the source and the destination
+	// -------------------------------------------------------------------
+	kc->dma_virtual_addr = (uint32_t *)mmap(NULL, SIZE_VIRTUAL_ADDR, PROT_READ | PROT_WRITE, MAP_SHARED, kc->ddr_memory, OFFS_DMA_KC_DATA);
+	if(kc->dma_virtual_addr == MAP_FAILED){
+		printf("Error mapping DMA virtual address.\n");
+		return -1;
+	}
+
+	kc->virtual_src_addr = (uint32_t *)mmap(NULL, SIZE_VIRTUAL_ADDR, PROT_READ | PROT_WRITE, MAP_SHARED, kc->ddr_memory, AES128_KC_SRC_ADDR);
+	if(kc->virtual_src_addr == MAP_FAILED){
+		printf("Error mapping command virtual source address.\n");
+		return -1;
+	}
+
+	kc->virtual_dst_addr = (uint32_t *)mmap(NULL, SIZE_VIRTUAL_ADDR, PROT_READ | PROT_WRITE, MAP_SHARED, kc->ddr_memory, AES128_KC_DST_ADDR);
+	if(kc->virtual_dst_addr == MAP_FAILED){
+		printf("Error mapping ENCRYPTED TEXT virtual destination address.\n");
+		return -1;
+	}
+
+	// reset, halt, enable all interrupts
+	// -------------------------------------------------------------------
+	write_dma(kc->dma_virtual_addr, MM2S_CONTROL_REGISTER, RESET_DMA);
+	write_dma(kc->dma_virtual_addr, S2MM_CONTROL_REGISTER, RESET_DMA);
+	write_dma(kc->dma_virtual_addr, MM2S_CONTROL_REGISTER, HALT_DMA);
+	write_dma(kc->dma_virtual_addr, S2MM_CONTROL_REGISTER, HALT_DMA);
+	write_dma(kc->dma_virtual_addr, MM2S_CONTROL_REGISTER, ENABLE_ALL_IRQ);
+	write_dma(kc->dma_virtual_addr, S2MM_CONTROL_REGISTER, ENABLE_ALL_IRQ);
+
+	// writing the source and destination registers
+	// -------------------------------------------------------------------
+	write_dma(kc->dma_virtual_addr, MM2S_SRC_ADDRESS_REGISTER, AES128_KC_SRC_ADDR);
+	write_dma(kc->dma_virtual_addr, S2MM_DST_ADDRESS_REGISTER, AES128_KC_DST_ADDR);
+
+	#ifdef DEBUG
+	dma_mm2s_status_print(kc->dma_virtual_addr);
+	dma_s2mm_status_print(kc->dma_virtual_addr);
+	#endif
+
+	axis_aes128_kc_flush(kc);
+
+	return 0;
+}
+
+/*  axis_aes128_kc_stop():    	stop the accelerator
+ *
+ * 	return -1 					an error occurs
+ *  return  0  					accelerator stopped
+ */
+int axis_aes128_kc_stop(aes128_kc_t *kc){
+
+	if(munmap(kc->dma_virtual_addr, SIZE_VIRTUAL_ADDR) != 0){
+		printf("Error unmapping DMA virtual address.\n");
+		return -1;
+	}
+	if(munmap(kc->virtual_src_addr, SIZE_VIRTUAL_ADDR) != 0){
+		printf("Error unmapping command virtual source address.\n");
+		return -1;
+	}
+	if(munmap(kc->virtual_dst_addr, SIZE_VIRTUAL_ADDR) != 0){
+		printf("Error unmapping ENCRYPTED TEXT virtual destination address.\n");
+		return -1;
+	}
+
+	if(close(kc->ddr_memory) != 0){
+		printf("Error closing the DDR memory.\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*  axis_aes128_kc_flush():    	forget the key table, e.g. after reloading the bitstream
+ */
+void axis_aes128_kc_flush(aes128_kc_t *kc){
+	memset(kc->slot_used, 0, sizeof(kc->slot_used));
+	kc->use_count = 0;
+	kc->key_loads = 0;
+}
+
+/*  aes128_kc_slot():    		slot holding key, least recently used slot if none
+ *
+ *  int *load:					set to 1 if the key has to be uploaded to the slot
+ */
+static int aes128_kc_slot(aes128_kc_t *kc, const uint8_t *key_data, int *load){
+	int s, lru = 0;
+
+	for (s = 0; s < AES128_KC_SLOTS; ++s) {
+		if (kc->slot_used[s] && memcmp(kc->slot_key[s], key_data, 16) == 0) {
+			kc->slot_used[s] = ++kc->use_count;
+			*load = 0;
+			return s;
+		}
+		if (kc->slot_used[s] < kc->slot_used[lru])
+			lru = s;
+	}
+
+	memcpy(kc->slot_key[lru], key_data, 16);
+	kc->slot_used[lru] = ++kc->use_count;
+	kc->key_loads++;
+	*load = 1;
+	return lru;
+}
+
+/*  Packed layout, byte 0 in lane 0. Device memory: aligned 32-bit accesses only. */
+static void aes128_kc_pack(uint32_t *dst, const uint8_t *src, size_t nbytes){
+	size_t i;
+
+	for (i = 0; i < nbytes / 4; ++i, src += 4)
+		dst[i] = (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static void aes128_kc_unpack(uint8_t *dst, const uint32_t *src, size_t nbytes){
+	size_t i;
+
+	for (i = 0; i < nbytes / 4; ++i, dst += 4) {
+		uint32_t w = src[i];
+		dst[0] = (uint8_t)w;
+		dst[1] = (uint8_t)(w >> 8);
+		dst[2] = (uint8_t)(w >> 16);
+		dst[3] = (uint8_t)(w >> 24);
+	}
+}
+
+/*  axis_aes128_kc_max_blocks():	blocks per DMA transaction
+ *
+ * 	return the largest N of one ENCRYPT command, with room for a KEY
+ * 	command in front of it
+ */
+size_t axis_aes128_kc_max_blocks(void){
+	size_t max_bytes = ((size_t)1 << AES128_DMA_LEN_WIDTH) - 1;
+
+	if (max_bytes > AES128_BUF_BYTES)
+		max_bytes = AES128_BUF_BYTES;
+
+	return (max_bytes - 4 * (1 + 4 + 1)) / 16;
+}
+
+/*  axis_aes128_kc_encrypt():   encrypt N blocks with key, any N
+ *
+ *  One DMA transaction per axis_aes128_kc_max_blocks() blocks: an ENCRYPT
+ *  command, preceded by a KEY command when the key is not in the table.
+ *
+ *	const uint8_t *text_data    N * 128-bit text
+ *  const uint8_t *key_data:	128-bit key, fixed-rcon schedule
+ *
+ * 	return  0  					done
+ */
+int axis_aes128_kc_encrypt(aes128_kc_t *kc, uint8_t *encrypted_text, const uint8_t *text_data, size_t nblocks, const uint8_t *key_data){
+	const size_t max_blocks = axis_aes128_kc_max_blocks();
+
+	while (nblocks > 0) {
+		size_t n = (nblocks < max_blocks) ? nblocks : max_blocks;
+		size_t w = 0;
+		int load;
+		int slot = aes128_kc_slot(kc, key_data, &load);
+
+		// write the command(s)
+		if (load) {
+			kc->virtual_src_addr[w++] = AES128_KC_HEADER(AES128_KC_OP_KEY, 0, slot, 0);
+			aes128_kc_pack(&kc->virtual_src_addr[w], key_data, 16);
+			w += 4;
+		}
+		kc->virtual_src_addr[w++] = AES128_KC_HEADER(AES128_KC_OP_ENCRYPT, 0, slot, n);
+		aes128_kc_pack(&kc->virtual_src_addr[w], text_data, 16 * n);
+		w += 4 * n;
+
+		// run both channels, S2MM first to take the output as it comes
+		write_dma(kc->dma_virtual_addr, S2MM_CONTROL_REGISTER, RUN_DMA);
+		write_dma(kc->dma_virtual_addr, MM2S_CONTROL_REGISTER, RUN_DMA);
+		write_dma(kc->dma_virtual_addr, S2MM_BUFF_LENGTH_REGISTER, 16 * n);
+		write_dma(kc->dma_virtual_addr, MM2S_TRNSFR_LENGTH_REGISTER, 4 * w);
+
+		dma_mm2s_sync(kc->dma_virtual_addr);
+		dma_s2mm_sync(kc->dma_virtual_addr);
+		#ifdef DEBUG
+		dma_mm2s_status_print(kc->dma_virtual_addr);
+		dma_s2mm_status_print(kc->dma_virtual_addr);
+		#endif
+
+		aes128_kc_unpack(encrypted_text, kc->virtual_dst_addr, 16 * n);
+
+		text_data += 16 * n;
+		encrypted_text += 16 * n;
+		nblocks -= n;
+	}
+
+	return 0;
+}
+
+/*  axis_aes128_kc_bench():     MB/s from 16 B to max_bytes messages
+ *
+ *  Messages cycle over 1 key, AES128_KC_SLOTS keys (all in the table) and
+ *  2 * AES128_KC_SLOTS keys (a key upload per message).
+ *
+ * 	return -1 					out of memory
+ *  return  0  					done
+ */
+int axis_aes128_kc_bench(aes128_kc_t *kc, size_t max_bytes){
+	const int n_keys[3] = { 1, AES128_KC_SLOTS, 2 * AES128_KC_SLOTS };
+	uint8_t keys[2 * AES128_KC_SLOTS][16];
+	struct timespec t0, t1;
+	uint8_t *in, *out;
+	size_t bytes, reps, r, b;
+	int k;
+
+	in = (uint8_t *)malloc(max_bytes);
+	out = (uint8_t *)malloc(max_bytes);
+	if (in == NULL || out == NULL) {
+		free(in);
+		free(out);
+		return -1;
+	}
+	for (b = 0; b < max_bytes; ++b)
+		in[b] = (uint8_t)(b * 31 + 7);
+	for (k = 0; k < 2 * AES128_KC_SLOTS; ++k)
+		for (b = 0; b < 16; ++b)
+			keys[k][b] = (uint8_t)(k * 16 + b);
+
+	printf("\n  - axis_aes128_kc (%d key slots, %zu blocks per DMA transaction)\n",
+		AES128_KC_SLOTS, axis_aes128_kc_max_blocks());
+	printf("\n  %10s", "bytes");
+	for (k = 0; k < 3; ++k)
+		printf("  %6d key(s) MB/s  %8s", n_keys[k], "loads");
+	printf("\n");
+
+	for (bytes = 16; bytes <= max_bytes; bytes *= 4) {
+		reps = (bytes < (1 << 20)) ? (1 << 20) / bytes : 1;
+
+		printf("  %10zu", bytes);
+		for (k = 0; k < 3; ++k) {
+			double us;
+
+			axis_aes128_kc_flush(kc);
+			clock_gettime(CLOCK_MONOTONIC, &t0);
+			for (r = 0; r < reps; ++r)
+				axis_aes128_kc_encrypt(kc, out, in, bytes / 16, keys[r % n_keys[k]]);
+			clock_gettime(CLOCK_MONOTONIC, &t1);
+			us = ((t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3) / reps;
+
+			printf("  %19.2f  %8llu", bytes / us, (unsigned long long)kc->key_loads);
+		}
+		printf("\n");
+	}
+	printf("\n");
+
+	free(in);
+	free(out);
+
+	return 0;
+}
+
+/*  axis_aes128_kc_ring_run():  aes_ring engine on the key-context accelerator
+ *
+ *  As axis_aes128_ring_run(), the keys of the jobs are cached in the table.
+ */
+#define AES128_KC_RING_CTR_BLOCKS 256
+
+int axis_aes128_kc_ring_run(void *ctx, aes_ring_job *job){
+	aes128_kc_t *kc = (aes128_kc_t *)ctx;
+	uint8_t ks[AES128_KC_RING_CTR_BLOCKS * 16];
+	const uint8_t *in = job->in;
+	uint8_t *out = job->out;
+	size_t nblocks = job->nblocks;
+	size_t n, b;
+	int i;
+
+	if (job->op == AES_RING_ECB)
+		return axis_aes128_kc_encrypt(kc, out, in, nblocks, job->key);
+
+	while (nblocks > 0) {
+		n = (nblocks < AES128_KC_RING_CTR_BLOCKS) ? nblocks : AES128_KC_RING_CTR_BLOCKS;
+
+		for (b = 0; b < n; ++b) {
+			memcpy(&ks[16 * b], job->ctr, 16);
+			for (i = 15; i >= 0 && ++job->ctr[i] == 0; --i)
+				;
+		}
+		if (axis_aes128_kc_encrypt(kc, ks, ks, n, job->key))
+			return -1;
+		for (b = 0; b < 16 * n; ++b)
+			out[b] = in[b] ^ ks[b];
+
+		in += 16 * n;
+		out += 16 * n;
+		nblocks -= n;
+	}
+
+	return 0;
+}
+
+/*  axis_aes128_kc_ring_engine(): fill an aes_ring engine for kc
+ *
+ * 	return engine, to pass to aes_ring_init()
+ */
+const aes_ring_engine *axis_aes128_kc_ring_engine(aes_ring_engine *engine, aes128_kc_t *kc){
+	engine->name = "axis_aes128_kc";
+	engine->ctx = kc;
+	engine->run = axis_aes128_kc_ring_run;
+
+	return engine;
+}
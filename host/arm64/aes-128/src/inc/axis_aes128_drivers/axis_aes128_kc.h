@@ -0,0 +1,73 @@
+/************************************************************************
+ * Filename:        axis_aes128_kc.h
+ * Description:     AES 128 Key-Context Accelerator Driver Header
+ * Date:            19/10/2026
+ ************************************************************************/
+
+#ifndef AXIS_AES128_KC_H
+#define AXIS_AES128_KC_H
+
+/*
+ * Driver of xilinx/aes128/01_key_cache (aes128_kc): one AXI DMA, commands
+ * on MM2S, encrypted text back on S2MM. Keys are expanded on chip and kept
+ * in AES128_KC_SLOTS key-context slots, the driver tracks which key is in
+ * which slot and uploads a key only when it is not in the table.
+ * The command encoding is the one of aes128_kc.h.
+ */
+
+/************************* Constant Definitions *************************/
+#define OFFS_DMA_KC_DATA 0x00A0000000		// MM2S: commands, S2MM: encrypted text
+
+#define AES128_KC_SRC_ADDR 0x0e000000
+#define AES128_KC_DST_ADDR 0x0f000000
+
+#define AES128_KC_SLOTS 8
+
+#define AES128_KC_OP_KEY        0x1
+#define AES128_KC_OP_ENCRYPT    0x2
+
+#define AES128_KC_HEADER(op, flags, slot, nblocks) \
+	(((uint32_t)(op) << 28) | ((uint32_t)(flags) << 24) | ((uint32_t)(slot) << 20) | ((uint32_t)(nblocks) & 0xfffff))
+
+#include <stdint.h>
+#include <stddef.h>
+#include "axis_aes128.h"
+
+
+/************************* Struct Definitions **************************/
+
+typedef struct aes128_kc{
+	int ddr_memory;								// DDR memory
+
+	uint32_t *dma_virtual_addr;				// DMA MM2S: commands, S2MM: encrypted text
+
+	uint32_t *virtual_src_addr;				// command addr
+	uint32_t *virtual_dst_addr;				// encrypted text addr
+
+	// key-context slots: key, last use (0: empty)
+	uint8_t slot_key[AES128_KC_SLOTS][16];
+	uint64_t slot_used[AES128_KC_SLOTS];
+	uint64_t use_count;
+	uint64_t key_loads;
+} aes128_kc_t;
+
+
+/************************ Function Definitions *************************/
+
+int axis_aes128_kc_init(aes128_kc_t *kc);
+
+int axis_aes128_kc_stop(aes128_kc_t *kc);
+
+void axis_aes128_kc_flush(aes128_kc_t *kc);
+
+size_t axis_aes128_kc_max_blocks(void);
+
+int axis_aes128_kc_encrypt(aes128_kc_t *kc, uint8_t *encrypted_text, const uint8_t *text_data, size_t nblocks, const uint8_t *key_data);
+
+int axis_aes128_kc_bench(aes128_kc_t *kc, size_t max_bytes);
+
+int axis_aes128_kc_ring_run(void *ctx, aes_ring_job *job);
+
+const aes_ring_engine *axis_aes128_kc_ring_engine(aes_ring_engine *engine, aes128_kc_t *kc);
+
+#endif
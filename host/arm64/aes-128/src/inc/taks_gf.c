@@ -0,0 +1,298 @@
+/*
+*   GF(2^8) engines of the TAKS key components, see taks_gf.h.
+*
+*   - Table: gf_log[0] is 510, past every sum of two non-zero logarithms
+*     (at most 508). gf_exp repeats the 255 powers of the generator 0x03
+*     twice and is zero from 510 on, so a zero operand gives zero with no
+*     test. The lookups are data dependent, like the T-table AES engine.
+*   - NEON: the 15-bit carry-less product is split into its low byte and
+*     its high byte h. h x^8 mod POLY is linear in h, so it is the XOR of
+*     two 16-entry lookups, one per nibble of h (TBL, in registers).
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "taks_gf.h"
+
+#ifdef __aarch64__
+#include <arm_neon.h>
+#endif
+
+const char * const taks_gf_impl_names[TAKS_GF_N] = { "bitserial", "table", "neon" };
+
+static const uint16_t gf_log[256] = {
+    0x1fe, 0x000, 0x019, 0x001, 0x032, 0x002, 0x01a, 0x0c6, 0x04b, 0x0c7, 0x01b, 0x068, 0x033, 0x0ee, 0x0df, 0x003,
+    0x064, 0x004, 0x0e0, 0x00e, 0x034, 0x08d, 0x081, 0x0ef, 0x04c, 0x071, 0x008, 0x0c8, 0x0f8, 0x069, 0x01c, 0x0c1,
+    0x07d, 0x0c2, 0x01d, 0x0b5, 0x0f9, 0x0b9, 0x027, 0x06a, 0x04d, 0x0e4, 0x0a6, 0x072, 0x09a, 0x0c9, 0x009, 0x078,
+    0x065, 0x02f, 0x08a, 0x005, 0x021, 0x00f, 0x0e1, 0x024, 0x012, 0x0f0, 0x082, 0x045, 0x035, 0x093, 0x0da, 0x08e,
+    0x096, 0x08f, 0x0db, 0x0bd, 0x036, 0x0d0, 0x0ce, 0x094, 0x013, 0x05c, 0x0d2, 0x0f1, 0x040, 0x046, 0x083, 0x038,
+    0x066, 0x0dd, 0x0fd, 0x030, 0x0bf, 0x006, 0x08b, 0x062, 0x0b3, 0x025, 0x0e2, 0x098, 0x022, 0x088, 0x091, 0x010,
+    0x07e, 0x06e, 0x048, 0x0c3, 0x0a3, 0x0b6, 0x01e, 0x042, 0x03a, 0x06b, 0x028, 0x054, 0x0fa, 0x085, 0x03d, 0x0ba,
+    0x02b, 0x079, 0x00a, 0x015, 0x09b, 0x09f, 0x05e, 0x0ca, 0x04e, 0x0d4, 0x0ac, 0x0e5, 0x0f3, 0x073, 0x0a7, 0x057,
+    0x0af, 0x058, 0x0a8, 0x050, 0x0f4, 0x0ea, 0x0d6, 0x074, 0x04f, 0x0ae, 0x0e9, 0x0d5, 0x0e7, 0x0e6, 0x0ad, 0x0e8,
+    0x02c, 0x0d7, 0x075, 0x07a, 0x0eb, 0x016, 0x00b, 0x0f5, 0x059, 0x0cb, 0x05f, 0x0b0, 0x09c, 0x0a9, 0x051, 0x0a0,
+    0x07f, 0x00c, 0x0f6, 0x06f, 0x017, 0x0c4, 0x049, 0x0ec, 0x0d8, 0x043, 0x01f, 0x02d, 0x0a4, 0x076, 0x07b, 0x0b7,
+    0x0cc, 0x0bb, 0x03e, 0x05a, 0x0fb, 0x060, 0x0b1, 0x086, 0x03b, 0x052, 0x0a1, 0x06c, 0x0aa, 0x055, 0x029, 0x09d,
+    0x097, 0x0b2, 0x087, 0x090, 0x061, 0x0be, 0x0dc, 0x0fc, 0x0bc, 0x095, 0x0cf, 0x0cd, 0x037, 0x03f, 0x05b, 0x0d1,
+    0x053, 0x039, 0x084, 0x03c, 0x041, 0x0a2, 0x06d, 0x047, 0x014, 0x02a, 0x09e, 0x05d, 0x056, 0x0f2, 0x0d3, 0x0ab,
+    0x044, 0x011, 0x092, 0x0d9, 0x023, 0x020, 0x02e, 0x089, 0x0b4, 0x07c, 0x0b8, 0x026, 0x077, 0x099, 0x0e3, 0x0a5,
+    0x067, 0x04a, 0x0ed, 0x0de, 0x0c5, 0x031, 0x0fe, 0x018, 0x00d, 0x063, 0x08c, 0x080, 0x0c0, 0x0f7, 0x070, 0x007
+};
+
+static const uint8_t gf_exp[1024] = {
+    0x01, 0x03, 0x05, 0x0f, 0x11, 0x33, 0x55, 0xff, 0x1a, 0x2e, 0x72, 0x96, 0xa1, 0xf8, 0x13, 0x35,
+    0x5f, 0xe1, 0x38, 0x48, 0xd8, 0x73, 0x95, 0xa4, 0xf7, 0x02, 0x06, 0x0a, 0x1e, 0x22, 0x66, 0xaa,
+    0xe5, 0x34, 0x5c, 0xe4, 0x37, 0x59, 0xeb, 0x26, 0x6a, 0xbe, 0xd9, 0x70, 0x90, 0xab, 0xe6, 0x31,
+    0x53, 0xf5, 0x04, 0x0c, 0x14, 0x3c, 0x44, 0xcc, 0x4f, 0xd1, 0x68, 0xb8, 0xd3, 0x6e, 0xb2, 0xcd,
+    0x4c, 0xd4, 0x67, 0xa9, 0xe0, 0x3b, 0x4d, 0xd7, 0x62, 0xa6, 0xf1, 0x08, 0x18, 0x28, 0x78, 0x88,
+    0x83, 0x9e, 0xb9, 0xd0, 0x6b, 0xbd, 0xdc, 0x7f, 0x81, 0x98, 0xb3, 0xce, 0x49, 0xdb, 0x76, 0x9a,
+    0xb5, 0xc4, 0x57, 0xf9, 0x10, 0x30, 0x50, 0xf0, 0x0b, 0x1d, 0x27, 0x69, 0xbb, 0xd6, 0x61, 0xa3,
+    0xfe, 0x19, 0x2b, 0x7d, 0x87, 0x92, 0xad, 0xec, 0x2f, 0x71, 0x93, 0xae, 0xe9, 0x20, 0x60, 0xa0,
+    0xfb, 0x16, 0x3a, 0x4e, 0xd2, 0x6d, 0xb7, 0xc2, 0x5d, 0xe7, 0x32, 0x56, 0xfa, 0x15, 0x3f, 0x41,
+    0xc3, 0x5e, 0xe2, 0x3d, 0x47, 0xc9, 0x40, 0xc0, 0x5b, 0xed, 0x2c, 0x74, 0x9c, 0xbf, 0xda, 0x75,
+    0x9f, 0xba, 0xd5, 0x64, 0xac, 0xef, 0x2a, 0x7e, 0x82, 0x9d, 0xbc, 0xdf, 0x7a, 0x8e, 0x89, 0x80,
+    0x9b, 0xb6, 0xc1, 0x58, 0xe8, 0x23, 0x65, 0xaf, 0xea, 0x25, 0x6f, 0xb1, 0xc8, 0x43, 0xc5, 0x54,
+    0xfc, 0x1f, 0x21, 0x63, 0xa5, 0xf4, 0x07, 0x09, 0x1b, 0x2d, 0x77, 0x99, 0xb0, 0xcb, 0x46, 0xca,
+    0x45, 0xcf, 0x4a, 0xde, 0x79, 0x8b, 0x86, 0x91, 0xa8, 0xe3, 0x3e, 0x42, 0xc6, 0x51, 0xf3, 0x0e,
+    0x12, 0x36, 0x5a, 0xee, 0x29, 0x7b, 0x8d, 0x8c, 0x8f, 0x8a, 0x85, 0x94, 0xa7, 0xf2, 0x0d, 0x17,
+    0x39, 0x4b, 0xdd, 0x7c, 0x84, 0x97, 0xa2, 0xfd, 0x1c, 0x24, 0x6c, 0xb4, 0xc7, 0x52, 0xf6, 0x01,
+    0x03, 0x05, 0x0f, 0x11, 0x33, 0x55, 0xff, 0x1a, 0x2e, 0x72, 0x96, 0xa1, 0xf8, 0x13, 0x35, 0x5f,
+    0xe1, 0x38, 0x48, 0xd8, 0x73, 0x95, 0xa4, 0xf7, 0x02, 0x06, 0x0a, 0x1e, 0x22, 0x66, 0xaa, 0xe5,
+    0x34, 0x5c, 0xe4, 0x37, 0x59, 0xeb, 0x26, 0x6a, 0xbe, 0xd9, 0x70, 0x90, 0xab, 0xe6, 0x31, 0x53,
+    0xf5, 0x04, 0x0c, 0x14, 0x3c, 0x44, 0xcc, 0x4f, 0xd1, 0x68, 0xb8, 0xd3, 0x6e, 0xb2, 0xcd, 0x4c,
+    0xd4, 0x67, 0xa9, 0xe0, 0x3b, 0x4d, 0xd7, 0x62, 0xa6, 0xf1, 0x08, 0x18, 0x28, 0x78, 0x88, 0x83,
+    0x9e, 0xb9, 0xd0, 0x6b, 0xbd, 0xdc, 0x7f, 0x81, 0x98, 0xb3, 0xce, 0x49, 0xdb, 0x76, 0x9a, 0xb5,
+    0xc4, 0x57, 0xf9, 0x10, 0x30, 0x50, 0xf0, 0x0b, 0x1d, 0x27, 0x69, 0xbb, 0xd6, 0x61, 0xa3, 0xfe,
+    0x19, 0x2b, 0x7d, 0x87, 0x92, 0xad, 0xec, 0x2f, 0x71, 0x93, 0xae, 0xe9, 0x20, 0x60, 0xa0, 0xfb,
+    0x16, 0x3a, 0x4e, 0xd2, 0x6d, 0xb7, 0xc2, 0x5d, 0xe7, 0x32, 0x56, 0xfa, 0x15, 0x3f, 0x41, 0xc3,
+    0x5e, 0xe2, 0x3d, 0x47, 0xc9, 0x40, 0xc0, 0x5b, 0xed, 0x2c, 0x74, 0x9c, 0xbf, 0xda, 0x75, 0x9f,
+    0xba, 0xd5, 0x64, 0xac, 0xef, 0x2a, 0x7e, 0x82, 0x9d, 0xbc, 0xdf, 0x7a, 0x8e, 0x89, 0x80, 0x9b,
+    0xb6, 0xc1, 0x58, 0xe8, 0x23, 0x65, 0xaf, 0xea, 0x25, 0x6f, 0xb1, 0xc8, 0x43, 0xc5, 0x54, 0xfc,
+    0x1f, 0x21, 0x63, 0xa5, 0xf4, 0x07, 0x09, 0x1b, 0x2d, 0x77, 0x99, 0xb0, 0xcb, 0x46, 0xca, 0x45,
+    0xcf, 0x4a, 0xde, 0x79, 0x8b, 0x86, 0x91, 0xa8, 0xe3, 0x3e, 0x42, 0xc6, 0x51, 0xf3, 0x0e, 0x12,
+    0x36, 0x5a, 0xee, 0x29, 0x7b, 0x8d, 0x8c, 0x8f, 0x8a, 0x85, 0x94, 0xa7, 0xf2, 0x0d, 0x17, 0x39,
+    0x4b, 0xdd, 0x7c, 0x84, 0x97, 0xa2, 0xfd, 0x1c, 0x24, 0x6c, 0xb4, 0xc7, 0x52, 0xf6
+};
+
+static int taks_gf_current = -1;
+
+/* -------------------------------------------------------------------------- */
+int taks_gf_parse(const char *name)
+{
+    int i;
+
+    if (name == NULL) return -1;
+    for (i = 0; i < TAKS_GF_N; i++)
+        if (strcmp(name, taks_gf_impl_names[i]) == 0) return i;
+
+    return -1;
+} /* taks_gf_parse */
+
+/* -------------------------------------------------------------------------- */
+int taks_gf_available(int impl)
+{
+    if (impl < 0 || impl >= TAKS_GF_N) return 0;
+    if (impl != TAKS_GF_NEON) return 1;
+
+#ifdef __aarch64__
+    return 1;
+#else
+    return 0;
+#endif
+} /* taks_gf_available */
+
+/* -------------------------------------------------------------------------- */
+int taks_gf_get(void)
+{
+    if (taks_gf_current < 0) {
+        int impl = taks_gf_parse(getenv("TAKS_GF_IMPL"));
+        if (impl < 0) impl = TAKS_GF_IMPL;
+        taks_gf_current = taks_gf_available(impl) ? impl : TAKS_GF_TABLE;
+    }
+
+    return taks_gf_current;
+} /* taks_gf_get */
+
+/* -------------------------------------------------------------------------- */
+int taks_gf_select(int impl)
+{
+    if (!taks_gf_available(impl)) return -1;
+    taks_gf_current = impl;
+
+    return 0;
+} /* taks_gf_select */
+
+/* -------------------------------------------------------------------------- */
+/*  Shift-and-xor, as galois_mult() of Taks.h before the table engines. */
+static inline uint8_t gf_bitserial_mul(uint8_t a, uint8_t b)
+{
+    uint8_t p = 0;
+
+    while (a && b) {
+        if (b & 1)
+            p ^= a;
+        if (a & 0x80)
+            a = (a << 1) ^ 0x1b;
+        else
+            a <<= 1;
+        b >>= 1;
+    }
+
+    return p;
+}
+
+static inline uint8_t gf_table_mul(uint8_t a, uint8_t b)
+{
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+uint8_t taks_gf_mul(uint8_t a, uint8_t b)
+{
+    return gf_table_mul(a, b);
+} /* taks_gf_mul */
+
+#ifdef __aarch64__
+/* -------------------------------------------------------------------------- */
+static const uint8_t gf_red_lo[16] = {    // i x^8 mod POLY
+    0x00, 0x1b, 0x36, 0x2d, 0x6c, 0x77, 0x5a, 0x41, 0xd8, 0xc3, 0xee, 0xf5, 0xb4, 0xaf, 0x82, 0x99
+};
+
+static const uint8_t gf_red_hi[16] = {    // i x^12 mod POLY
+    0x00, 0xab, 0x4d, 0xe6, 0x9a, 0x31, 0xd7, 0x7c, 0x2f, 0x84, 0x62, 0xc9, 0xb5, 0x1e, 0xf8, 0x53
+};
+
+/*  16 carry-less products, low bytes in *lo and high bytes (7 bits) in *hi. */
+static inline void gf_neon_clmul(uint8x16_t a, uint8x16_t b, uint8x16_t *lo, uint8x16_t *hi)
+{
+    const poly8x16_t pa = vreinterpretq_p8_u8(a);
+    const poly8x16_t pb = vreinterpretq_p8_u8(b);
+    const uint8x16_t p0 = vreinterpretq_u8_p16(vmull_p8(vget_low_p8(pa), vget_low_p8(pb)));
+    const uint8x16_t p1 = vreinterpretq_u8_p16(vmull_high_p8(pa, pb));
+
+    *lo = vuzp1q_u8(p0, p1);
+    *hi = vuzp2q_u8(p0, p1);
+}
+
+static inline uint8x16_t gf_neon_reduce(uint8x16_t lo, uint8x16_t hi, uint8x16_t rlo, uint8x16_t rhi)
+{
+    const uint8x16_t r = veorq_u8(vqtbl1q_u8(rlo, vandq_u8(hi, vdupq_n_u8(0x0f))), vqtbl1q_u8(rhi, vshrq_n_u8(hi, 4)));
+
+    return veorq_u8(lo, r);
+}
+
+static size_t gf_neon_mul_n(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t n)
+{
+    const uint8x16_t rlo = vld1q_u8(gf_red_lo);
+    const uint8x16_t rhi = vld1q_u8(gf_red_hi);
+    uint8x16_t lo, hi;
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        gf_neon_clmul(vld1q_u8(a + i), vld1q_u8(b + i), &lo, &hi);
+        vst1q_u8(out + i, gf_neon_reduce(lo, hi, rlo, rhi));
+    }
+
+    return i;
+}
+
+/*  Both products are added before the reduction, which is linear: one
+ *  reduction per 16 bytes instead of two. */
+static size_t gf_neon_dot2(uint8_t *out, const uint8_t *ax, const uint8_t *bx, const uint8_t *ay, const uint8_t *by, size_t n)
+{
+    const uint8x16_t rlo = vld1q_u8(gf_red_lo);
+    const uint8x16_t rhi = vld1q_u8(gf_red_hi);
+    uint8x16_t lo, hi, lo_y, hi_y;
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        gf_neon_clmul(vld1q_u8(ax + i), vld1q_u8(bx + i), &lo, &hi);
+        gf_neon_clmul(vld1q_u8(ay + i), vld1q_u8(by + i), &lo_y, &hi_y);
+        vst1q_u8(out + i, gf_neon_reduce(veorq_u8(lo, lo_y), veorq_u8(hi, hi_y), rlo, rhi));
+    }
+
+    return i;
+}
+#endif /* __aarch64__ */
+
+/* -------------------------------------------------------------------------- */
+void taks_gf_mul_n(int impl, uint8_t *out, const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+
+    if (impl == TAKS_GF_BITSERIAL) {
+        for (; i < n; i++)
+            out[i] = gf_bitserial_mul(a[i], b[i]);
+        return;
+    }
+#ifdef __aarch64__
+    if (impl == TAKS_GF_NEON)
+        i = gf_neon_mul_n(out, a, b, n);
+#endif
+    for (; i < n; i++)
+        out[i] = gf_table_mul(a[i], b[i]);
+} /* taks_gf_mul_n */
+
+/* -------------------------------------------------------------------------- */
+void taks_gf_dot2(int impl, uint8_t *out, const uint8_t *ax, const uint8_t *bx, const uint8_t *ay, const uint8_t *by, size_t n)
+{
+    size_t i = 0;
+
+    if (impl == TAKS_GF_BITSERIAL) {
+        for (; i < n; i++)
+            out[i] = gf_bitserial_mul(ax[i], bx[i]) ^ gf_bitserial_mul(ay[i], by[i]);
+        return;
+    }
+#ifdef __aarch64__
+    if (impl == TAKS_GF_NEON)
+        i = gf_neon_dot2(out, ax, bx, ay, by, n);
+#endif
+    for (; i < n; i++)
+        out[i] = gf_table_mul(ax[i], bx[i]) ^ gf_table_mul(ay[i], by[i]);
+} /* taks_gf_dot2 */
+
+/* -------------------------------------------------------------------------- */
+int taks_gf_selftest(void)
+{
+    const size_t n = 65536;
+    uint8_t *a = (uint8_t *)malloc(5 * n);
+    uint8_t *b = a + n, *c = b + n, *ref = c + n, *out = ref + n;
+    size_t i;
+    int impl, err = 0;
+
+    if (a == NULL) return -1;
+
+    /* Every (a, b) pair once, c runs through the pairs in another order */
+    for (i = 0; i < n; i++) {
+        a[i] = (uint8_t)(i >> 8);
+        b[i] = (uint8_t)i;
+        c[i] = (uint8_t)(i * 167 + (i >> 8));
+    }
+
+    for (impl = 0; impl < TAKS_GF_N; impl++) {
+        if (impl == TAKS_GF_BITSERIAL || !taks_gf_available(impl)) continue;
+
+        taks_gf_mul_n(TAKS_GF_BITSERIAL, ref, a, b, n);
+        taks_gf_mul_n(impl, out, a, b, n);
+        for (i = 0; i < n; i++) err += (out[i] != ref[i]);
+
+        /* Odd length and offset: the scalar tail of the vector engines */
+        taks_gf_mul_n(impl, out, a + 1, b + 1, n - 1);
+        for (i = 0; i < n - 1; i++) err += (out[i] != ref[i + 1]);
+
+        taks_gf_dot2(TAKS_GF_BITSERIAL, ref, a, b, c, a, n);
+        taks_gf_dot2(impl, out, a, b, c, a, n);
+        for (i = 0; i < n; i++) err += (out[i] != ref[i]);
+
+        /* In place, as elementwise_mult(x, x, y) */
+        memcpy(out, a, n);
+        taks_gf_mul_n(impl, out, out, b, n);
+        taks_gf_mul_n(TAKS_GF_BITSERIAL, ref, a, b, n);
+        for (i = 0; i < n; i++) err += (out[i] != ref[i]);
+    }
+
+    for (i = 0; i < n; i++) err += (taks_gf_mul(a[i], b[i]) != ref[i]);
+
+    free(a);
+
+    return err;
+} /* taks_gf_selftest */
@@ -0,0 +1,71 @@
+/*
+*   GF(2^8) arithmetic of the TAKS key components, modulo the AES polynomial
+*   x^8 + x^4 + x^3 + x + 1 (POLY in Taks.h).
+*
+*   Engines, all bit-exact with the shift-and-xor galois_mult() of Taks.h:
+*   - bitserial: that loop, the reference, time depends on the operands
+*   - table:     log / antilog tables (1.5 KB), one add and two lookups per
+*                byte, zero operands handled by the tables, no branches
+*   - neon:      16 bytes per step, VMULL.P8 carry-less product, the high
+*                byte folded back with two TBL nibble lookups, no data-dependent
+*                memory access (AArch64 only)
+*
+*   Engine selection:
+*   - build time: -DTAKS_GF_IMPL=TAKS_GF_BITSERIAL|TAKS_GF_TABLE|TAKS_GF_NEON
+*   - run time:   TAKS_GF_IMPL=bitserial|table|neon in the environment, or
+*                 taks_gf_select()
+*   TAKS_GF_NEON falls back to TAKS_GF_TABLE where NEON is not built in.
+*/
+
+#ifndef TAKS_GF_H
+#define TAKS_GF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    enum taks_gf_impl {
+        TAKS_GF_BITSERIAL = 0,
+        TAKS_GF_TABLE,
+        TAKS_GF_NEON,
+        TAKS_GF_N
+    };
+
+#ifndef TAKS_GF_IMPL
+#define TAKS_GF_IMPL TAKS_GF_NEON
+#endif
+
+    extern const char * const taks_gf_impl_names[TAKS_GF_N];
+
+    /* Engine name to enum taks_gf_impl, -1 if unknown. */
+    int taks_gf_parse(const char * /* name */);
+
+    /* 1 if impl runs on this CPU. */
+    int taks_gf_available(int /* impl */);
+
+    /* Current engine - TAKS_GF_IMPL, unless overridden by the environment or taks_gf_select(). */
+    int taks_gf_get(void);
+    int taks_gf_select(int /* impl */);
+
+    /* a * b, table engine. */
+    uint8_t taks_gf_mul(uint8_t /* a */, uint8_t /* b */);
+
+    /* out[i] = a[i] * b[i] over n bytes, in place allowed. */
+    void taks_gf_mul_n(int /* impl */, uint8_t * /* out */, const uint8_t * /* a */, const uint8_t * /* b */, size_t /* n */);
+
+    /* out[i] = ax[i] * bx[i] + ay[i] * by[i] over n bytes, in place allowed. */
+    void taks_gf_dot2(int /* impl */, uint8_t * /* out */, const uint8_t * /* ax */, const uint8_t * /* bx */,
+        const uint8_t * /* ay */, const uint8_t * /* by */, size_t /* n */);
+
+    /* Every available engine against bitserial, all 65536 products through
+     * taks_gf_mul_n() and taks_gf_dot2(). Number of mismatches. */
+    int taks_gf_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
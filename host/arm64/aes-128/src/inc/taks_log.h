@@ -0,0 +1,30 @@
+/*
+*   Compile-time logging of the TAKS primitives and of the AES entry points
+*   of aes.h, e.g. -DTAKS_LOG_LEVEL=TAKS_LOG_DEBUG. A message above the
+*   level is removed by the compiler, arguments included.
+*
+*   The default, TAKS_LOG_ERROR, only reports failures: TAKS_LOG_DEBUG
+*   brings back the step-by-step trace of encrypt_pw()/decrypt_pw(). The
+*   batch API of Taks.h never logs.
+*/
+
+#ifndef TAKS_LOG_H
+#define TAKS_LOG_H
+
+#include <stdio.h>
+
+#define TAKS_LOG_NONE   0
+#define TAKS_LOG_ERROR  1   // failed MAC checks
+#define TAKS_LOG_INFO   2   // one line per message
+#define TAKS_LOG_DEBUG  3   // inputs, intermediate values, timing
+
+#ifndef TAKS_LOG_LEVEL
+#define TAKS_LOG_LEVEL TAKS_LOG_ERROR
+#endif
+
+#define TAKS_LOG_ON(level) (TAKS_LOG_LEVEL >= (level))
+
+#define TAKS_LOG(level, ...) \
+    do { if (TAKS_LOG_ON(level)) printf(__VA_ARGS__); } while (0)
+
+#endif
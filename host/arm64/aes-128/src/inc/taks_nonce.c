@@ -0,0 +1,292 @@
+/*
+*   CTR_DRBG nonce pools for the TAKS primitives, see taks_nonce.h.
+*
+*   The DRBG state is the AES key and ctr = V + 1: the output blocks and the
+*   two blocks of CTR_DRBG_Update are then a plain aes_fast_ctr() run from
+*   ctr, which leaves ctr on the next counter block.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "taks_nonce.h"
+
+typedef struct {
+    taks_drbg drbg;
+    uint8_t buf[16 * TAKS_NONCE_POOL_BLOCKS];
+    size_t pos;             // next unread byte of buf
+    uint64_t refills;
+    uint32_t reseed_in;     // refills to the next OS reseed, 0: fixed seed, never
+    int seeded;
+} taks_nonce_pool;
+
+static __thread taks_nonce_pool nonce_pool;
+static pthread_once_t nonce_once = PTHREAD_ONCE_INIT;
+
+/* -------------------------------------------------------------------------- */
+static void drbg_increment(uint8_t *ctr)
+{
+    int i;
+
+    for (i = 15; i >= 0 && ++ctr[i] == 0; i--)
+        ;
+}
+
+/*  CTR_DRBG_Update: K || V = E(K, V + 1) || E(K, V + 2) xor provided. */
+static void drbg_update(taks_drbg *d, const uint8_t *provided)
+{
+    uint8_t temp[TAKS_DRBG_SEED_LEN];
+    int i;
+
+    memset(temp, 0, sizeof(temp));
+    aes_fast_ctr(&d->k, temp, temp, 2, d->ctr);
+    if (provided)
+        for (i = 0; i < TAKS_DRBG_SEED_LEN; i++)
+            temp[i] ^= provided[i];
+
+    aes_fast_init(&d->k, temp, d->k.impl, AES_RCON_FIPS);
+    memcpy(d->ctr, temp + 16, 16);
+    drbg_increment(d->ctr);
+
+    memset(temp, 0, sizeof(temp));
+}
+
+/* -------------------------------------------------------------------------- */
+void taks_drbg_init(taks_drbg *d, const uint8_t *entropy, const uint8_t *personalization, int impl)
+{
+    uint8_t seed[TAKS_DRBG_SEED_LEN];
+    int i;
+
+    memset(d, 0, sizeof(*d));
+    aes_fast_init(&d->k, d->ctr, impl == AES_IMPL_REF ? AES_IMPL_TTABLE : impl, AES_RCON_FIPS);
+    d->ctr[15] = 1;
+
+    for (i = 0; i < TAKS_DRBG_SEED_LEN; i++)
+        seed[i] = entropy[i] ^ (personalization ? personalization[i] : 0);
+    drbg_update(d, seed);
+    d->requests = 1;
+
+    memset(seed, 0, sizeof(seed));
+} /* taks_drbg_init */
+
+/* -------------------------------------------------------------------------- */
+void taks_drbg_reseed(taks_drbg *d, const uint8_t *entropy)
+{
+    drbg_update(d, entropy);
+    d->requests = 1;
+} /* taks_drbg_reseed */
+
+/* -------------------------------------------------------------------------- */
+void taks_drbg_generate(taks_drbg *d, uint8_t *out, size_t len)
+{
+    uint8_t tail[16];
+    size_t nblocks = len / 16;
+
+    memset(out, 0, 16 * nblocks);
+    aes_fast_ctr(&d->k, out, out, nblocks, d->ctr);
+    if (len % 16) {
+        memset(tail, 0, sizeof(tail));
+        aes_fast_ctr(&d->k, tail, tail, 1, d->ctr);
+        memcpy(out + 16 * nblocks, tail, len % 16);
+        memset(tail, 0, sizeof(tail));
+    }
+
+    drbg_update(d, NULL);
+    d->requests++;
+} /* taks_drbg_generate */
+
+/* -------------------------------------------------------------------------- */
+void taks_drbg_destroy(taks_drbg *d)
+{
+    memset(d, 0, sizeof(*d));
+} /* taks_drbg_destroy */
+
+/* -------------------------------------------------------------------------- */
+static int nonce_entropy(uint8_t *out, size_t len)
+{
+    int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    ssize_t r;
+
+    if (fd < 0)
+        return -errno;
+    while (len > 0) {
+        r = read(fd, out, len);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0) {
+            r = r < 0 ? -errno : -EIO;
+            close(fd);
+            return (int)r;
+        }
+        out += r;
+        len -= r;
+    }
+    close(fd);
+
+    return 0;
+}
+
+/*  The child starts with a copy of the forking thread's pool: drop it, the
+ *  next nonce reseeds from the OS. The other threads do not exist there. */
+static void nonce_atfork_child(void)
+{
+    nonce_pool.seeded = 0;
+    nonce_pool.pos = sizeof(nonce_pool.buf);
+}
+
+static void nonce_atfork_register(void)
+{
+    pthread_atfork(NULL, NULL, nonce_atfork_child);
+}
+
+/* -------------------------------------------------------------------------- */
+int taks_nonce_seed(const uint8_t *seed)
+{
+    taks_nonce_pool *p = &nonce_pool;
+    uint8_t entropy[TAKS_DRBG_SEED_LEN], pers[TAKS_DRBG_SEED_LEN];
+    struct timespec ts;
+    pthread_t self = pthread_self();
+    pid_t pid = getpid();
+    int err;
+
+    pthread_once(&nonce_once, nonce_atfork_register);
+
+    if (seed) {
+        taks_drbg_init(&p->drbg, seed, NULL, aes_impl_get());
+        p->reseed_in = 0;
+    } else {
+        if ((err = nonce_entropy(entropy, sizeof(entropy))))
+            return err;
+
+        // Personalization: the process, the thread and the time
+        clock_gettime(CLOCK_REALTIME, &ts);
+        memset(pers, 0, sizeof(pers));
+        memcpy(pers, &pid, sizeof(pid));
+        memcpy(pers + 8, &ts, sizeof(ts) < 16 ? sizeof(ts) : 16);
+        memcpy(pers + 24, &self, sizeof(self) < 8 ? sizeof(self) : 8);
+
+        taks_drbg_init(&p->drbg, entropy, pers, aes_impl_get());
+        p->reseed_in = TAKS_NONCE_RESEED;
+        memset(entropy, 0, sizeof(entropy));
+    }
+
+    memset(p->buf, 0, sizeof(p->buf));
+    p->pos = sizeof(p->buf);
+    p->seeded = 1;
+
+    return 0;
+} /* taks_nonce_seed */
+
+/* -------------------------------------------------------------------------- */
+static int nonce_refill(taks_nonce_pool *p)
+{
+    uint8_t entropy[TAKS_DRBG_SEED_LEN];
+    int err;
+
+    if (!p->seeded) {
+        if ((err = taks_nonce_seed(NULL)))
+            return err;
+    } else if (p->reseed_in && --p->reseed_in == 0) {
+        if ((err = nonce_entropy(entropy, sizeof(entropy))))
+            return err;
+        taks_drbg_reseed(&p->drbg, entropy);
+        p->reseed_in = TAKS_NONCE_RESEED;
+        memset(entropy, 0, sizeof(entropy));
+    }
+
+    taks_drbg_generate(&p->drbg, p->buf, sizeof(p->buf));
+    p->pos = 0;
+    p->refills++;
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+int taks_nonce_bytes(uint8_t *out, size_t n)
+{
+    taks_nonce_pool *p = &nonce_pool;
+    size_t i = 0, k, take;
+    uint8_t *src, b;
+    int err;
+
+    while (i < n) {
+        if (!p->seeded || p->pos == sizeof(p->buf))
+            if ((err = nonce_refill(p)))
+                return err;
+
+        // Zero bytes skipped without a branch, out[i] is rewritten instead
+        take = sizeof(p->buf) - p->pos;
+        if (take > n - i)
+            take = n - i;
+        src = &p->buf[p->pos];
+        for (k = 0; k < take; k++) {
+            b = src[k];
+            out[i] = b;
+            i += (b != 0);
+        }
+
+        // A byte is handed out once: wiped from the pool as it is read
+        memset(src, 0, take);
+        p->pos += take;
+    }
+
+    return 0;
+} /* taks_nonce_bytes */
+
+/* -------------------------------------------------------------------------- */
+uint64_t taks_nonce_refills(void)
+{
+    return nonce_pool.refills;
+} /* taks_nonce_refills */
+
+/* -------------------------------------------------------------------------- */
+/*  OpenSSL 3 EVP_RAND "CTR-DRBG", AES-128-CTR, use_derivation_function 0,
+ *  TEST-RAND parent: entropy 00..1f, personalization 80..9f, two 64 B
+ *  generates (the second kept), reseed with entropy 40..5f, one generate.
+ */
+static const uint8_t drbg_kat_gen2[64] = {
+    0x18, 0xc1, 0x60, 0xd8, 0x97, 0x52, 0x1e, 0x86, 0x59, 0x92, 0x7a, 0x35, 0x53, 0xb4, 0x23, 0x0b,
+    0x72, 0xfe, 0x97, 0xf0, 0x17, 0xb2, 0x3e, 0x69, 0xdc, 0xe3, 0xdb, 0x32, 0x74, 0xed, 0xe4, 0x88,
+    0xff, 0x17, 0xbb, 0x99, 0x28, 0x3e, 0xd3, 0xcd, 0x7b, 0x86, 0xac, 0xb5, 0x1e, 0x53, 0x89, 0x18,
+    0x4f, 0x50, 0x83, 0xd9, 0x65, 0xb6, 0x65, 0xc0, 0x74, 0x95, 0x9b, 0x1c, 0x06, 0x17, 0xbf, 0x40
+};
+
+static const uint8_t drbg_kat_gen3[64] = {
+    0xf3, 0xc5, 0xdf, 0x7e, 0x50, 0x48, 0x7f, 0xcb, 0x8c, 0xab, 0x85, 0xf9, 0xf0, 0x5e, 0x10, 0x49,
+    0x72, 0xcf, 0x4a, 0xf0, 0x70, 0x71, 0xed, 0xf4, 0x26, 0x7a, 0x5f, 0xbe, 0xb1, 0xfd, 0xf6, 0x88,
+    0xe0, 0x5b, 0x42, 0x17, 0x20, 0x41, 0xcf, 0x59, 0x09, 0xca, 0x0c, 0xa1, 0x86, 0xce, 0xb3, 0xa3,
+    0x11, 0x1c, 0x04, 0x77, 0xc4, 0x87, 0x9e, 0x94, 0xf2, 0xed, 0x2c, 0x78, 0xa5, 0x01, 0x75, 0xf9
+};
+
+int taks_nonce_selftest(void)
+{
+    uint8_t entropy[TAKS_DRBG_SEED_LEN], pers[TAKS_DRBG_SEED_LEN], out[64];
+    taks_drbg d;
+    int impl, i, err = 0;
+
+    for (impl = AES_IMPL_TTABLE; impl < AES_IMPL_N; impl++) {
+        if (!aes_impl_available(impl)) continue;
+
+        for (i = 0; i < TAKS_DRBG_SEED_LEN; i++) {
+            entropy[i] = (uint8_t)i;
+            pers[i] = (uint8_t)(0x80 + i);
+        }
+        taks_drbg_init(&d, entropy, pers, impl);
+        taks_drbg_generate(&d, out, sizeof(out));
+        taks_drbg_generate(&d, out, sizeof(out));
+        err += memcmp(out, drbg_kat_gen2, sizeof(out)) != 0;
+
+        for (i = 0; i < TAKS_DRBG_SEED_LEN; i++)
+            entropy[i] = (uint8_t)(0x40 + i);
+        taks_drbg_reseed(&d, entropy);
+        taks_drbg_generate(&d, out, sizeof(out));
+        err += memcmp(out, drbg_kat_gen3, sizeof(out)) != 0;
+    }
+    taks_drbg_destroy(&d);
+
+    return err;
+} /* taks_nonce_selftest */
@@ -0,0 +1,71 @@
+/*
+*   Nonce source of the TAKS primitives: AES-128 CTR_DRBG (NIST SP 800-90A,
+*   no derivation function, no prediction resistance) on the aes_fast
+*   engines, with the FIPS-197 key schedule.
+*
+*   Each thread has its own generator and a pool of TAKS_NONCE_POOL_BLOCKS
+*   output blocks. A nonce is a copy out of the pool. The pool is refilled by
+*   one generate call, i.e. one CTR run over the whole pool on the current
+*   AES engine. A generator is seeded from the OS on first use, is
+*   reseeded every TAKS_NONCE_RESEED refills, and is reseeded in the child
+*   after fork(), so two processes never share an output stream.
+*/
+
+#ifndef TAKS_NONCE_H
+#define TAKS_NONCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "aes_fast.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TAKS_DRBG_SEED_LEN      32      // key + V, entropy input and personalization
+#define TAKS_NONCE_POOL_BLOCKS  256     // 4 KB per refill
+#define TAKS_NONCE_RESEED       65536   // refills between OS reseeds (256 MB)
+
+    typedef struct {
+        aes_fast_context k;
+        uint8_t ctr[16];        // V + 1, the counter block of the next output
+        uint64_t requests;      // generate calls since the last (re)seed
+    } taks_drbg;
+
+    /* CTR_DRBG_Instantiate: entropy of TAKS_DRBG_SEED_LEN bytes, optional
+     * personalization of TAKS_DRBG_SEED_LEN bytes (NULL: none), the aes_fast
+     * engine impl (AES_IMPL_REF runs on AES_IMPL_TTABLE). */
+    void taks_drbg_init(taks_drbg *, const uint8_t * /* entropy */, const uint8_t * /* personalization */, int /* impl */);
+
+    /* CTR_DRBG_Reseed with TAKS_DRBG_SEED_LEN bytes of entropy, no additional input. */
+    void taks_drbg_reseed(taks_drbg *, const uint8_t * /* entropy */);
+
+    /* CTR_DRBG_Generate, no additional input, len up to 64 KB. */
+    void taks_drbg_generate(taks_drbg *, uint8_t * /* out */, size_t /* len */);
+
+    /* Wipe the state. */
+    void taks_drbg_destroy(taks_drbg *);
+
+    /* n bytes from the pool of the calling thread, none of them zero: a zero
+     * nonce byte would zero that byte of the shared secret. 0 or -errno (no
+     * entropy from the OS). */
+    int taks_nonce_bytes(uint8_t * /* out */, size_t /* n */);
+
+    /* Reseed the generator of the calling thread and drop its pool. seed:
+     * TAKS_DRBG_SEED_LEN bytes, for reproducible runs (no OS reseed after
+     * that), NULL: from the OS. 0 or -errno. */
+    int taks_nonce_seed(const uint8_t * /* seed */);
+
+    /* Refills of the calling thread's pool so far. */
+    uint64_t taks_nonce_refills(void);
+
+    /* Known-answer test of taks_drbg against OpenSSL's CTR-DRBG
+     * (AES-128-CTR, no df): instantiate, two generates, reseed, generate.
+     * Number of mismatches. */
+    int taks_nonce_selftest(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
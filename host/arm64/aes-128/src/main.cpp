@@ -15,17 +15,1133 @@
 #include <math.h>
 #include <time.h>
 #include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
 
 #include <aes_sw.h>
 #include <LCM.h>
+#include <arm-bench.h>
+
+/* Cycle estimate when the PMU is not readable. */
+#ifndef AES_BENCH_CPU_MHZ
+#define AES_BENCH_CPU_MHZ 1200        // Cortex-A53 on the ZCU102
+#endif
+
+#define AES_BENCH_KB 256
+
+#define AES_RING_BENCH_MSGS 4096
+#define AES_RING_BENCH_LATENCY_US 20  // software engine, per job
+
+#define AES_TAKS_BENCH_MSGS 2000
+#define AES_TAKS_BENCH_PEERS 4
+#define AES_TAKS_BULK_MSGS 100000
+#define AES_GF_BENCH_ITERS 200000
+#define AES_NONCE_BENCH_NONCES 1000000
+#define AES_NONCE_BENCH_BBS 20000     // nonces of the Blum-Blum-Shub baseline
+
+enum aes_bench_api {
+  AES_API_BLOCK = 0,                  // AES_Encrypt_Block, key schedule per block (CTR in Taks.h)
+  AES_API_ECB,                        // aes256_encrypt_ecb, one aes256_init
+  AES_API_BULK,                       // aes_fast_encrypt over the buffer
+  AES_API_CTR,                        // aes_fast_ctr over the buffer
+  AES_N_API
+};
+
+static const char * const aes_bench_api_names[AES_N_API] = { "AES_Encrypt_Block", "aes256_encrypt_ecb", "aes_fast_encrypt", "aes_fast_ctr" };
+
+static const uint8_t fips197_key[16] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const uint8_t fips197_pt[16] = {
+  0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const uint8_t fips197_ct[16] = {
+  0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+
+// Nonce generator seed of the runs that must draw the same nonces twice
+static const uint8_t taks_bench_seed[TAKS_DRBG_SEED_LEN] = { 0 };
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+static double elapsed_ms(timer_host *t)
+{
+  t->t_meas = ((t->t1.tv_sec - t->t0.tv_sec) + (t->t1.tv_nsec - t->t0.tv_nsec)/1000000000.0)*1000.0;
+  return t->t_meas;
+}
+
+static void fill_pattern(uint8_t *buf, size_t len)
+{
+  uint32_t x = 0x12345678;
+  for (size_t i = 0; i < len; i++) {
+    x = x * 1664525 + 1013904223;
+    buf[i] = (uint8_t)(x >> 24);
+  }
+}
+
+/*  aes256_check():             aes256.c ECB on the current engine
+ *
+ *  encrypt n_blocks of pt in buf against ref, decrypt back to pt
+ *
+ * 	return 1 on mismatch
+ */
+static int aes256_check(const uint8_t *pt, const uint8_t *ref, uint8_t *buf, size_t n_blocks)
+{
+  aes256_context ctx;
+  int e;
+
+  memcpy(buf, pt, 16 * n_blocks);
+  aes256_init(&ctx, (uint8_t *)fips197_key);
+  for (size_t b = 0; b < n_blocks; b++)
+    aes256_encrypt_ecb(&ctx, &buf[16 * b]);
+  e = memcmp(buf, ref, 16 * n_blocks) != 0;
+  for (size_t b = 0; b < n_blocks; b++)
+    aes256_decrypt_ecb(&ctx, &buf[16 * b]);
+  e |= memcmp(buf, pt, 16 * n_blocks) != 0;
+  aes256_done(&ctx);
+
+  return e;
+}
+
+/*  aes_bench_check():          engines against FIPS-197 and the reference
+ *
+ *  Engines run the FIPS-197 schedule on the Appendix C.1 vector, and the
+ *  fixed-rcon schedule of aes.h / aes256.c through every entry point against
+ *  the byte-oriented reference.
+ *
+ * 	return the number of failed checks
+ */
+static int aes_bench_check(void)
+{
+  const size_t n_blocks = 64;
+  uint8_t pt[16 * 64], ref[16 * 64], ct[16 * 64], dt[16 * 64];
+  uint8_t ctr_ref[16 * 64], ctr[16], ks[16];
+  aes_fast_context fast;
+  int impl_saved = aes_impl_get();
+  int err = 0, e;
+
+  e = aes_fast_selftest();
+  printf("  -     - Bitsliced S-box (256 in):     %s\n", e ? "FAIL" : "ok");
+  err += (e != 0);
+
+  fill_pattern(pt, sizeof(pt));
+
+  aes_impl_select(AES_IMPL_REF);
+  for (size_t b = 0; b < n_blocks; b++)
+    AES_Encrypt_Block(&ref[16 * b], fips197_key, &pt[16 * b]);
+
+  // CTR from 2^64 - 2, to carry into the upper half
+  memset(ctr, 0, 8);
+  memset(ctr + 8, 0xff, 8);
+  ctr[15] = 0xfe;
+  for (size_t b = 0; b < n_blocks; b++) {
+    AES_Encrypt_Block(ks, fips197_key, ctr);
+    for (int i = 0; i < 16; i++)
+      ctr_ref[16 * b + i] = pt[16 * b + i] ^ ks[i];
+    AES_Util_Increment(ctr, 16);
+  }
+
+  e = aes256_check(pt, ref, ct, n_blocks);
+  printf("  -     - %-8s aes256 ECB roundtrip:  %s\n", aes_impl_names[AES_IMPL_REF], e ? "FAIL" : "ok");
+  err += e;
+
+  for (int impl = AES_IMPL_TTABLE; impl < AES_IMPL_N; impl++) {
+    if (!aes_impl_available(impl)) {
+      printf("  -     - %-8s                        not available\n", aes_impl_names[impl]);
+      continue;
+    }
+
+    // FIPS-197 C.1
+    aes_fast_init(&fast, fips197_key, impl, AES_RCON_FIPS);
+    aes_fast_encrypt(&fast, ct, fips197_pt, 1);
+    aes_fast_decrypt(&fast, dt, ct, 1);
+    e = memcmp(ct, fips197_ct, 16) != 0 || memcmp(dt, fips197_pt, 16) != 0;
+    printf("  -     - %-8s FIPS-197 C.1:          %s\n", aes_impl_names[impl], e ? "FAIL" : "ok");
+    err += e;
+
+    // Fixed rcon, all entry points
+    aes_impl_select(impl);
+    e = 0;
+    for (size_t b = 0; b < n_blocks; b++) {
+      AES_Encrypt_Block(&ct[16 * b], fips197_key, &pt[16 * b]);
+      AES_Decrypt_Block(&dt[16 * b], fips197_key, &ct[16 * b]);
+    }
+    e += memcmp(ct, ref, sizeof(ref)) != 0 || memcmp(dt, pt, sizeof(pt)) != 0;
+
+    e += aes256_check(pt, ref, ct, n_blocks);
+
+    aes_fast_init(&fast, fips197_key, impl, AES_RCON_FIXED);
+    for (size_t n = 1; n <= n_blocks; n += 7) {
+      aes_fast_encrypt(&fast, ct, pt, n);
+      aes_fast_decrypt(&fast, dt, ct, n);
+      e += memcmp(ct, ref, 16 * n) != 0 || memcmp(dt, pt, 16 * n) != 0;
+
+      memset(ctr, 0, 8);
+      memset(ctr + 8, 0xff, 8);
+      ctr[15] = 0xfe;
+      aes_fast_ctr(&fast, ct, pt, n, ctr);
+      e += memcmp(ct, ctr_ref, 16 * n) != 0;
+    }
+    printf("  -     - %-8s vs reference:          %s\n", aes_impl_names[impl], e ? "FAIL" : "ok");
+    err += (e != 0);
+  }
+
+  aes_impl_select(impl_saved);
+  return err;
+}
+
+/*  aes_bench():                throughput and cycles per byte per engine
+ *
+ *  size_t bytes:               buffer encrypted per measurement, ECB
+ */
+static int aes_bench(size_t bytes)
+{
+  timer_host t;
+  perf_group pg;
+  aes_fast_context fast;
+  aes256_context ctx;
+  uint8_t ctr[16] = { 0 };
+  const size_t n_blocks = bytes / 16;
+  uint8_t *buf = (uint8_t *)malloc(16 * n_blocks);
+  int impl_saved = aes_impl_get();
+
+  if (buf == NULL || n_blocks == 0) {
+    free(buf);
+    return -ENOMEM;
+  }
+
+  printf("\n  - AES-128 software engines (default: %s)\n", aes_impl_names[impl_saved]);
+  printf("  ------------------------------------------\n\n");
+
+  int err = aes_bench_check();
+  if (err) {
+    printf("\n  - %d check(s) failed\n\n", err);
+    free(buf);
+    return -1;
+  }
+
+  perf_group_open(&pg);
+
+  printf("\n  - %zu B, ECB\n", 16 * n_blocks);
+  if (!perf_group_valid(&pg, PERF_CYCLES))
+    printf("  - cycles estimated at %d MHz (PMU not available)\n", AES_BENCH_CPU_MHZ);
+  printf("\n  %-8s  %-18s  %10s  %12s  %10s\n", "engine", "entry point", "MB/s", "ns/block", "cycles/B");
+
+  for (int impl = AES_IMPL_REF; impl < AES_IMPL_N; impl++) {
+    if (aes_impl_select(impl))
+      continue;
+    for (int api = AES_API_BLOCK; api < AES_N_API; api++) {
+      if (api >= AES_API_BULK && impl == AES_IMPL_REF)
+        continue;
+
+      fill_pattern(buf, 16 * n_blocks);
+      aes256_init(&ctx, (uint8_t *)fips197_key);
+      aes_fast_init(&fast, fips197_key, impl, AES_RCON_FIXED);
+
+perf_group_start(&pg);
+clock_gettime(CLOCK_REALTIME, &t.t0);
+      switch (api) {
+      case AES_API_BLOCK:
+        for (size_t b = 0; b < n_blocks; b++)
+          AES_Encrypt_Block(&buf[16 * b], fips197_key, &buf[16 * b]);
+        break;
+      case AES_API_ECB:
+        // The reference clobbers its key copy after the first block, the
+        // work per block is the same.
+        for (size_t b = 0; b < n_blocks; b++)
+          aes256_encrypt_ecb(&ctx, &buf[16 * b]);
+        break;
+      case AES_API_BULK:
+        aes_fast_encrypt(&fast, buf, buf, n_blocks);
+        break;
+      case AES_API_CTR:
+        aes_fast_ctr(&fast, buf, buf, n_blocks, ctr);
+        break;
+      }
+clock_gettime(CLOCK_REALTIME, &t.t1);
+perf_group_stop(&pg);
+
+      double ms = elapsed_ms(&t);
+      double cycles = perf_group_valid(&pg, PERF_CYCLES)
+        ? (double)pg.val[PERF_CYCLES]
+        : ms * 1000.0 * AES_BENCH_CPU_MHZ;
+
+      printf("  %-8s  %-18s  %10.2f  %12.1f  %10.2f\n",
+        aes_impl_names[impl], aes_bench_api_names[api],
+        (16.0 * n_blocks) / (ms * 1000.0),
+        ms * 1e6 / n_blocks,
+        cycles / (16.0 * n_blocks));
+      aes256_done(&ctx);
+    }
+  }
+  printf("\n");
+
+  perf_group_close(&pg);
+  aes_impl_select(impl_saved);
+  free(buf);
+  return 0;
+}
+
+/*  aes_hwbench():              axis_aes128 bulk transfers against the engines
+ *
+ *  int beat:                   enum aes128_beat, must match the bitstream
+ *  size_t max_bytes:           largest message of the sweep
+ */
+static int aes_hwbench(int beat, size_t max_bytes)
+{
+  aes128_addr_t addr;
+  aes_fast_context fast;
+  uint8_t rc[] = {0x01};
+  const size_t n_blocks = 1000;         // not a multiple of the transaction size
+  uint8_t *pt = (uint8_t *)malloc(16 * n_blocks);
+  uint8_t *ct = (uint8_t *)malloc(16 * n_blocks);
+  uint8_t *ref = (uint8_t *)malloc(16 * n_blocks);
+
+  if (pt == NULL || ct == NULL || ref == NULL) {
+    free(pt); free(ct); free(ref);
+    return -ENOMEM;
+  }
+
+  axis_aes128_load((char *)"axis_aes128_drivers/axis_aes128_design_1_wrapper.bin");
+  if (axis_aes128_init(&addr)) {
+    free(pt); free(ct); free(ref);
+    return -1;
+  }
+
+  printf("\n  - AES-128 accelerator, bulk transfers\n");
+  printf("  -------------------------------------\n\n");
+
+  fill_pattern(pt, 16 * n_blocks);
+  aes_fast_init(&fast, fips197_key, aes_impl_get(), AES_RCON_FIXED);
+  aes_fast_encrypt(&fast, ref, pt, n_blocks);
+
+  axis_aes128_encrypt_bulk(&addr, ct, pt, n_blocks, fips197_key, rc, beat);
+  printf("  -     - %zu blocks vs %-8s      %s\n", n_blocks, aes_impl_names[aes_impl_get()],
+    memcmp(ct, ref, 16 * n_blocks) ? "FAIL" : "ok");
+
+  axis_aes128_bench_bulk(&addr, fips197_key, rc, beat, max_bytes);
+
+  axis_aes128_stop(&addr);
+  free(pt); free(ct); free(ref);
+  return 0;
+}
+
+/*  aes_kcbench():              key-context accelerator against the engines
+ *
+ *  Blocks under 2 * AES128_KC_SLOTS keys in turn, i.e. with key uploads and
+ *  slot switches, checked against the software engine, then the sweep.
+ *
+ *  size_t max_bytes:           largest message of the sweep
+ */
+static int aes_kcbench(size_t max_bytes)
+{
+  aes128_kc_t kc;
+  aes_fast_context fast;
+  const size_t n_blocks = 1000;
+  const int n_keys = 2 * AES128_KC_SLOTS;
+  uint8_t key[16];
+  uint8_t *pt = (uint8_t *)malloc(16 * n_blocks);
+  uint8_t *ct = (uint8_t *)malloc(16 * n_blocks);
+  uint8_t *ref = (uint8_t *)malloc(16 * n_blocks);
+  int failed = 0;
+
+  if (pt == NULL || ct == NULL || ref == NULL) {
+    free(pt); free(ct); free(ref);
+    return -ENOMEM;
+  }
+
+  axis_aes128_load((char *)"axis_aes128_drivers/axis_aes128_kc_design_1_wrapper.bin");
+  if (axis_aes128_kc_init(&kc)) {
+    free(pt); free(ct); free(ref);
+    return -1;
+  }
+
+  printf("\n  - AES-128 key-context accelerator\n");
+  printf("  ---------------------------------\n\n");
+
+  fill_pattern(pt, 16 * n_blocks);
+  for (int r = 0; r < 3 * n_keys; r++) {
+    const size_t n = 1 + (r * 97) % n_blocks;
+
+    memcpy(key, fips197_key, 16);
+    key[15] = (uint8_t)((r * 5) % n_keys);  // slots hit and evicted
+    aes_fast_init(&fast, key, aes_impl_get(), AES_RCON_FIXED);
+    aes_fast_encrypt(&fast, ref, pt, n);
+    axis_aes128_kc_encrypt(&kc, ct, pt, n, key);
+    failed += memcmp(ct, ref, 16 * n) != 0;
+  }
+  printf("  -     - %d messages, %d keys vs %-8s      %s (%llu key loads)\n", 3 * n_keys, n_keys,
+    aes_impl_names[aes_impl_get()], failed ? "FAIL" : "ok", (unsigned long long)kc.key_loads);
+
+  axis_aes128_kc_bench(&kc, max_bytes);
+
+  axis_aes128_kc_stop(&kc);
+  free(pt); free(ct); free(ref);
+  return failed ? -1 : 0;
+}
+
+/*  aes_ring_check():           raw ring jobs against aes_fast
+ *
+ *  ECB and CTR jobs of 1 to 300 blocks from one thread, submitted with
+ *  aes_ring_try_submit() and reaped when the ring is full.
+ *
+ * 	return the number of failed jobs
+ */
+struct ring_check {
+  int done;
+  int failed;
+};
+
+static void ring_check_done(const aes_ring_job *job)
+{
+  struct ring_check *c = (struct ring_check *)job->arg;
+  c->done++;
+  if (job->status)
+    c->failed++;
+}
+
+static int aes_ring_check(aes_ring *ring)
+{
+  const int n_jobs = 40;
+  const size_t max_blocks = 300;
+  struct ring_check c = { 0, 0 };
+  uint8_t *pt = (uint8_t *)malloc(16 * max_blocks);
+  uint8_t *ct = (uint8_t *)malloc(16 * max_blocks * n_jobs);
+  uint8_t *ref = (uint8_t *)malloc(16 * max_blocks);
+  aes_fast_context fast;
+  aes_ring_job job;
+  int failed = 0;
+
+  if (pt == NULL || ct == NULL || ref == NULL) {
+    free(pt); free(ct); free(ref);
+    return -ENOMEM;
+  }
+  fill_pattern(pt, 16 * max_blocks);
+
+  for (int j = 0; j < n_jobs; j++) {
+    memset(&job, 0, sizeof(job));
+    job.op = (j & 1) ? AES_RING_CTR : AES_RING_ECB;
+    job.out = &ct[16 * max_blocks * j];
+    job.in = pt;
+    job.nblocks = 1 + (j * 37) % max_blocks;
+    memcpy(job.key, fips197_key, 16);
+    job.key[0] = (uint8_t)j;
+    memset(job.ctr, 0xff, 16);            // carry through all 16 bytes
+    job.ctr[0] = (uint8_t)j;
+    job.cb = ring_check_done;
+    job.arg = &c;
+    while (aes_ring_try_submit(ring, &job) == -EAGAIN)
+      aes_ring_wait(ring, 1, AES_RING_SLOTS);
+  }
+  aes_ring_drain(ring);
+
+  for (int j = 0; j < n_jobs; j++) {
+    uint8_t key[16], ctr[16];
+    const size_t nblocks = 1 + (j * 37) % max_blocks;
+
+    memcpy(key, fips197_key, 16);
+    key[0] = (uint8_t)j;
+    memset(ctr, 0xff, 16);
+    ctr[0] = (uint8_t)j;
+    aes_fast_init(&fast, key, aes_impl_get() == AES_IMPL_REF ? AES_IMPL_TTABLE : aes_impl_get(), AES_RCON_FIXED);
+    if (j & 1)
+      aes_fast_ctr(&fast, ref, pt, nblocks, ctr);
+    else
+      aes_fast_encrypt(&fast, ref, pt, nblocks);
+    if (memcmp(ref, &ct[16 * max_blocks * j], 16 * nblocks))
+      failed++;
+  }
+
+  printf("  -     - %d jobs, ECB and CTR, %d callbacks  %s\n", n_jobs, c.done,
+    (failed || c.failed || c.done != n_jobs) ? "FAIL" : "ok");
+
+  free(pt); free(ct); free(ref);
+  return failed + c.failed + (c.done != n_jobs);
+}
+
+/*  aes_ring_bench():           encryptMessageAsync() under concurrent producers
+ *
+ *  Producer threads prepare the messages (nonce, KRI, shared secret) and
+ *  submit them, the main thread reaps the ring and counts the completions.
+ *  The blocking baseline waits for every message before preparing the next
+ *  one, as encryptMessage() does. Each message is then decrypted and its MAC
+ *  checked on the CPU.
+ */
+struct ring_bench {
+  int done;
+  int failed;
+  int dropped;    // never submitted, no callback to wait for
+};
+
+struct ring_producer {
+  aes_ring *ring;
+  message_t *msg;
+  lcm_request_t *req;
+  const uint8_t *text;
+  size_t n;
+  struct ring_bench *rb;
+  int err;
+};
+
+static void ring_bench_done(message_t *msg, int status, void *arg)
+{
+  struct ring_bench *rb = (struct ring_bench *)arg;
+  (void)msg;
+  rb->done++;
+  if (status)
+    rb->failed++;
+}
+
+static void *ring_producer_main(void *arg)
+{
+  struct ring_producer *p = (struct ring_producer *)arg;
+
+  for (size_t i = 0; i < p->n && !p->err; i++) {
+    p->err = encryptMessageAsync(p->ring, &p->req[i], &p->msg[i],
+      (const char *)&p->text[TAKS_PAYLOAD_LEN * i], ring_bench_done, p->rb);
+    if (p->err)
+      __atomic_fetch_add(&p->rb->dropped, (int)(p->n - i), __ATOMIC_RELEASE);
+  }
+
+  return NULL;
+}
+
+static int ring_bench_verify(const message_t *msg, const uint8_t *text, size_t n)
+{
+  aes_fast_context fast;
+  uint8_t ss[TAKS_KEY_LEN], mac[TAKS_MAC_LEN], pt[TAKS_PAYLOAD_LEN], ctr[16];
+  int impl = aes_impl_get() == AES_IMPL_REF ? AES_IMPL_TTABLE : aes_impl_get();
+  int failed = 0;
+
+  for (size_t i = 0; i < n; i++) {
+    vector_mult(ss, (uint8_t *)msg[i].kri, LKC_1);
+    authentication_tag(mac, msg[i].payload, TAKS_PAYLOAD_LEN, ss);
+    memset(ctr, 0, 16);
+    aes_fast_init(&fast, ss, impl, AES_RCON_FIXED);
+    aes_fast_ctr(&fast, pt, msg[i].payload, TAKS_PAYLOAD_LEN / 16, ctr);
+    if (memcmp(mac, msg[i].mac, TAKS_MAC_LEN) || memcmp(pt, &text[TAKS_PAYLOAD_LEN * i], TAKS_PAYLOAD_LEN))
+      failed++;
+  }
+  return failed;
+}
+
+static int aes_ring_bench(int max_producers, size_t n_msgs, const aes_ring_engine *engine)
+{
+  timer_host t;
+  aes_ring ring;
+  struct ring_bench rb;
+  message_t *msg = (message_t *)calloc(n_msgs, sizeof(message_t));
+  lcm_request_t *req = (lcm_request_t *)calloc(n_msgs, sizeof(lcm_request_t));
+  uint8_t *text = (uint8_t *)malloc(TAKS_PAYLOAD_LEN * n_msgs);
+  pthread_t tid[64];
+  struct ring_producer prod[64];
+  double ms_blocking = 0.0;
+  int err = 0;
+
+  if (msg == NULL || req == NULL || text == NULL || n_msgs == 0) {
+    free(msg); free(req); free(text);
+    return -ENOMEM;
+  }
+  if (max_producers < 1)
+    max_producers = 1;
+  if (max_producers > 64)
+    max_producers = 64;
+
+  if (aes_ring_init(&ring, engine)) {
+    free(msg); free(req); free(text);
+    return -1;
+  }
+
+  printf("\n  - AES-128 submission ring (%d slots, engine %s)\n", AES_RING_SLOTS, engine->name);
+  printf("  ------------------------------------------------\n\n");
+
+  initNodes();
+  fill_pattern(text, TAKS_PAYLOAD_LEN * n_msgs);
+
+  err = aes_ring_check(&ring);
+  if (err) {
+    printf("\n  - %d check(s) failed\n\n", err);
+    aes_ring_destroy(&ring);
+    free(msg); free(req); free(text);
+    return -1;
+  }
+
+  printf("\n  - %zu messages of %d B\n", n_msgs, TAKS_PAYLOAD_LEN);
+  printf("\n  %-10s  %10s  %10s  %10s  %8s  %s\n", "producers", "msgs/s", "MB/s", "us/msg", "speedup", "check");
+
+  // 0: blocking baseline, one message in flight
+  for (int p = 0; p <= max_producers; p = p ? 2 * p : 1) {
+    const int n_prod = p ? p : 1;
+
+    memset(msg, 0, sizeof(message_t) * n_msgs);
+    rb.done = rb.failed = rb.dropped = 0;
+
+clock_gettime(CLOCK_REALTIME, &t.t0);
+    if (p == 0) {
+      for (size_t i = 0; i < n_msgs; i++) {
+        if (encryptMessageAsync(&ring, &req[i], &msg[i], (const char *)&text[TAKS_PAYLOAD_LEN * i], ring_bench_done, &rb))
+          rb.failed++;
+        aes_ring_drain(&ring);
+      }
+    } else {
+      for (int k = 0; k < n_prod; k++) {
+        const size_t first = n_msgs * k / n_prod;
+        prod[k].ring = &ring;
+        prod[k].msg = &msg[first];
+        prod[k].req = &req[first];
+        prod[k].text = &text[TAKS_PAYLOAD_LEN * first];
+        prod[k].n = n_msgs * (k + 1) / n_prod - first;
+        prod[k].rb = &rb;
+        prod[k].err = 0;
+        pthread_create(&tid[k], NULL, ring_producer_main, &prod[k]);
+      }
+      // A failed submit stops its producer, its remaining messages never complete
+      while (rb.done < (int)n_msgs - __atomic_load_n(&rb.dropped, __ATOMIC_ACQUIRE))
+        if (aes_ring_wait(&ring, 1, AES_RING_SLOTS) == 0)
+          sched_yield();
+      for (int k = 0; k < n_prod; k++) {
+        pthread_join(tid[k], NULL);
+        rb.failed += prod[k].err != 0;
+      }
+    }
+clock_gettime(CLOCK_REALTIME, &t.t1);
+
+    double ms = elapsed_ms(&t);
+    if (p == 0)
+      ms_blocking = ms;
+    int failed = rb.failed + ring_bench_verify(msg, text, n_msgs);
+    err += failed;
+
+    char label[16];
+    if (p == 0)
+      snprintf(label, sizeof(label), "blocking");
+    else
+      snprintf(label, sizeof(label), "%d", p);
+    printf("  %-10s  %10.0f  %10.2f  %10.2f  %8.2f  %s\n", label,
+      n_msgs / (ms / 1000.0),
+      (double)TAKS_PAYLOAD_LEN * n_msgs / (ms * 1000.0),
+      ms * 1000.0 / n_msgs,
+      ms_blocking / ms,
+      failed ? "FAIL" : "ok");
+  }
+  printf("\n");
+
+  aes_ring_destroy(&ring);
+  free(msg); free(req); free(text);
+  return err ? -1 : 0;
+}
+
+/*  aes_taksbench():            TAKS messages/s without and with the key-schedule cache
+ *
+ *  - Round trip: encryptMessage() then decryptMessage(). The shared secret
+ *    changes with the nonce of every message, the cache saves the repeated
+ *    expansions of one secret within encrypt_pw() and decrypt_pw(). Both runs
+ *    draw the same nonces, the messages must match.
+ *  - Peer keys: symmetric_encrypt(), authentication_tag(), then
+ *    authentication_tag() and symmetric_decrypt() under one of n_peers fixed
+ *    keys, i.e. a session key per peer.
+ *  TAKS still logs every step to stdout, which goes to /dev/null while timed.
+ *
+ *  size_t n_msgs:              messages per run
+ *  int n_peers:                peer keys of the second test
+ *  int entries:                cache size
+ */
+static int stdout_mute(void)
+{
+  int saved, fd;
+
+  fflush(stdout);
+  saved = dup(STDOUT_FILENO);
+  fd = open("/dev/null", O_WRONLY);
+  if (fd >= 0) {
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+  }
+  return saved;
+}
+
+static void stdout_restore(int saved)
+{
+  fflush(stdout);
+  if (saved >= 0) {
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+  }
+}
+
+static int aes_taksbench(size_t n_msgs, int n_peers, int entries)
+{
+  timer_host t;
+  message_t *msg[2];
+  uint8_t *text = (uint8_t *)malloc(TAKS_PAYLOAD_LEN * n_msgs);
+  uint8_t *dec = (uint8_t *)malloc(TAKS_PAYLOAD_LEN * n_msgs);
+  uint8_t peer_key[64 * TAKS_KEY_LEN];
+  const char *path[2] = { "encrypt_pw + decrypt_pw", "peer keys" };
+  double ms[2][2];
+  uint64_t misses[2][2];
+  int failed[2] = { 0, 0 };
+
+  msg[0] = (message_t *)calloc(n_msgs, sizeof(message_t));
+  msg[1] = (message_t *)calloc(n_msgs, sizeof(message_t));
+  if (msg[0] == NULL || msg[1] == NULL || text == NULL || dec == NULL || n_msgs == 0) {
+    free(msg[0]); free(msg[1]); free(text); free(dec);
+    return -ENOMEM;
+  }
+  if (n_peers < 1)
+    n_peers = 1;
+  if (n_peers > 64)
+    n_peers = 64;
+
+  initNodes();
+  fill_pattern(peer_key, sizeof(peer_key));
+  fill_pattern(text, TAKS_PAYLOAD_LEN * n_msgs);
+  for (size_t i = 0; i < TAKS_PAYLOAD_LEN * n_msgs; i++)
+    text[i] ^= 0x5a;
+
+  printf("\n  - TAKS key-schedule cache (engine %s)\n", aes_impl_names[aes_impl_get()]);
+  printf("  --------------------------------------\n\n");
+
+  // c = 0: no cache, every call expands its key
+  for (int c = 0; c < 2; c++) {
+    if (taks_cache_init(c ? entries : 0)) {
+      free(msg[0]); free(msg[1]); free(text); free(dec);
+      return -ENOMEM;
+    }
+
+    taks_nonce_seed(taks_bench_seed);
+    int saved = stdout_mute();
+clock_gettime(CLOCK_REALTIME, &t.t0);
+    for (size_t i = 0; i < n_msgs; i++) {
+      encryptMessage(&msg[c][i], (const char *)&text[TAKS_PAYLOAD_LEN * i]);
+      failed[0] += decryptMessage((const char *)&dec[TAKS_PAYLOAD_LEN * i], &msg[c][i]) != 0;
+    }
+clock_gettime(CLOCK_REALTIME, &t.t1);
+    stdout_restore(saved);
+    ms[0][c] = elapsed_ms(&t);
+    misses[0][c] = taks_kcache.misses;
+    failed[0] += memcmp(dec, text, TAKS_PAYLOAD_LEN * n_msgs) != 0;
+
+    taks_cache_init(c ? entries : 0);
+    saved = stdout_mute();
+clock_gettime(CLOCK_REALTIME, &t.t0);
+    for (size_t i = 0; i < n_msgs; i++) {
+      uint8_t *k = &peer_key[TAKS_KEY_LEN * (i % n_peers)];
+      uint8_t *pt = &text[TAKS_PAYLOAD_LEN * i];
+      uint8_t ct[TAKS_PAYLOAD_LEN], mac[TAKS_MAC_LEN], mac_rx[TAKS_MAC_LEN];
+
+      symmetric_encrypt(ct, pt, TAKS_PAYLOAD_LEN, k);
+      authentication_tag(mac, ct, TAKS_PAYLOAD_LEN, k);
+      authentication_tag(mac_rx, ct, TAKS_PAYLOAD_LEN, k);
+      symmetric_decrypt(&dec[TAKS_PAYLOAD_LEN * i], ct, TAKS_PAYLOAD_LEN, k);
+      failed[1] += memcmp(mac, mac_rx, TAKS_MAC_LEN) != 0;
+    }
+clock_gettime(CLOCK_REALTIME, &t.t1);
+    stdout_restore(saved);
+    ms[1][c] = elapsed_ms(&t);
+    misses[1][c] = taks_kcache.misses;
+    failed[1] += memcmp(dec, text, TAKS_PAYLOAD_LEN * n_msgs) != 0;
+  }
+  failed[0] += memcmp(msg[0], msg[1], sizeof(message_t) * n_msgs) != 0;
+
+  printf("  - %zu messages of %d B, %d peer keys, %d cache entries\n", n_msgs, TAKS_PAYLOAD_LEN, n_peers, entries);
+  printf("\n  %-24s  %-6s  %10s  %10s  %11s  %8s  %s\n", "path", "cache", "msgs/s", "us/msg", "expansions", "speedup", "check");
+  for (int p = 0; p < 2; p++)
+    for (int c = 0; c < 2; c++) {
+      char exp[24];
+      if (c)
+        snprintf(exp, sizeof(exp), "%llu", (unsigned long long)misses[p][c]);
+      else
+        snprintf(exp, sizeof(exp), "every call");
+      printf("  %-24s  %-6s  %10.0f  %10.2f  %11s  %8.2f  %s\n", c ? "" : path[p], c ? "on" : "off",
+        n_msgs / (ms[p][c] / 1000.0),
+        ms[p][c] * 1000.0 / n_msgs,
+        exp,
+        ms[p][0] / ms[p][c],
+        failed[p] ? "FAIL" : "ok");
+    }
+  printf("\n");
+
+  taks_cache_init(TAKS_KCACHE_ENTRIES);
+  free(msg[0]); free(msg[1]); free(text); free(dec);
+  return failed[0] || failed[1] ? -1 : 0;
+}
+
+/*  aes_taksbulk():             throughput of the TAKS batch API
+ *
+ *  encrypt_pw() then decrypt_pw() one message at a time (stdout to
+ *  /dev/null) as the baseline, then encryptMessages() / decryptMessages()
+ *  on 1, 2, 4 ... max_threads threads. Each batch is decrypted and checked
+ *  against the text, a tampered MAC must be reported, and on one thread the
+ *  batch must match encrypt_pw() given the same nonces.
+ *
+ *  size_t n_msgs:              messages per batch
+ *  int max_threads:            largest thread count
+ */
+static int aes_taksbulk(size_t n_msgs, int max_threads)
+{
+  timer_host t;
+  const size_t n_base = n_msgs < AES_TAKS_BENCH_MSGS ? n_msgs : AES_TAKS_BENCH_MSGS;
+  message_t *msg = (message_t *)calloc(n_msgs, sizeof(message_t));
+  message_t *ref = (message_t *)calloc(n_base, sizeof(message_t));
+  uint8_t *text = (uint8_t *)malloc(TAKS_PAYLOAD_LEN * n_msgs);
+  uint8_t *dec = (uint8_t *)malloc(TAKS_PAYLOAD_LEN * n_msgs);
+  int *status = (int *)malloc(sizeof(int) * n_msgs);
+  double ms_enc, ms_dec, us_base;
+  int failed, err = 0;
+
+  if (msg == NULL || ref == NULL || text == NULL || dec == NULL || status == NULL || n_msgs == 0) {
+    free(msg); free(ref); free(text); free(dec); free(status);
+    return -ENOMEM;
+  }
+  if (max_threads < 1)
+    max_threads = 1;
+  if (max_threads > TAKS_BATCH_MAX_THREADS)
+    max_threads = TAKS_BATCH_MAX_THREADS;
+
+  initNodes();
+  fill_pattern(text, TAKS_PAYLOAD_LEN * n_msgs);
+
+  printf("\n  - TAKS batch API (engine %s, %ld cores, log level %d)\n", aes_impl_names[aes_impl_get()],
+    sysconf(_SC_NPROCESSORS_ONLN), TAKS_LOG_LEVEL);
+  printf("  ------------------------------------------------------\n\n");
+  printf("  - %zu messages of %d B per batch, baseline over %zu\n", n_msgs, TAKS_PAYLOAD_LEN, n_base);
+  printf("\n  %-22s  %7s  %12s  %12s  %10s  %8s  %s\n", "path", "threads", "enc msgs/s", "dec msgs/s", "us/msg", "speedup", "check");
+
+  // Baseline: the per-message API, one message at a time
+  taks_nonce_seed(taks_bench_seed);
+  int saved = stdout_mute();
+clock_gettime(CLOCK_REALTIME, &t.t0);
+  for (size_t i = 0; i < n_base; i++)
+    encryptMessage(&ref[i], (const char *)&text[TAKS_PAYLOAD_LEN * i]);
+clock_gettime(CLOCK_REALTIME, &t.t1);
+  ms_enc = elapsed_ms(&t);
+  failed = 0;
+clock_gettime(CLOCK_REALTIME, &t.t0);
+  for (size_t i = 0; i < n_base; i++)
+    failed += decryptMessage((const char *)&dec[TAKS_PAYLOAD_LEN * i], &ref[i]) != 0;
+clock_gettime(CLOCK_REALTIME, &t.t1);
+  ms_dec = elapsed_ms(&t);
+  stdout_restore(saved);
+  failed += memcmp(dec, text, TAKS_PAYLOAD_LEN * n_base) != 0;
+  err += failed;
+
+  us_base = (ms_enc + ms_dec) * 1000.0 / n_base;
+  printf("  %-22s  %7d  %12.0f  %12.0f  %10.2f  %8.2f  %s\n", "encrypt_pw/decrypt_pw", 1,
+    n_base / (ms_enc / 1000.0), n_base / (ms_dec / 1000.0), us_base, 1.0, failed ? "FAIL" : "ok");
+
+  for (int th = 1; th <= max_threads; th *= 2) {
+    memset(msg, 0, sizeof(message_t) * n_msgs);
+    memset(dec, 0, TAKS_PAYLOAD_LEN * n_msgs);
+
+    taks_nonce_seed(taks_bench_seed);
+clock_gettime(CLOCK_REALTIME, &t.t0);
+    failed = encryptMessages(msg, (const char *)text, n_msgs, th) != 0;
+clock_gettime(CLOCK_REALTIME, &t.t1);
+    ms_enc = elapsed_ms(&t);
+clock_gettime(CLOCK_REALTIME, &t.t0);
+    failed += decryptMessages((char *)dec, msg, n_msgs, status, th) != 0;
+clock_gettime(CLOCK_REALTIME, &t.t1);
+    ms_dec = elapsed_ms(&t);
+
+    failed += memcmp(dec, text, TAKS_PAYLOAD_LEN * n_msgs) != 0;
+    if (th == 1)
+      failed += memcmp(msg, ref, sizeof(message_t) * n_base) != 0;
+
+    // One tampered MAC: reported, status -1, plaintext zeroed
+    message_t bad = msg[n_msgs / 2];
+    uint8_t out[TAKS_PAYLOAD_LEN], zero[TAKS_PAYLOAD_LEN] = { 0 };
+    int st = 0;
+    bad.mac[0] ^= 0x01;
+    failed += decryptMessages((char *)out, &bad, 1, &st, 1) != 1 || st != -1 || memcmp(out, zero, TAKS_PAYLOAD_LEN);
+    err += failed;
+
+    const double us = (ms_enc + ms_dec) * 1000.0 / n_msgs;
+    printf("  %-22s  %7d  %12.0f  %12.0f  %10.2f  %8.2f  %s\n", th == 1 ? "batch" : "", th,
+      n_msgs / (ms_enc / 1000.0), n_msgs / (ms_dec / 1000.0), us, us_base / us, failed ? "FAIL" : "ok");
+  }
+  printf("\n");
+
+  free(msg); free(ref); free(text); free(dec); free(status);
+  return err ? -1 : 0;
+}
+
+/*  aes_gfbench():              GF(2^8) engines of the TAKS key components
+ *
+ *  Exhaustive check of every engine against the bit-serial multiply, then
+ *  the time of elementwise_mult() (COMPLEN bytes), vector_mult()
+ *  (TAKS_KEY_LEN) and of the shared-secret derivation of taks_encrypt(),
+ *  two elementwise_mult() and one vector_mult(), on each engine. All
+ *  engines must end on the same bytes.
+ *
+ *  size_t iters:               calls per function and engine
+ */
+static int aes_gfbench(size_t iters)
+{
+  timer_host t;
+  uint8_t key[4][COMPLEN], x[COMPLEN], alpha[COMPLEN], kri[COMPLEN], ss[TAKS_KEY_LEN];
+  uint8_t ref[COMPLEN * 3 + TAKS_KEY_LEN], out[COMPLEN * 3 + TAKS_KEY_LEN];
+  double ns_x, ns_v, ns_ss, ns_ref = 0;
+  const int impl_saved = taks_gf_get();
+  int err = 0, e;
+
+  fill_pattern(&key[0][0], sizeof(key));
+
+  printf("\n  - TAKS GF(2^8) engines (current %s)\n", taks_gf_impl_names[impl_saved]);
+  printf("  ------------------------------------------------------\n\n");
+
+  e = taks_gf_selftest();
+  printf("  - Exhaustive check (65536 products):  %s\n", e ? "FAIL" : "ok");
+  err += (e != 0);
+
+  printf("\n  %-10s  %16s  %16s  %16s  %8s  %s\n", "engine", "elementwise ns", "vector ns", "secret ns", "speedup", "check");
+  for (int impl = 0; impl < TAKS_GF_N; impl++) {
+    if (!taks_gf_available(impl)) {
+      printf("  %-10s  not available\n", taks_gf_impl_names[impl]);
+      continue;
+    }
+    taks_gf_select(impl);
+
+clock_gettime(CLOCK_REALTIME, &t.t0);
+    for (size_t i = 0; i < iters; i++)
+      elementwise_mult(x, key[i & 3], key[(i + 1) & 3]);
+clock_gettime(CLOCK_REALTIME, &t.t1);
+    ns_x = elapsed_ms(&t) * 1e6 / iters;
+
+clock_gettime(CLOCK_REALTIME, &t.t0);
+    for (size_t i = 0; i < iters; i++)
+      vector_mult(ss, key[i & 3], key[(i + 1) & 3]);
+clock_gettime(CLOCK_REALTIME, &t.t1);
+    ns_v = elapsed_ms(&t) * 1e6 / iters;
+
+    // nonce, src_LKC, dst_TKC, src_TKC as in taks_encrypt()
+clock_gettime(CLOCK_REALTIME, &t.t0);
+    for (size_t i = 0; i < iters; i++) {
+      elementwise_mult(alpha, key[i & 3], key[(i + 1) & 3]);
+      vector_mult(ss, alpha, key[(i + 2) & 3]);
+      elementwise_mult(kri, key[i & 3], key[(i + 3) & 3]);
+    }
+clock_gettime(CLOCK_REALTIME, &t.t1);
+    ns_ss = elapsed_ms(&t) * 1e6 / iters;
+
+    memcpy(out, x, COMPLEN);
+    memcpy(out + COMPLEN, alpha, COMPLEN);
+    memcpy(out + 2 * COMPLEN, kri, COMPLEN);
+    memcpy(out + 3 * COMPLEN, ss, TAKS_KEY_LEN);
+    if (impl == TAKS_GF_BITSERIAL) {
+      memcpy(ref, out, sizeof(ref));
+      ns_ref = ns_ss;
+    }
+    e = memcmp(out, ref, sizeof(ref)) != 0;
+    err += e;
+
+    printf("  %-10s  %16.1f  %16.1f  %16.1f  %8.2f  %s\n", taks_gf_impl_names[impl], ns_x, ns_v, ns_ss,
+      ns_ref / ns_ss, e ? "FAIL" : "ok");
+  }
+  printf("\n");
+
+  taks_gf_select(impl_saved);
+
+  return err ? -1 : 0;
+}
+
+typedef struct {
+  uint8_t *out;                       // n nonces of TAKS_KEY_LEN bytes, the x half
+  size_t n;
+  int bad;                            // y half differs from x, or a zero byte
+} nonce_bench_job;
+
+static void *nonce_bench_main(void *arg)
+{
+  nonce_bench_job *job = (nonce_bench_job *)arg;
+  uint8_t nonce[COMPLEN];
+
+  for (size_t i = 0; i < job->n; i++) {
+    getNonce(nonce);
+    memcpy(&job->out[TAKS_KEY_LEN * i], nonce, TAKS_KEY_LEN);
+    job->bad += memcmp(nonce, tc_getY(nonce), TAKS_KEY_LEN) != 0 || memchr(nonce, 0, COMPLEN) != NULL;
+  }
+
+  return NULL;
+}
+
+static int nonce_cmp(const void *a, const void *b)
+{
+  return memcmp(a, b, TAKS_KEY_LEN);
+}
+
+/*  Nonces drawn twice: 0 if all n are distinct. */
+static size_t nonce_duplicates(uint8_t *nonces, size_t n)
+{
+  size_t dup = 0;
+
+  qsort(nonces, n, TAKS_KEY_LEN, nonce_cmp);
+  for (size_t i = 1; i < n; i++)
+    dup += memcmp(&nonces[TAKS_KEY_LEN * (i - 1)], &nonces[TAKS_KEY_LEN * i], TAKS_KEY_LEN) == 0;
+
+  return dup;
+}
+
+/*  aes_noncebench():           TAKS nonce generator
+ *
+ *  CTR_DRBG known-answer test, the Blum-Blum-Shub getNonceBBS() as the
+ *  baseline, then getNonce() on 1, 2, 4 ... max_threads threads, each on
+ *  its own pool. Every run keeps all its nonces: they must be distinct
+ *  across threads, with no zero byte and the same x and y halves. A fixed
+ *  seed must give the same stream twice.
+ *
+ *  size_t n_nonces:            nonces per run
+ *  int max_threads:            largest thread count
+ */
+static int aes_noncebench(size_t n_nonces, int max_threads)
+{
+  timer_host t;
+  const size_t n_bbs = n_nonces < AES_NONCE_BENCH_BBS ? n_nonces : AES_NONCE_BENCH_BBS;
+  uint8_t *nonces = (uint8_t *)malloc(TAKS_KEY_LEN * n_nonces);
+  uint8_t a[COMPLEN], b[COMPLEN];
+  nonce_bench_job job[TAKS_BATCH_MAX_THREADS];
+  pthread_t tid[TAKS_BATCH_MAX_THREADS];
+  double ms, ns_bbs;
+  size_t dup;
+  int err = 0, e, bad;
+
+  if (nonces == NULL || n_nonces == 0) {
+    free(nonces);
+    return -ENOMEM;
+  }
+  if (max_threads < 1)
+    max_threads = 1;
+  if (max_threads > TAKS_BATCH_MAX_THREADS)
+    max_threads = TAKS_BATCH_MAX_THREADS;
+
+  printf("\n  - TAKS nonce generator (AES-128 CTR_DRBG on %s, %ld cores)\n", aes_impl_names[aes_impl_get()],
+    sysconf(_SC_NPROCESSORS_ONLN));
+  printf("  ------------------------------------------------------\n\n");
+
+  e = taks_nonce_selftest();
+  printf("  - CTR_DRBG known answers:             %s\n", e ? "FAIL" : "ok");
+  err += (e != 0);
+
+  e = taks_nonce_seed(taks_bench_seed);
+  getNonce(a);
+  e |= taks_nonce_seed(taks_bench_seed);
+  getNonce(b);
+  e |= memcmp(a, b, COMPLEN) != 0;
+  taks_nonce_seed(NULL);
+  printf("  - Fixed seed, same stream:            %s\n", e ? "FAIL" : "ok");
+  err += (e != 0);
+
+  printf("\n  %-14s  %7s  %12s  %10s  %8s  %s\n", "path", "threads", "nonces/s", "ns/nonce", "speedup", "check");
+
+clock_gettime(CLOCK_REALTIME, &t.t0);
+  for (size_t i = 0; i < n_bbs; i++)
+    getNonceBBS(a);
+clock_gettime(CLOCK_REALTIME, &t.t1);
+  ns_bbs = elapsed_ms(&t) * 1e6 / n_bbs;
+  printf("  %-14s  %7d  %12.0f  %10.1f  %8.2f  %s\n", "getNonceBBS", 1, 1e9 / ns_bbs, ns_bbs, 1.0, "-");
+
+  for (int th = 1; th <= max_threads; th *= 2) {
+    size_t first = 0;
+
+    bad = 0;
+clock_gettime(CLOCK_REALTIME, &t.t0);
+    for (int k = 0; k < th; k++) {
+      job[k].n = n_nonces / th + ((size_t)k < n_nonces % th);
+      job[k].out = &nonces[TAKS_KEY_LEN * first];
+      job[k].bad = 0;
+      first += job[k].n;
+      if (pthread_create(&tid[k], NULL, nonce_bench_main, &job[k])) {
+        tid[k] = pthread_self();
+        nonce_bench_main(&job[k]);
+      }
+    }
+    for (int k = 0; k < th; k++) {
+      if (!pthread_equal(tid[k], pthread_self()))
+        pthread_join(tid[k], NULL);
+      bad += job[k].bad;
+    }
+clock_gettime(CLOCK_REALTIME, &t.t1);
+    ms = elapsed_ms(&t);
+
+    dup = nonce_duplicates(nonces, n_nonces);
+    e = bad != 0 || dup != 0;
+    err += e;
+
+    const double ns = ms * 1e6 / n_nonces;
+    printf("  %-14s  %7d  %12.0f  %10.1f  %8.2f  %s", th == 1 ? "getNonce" : "", th, 1e9 / ns, ns, ns_bbs / ns,
+      e ? "FAIL" : "ok");
+    if (e)
+      printf(" (%zu repeated, %d malformed)", dup, bad);
+    printf("\n");
+  }
+  printf("\n");
+
+  free(nonces);
+  return err ? -1 : 0;
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
 
 int main(int argc, char **argv)
 {
   message_t temp;
   char decrypted[TAKS_PAYLOAD_LEN];
 
-  if (argc < 2)
+  if (argc < 2) {
+      printf("Usage: %s \"msg\" | bench [kbytes] | hwbench [word|packed] [mbytes] | kcbench [mbytes] | ring [producers] [msgs] [latency_us|hw] | taksbench [msgs] [peers] [entries] | taksbulk [msgs] [threads] | gfbench [iters] | noncebench [nonces] [threads]\n", argv[0]);
       return -1;
+  }
+
+  if (!strcmp(argv[1], "bench"))
+    return aes_bench((argc > 2 ? strtoul(argv[2], NULL, 0) : AES_BENCH_KB) * 1024);
+
+  if (!strcmp(argv[1], "hwbench")) {
+    int beat = AES128_BEAT_WORD;
+    if (argc > 2 && !strcmp(argv[2], aes128_beat_names[AES128_BEAT_PACKED]))
+      beat = AES128_BEAT_PACKED;
+    return aes_hwbench(beat, (argc > 3 ? strtoul(argv[3], NULL, 0) : 16) << 20);
+  }
+
+  if (!strcmp(argv[1], "kcbench"))
+    return aes_kcbench((argc > 2 ? strtoul(argv[2], NULL, 0) : 16) << 20);
+
+  if (!strcmp(argv[1], "taksbench"))
+    return aes_taksbench(argc > 2 ? strtoul(argv[2], NULL, 0) : AES_TAKS_BENCH_MSGS,
+      argc > 3 ? atoi(argv[3]) : AES_TAKS_BENCH_PEERS,
+      argc > 4 ? atoi(argv[4]) : TAKS_KCACHE_ENTRIES);
+
+  if (!strcmp(argv[1], "taksbulk"))
+    return aes_taksbulk(argc > 2 ? strtoul(argv[2], NULL, 0) : AES_TAKS_BULK_MSGS,
+      argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN));
+
+  if (!strcmp(argv[1], "gfbench"))
+    return aes_gfbench(argc > 2 ? strtoul(argv[2], NULL, 0) : AES_GF_BENCH_ITERS);
+
+  if (!strcmp(argv[1], "noncebench"))
+    return aes_noncebench(argc > 2 ? strtoul(argv[2], NULL, 0) : AES_NONCE_BENCH_NONCES,
+      argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN));
+
+  if (!strcmp(argv[1], "ring")) {
+    int producers = argc > 2 ? atoi(argv[2]) : 4;
+    size_t n_msgs = argc > 3 ? strtoul(argv[3], NULL, 0) : AES_RING_BENCH_MSGS;
+
+    if (argc > 4 && !strcmp(argv[4], "hw")) {
+      aes128_addr_t addr;
+      aes_ring_engine hw;
+      axis_aes128_load((char *)"axis_aes128_drivers/axis_aes128_design_1_wrapper.bin");
+      if (axis_aes128_init(&addr))
+        return -1;
+      int r = aes_ring_bench(producers, n_msgs, axis_aes128_ring_engine(&hw, &addr));
+      axis_aes128_stop(&addr);
+      return r;
+    }
+
+    aes_ring_sw sw;
+    unsigned latency_us = argc > 4 ? strtoul(argv[4], NULL, 0) : AES_RING_BENCH_LATENCY_US;
+    return aes_ring_bench(producers, n_msgs, aes_ring_sw_engine(&sw, aes_impl_get(), latency_us));
+  }
+
+  printf("\n\nAES engine: %s", aes_impl_names[aes_impl_get()]);
 
 	initNodes();
   printf("\n\nINPUT MESSAGE - PLAIN TEXT: %s",argv[1]);
@@ -0,0 +1,196 @@
+/*
+ * Host buffer allocation backends - the same benchmark body runs over
+ * buffers obtained in different ways, i.e. with different memory
+ * attributes, instead of one source tree per allocation scheme.
+ */
+
+#ifndef ARM_ALLOC_H
+#define ARM_ALLOC_H
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/*
+ * Reserved address in Contiguous Memory, shared with the accelerator apps.
+ * To check whether CMA has been correctly allocated: 'dmesg | grep Reserved'
+ */
+
+#ifndef CMA_ADDR
+#define CMA_ADDR 0x10000000
+#endif
+
+enum arm_mem_backend {
+    ARM_MEM_MALLOC = 0,     // heap, 64 B aligned
+    ARM_MEM_HUGEPAGE,       // anonymous mmap, MAP_HUGETLB, else THP
+    ARM_MEM_DEVMEM_CACHED,  // /dev/mem window at CMA_ADDR, cacheable
+    ARM_MEM_DEVMEM_UNCACHED,// /dev/mem window at CMA_ADDR, O_SYNC
+    ARM_MEM_PINNED,         // CMA stand-in: locked, pre-faulted pages
+    ARM_MEM_N_BACKENDS
+};
+
+static const char * const arm_mem_names[ARM_MEM_N_BACKENDS] = {
+    "malloc", "hugepage", "devmem_cached", "devmem_uncached", "pinned"
+};
+
+/* Huge page backing obtained by ARM_MEM_HUGEPAGE. */
+
+#define ARM_HUGE_PAGE_SIZE (2 << 20)
+
+enum arm_mem_huge {
+    ARM_HUGE_NONE = 0,      // 4 KB pages, neither mechanism available
+    ARM_HUGE_TLB,           // hugetlbfs pool, MAP_HUGETLB
+    ARM_HUGE_THP,           // transparent huge pages, madvise(MADV_HUGEPAGE)
+};
+
+static const char * const arm_mem_huge_names[] = { "none", "hugetlb", "thp" };
+
+struct arm_buf {
+    void *ptr;
+    size_t len;         // requested length
+    size_t map_len;     // mapped length, 0 for malloc
+    int backend;
+    int huge;           // enum arm_mem_huge
+};
+
+typedef struct arm_buf                arm_buf;
+
+/*  arm_mem_backend_parse():    backend from its name
+ *
+ * 	return the backend, -1 if unknown
+ */
+static inline int arm_mem_backend_parse(const char *name)
+{
+    for (int b = 0; b < ARM_MEM_N_BACKENDS; b++)
+        if (!strcmp(name, arm_mem_names[b]))
+            return b;
+    return -1;
+}
+
+static inline size_t arm_mem_round(size_t len, size_t align)
+{
+    return (len + align - 1) & ~(align - 1);
+}
+
+/*
+ * Huge page mapping - MAP_HUGETLB needs pages reserved in
+ * /proc/sys/vm/nr_hugepages. Failing that, a 2 MB aligned anonymous
+ * mapping is advised for THP, which the kernel backs with huge pages on
+ * fault if THP is enabled ('madvise' or 'always'). Failing that too, the
+ * mapping stays on 4 KB pages.
+ */
+static inline void *arm_mem_map_huge(size_t map_len, int *huge)
+{
+    void *ptr = mmap(NULL, map_len, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+        *huge = ARM_HUGE_TLB;
+        return ptr;
+    }
+
+    // Over-allocate by one huge page, trim to a 2 MB aligned window.
+    uint8_t *raw = (uint8_t *)mmap(NULL, map_len + ARM_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return MAP_FAILED;
+
+    uint8_t *aligned = (uint8_t *)arm_mem_round((uintptr_t)raw, ARM_HUGE_PAGE_SIZE);
+    if (aligned > raw)
+        munmap(raw, aligned - raw);
+    if (aligned + map_len < raw + map_len + ARM_HUGE_PAGE_SIZE)
+        munmap(aligned + map_len, raw + map_len + ARM_HUGE_PAGE_SIZE - (aligned + map_len));
+
+#ifdef MADV_HUGEPAGE
+    *huge = madvise(aligned, map_len, MADV_HUGEPAGE) ? ARM_HUGE_NONE : ARM_HUGE_THP;
+#else
+    *huge = ARM_HUGE_NONE;
+#endif
+    return aligned;
+}
+
+/*  arm_buf_alloc():            allocate a buffer from a backend
+ *
+ *  int backend:                enum arm_mem_backend
+ *  size_t len:                 length in bytes
+ *  uint64_t phys_addr:         physical address, /dev/mem backends only,
+ *                              page aligned
+ *
+ * 	return 0 on success, a negative errno otherwise, e.g. -EACCES when
+ * 	/dev/mem cannot be opened
+ */
+static inline int arm_buf_alloc(arm_buf *buf, int backend, size_t len, uint64_t phys_addr)
+{
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    void *ptr = MAP_FAILED;
+    int fd;
+
+    buf->ptr = NULL;
+    buf->len = len;
+    buf->map_len = 0;
+    buf->backend = backend;
+    buf->huge = ARM_HUGE_NONE;
+
+    switch (backend) {
+    case ARM_MEM_MALLOC:
+        if (posix_memalign(&buf->ptr, 64, len))
+            return -ENOMEM;
+        return 0;
+
+    case ARM_MEM_HUGEPAGE:
+        buf->map_len = arm_mem_round(len, ARM_HUGE_PAGE_SIZE);
+        ptr = arm_mem_map_huge(buf->map_len, &buf->huge);
+        break;
+
+    case ARM_MEM_DEVMEM_CACHED:
+    case ARM_MEM_DEVMEM_UNCACHED:
+        fd = open("/dev/mem", backend == ARM_MEM_DEVMEM_UNCACHED ? O_RDWR | O_SYNC : O_RDWR);
+        if (fd == -1)
+            return -errno;
+        buf->map_len = arm_mem_round(len, page);
+        ptr = mmap(NULL, buf->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t)phys_addr);
+        close(fd); // the mapping holds its own reference
+        break;
+
+    case ARM_MEM_PINNED:
+        buf->map_len = arm_mem_round(len, page);
+        ptr = mmap(NULL, buf->map_len, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE | MAP_LOCKED, -1, 0);
+        // Over RLIMIT_MEMLOCK - still pre-faulted, just not locked.
+        if (ptr == MAP_FAILED && (errno == EAGAIN || errno == EPERM))
+            ptr = mmap(NULL, buf->map_len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        break;
+
+    default:
+        return -EINVAL;
+    }
+
+    if (ptr == MAP_FAILED) {
+        int err = errno;
+        buf->map_len = 0;
+        return -err;
+    }
+    buf->ptr = ptr;
+    return 0;
+}
+
+static inline void arm_buf_free(arm_buf *buf)
+{
+    if (buf->ptr == NULL)
+        return;
+    if (buf->map_len)
+        munmap(buf->ptr, buf->map_len);
+    else
+        free(buf->ptr);
+    buf->ptr = NULL;
+}
+
+#endif
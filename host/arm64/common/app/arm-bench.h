@@ -2,10 +2,240 @@
  * Author: Gianluca Bellocchi <gianluca.bellocchi@unimore.it>
  */
 
+#ifndef ARM_BENCH_H
+#define ARM_BENCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
 struct timer_host {
     struct timespec t0;
     struct timespec t1;
-    float t_meas;   
+    float t_meas;
 };
 
 typedef struct timer_host             timer_host;
+
+/*
+ * Hardware performance counters - a perf_event_open group around the
+ * measured region, counting this process and the threads it spawns.
+ *
+ * Counters are best effort: events the PMU (or the kernel, or the
+ * container) does not provide read as unavailable and are left out of the
+ * derived metrics, the benchmark itself runs unchanged.
+ *
+ *   perf_group pg;
+ *   perf_group_open(&pg);
+ *   perf_group_start(&pg);
+ *   ... measured region ...
+ *   perf_group_stop(&pg);
+ *   perf_group_print(&pg, bytes);
+ *   perf_group_close(&pg);
+ */
+
+enum perf_counter {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_L2D_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_STALLS_BACKEND,
+    PERF_N_COUNTERS
+};
+
+struct perf_group {
+    int fd[PERF_N_COUNTERS];        // -1 if not available
+    uint64_t val[PERF_N_COUNTERS];
+    int n_open;
+};
+
+typedef struct perf_group             perf_group;
+
+#ifdef __linux__
+
+/* Counter configurations, same order as enum perf_counter. */
+
+static inline void perf_counter_attr(int counter, struct perf_event_attr *attr)
+{
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->disabled = 1;
+    attr->inherit = 1;
+    attr->exclude_kernel = 1;       // perf_event_paranoid <= 2
+    attr->exclude_hv = 1;
+
+    switch (counter) {
+    case PERF_CYCLES:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PERF_INSTRUCTIONS:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PERF_L1D_MISSES:
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_L1D
+            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case PERF_L2D_MISSES:
+#ifdef __aarch64__
+        // ARMv8 common event L2D_CACHE_REFILL - the generic LL cache event
+        // is not mapped on the A53.
+        attr->type = PERF_TYPE_RAW;
+        attr->config = 0x17;
+#else
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_LL
+            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+#endif
+        break;
+    case PERF_DTLB_MISSES:
+#ifdef __aarch64__
+        // ARMv8 common event L1D_TLB_REFILL.
+        attr->type = PERF_TYPE_RAW;
+        attr->config = 0x05;
+#else
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_DTLB
+            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+#endif
+        break;
+    case PERF_STALLS_BACKEND:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_STALLED_CYCLES_BACKEND;
+        break;
+    }
+}
+
+/*  perf_group_open():          open the counters, cycles as group leader
+ *
+ * 	return the number of counters available, 0 if none is
+ */
+static inline int perf_group_open(perf_group *pg)
+{
+    struct perf_event_attr attr;
+
+    pg->n_open = 0;
+    for (int i = 0; i < PERF_N_COUNTERS; i++) {
+        pg->fd[i] = -1;
+        pg->val[i] = 0;
+    }
+
+    for (int i = 0; i < PERF_N_COUNTERS; i++) {
+        perf_counter_attr(i, &attr);
+        // Without a leader, the others are opened standalone.
+        int leader = pg->fd[PERF_CYCLES];
+        pg->fd[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+        if (pg->fd[i] >= 0)
+            pg->n_open++;
+    }
+
+    return pg->n_open;
+}
+
+static inline void perf_group_start(perf_group *pg)
+{
+    for (int i = 0; i < PERF_N_COUNTERS; i++) {
+        if (pg->fd[i] < 0) continue;
+        ioctl(pg->fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(pg->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+static inline void perf_group_stop(perf_group *pg)
+{
+    for (int i = 0; i < PERF_N_COUNTERS; i++) {
+        if (pg->fd[i] < 0) continue;
+        ioctl(pg->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i = 0; i < PERF_N_COUNTERS; i++) {
+        if (pg->fd[i] < 0) continue;
+        if (read(pg->fd[i], &pg->val[i], sizeof(uint64_t)) != sizeof(uint64_t))
+            pg->val[i] = 0;
+    }
+}
+
+static inline void perf_group_close(perf_group *pg)
+{
+    // Members first, then the leader.
+    for (int i = PERF_N_COUNTERS - 1; i >= 0; i--) {
+        if (pg->fd[i] >= 0) close(pg->fd[i]);
+        pg->fd[i] = -1;
+    }
+    pg->n_open = 0;
+}
+
+#else
+
+static inline int perf_group_open(perf_group *pg)
+{
+    for (int i = 0; i < PERF_N_COUNTERS; i++) {
+        pg->fd[i] = -1;
+        pg->val[i] = 0;
+    }
+    pg->n_open = 0;
+    return 0;
+}
+
+static inline void perf_group_start(perf_group *pg) { (void)pg; }
+static inline void perf_group_stop(perf_group *pg) { (void)pg; }
+static inline void perf_group_close(perf_group *pg) { (void)pg; }
+
+#endif
+
+/* A counter is usable if open and it counted something. */
+
+static inline int perf_group_valid(const perf_group *pg, int counter)
+{
+    return pg->fd[counter] >= 0 && pg->val[counter] > 0;
+}
+
+/*  perf_group_print():         print counters and derived metrics
+ *
+ *  double bytes:               bytes moved by the region, for bytes per
+ *                              cycle, 0 to omit
+ */
+static inline void perf_group_print(const perf_group *pg, double bytes)
+{
+    const int has_cyc = perf_group_valid(pg, PERF_CYCLES);
+    const int has_ins = perf_group_valid(pg, PERF_INSTRUCTIONS);
+    const double cyc = (double)pg->val[PERF_CYCLES];
+    const double kins = (double)pg->val[PERF_INSTRUCTIONS] / 1000.0;
+
+    if (!has_cyc && !has_ins) {
+        printf("  -     - HW counters:            not available\n");
+        return;
+    }
+
+    if (has_cyc)
+        printf("  -     - Cycles:                 %llu\n", (unsigned long long)pg->val[PERF_CYCLES]);
+    if (has_ins)
+        printf("  -     - Instructions:           %llu\n", (unsigned long long)pg->val[PERF_INSTRUCTIONS]);
+    if (has_cyc && has_ins)
+        printf("  -     - IPC:                    %.3f\n", kins * 1000.0 / cyc);
+    if (has_ins && pg->fd[PERF_L1D_MISSES] >= 0)
+        printf("  -     - L1D MPKI:               %.3f\n", pg->val[PERF_L1D_MISSES] / kins);
+    if (has_ins && pg->fd[PERF_L2D_MISSES] >= 0)
+        printf("  -     - L2D MPKI:               %.3f\n", pg->val[PERF_L2D_MISSES] / kins);
+    if (has_ins && pg->fd[PERF_DTLB_MISSES] >= 0)
+        printf("  -     - dTLB MPKI:              %.3f\n", pg->val[PERF_DTLB_MISSES] / kins);
+    if (has_cyc && pg->fd[PERF_STALLS_BACKEND] >= 0)
+        printf("  -     - Backend stalls (%%):     %.1f\n", 100.0 * pg->val[PERF_STALLS_BACKEND] / cyc);
+    if (has_cyc && bytes > 0)
+        printf("  -     - Bytes per cycle:        %.3f\n", bytes / cyc);
+}
+
+#endif
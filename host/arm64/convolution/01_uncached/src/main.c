@@ -32,6 +32,9 @@
 /* Include host timer struct. */
 #include <arm-bench.h>
 
+/* Include host convolution. */
+#include <convolution_sw.h>
+
 /* 
  * Reserved address in Contiguous Memory. 
  * To check whether CMA has been correctly allocated: 'dmesg | grep Reserved'
@@ -88,107 +91,6 @@ void check_result(
     }
 }
 
-/* Host 2D convolution. */
-
-void convolution_sw(uint32_t* in, uint32_t* out, uint32_t coeffs[UAV_FILTER_DIM], uint32_t width, uint32_t height)
-{
-  const int conv_size = UAV_FILTER_DIM;
-
-  uint32_t in_temp;
-  uint32_t out_temp;
-  uint32_t out_H[width*height];
-  uint32_t out_V[width*height];
-
-  const int border_width = (int)(conv_size / 2);
-
-  // Horizontal convolution
-
-  Clear_out_H:for(int i = 0; i < height * width; i++){
-    out_H[i]=0;
-  }
-
-  HconvH: for(int col = 0; col < height; col++){
-    HconvW: for(int row = border_width; row < width - border_width; row++){
-      int pixel = col * width + row;
-      Hconv: for(int i = - border_width; i <= border_width; i++){
-        out_H[pixel] += in[pixel + i] * coeffs[i + border_width];
-      }
-    }
-  }
-
-  // Vertical convolution
-
-  Clear_out_V:for(int i = 0; i < height * width; i++){
-    out_V[i]=0;
-  }
-
-  VconvH: for(int col = border_width; col < height - border_width; col++){
-    VconvW: for(int row = 0; row < width; row++){
-      int pixel = col * width + row;
-      Vconv: for(int i = - border_width; i <= border_width; i++){
-        int offset = i * width;
-        out[pixel] += out_H[pixel + offset] * coeffs[i + border_width];
-      }
-    }
-  }
-
-  // Border pixels
-
-  // const int border_width = (int)(conv_size / 2);
-  int border_width_offset = border_width * width;
-  int border_height_offset = (height - border_width - 1) * width;
-
-  // Border pixels
-
-  Top_Border:for(int col = 0; col < border_width; col++){
-
-    int offset = col * width;
-
-    Top_Left:for(int row = 0; row < border_width; row++){
-      int pixel = offset + row;
-      out[pixel] = out[border_width_offset + border_width];
-    }
-
-    Top_Row:for(int row = 5; row < 315; row++){
-      uint32_t pixel = offset + row;
-      out[pixel] = out[border_width_offset + row];
-    }
-
-    Top_Right:for(int row = width - border_width; row < width; row++){
-      int pixel = offset + row;
-      out[pixel] = out[border_width_offset + width - border_width - 1];
-    }
-  }
-
-  Side_Border:for(int col = border_width; col < height - border_width; col++){
-    int offset = col * width;
-    for(int row = 0; row < border_width; row++){
-      int pixel = offset + row;
-      out[pixel] = out[offset + border_width];
-    }
-    for(int row = width - border_width; row < width; row++){
-      int pixel = offset + row;
-      out[pixel] = out[offset + width - border_width - 1];
-    }
-  }
-
-  Bottom_Border:for(int col = height - border_width; col < height; col++){
-    int offset = col * width;
-    for(int row = 0; row < border_width; row++){
-      int pixel = offset + row;
-      out[pixel] = out[border_height_offset + border_width];
-    }
-    for(int row = border_width; row < width - border_width; row++){
-      uint32_t pixel = offset + row;
-      out[pixel] = out[border_height_offset + row];
-    }
-    for(int row = width - border_width; row < width; row++){
-      int pixel = offset + row;
-      out[pixel] = out[border_height_offset + width - border_width - 1];
-    }
-  }
-}
-
 /* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
 
 /*
@@ -210,6 +112,7 @@ int main(int argc, char *argv[])
   timer_host t_proc;
   timer_host t_memcpy_out;
   timer_host t_clean;
+  perf_group pg_proc;
 
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -362,16 +265,25 @@ t_memcpy_in.t_meas = ((t_memcpy_in.t1.tv_sec - t_memcpy_in.t0.tv_sec) + (t_memcp
   printf("| Execute CONVO on ARM. |");
   printf("\n|------------------------|\n\n");
 
+  perf_group_open(&pg_proc);
+
 clock_gettime(CLOCK_REALTIME, &t_proc.t0);
+perf_group_start(&pg_proc);
 
   /* Execute 2D convolution on ARM. */
 
-  convolution_sw( _l3_src, _l3_dst, filter_coeffs, width, height);
+  status = convolution_sw( _l3_src, _l3_dst, filter_coeffs, UAV_FILTER_DIM, width, height);
 
+perf_group_stop(&pg_proc);
 clock_gettime(CLOCK_REALTIME, &t_proc.t1);
 
 t_proc.t_meas = ((t_proc.t1.tv_sec - t_proc.t0.tv_sec) + (t_proc.t1.tv_nsec - t_proc.t0.tv_nsec)/1000000000.0)*1000.0;
 
+  if (status) {
+    printf("ERROR: convolution_sw() failed (%d)!\n", status);
+    return status;
+  }
+
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
   printf("\n|-----------------|\n");
@@ -435,6 +347,9 @@ t_clean.t_meas = ((t_clean.t1.tv_sec - t_clean.t0.tv_sec) + (t_clean.t1.tv_nsec
 
   printf("\n  - Host execution:\n");
   printf("  -     - Execution time (ms):    %.3f ms\n", t_proc.t_meas );
+  // Compulsory DRAM traffic: src read, dst write.
+  perf_group_print(&pg_proc, 2.0 * width * height * sizeof(uint32_t));
+  perf_group_close(&pg_proc);
 
   printf("\n  - Memcpy from CMA:\n");
   printf("  -     - Execution time (ms):    %.3f ms\n", t_memcpy_out.t_meas );
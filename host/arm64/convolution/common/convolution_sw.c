@@ -0,0 +1,170 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Libraries. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define CONV_SW_NEON 1
+#endif
+
+#include "convolution_sw.h"
+
+/*
+ * Row kernels - dst[x] = sum_i src_i[x] * coeffs[i], x in [x0, x1).
+ *
+ * The horizontal pass passes src_i = in_row + i - border_width, the vertical
+ * pass the K rows of the ring. Arithmetic is modulo 2^32 as in the original
+ * three-pass version, hence the result does not depend on the MAC order.
+ */
+
+static void conv_row(
+  uint32_t* dst, const uint32_t* const* src,
+  const uint32_t* coeffs, int k,
+  int x0, int x1)
+{
+  int x = x0;
+
+#ifdef CONV_SW_NEON
+  // 8 pixels per iteration, two independent accumulators.
+  for(; x + 8 <= x1; x += 8){
+    uint32x4_t acc0 = vdupq_n_u32(0);
+    uint32x4_t acc1 = vdupq_n_u32(0);
+    for(int i = 0; i < k; i++){
+      acc0 = vmlaq_n_u32(acc0, vld1q_u32(src[i] + x), coeffs[i]);
+      acc1 = vmlaq_n_u32(acc1, vld1q_u32(src[i] + x + 4), coeffs[i]);
+    }
+    vst1q_u32(dst + x, acc0);
+    vst1q_u32(dst + x + 4, acc1);
+  }
+  for(; x + 4 <= x1; x += 4){
+    uint32x4_t acc = vdupq_n_u32(0);
+    for(int i = 0; i < k; i++)
+      acc = vmlaq_n_u32(acc, vld1q_u32(src[i] + x), coeffs[i]);
+    vst1q_u32(dst + x, acc);
+  }
+#endif
+
+  for(; x < x1; x++){
+    uint32_t acc = 0;
+    for(int i = 0; i < k; i++)
+      acc += src[i][x] * coeffs[i];
+    dst[x] = acc;
+  }
+}
+
+/* Arguments check, shared by both entry points. */
+
+static int conv_args_ok(int k, uint32_t width, uint32_t height)
+{
+  return k >= 1 && (k & 1) && k <= CONV_SW_MAX_K &&
+    width >= (uint32_t)k && height >= (uint32_t)k;
+}
+
+/* Host 2D convolution - caller-owned ring. */
+
+size_t convolution_sw_ring_size(int k, uint32_t width)
+{
+  return (size_t)k * width * sizeof(uint32_t);
+}
+
+int convolution_sw_buf(
+  const uint32_t* in, uint32_t* out,
+  const uint32_t* coeffs, int k,
+  uint32_t width, uint32_t height,
+  uint32_t* ring)
+{
+  const int w = (int)width;
+  const int h = (int)height;
+  const int border_width = k / 2;
+  const int x0 = border_width;
+  const int x1 = w - border_width;
+
+  // K rows of horizontal results
+  const uint32_t* taps[CONV_SW_MAX_K];
+
+  if (!conv_args_ok(k, width, height))
+    return -EINVAL;
+
+  /*
+   * Row rolling: input row r is convolved horizontally into ring row
+   * (r % K). Once K rows are in, output row (r - border_width) is convolved
+   * vertically from the ring and its left/right border replicated, so that
+   * the frame is swept once and only the ring (K rows) is re-read.
+   */
+
+  Rows: for(int r = 0; r < h; r++){
+    const uint32_t* in_row = in + (size_t)r * w;
+
+    // Horizontal convolution
+    for(int i = 0; i < k; i++)
+      taps[i] = in_row + i - border_width;
+    conv_row(ring + (size_t)(r % k) * w, taps, coeffs, k, x0, x1);
+
+    if (r < k - 1)
+      continue;
+
+    // Vertical convolution - ring rows r - K + 1 .. r, oldest first
+    const int o = r - border_width;
+    uint32_t* out_row = out + (size_t)o * w;
+
+    for(int i = 0; i < k; i++)
+      taps[i] = ring + (size_t)((r - k + 1 + i) % k) * w;
+    conv_row(out_row, taps, coeffs, k, x0, x1);
+
+    // Side border
+    for(int x = 0; x < x0; x++)
+      out_row[x] = out_row[x0];
+    for(int x = x1; x < w; x++)
+      out_row[x] = out_row[x1 - 1];
+  }
+
+  // Top and bottom border - replicate the first/last valid row.
+
+  Top_Border: for(int r = 0; r < border_width; r++)
+    memcpy(out + (size_t)r * w, out + (size_t)border_width * w, w * sizeof(uint32_t));
+
+  Bottom_Border: for(int r = h - border_width; r < h; r++)
+    memcpy(out + (size_t)r * w, out + (size_t)(h - border_width - 1) * w, w * sizeof(uint32_t));
+
+  return 0;
+}
+
+/* Host 2D convolution. */
+
+int convolution_sw(
+  const uint32_t* in, uint32_t* out,
+  const uint32_t* coeffs, int k,
+  uint32_t width, uint32_t height)
+{
+  if (!conv_args_ok(k, width, height))
+    return -EINVAL;
+
+  // Ring on the heap - K rows only, independent of the frame height.
+  uint32_t* ring = (uint32_t*)malloc(convolution_sw_ring_size(k, width));
+
+  if (ring == NULL)
+    return -ENOMEM;
+
+  int ret = convolution_sw_buf(in, out, coeffs, k, width, height, ring);
+
+  free(ring);
+  return ret;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CONVOLUTION_SW_H_
+#define CONVOLUTION_SW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Largest window handled by the host convolution.
+#define CONV_SW_MAX_K 31
+
+/* 
+ * Host 2D separable convolution - same coefficients for the horizontal and
+ * vertical passes, K odd. Border pixels replicate the nearest valid
+ * interior pixel, as in the accelerators.
+ *
+ * Single fused sweep: each input row is convolved horizontally into a ring
+ * of K rows, which the vertical pass consumes right away, so that the
+ * working set is K rows rather than a whole intermediate frame. MACs use
+ * NEON when available.
+ *
+ * Returns 0 on success, -EINVAL on an even K, a K above CONV_SW_MAX_K or a
+ * frame smaller than K x K, -ENOMEM if the ring cannot be allocated.
+ */
+
+int convolution_sw(
+  const uint32_t* in, uint32_t* out, 
+  const uint32_t* coeffs, int k,
+  uint32_t width, uint32_t height);
+
+/*
+ * Same as convolution_sw, with a caller-owned ring of at least
+ * convolution_sw_ring_size(k, width) bytes, e.g. to keep it allocated
+ * across frames. Never returns -ENOMEM.
+ */
+
+size_t convolution_sw_ring_size(int k, uint32_t width);
+
+int convolution_sw_buf(
+  const uint32_t* in, uint32_t* out,
+  const uint32_t* coeffs, int k,
+  uint32_t width, uint32_t height,
+  uint32_t* ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONVOLUTION_SW_H_ not defined
@@ -39,18 +39,8 @@
 
 #define CMA_ADDR 0x10000000
 
-/* Host matrix multiplication. */
-
-void mmult_sw(uint32_t* in1, uint32_t* in2, uint32_t* out, uint32_t mat_dim, uint32_t stripe_height)
-{
-  for (unsigned i = 0; i < mat_dim; i++){
-    for (unsigned j = 0; j < mat_dim; j++){
-      for (unsigned k = 0; k < mat_dim; k++){
-        out[i * mat_dim + j] += in1[i * mat_dim + k] * in2[j * mat_dim  + k];
-      }
-    }
-  }
-}
+/* Include host matrix multiplication. */
+#include <mmult_sw.h>
 
 /* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
 
@@ -73,6 +63,7 @@ int main(int argc, char *argv[])
   timer_host t_proc;
   timer_host t_memcpy_out;
   timer_host t_clean;
+  perf_group pg_proc;
 
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -88,6 +79,27 @@ clock_gettime(CLOCK_REALTIME, &t_alloc.t0);
   unsigned height         = 512;
   unsigned stripe_height  = 8;
 
+  /* Algorithm - 'naive', 'blocked' (default) or 'strassen', worker threads, Strassen cutoff. */
+
+  int algo                = MMULT_BLOCKED;
+  int n_threads           = MMULT_MAX_THREADS;
+  unsigned cutoff         = MMULT_STRASSEN_CUTOFF;
+
+  if (argc > 2)
+    n_threads = atoi(argv[2]);
+  if (argc > 3)
+    cutoff = atoi(argv[3]);
+
+  if (argc > 1) {
+    for (algo = 0; algo < MMULT_N_ALGOS; algo++)
+      if (!strcmp(argv[1], mmult_sw_names[algo]))
+        break;
+    if (algo == MMULT_N_ALGOS) {
+      printf("Usage: %s [naive|blocked|strassen] [n_threads] [cutoff]\n", argv[0]);
+      return -EINVAL;
+    }
+  }
+
   /* General. */
 
   int status;
@@ -181,12 +193,24 @@ t_memcpy_in.t_meas = ((t_memcpy_in.t1.tv_sec - t_memcpy_in.t0.tv_sec) + (t_memcp
   printf("| Execute MMULT on ARM. |");
   printf("\n|------------------------|\n\n");
 
+  perf_group_open(&pg_proc);
+
 clock_gettime(CLOCK_REALTIME, &t_proc.t0);
+perf_group_start(&pg_proc);
 
   /* Execute hardware mmult on ARM. */
 
-  mmult_sw( _l3_in1, _l3_in2, _l3_test, width, stripe_height);
+  if (algo == MMULT_STRASSEN)
+    status = mmult_sw_strassen( _l3_in1, _l3_in2, _l3_test, width, cutoff, n_threads);
+  else
+    status = mmult_sw( _l3_in1, _l3_in2, _l3_test, width, algo, n_threads);
 
+  if (status) {
+    printf("ERROR: mmult_sw() failed: %s\n", strerror(-status));
+    return status;
+  }
+
+perf_group_stop(&pg_proc);
 clock_gettime(CLOCK_REALTIME, &t_proc.t1);
 
 t_proc.t_meas = ((t_proc.t1.tv_sec - t_proc.t0.tv_sec) + (t_proc.t1.tv_nsec - t_proc.t0.tv_nsec)/1000000000.0)*1000.0;
@@ -209,6 +233,30 @@ t_memcpy_out.t_meas = ((t_memcpy_out.t1.tv_sec - t_memcpy_out.t0.tv_sec) + (t_me
 
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+  printf("\n|-----------|\n");
+  printf("| Checksum. |");
+  printf("\n|-----------|\n\n");
+
+  /* Spot check - sampled entries against a plain dot product. */
+
+  int err_cnt = 0;
+
+  for (int s = 0; s < 256; s++) {
+    unsigned i = rand() % height;
+    unsigned j = rand() % width;
+    uint32_t ref = 0;
+    for (unsigned k = 0; k < width; k++)
+      ref += l3_in1[i * width + k] * l3_in2[j * width + k];
+    if (l3_test[i * width + j] != ref) err_cnt++;
+  }
+
+  if (err_cnt)
+    printf("Post-computation checksum... %d mismatches!\n", err_cnt);
+  else
+    printf("Post-computation checksum... Checksum completed SUCCESFULLY!\n");
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
   printf("\n|---------|\n");
   printf("| Cleanup. |");
   printf("\n|---------|\n\n");
@@ -243,8 +291,15 @@ t_clean.t_meas = ((t_clean.t1.tv_sec - t_clean.t0.tv_sec) + (t_clean.t1.tv_nsec
   printf("\n  - Memcpy to CMA:\n");
   printf("  -     - Execution time (ms):    %.3f ms\n", t_memcpy_in.t_meas );
 
-  printf("\n  - Host execution:\n");
+  printf("\n  - Host execution (%s, %d threads):\n",
+    mmult_sw_names[algo], algo == MMULT_NAIVE ? 1 : n_threads);
+  if (algo == MMULT_STRASSEN)
+    printf("  -     - Strassen cutoff:        %u\n", cutoff );
   printf("  -     - Execution time (ms):    %.3f ms\n", t_proc.t_meas );
+  printf("  -     - Throughput (GOPS):      %.3f\n", 2.0 * width * width * height / (t_proc.t_meas * 1e6) );
+  // Compulsory DRAM traffic: in1, in2 read, out read-modify-write.
+  perf_group_print(&pg_proc, 4.0 * width * height * sizeof(uint32_t));
+  perf_group_close(&pg_proc);
 
   printf("\n  - Memcpy from CMA:\n");
   printf("  -     - Execution time (ms):    %.3f ms\n", t_memcpy_out.t_meas );
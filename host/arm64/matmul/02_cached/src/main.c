@@ -28,17 +28,124 @@
 /* Include host timer struct. */
 #include <arm-bench.h>
 
-/* Host matrix multiplication. */
+/* Include host matrix multiplication. */
+#include <mmult_sw.h>
 
-void mmult_sw(uint32_t* in1, uint32_t* in2, uint32_t* out, uint32_t mat_dim, uint32_t stripe_height)
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/*
+ *
+ *     HOST processor - Strassen crossover.
+ *
+ */
+
+/*
+ * Blocked vs. one Strassen-Winograd level (cutoff n / 2) over growing sizes,
+ * best of a few runs each. The first size from which Strassen stays ahead
+ * is the crossover, MMULT_STRASSEN_CUTOFF should sit just below it.
+ */
+
+static float run_ms(const uint32_t* in1, const uint32_t* in2, uint32_t* out,
+  unsigned n, int algo, int n_threads, int reps)
+{
+  timer_host t;
+  float best = 0;
+
+  for (int r = 0; r < reps; r++) {
+    memset(out, 0, n * n * sizeof(uint32_t));
+
+clock_gettime(CLOCK_REALTIME, &t.t0);
+
+    if (algo == MMULT_STRASSEN)
+      mmult_sw_strassen(in1, in2, out, n, n / 2, n_threads);
+    else
+      mmult_sw_blocked(in1, in2, out, n, n_threads);
+
+clock_gettime(CLOCK_REALTIME, &t.t1);
+
+t.t_meas = ((t.t1.tv_sec - t.t0.tv_sec) + (t.t1.tv_nsec - t.t0.tv_nsec)/1000000000.0)*1000.0;
+
+    if (r == 0 || t.t_meas < best)
+      best = t.t_meas;
+  }
+
+  return best;
+}
+
+static int crossover(int n_threads)
 {
-  for (unsigned i = 0; i < mat_dim; i++){
-    for (unsigned j = 0; j < mat_dim; j++){
-      for (unsigned k = 0; k < mat_dim; k++){
-        out[i * mat_dim + j] += in1[i * mat_dim + k] * in2[j * mat_dim  + k];
-      }
+  static const unsigned sizes[] = { 128, 192, 256, 384, 512, 768, 1024, 1536, 2048 };
+  const int n_sizes = sizeof(sizes) / sizeof(sizes[0]);
+  const unsigned n_max = sizes[n_sizes - 1];
+
+  if (n_threads < 1 || n_threads > MMULT_MAX_THREADS) {
+    printf("ERROR: bad thread count %d\n", n_threads);
+    return -EINVAL;
+  }
+
+  uint32_t* in1     = (uint32_t*)malloc(n_max * n_max * sizeof(uint32_t));
+  uint32_t* in2     = (uint32_t*)malloc(n_max * n_max * sizeof(uint32_t));
+  uint32_t* out_blk = (uint32_t*)malloc(n_max * n_max * sizeof(uint32_t));
+  uint32_t* out_str = (uint32_t*)malloc(n_max * n_max * sizeof(uint32_t));
+
+  if ( (in1 == NULL) || (in2 == NULL) || (out_blk == NULL) || (out_str == NULL) ) {
+    printf("ERROR: malloc() failed!\n");
+    return -ENOMEM;
+  }
+
+  printf("\n|---------------------|\n");
+  printf("| Strassen crossover. |");
+  printf("\n|---------------------|\n\n");
+
+  printf("Worker threads        - %d        \n\n", n_threads);
+  printf("  %6s %14s %14s %8s\n", "size", "blocked (ms)", "strassen (ms)", "speedup");
+
+  int x_idx = -1;
+  int err_cnt = 0;
+
+  for (int s = 0; s < n_sizes; s++) {
+    const unsigned n = sizes[s];
+    const int reps = n <= 1024 ? 3 : 1;
+
+    for (unsigned i = 0; i < n * n; i++) {
+      in1[i] = rand() % 255;
+      in2[i] = rand() % 255;
+    }
+
+    const float t_blk = run_ms(in1, in2, out_blk, n, MMULT_BLOCKED, n_threads, reps);
+    const float t_str = run_ms(in1, in2, out_str, n, MMULT_STRASSEN, n_threads, reps);
+
+    if (memcmp(out_blk, out_str, n * n * sizeof(uint32_t)))
+      err_cnt++;
+
+    printf("  %6u %14.3f %14.3f %8.3f\n", n, t_blk, t_str, t_blk / t_str);
+
+    // Crossover - Strassen ahead from here on.
+    if (t_str < t_blk) {
+      if (x_idx < 0) x_idx = s;
+    } else {
+      x_idx = -1;
     }
   }
+
+  printf("\n");
+  if (x_idx < 0)
+    printf("Crossover: none up to %u, keep MMULT_STRASSEN_CUTOFF >= %u\n", n_max, n_max);
+  else
+    printf("Crossover: %u, i.e. MMULT_STRASSEN_CUTOFF ~ %u\n",
+      sizes[x_idx], x_idx ? sizes[x_idx - 1] : sizes[x_idx] / 2);
+
+  if (err_cnt)
+    printf("Blocked/Strassen comparison... %d mismatching sizes!\n", err_cnt);
+  else
+    printf("Blocked/Strassen comparison... Checksum completed SUCCESFULLY!\n");
+
+  free(in1);
+  free(in2);
+  free(out_blk);
+  free(out_str);
+
+  return err_cnt ? -EIO : 0;
 }
 
 /* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
@@ -60,6 +167,7 @@ int main(int argc, char *argv[])
   timer_host t_alloc;
   timer_host t_proc;
   timer_host t_clean;
+  perf_group pg_proc;
 
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -75,6 +183,29 @@ clock_gettime(CLOCK_REALTIME, &t_alloc.t0);
   unsigned height         = 512;
   unsigned stripe_height  = 8;
 
+  /* Algorithm - 'naive', 'blocked' (default) or 'strassen', worker threads, Strassen cutoff. */
+
+  int algo                = MMULT_BLOCKED;
+  int n_threads           = MMULT_MAX_THREADS;
+  unsigned cutoff         = MMULT_STRASSEN_CUTOFF;
+
+  if (argc > 2)
+    n_threads = atoi(argv[2]);
+  if (argc > 3)
+    cutoff = atoi(argv[3]);
+
+  if (argc > 1) {
+    if (!strcmp(argv[1], "crossover"))
+      return crossover(n_threads);
+    for (algo = 0; algo < MMULT_N_ALGOS; algo++)
+      if (!strcmp(argv[1], mmult_sw_names[algo]))
+        break;
+    if (algo == MMULT_N_ALGOS) {
+      printf("Usage: %s [naive|blocked|strassen|crossover] [n_threads] [cutoff]\n", argv[0]);
+      return -EINVAL;
+    }
+  }
+
   /* General. */
 
   int status;
@@ -132,18 +263,54 @@ t_alloc.t_meas = ((t_alloc.t1.tv_sec - t_alloc.t0.tv_sec) + (t_alloc.t1.tv_nsec
   printf("| Execute MMULT on ARM. |");
   printf("\n|------------------------|\n\n");
 
+  perf_group_open(&pg_proc);
+
 clock_gettime(CLOCK_REALTIME, &t_proc.t0);
+perf_group_start(&pg_proc);
 
   /* Execute hardware mmult on ARM. */
 
-  mmult_sw( l3_in1, l3_in2, l3_test, width, stripe_height);
+  if (algo == MMULT_STRASSEN)
+    status = mmult_sw_strassen( l3_in1, l3_in2, l3_test, width, cutoff, n_threads);
+  else
+    status = mmult_sw( l3_in1, l3_in2, l3_test, width, algo, n_threads);
 
+  if (status) {
+    printf("ERROR: mmult_sw() failed: %s\n", strerror(-status));
+    return status;
+  }
+
+perf_group_stop(&pg_proc);
 clock_gettime(CLOCK_REALTIME, &t_proc.t1);
 
 t_proc.t_meas = ((t_proc.t1.tv_sec - t_proc.t0.tv_sec) + (t_proc.t1.tv_nsec - t_proc.t0.tv_nsec)/1000000000.0)*1000.0;
 
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+  printf("\n|-----------|\n");
+  printf("| Checksum. |");
+  printf("\n|-----------|\n\n");
+
+  /* Spot check - sampled entries against a plain dot product. */
+
+  int err_cnt = 0;
+
+  for (int s = 0; s < 256; s++) {
+    unsigned i = rand() % height;
+    unsigned j = rand() % width;
+    uint32_t ref = 0;
+    for (unsigned k = 0; k < width; k++)
+      ref += l3_in1[i * width + k] * l3_in2[j * width + k];
+    if (l3_test[i * width + j] != ref) err_cnt++;
+  }
+
+  if (err_cnt)
+    printf("Post-computation checksum... %d mismatches!\n", err_cnt);
+  else
+    printf("Post-computation checksum... Checksum completed SUCCESFULLY!\n");
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
   printf("\n|---------|\n");
   printf("| Cleanup. |");
   printf("\n|---------|\n\n");
@@ -171,8 +338,15 @@ t_clean.t_meas = ((t_clean.t1.tv_sec - t_clean.t0.tv_sec) + (t_clean.t1.tv_nsec
   printf("\n  - I/O arrays allocation and initialization:\n");
   printf("  -     - Execution time (ms):    %.3f ms\n", t_alloc.t_meas );
 
-  printf("\n  - Host execution:\n");
+  printf("\n  - Host execution (%s, %d threads):\n",
+    mmult_sw_names[algo], algo == MMULT_NAIVE ? 1 : n_threads);
+  if (algo == MMULT_STRASSEN)
+    printf("  -     - Strassen cutoff:        %u\n", cutoff );
   printf("  -     - Execution time (ms):    %.3f ms\n", t_proc.t_meas );
+  printf("  -     - Throughput (GOPS):      %.3f\n", 2.0 * width * width * height / (t_proc.t_meas * 1e6) );
+  // Compulsory DRAM traffic: in1, in2 read, out read-modify-write.
+  perf_group_print(&pg_proc, 4.0 * width * height * sizeof(uint32_t));
+  perf_group_close(&pg_proc);
 
   printf("\n  - Cleaning:\n");
   printf("  -     - Execution time (ms):    %.3f ms\n", t_clean.t_meas );
@@ -0,0 +1,603 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Libraries. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define MMULT_SW_NEON 1
+#endif
+
+#include "mmult_sw.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/* Host matrix multiplication - naive. */
+
+void mmult_sw_naive(
+  const uint32_t* in1, const uint32_t* in2, uint32_t* out,
+  uint32_t mat_dim)
+{
+  for (unsigned i = 0; i < mat_dim; i++){
+    for (unsigned j = 0; j < mat_dim; j++){
+      for (unsigned k = 0; k < mat_dim; k++){
+        out[i * mat_dim + j] += in1[i * mat_dim + k] * in2[j * mat_dim  + k];
+      }
+    }
+  }
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/*
+ * Packing - operands are copied into contiguous micro-panels, so that the
+ * micro-kernel streams both of them with unit stride. Panels are padded
+ * with zeros up to MR (NR) rows, edge tiles need no special kernel.
+ */
+
+/* in1 rows [i0, i0 + mc), cols [p0, p0 + kc) -> panels of MR rows, [k][MR]. */
+
+static void pack_in1(
+  const uint32_t* in1, uint32_t ld, int i0, int mc, int p0, int kc,
+  uint32_t* dst)
+{
+  for (int ip = 0; ip < mc; ip += MMULT_MR){
+    for (int r = 0; r < MMULT_MR; r++){
+      if (ip + r < mc){
+        const uint32_t* src = in1 + (size_t)(i0 + ip + r) * ld + p0;
+        for (int k = 0; k < kc; k++)
+          dst[k * MMULT_MR + r] = src[k];
+      } else {
+        for (int k = 0; k < kc; k++)
+          dst[k * MMULT_MR + r] = 0;
+      }
+    }
+    dst += kc * MMULT_MR;
+  }
+}
+
+/* in2 rows (out cols) [j0, j0 + NR), cols [p0, p0 + kc) -> one panel, [k][NR]. */
+
+static void pack_in2_panel(
+  const uint32_t* in2, uint32_t ld, int j0, int nr, int p0, int kc,
+  uint32_t* dst)
+{
+  for (int c = 0; c < MMULT_NR; c++){
+    if (c < nr){
+      const uint32_t* src = in2 + (size_t)(j0 + c) * ld + p0;
+      for (int k = 0; k < kc; k++)
+        dst[k * MMULT_NR + c] = src[k];
+    } else {
+      for (int k = 0; k < kc; k++)
+        dst[k * MMULT_NR + c] = 0;
+    }
+  }
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/*
+ * Micro-kernel - C[MR][NR] += A_panel * B_panel over kc, the C tile held in
+ * registers for the whole panel, i.e. 2 * MR * NR ops per MR + NR loads.
+ */
+
+static void kernel_8x8(
+  int kc, const uint32_t* a, const uint32_t* b,
+  uint32_t* c, int ldc)
+{
+#ifdef MMULT_SW_NEON
+  uint32x4_t c00 = vld1q_u32(c + 0 * ldc), c01 = vld1q_u32(c + 0 * ldc + 4);
+  uint32x4_t c10 = vld1q_u32(c + 1 * ldc), c11 = vld1q_u32(c + 1 * ldc + 4);
+  uint32x4_t c20 = vld1q_u32(c + 2 * ldc), c21 = vld1q_u32(c + 2 * ldc + 4);
+  uint32x4_t c30 = vld1q_u32(c + 3 * ldc), c31 = vld1q_u32(c + 3 * ldc + 4);
+  uint32x4_t c40 = vld1q_u32(c + 4 * ldc), c41 = vld1q_u32(c + 4 * ldc + 4);
+  uint32x4_t c50 = vld1q_u32(c + 5 * ldc), c51 = vld1q_u32(c + 5 * ldc + 4);
+  uint32x4_t c60 = vld1q_u32(c + 6 * ldc), c61 = vld1q_u32(c + 6 * ldc + 4);
+  uint32x4_t c70 = vld1q_u32(c + 7 * ldc), c71 = vld1q_u32(c + 7 * ldc + 4);
+
+  for (int k = 0; k < kc; k++){
+    uint32x4_t a0 = vld1q_u32(a), a1 = vld1q_u32(a + 4);
+    uint32x4_t b0 = vld1q_u32(b), b1 = vld1q_u32(b + 4);
+
+    c00 = vmlaq_laneq_u32(c00, b0, a0, 0); c01 = vmlaq_laneq_u32(c01, b1, a0, 0);
+    c10 = vmlaq_laneq_u32(c10, b0, a0, 1); c11 = vmlaq_laneq_u32(c11, b1, a0, 1);
+    c20 = vmlaq_laneq_u32(c20, b0, a0, 2); c21 = vmlaq_laneq_u32(c21, b1, a0, 2);
+    c30 = vmlaq_laneq_u32(c30, b0, a0, 3); c31 = vmlaq_laneq_u32(c31, b1, a0, 3);
+    c40 = vmlaq_laneq_u32(c40, b0, a1, 0); c41 = vmlaq_laneq_u32(c41, b1, a1, 0);
+    c50 = vmlaq_laneq_u32(c50, b0, a1, 1); c51 = vmlaq_laneq_u32(c51, b1, a1, 1);
+    c60 = vmlaq_laneq_u32(c60, b0, a1, 2); c61 = vmlaq_laneq_u32(c61, b1, a1, 2);
+    c70 = vmlaq_laneq_u32(c70, b0, a1, 3); c71 = vmlaq_laneq_u32(c71, b1, a1, 3);
+
+    a += MMULT_MR;
+    b += MMULT_NR;
+  }
+
+  vst1q_u32(c + 0 * ldc, c00); vst1q_u32(c + 0 * ldc + 4, c01);
+  vst1q_u32(c + 1 * ldc, c10); vst1q_u32(c + 1 * ldc + 4, c11);
+  vst1q_u32(c + 2 * ldc, c20); vst1q_u32(c + 2 * ldc + 4, c21);
+  vst1q_u32(c + 3 * ldc, c30); vst1q_u32(c + 3 * ldc + 4, c31);
+  vst1q_u32(c + 4 * ldc, c40); vst1q_u32(c + 4 * ldc + 4, c41);
+  vst1q_u32(c + 5 * ldc, c50); vst1q_u32(c + 5 * ldc + 4, c51);
+  vst1q_u32(c + 6 * ldc, c60); vst1q_u32(c + 6 * ldc + 4, c61);
+  vst1q_u32(c + 7 * ldc, c70); vst1q_u32(c + 7 * ldc + 4, c71);
+#else
+  uint32_t acc[MMULT_MR][MMULT_NR];
+
+  for (int r = 0; r < MMULT_MR; r++)
+    for (int j = 0; j < MMULT_NR; j++)
+      acc[r][j] = c[r * ldc + j];
+
+  for (int k = 0; k < kc; k++){
+    for (int r = 0; r < MMULT_MR; r++)
+      for (int j = 0; j < MMULT_NR; j++)
+        acc[r][j] += a[r] * b[j];
+    a += MMULT_MR;
+    b += MMULT_NR;
+  }
+
+  for (int r = 0; r < MMULT_MR; r++)
+    for (int j = 0; j < MMULT_NR; j++)
+      c[r * ldc + j] = acc[r][j];
+#endif
+}
+
+/* Macro-kernel - packed MC x KC block of in1 times packed KC x NC block of in2. */
+
+static void macro_kernel(
+  int mc, int nc, int kc,
+  const uint32_t* a_pack, const uint32_t* b_pack,
+  uint32_t* c, uint32_t ldc)
+{
+  uint32_t tile[MMULT_MR * MMULT_NR];
+
+  for (int jr = 0; jr < nc; jr += MMULT_NR){
+    const int nr = MIN(MMULT_NR, nc - jr);
+    const uint32_t* b = b_pack + (size_t)jr * kc;
+
+    for (int ir = 0; ir < mc; ir += MMULT_MR){
+      const int mr = MIN(MMULT_MR, mc - ir);
+      const uint32_t* a = a_pack + (size_t)ir * kc;
+      uint32_t* c_tile = c + (size_t)ir * ldc + jr;
+
+      if (mr == MMULT_MR && nr == MMULT_NR){
+        kernel_8x8(kc, a, b, c_tile, ldc);
+      } else {
+        // Edge tile - compute into a scratch tile, add the valid part.
+        memset(tile, 0, sizeof(tile));
+        kernel_8x8(kc, a, b, tile, MMULT_NR);
+        for (int r = 0; r < mr; r++)
+          for (int j = 0; j < nr; j++)
+            c_tile[r * ldc + j] += tile[r * MMULT_NR + j];
+      }
+    }
+  }
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/* Host matrix multiplication - blocked, multithreaded. */
+
+/*
+ * Packing buffer - the shared in2 block, then one in1 block per thread, each
+ * rounded up to whole panels. In words.
+ */
+
+#define MMULT_A_PACK_LEN ((size_t)(MMULT_MC + MMULT_MR) * MMULT_KC)
+#define MMULT_B_PACK_LEN ((size_t)(MMULT_NC + MMULT_NR) * MMULT_KC)
+#define MMULT_PACK_LEN   (MMULT_B_PACK_LEN + MMULT_MAX_THREADS * MMULT_A_PACK_LEN)
+
+/*
+ * Worker pool - started once per top-level call and fed one GEMM (job) at a
+ * time, so that the Strassen leaves do not create threads nor barriers.
+ */
+
+typedef struct mmult_job {
+  const uint32_t* in1;
+  const uint32_t* in2;
+  uint32_t* out;
+  uint32_t lda, ldb, ldc;       // row strides of in1, in2, out
+  uint32_t n;
+} mmult_job;
+
+typedef struct mmult_pool mmult_pool;
+
+typedef struct mmult_task {
+  mmult_pool* pool;
+  int tid;
+  uint32_t* a_pack;             // private, MC x KC
+} mmult_task;
+
+struct mmult_pool {
+  mmult_job job;
+  uint32_t* b_pack;             // shared, KC x NC
+  int n_threads;                // started, the calling thread is worker 0
+  pthread_barrier_t barrier;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  unsigned gen;                 // bumped for every job
+  int quit;
+  pthread_t threads[MMULT_MAX_THREADS];
+  mmult_task tasks[MMULT_MAX_THREADS];
+};
+
+static void mmult_gemm(const mmult_task* t)
+{
+  mmult_pool* p = t->pool;
+  const mmult_job* job = &p->job;
+  const int n = (int)job->n;
+
+  /*
+   * Loop order (outer to inner): NC columns, KC depth, MC rows, then the
+   * NR x MR register tiles. For each (jc, pc), the threads pack the shared
+   * in2 block NR-panel by NR-panel round-robin, synchronize, then each
+   * multiplies its own MC-row blocks against it. The second barrier keeps
+   * the block alive until everyone is done with it.
+   */
+
+  for (int jc = 0; jc < n; jc += MMULT_NC){
+    const int nc = MIN(MMULT_NC, n - jc);
+
+    for (int pc = 0; pc < n; pc += MMULT_KC){
+      const int kc = MIN(MMULT_KC, n - pc);
+
+      for (int jr = t->tid * MMULT_NR; jr < nc; jr += p->n_threads * MMULT_NR)
+        pack_in2_panel(job->in2, job->ldb, jc + jr, MIN(MMULT_NR, nc - jr), pc, kc,
+          p->b_pack + (size_t)jr * kc);
+
+      pthread_barrier_wait(&p->barrier);
+
+      for (int ic = t->tid * MMULT_MC; ic < n; ic += p->n_threads * MMULT_MC){
+        const int mc = MIN(MMULT_MC, n - ic);
+
+        pack_in1(job->in1, job->lda, ic, mc, pc, kc, t->a_pack);
+        macro_kernel(mc, nc, kc, t->a_pack, p->b_pack,
+          job->out + (size_t)ic * job->ldc + jc, job->ldc);
+      }
+
+      pthread_barrier_wait(&p->barrier);
+    }
+  }
+}
+
+static void* mmult_worker(void* arg)
+{
+  const mmult_task* t = (const mmult_task*)arg;
+  mmult_pool* p = t->pool;
+  unsigned seen = 0;
+
+  for (;;){
+    pthread_mutex_lock(&p->lock);
+    while (p->gen == seen && !p->quit)
+      pthread_cond_wait(&p->cond, &p->lock);
+    seen = p->gen;
+    const int quit = p->quit;
+    pthread_mutex_unlock(&p->lock);
+
+    if (quit)
+      return NULL;
+
+    // Closing barrier: no one is left in a job when the next one is posted.
+    mmult_gemm(t);
+    pthread_barrier_wait(&p->barrier);
+  }
+}
+
+static void mmult_pool_start(mmult_pool* p, int n_threads, uint32_t* pack)
+{
+  int n_started = 1;
+
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->cond, NULL);
+  p->gen = 0;
+  p->quit = 0;
+  p->b_pack = pack;
+
+  for (int t = 0; t < n_threads; t++){
+    p->tasks[t].pool   = p;
+    p->tasks[t].tid    = t;
+    p->tasks[t].a_pack = pack + MMULT_B_PACK_LEN + t * MMULT_A_PACK_LEN;
+  }
+
+  // Calling thread is worker 0. If thread creation fails, the work is
+  // split over the threads that did start. Workers read the thread count
+  // only once the first job is posted.
+  for (; n_started < n_threads; n_started++)
+    if (pthread_create(&p->threads[n_started], NULL, mmult_worker, &p->tasks[n_started]))
+      break;
+
+  p->n_threads = n_started;
+  pthread_barrier_init(&p->barrier, NULL, n_started);
+}
+
+static void mmult_pool_stop(mmult_pool* p)
+{
+  pthread_mutex_lock(&p->lock);
+  p->quit = 1;
+  pthread_cond_broadcast(&p->cond);
+  pthread_mutex_unlock(&p->lock);
+
+  for (int t = 1; t < p->n_threads; t++)
+    pthread_join(p->threads[t], NULL);
+
+  pthread_barrier_destroy(&p->barrier);
+  pthread_cond_destroy(&p->cond);
+  pthread_mutex_destroy(&p->lock);
+}
+
+/* Blocked GEMM on mat_dim x mat_dim sub-matrices of larger row-major arrays. */
+
+static void mmult_blocked_ld(
+  mmult_pool* p,
+  const uint32_t* in1, uint32_t lda, const uint32_t* in2, uint32_t ldb,
+  uint32_t* out, uint32_t ldc, uint32_t mat_dim)
+{
+  pthread_mutex_lock(&p->lock);
+  p->job.in1 = in1;
+  p->job.in2 = in2;
+  p->job.out = out;
+  p->job.lda = lda;
+  p->job.ldb = ldb;
+  p->job.ldc = ldc;
+  p->job.n   = mat_dim;
+  p->gen++;
+  pthread_cond_broadcast(&p->cond);
+  pthread_mutex_unlock(&p->lock);
+
+  mmult_gemm(&p->tasks[0]);
+  pthread_barrier_wait(&p->barrier);
+}
+
+int mmult_sw_blocked(
+  const uint32_t* in1, const uint32_t* in2, uint32_t* out,
+  uint32_t mat_dim, int n_threads)
+{
+  uint32_t* pack = NULL;
+  mmult_pool pool;
+
+  if (n_threads < 1 || n_threads > MMULT_MAX_THREADS)
+    return -EINVAL;
+
+  if (posix_memalign((void**)&pack, 64, MMULT_PACK_LEN * sizeof(uint32_t)))
+    return -ENOMEM;
+
+  mmult_pool_start(&pool, n_threads, pack);
+  mmult_blocked_ld(&pool, in1, mat_dim, in2, mat_dim, out, mat_dim, mat_dim);
+  mmult_pool_stop(&pool);
+
+  free(pack);
+  return 0;
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/*
+ * Host matrix multiplication - Strassen-Winograd.
+ *
+ * With B = in2^T, the quadrants of B are the transposed quadrants of in2,
+ * B11 = in2_11^T, B12 = in2_21^T, B21 = in2_12^T, B22 = in2_22^T, and sums
+ * of B quadrants are sums of in2 quadrants transposed. The recursion thus
+ * stays in the out += in1 * in2^T form all the way down to the blocked
+ * kernel. Winograd's variant, 7 products and 15 additions per level:
+ *
+ *   S1 = A21 + A22   T1 = B12 - B11   P1 = A11 B11   P5 = S1 T1
+ *   S2 = S1 - A11    T2 = B22 - T1    P2 = A12 B21   P6 = S2 T2
+ *   S3 = A11 - A21   T3 = B22 - B12   P3 = S4 B22    P7 = S3 T3
+ *   S4 = A12 - S2    T4 = T2 - B21    P4 = A22 T4
+ *
+ *   C11 += P1 + P2            C21 += P1 + P6 + P7 - P4
+ *   C12 += P1 + P6 + P5 + P3  C22 += P1 + P6 + P7 + P5
+ *
+ * Each level uses three h x h temporaries X, Y, Z out of the workspace,
+ * deeper levels take the rest of it. The leaves share one packing buffer
+ * and one worker pool, so the whole recursion runs without allocating nor
+ * creating threads. Arithmetic is modulo 2^32, so the
+ * result is bit-exact with the other algorithms.
+ */
+
+static void mat_add(
+  uint32_t* dst, uint32_t ldd, const uint32_t* a, uint32_t lda,
+  const uint32_t* b, uint32_t ldb, uint32_t h)
+{
+  for (uint32_t i = 0; i < h; i++)
+    for (uint32_t j = 0; j < h; j++)
+      dst[(size_t)i * ldd + j] = a[(size_t)i * lda + j] + b[(size_t)i * ldb + j];
+}
+
+static void mat_sub(
+  uint32_t* dst, uint32_t ldd, const uint32_t* a, uint32_t lda,
+  const uint32_t* b, uint32_t ldb, uint32_t h)
+{
+  for (uint32_t i = 0; i < h; i++)
+    for (uint32_t j = 0; j < h; j++)
+      dst[(size_t)i * ldd + j] = a[(size_t)i * lda + j] - b[(size_t)i * ldb + j];
+}
+
+static void mat_acc(
+  uint32_t* dst, uint32_t ldd, const uint32_t* a, uint32_t lda, uint32_t h)
+{
+  for (uint32_t i = 0; i < h; i++)
+    for (uint32_t j = 0; j < h; j++)
+      dst[(size_t)i * ldd + j] += a[(size_t)i * lda + j];
+}
+
+static void strassen_rec(
+  const uint32_t* a, uint32_t lda, const uint32_t* b, uint32_t ldb,
+  uint32_t* c, uint32_t ldc, uint32_t n, uint32_t cutoff,
+  mmult_pool* pool, uint32_t* ws)
+{
+  if (n <= cutoff){
+    mmult_blocked_ld(pool, a, lda, b, ldb, c, ldc, n);
+    return;
+  }
+
+  // Odd size - recurse on the even part, peel the last row, column and
+  // k index below.
+  const uint32_t m = n & ~1u;
+  const uint32_t h = m / 2;
+
+  const uint32_t* a11 = a;
+  const uint32_t* a12 = a + h;
+  const uint32_t* a21 = a + (size_t)h * lda;
+  const uint32_t* a22 = a + (size_t)h * lda + h;
+  const uint32_t* b11 = b;
+  const uint32_t* b12 = b + h;
+  const uint32_t* b21 = b + (size_t)h * ldb;
+  const uint32_t* b22 = b + (size_t)h * ldb + h;
+  uint32_t* c11 = c;
+  uint32_t* c12 = c + h;
+  uint32_t* c21 = c + (size_t)h * ldc;
+  uint32_t* c22 = c + (size_t)h * ldc + h;
+
+  uint32_t* x = ws;
+  uint32_t* y = ws + (size_t)h * h;
+  uint32_t* z = ws + (size_t)2 * h * h;
+  uint32_t* ws_next = ws + (size_t)3 * h * h;
+
+#define STRASSEN_MUL(A, LDA, B, LDB, C, LDC) \
+  strassen_rec(A, LDA, B, LDB, C, LDC, h, cutoff, pool, ws_next)
+
+  // Z = P1, C11 += P1 + P2.
+  memset(z, 0, (size_t)h * h * sizeof(uint32_t));
+  STRASSEN_MUL(a11, lda, b11, ldb, z, h);
+  mat_acc(c11, ldc, z, h, h);
+  STRASSEN_MUL(a12, lda, b12, ldb, c11, ldc);
+
+  // Z = P1 + P6, into C12.
+  mat_add(x, h, a21, lda, a22, lda, h);   // S1
+  mat_sub(y, h, b21, ldb, b11, ldb, h);   // T1^T
+  mat_sub(x, h, x, h, a11, lda, h);       // S2
+  mat_sub(y, h, b22, ldb, y, h, h);       // T2^T
+  STRASSEN_MUL(x, h, y, h, z, h);
+  mat_acc(c12, ldc, z, h, h);
+
+  // C21 -= P4, C12 += P3.
+  mat_sub(y, h, b12, ldb, y, h, h);       // -T4^T
+  STRASSEN_MUL(a22, lda, y, h, c21, ldc);
+  mat_sub(x, h, a12, lda, x, h, h);       // S4
+  STRASSEN_MUL(x, h, b22, ldb, c12, ldc);
+
+  // Z = P1 + P6 + P7, into C21 and C22.
+  mat_sub(x, h, a11, lda, a21, lda, h);   // S3
+  mat_sub(y, h, b22, ldb, b21, ldb, h);   // T3^T
+  STRASSEN_MUL(x, h, y, h, z, h);
+  mat_acc(c21, ldc, z, h, h);
+  mat_acc(c22, ldc, z, h, h);
+
+  // Z = P5, into C12 and C22.
+  mat_add(x, h, a21, lda, a22, lda, h);   // S1
+  mat_sub(y, h, b21, ldb, b11, ldb, h);   // T1^T
+  memset(z, 0, (size_t)h * h * sizeof(uint32_t));
+  STRASSEN_MUL(x, h, y, h, z, h);
+  mat_acc(c12, ldc, z, h, h);
+  mat_acc(c22, ldc, z, h, h);
+
+#undef STRASSEN_MUL
+
+  if (m == n)
+    return;
+
+  // Peeling - last k index over the even part, then last column and row.
+  for (uint32_t i = 0; i < m; i++){
+    const uint32_t aik = a[(size_t)i * lda + m];
+    for (uint32_t j = 0; j < m; j++)
+      c[(size_t)i * ldc + j] += aik * b[(size_t)j * ldb + m];
+  }
+  for (uint32_t i = 0; i < n; i++){
+    uint32_t acc = 0;
+    for (uint32_t k = 0; k < n; k++)
+      acc += a[(size_t)i * lda + k] * b[(size_t)m * ldb + k];
+    c[(size_t)i * ldc + m] += acc;
+  }
+  for (uint32_t j = 0; j < m; j++){
+    uint32_t acc = 0;
+    for (uint32_t k = 0; k < n; k++)
+      acc += a[(size_t)m * lda + k] * b[(size_t)j * ldb + k];
+    c[(size_t)m * ldc + j] += acc;
+  }
+}
+
+size_t mmult_sw_strassen_ws_size(uint32_t mat_dim, uint32_t cutoff)
+{
+  size_t len = MMULT_PACK_LEN;
+
+  if (cutoff < 1)
+    return 0;
+
+  for (uint32_t n = mat_dim; n > cutoff; n /= 2)
+    len += (size_t)3 * (n / 2) * (n / 2);
+
+  return len * sizeof(uint32_t);
+}
+
+int mmult_sw_strassen_buf(
+  const uint32_t* in1, const uint32_t* in2, uint32_t* out,
+  uint32_t mat_dim, uint32_t cutoff, int n_threads, uint32_t* ws)
+{
+  mmult_pool pool;
+
+  if (cutoff < 1 || n_threads < 1 || n_threads > MMULT_MAX_THREADS)
+    return -EINVAL;
+
+  // Packing buffer first, the recursion temporaries after it.
+  mmult_pool_start(&pool, n_threads, ws);
+  strassen_rec(in1, mat_dim, in2, mat_dim, out, mat_dim,
+    mat_dim, cutoff, &pool, ws + MMULT_PACK_LEN);
+  mmult_pool_stop(&pool);
+  return 0;
+}
+
+int mmult_sw_strassen(
+  const uint32_t* in1, const uint32_t* in2, uint32_t* out,
+  uint32_t mat_dim, uint32_t cutoff, int n_threads)
+{
+  uint32_t* ws = NULL;
+  int ret;
+
+  if (cutoff < 1)
+    return -EINVAL;
+
+  if (posix_memalign((void**)&ws, 64, mmult_sw_strassen_ws_size(mat_dim, cutoff)))
+    return -ENOMEM;
+
+  ret = mmult_sw_strassen_buf(in1, in2, out, mat_dim, cutoff, n_threads, ws);
+
+  free(ws);
+  return ret;
+}
+
+/* Host matrix multiplication. */
+
+int mmult_sw(
+  const uint32_t* in1, const uint32_t* in2, uint32_t* out,
+  uint32_t mat_dim, int algo, int n_threads)
+{
+  switch (algo){
+  case MMULT_NAIVE:
+    mmult_sw_naive(in1, in2, out, mat_dim);
+    return 0;
+  case MMULT_BLOCKED:
+    return mmult_sw_blocked(in1, in2, out, mat_dim, n_threads);
+  case MMULT_STRASSEN:
+    return mmult_sw_strassen(in1, in2, out, mat_dim, MMULT_STRASSEN_CUTOFF, n_threads);
+  default:
+    return -EINVAL;
+  }
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MMULT_SW_H_
+#define MMULT_SW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Host matrix multiplication - out += in1 * in2^T, square mat_dim x mat_dim
+ * row-major matrices, i.e. in2 holds the columns of the right operand as
+ * rows, the same layout the accelerators are fed with. Arithmetic is
+ * modulo 2^32.
+ */
+
+/* Algorithms. */
+
+#define MMULT_NAIVE   0 // textbook ijk triple loop
+#define MMULT_BLOCKED 1 // packed panels, register-blocked micro-kernel
+#define MMULT_STRASSEN 2 // Strassen-Winograd recursion over MMULT_BLOCKED
+#define MMULT_N_ALGOS  3
+
+static const char * const mmult_sw_names[MMULT_N_ALGOS] = {
+  "naive", "blocked", "strassen"
+};
+
+/*
+ * Blocking parameters (Cortex-A53: 32 KB L1D per core, 1 MB shared L2).
+ *  - MR x NR: register tile of the micro-kernel, i.e. 16 NEON accumulators.
+ *  - KC: depth of a packed block, a KC x NR panel of in2 (8 KB) stays in L1.
+ *  - MC: rows of in1 packed per block, i.e. MC x KC (64 KB) per thread in L2.
+ *  - NC: columns of in2 packed per block, i.e. KC x NC (256 KB) shared in L2.
+ */
+
+#define MMULT_MR 8
+#define MMULT_NR 8
+
+#ifndef MMULT_KC
+#define MMULT_KC 256
+#endif
+#ifndef MMULT_MC
+#define MMULT_MC 64
+#endif
+#ifndef MMULT_NC
+#define MMULT_NC 256
+#endif
+
+/*
+ * Strassen-Winograd cutoff - sizes up to it go to the blocked kernel. Each
+ * level above saves 1/8 of the multiplications for 15 h x h additions, so
+ * it only pays once the blocked kernel is compute bound; see the
+ * 'crossover' mode of the matmul apps to tune it.
+ */
+
+#ifndef MMULT_STRASSEN_CUTOFF
+#define MMULT_STRASSEN_CUTOFF 256
+#endif
+
+/* Upper bound on worker threads, i.e. the A53 cluster. */
+
+#define MMULT_MAX_THREADS 4
+
+void mmult_sw_naive(
+  const uint32_t* in1, const uint32_t* in2, uint32_t* out,
+  uint32_t mat_dim);
+
+/*
+ * Blocked GEMM over n_threads threads (1..MMULT_MAX_THREADS): the packed
+ * in2 block is shared, MC-row blocks of in1 are distributed round-robin.
+ *
+ * Returns 0 on success, -EINVAL on a bad thread count, -ENOMEM if the
+ * packing buffers cannot be allocated. If fewer threads can be created,
+ * the work is split over those that did start.
+ */
+
+int mmult_sw_blocked(
+  const uint32_t* in1, const uint32_t* in2, uint32_t* out,
+  uint32_t mat_dim, int n_threads);
+
+/*
+ * Strassen-Winograd over the blocked kernel (n_threads threads per leaf
+ * product), recursing while the size is above cutoff (>= 1). Odd sizes are
+ * peeled. Same return values as mmult_sw_blocked.
+ */
+
+int mmult_sw_strassen(
+  const uint32_t* in1, const uint32_t* in2, uint32_t* out,
+  uint32_t mat_dim, uint32_t cutoff, int n_threads);
+
+/*
+ * Same as mmult_sw_strassen, with a caller-owned workspace of at least
+ * mmult_sw_strassen_ws_size(mat_dim, cutoff) bytes, 64 B aligned, e.g. to
+ * keep it allocated across calls: the packing buffers plus under mat_dim^2
+ * words of temporaries. Never returns -ENOMEM.
+ */
+
+size_t mmult_sw_strassen_ws_size(uint32_t mat_dim, uint32_t cutoff);
+
+int mmult_sw_strassen_buf(
+  const uint32_t* in1, const uint32_t* in2, uint32_t* out,
+  uint32_t mat_dim, uint32_t cutoff, int n_threads, uint32_t* ws);
+
+/*
+ * Dispatch on MMULT_NAIVE / MMULT_BLOCKED / MMULT_STRASSEN (with
+ * MMULT_STRASSEN_CUTOFF), n_threads ignored by the former.
+ */
+
+int mmult_sw(
+  const uint32_t* in1, const uint32_t* in2, uint32_t* out,
+  uint32_t mat_dim, int algo, int n_threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MMULT_SW_H_ not defined
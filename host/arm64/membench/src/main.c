@@ -0,0 +1,363 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+    Memory path microbenchmarks - raw bandwidth and latency of every buffer
+    type the host and accelerator apps use (see arm-alloc.h), i.e. the
+    ceilings the measured kernels are to be compared against.
+
+    - STREAM copy, scale, add, triad: best of N_REPS, over n_threads.
+    - memcpy_in / memcpy_out: heap to backend and back, i.e. the copies of
+      the xilinx apps into and out of the CMA window when the backend is
+      devmem_uncached (how they map it) or devmem_cached.
+    - chase: dependent loads over a random cyclic permutation of cache
+      lines, working set swept from 4 KB up to the array size.
+
+    Output is one CSV row per (backend, test[, working set]):
+        backend,test,bytes,threads,mb_per_s,ns_per_access
+    - bytes: bytes counted per repetition, reads plus writes (STREAM,
+      memcpy - twice the copy size), working set (chase).
+    - mb_per_s: STREAM accounting, i.e. reads plus writes, empty for chase.
+    - ns_per_access: chase only.
+*/
+
+/* Libraries. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+
+/* Include allocation backends. */
+#include <arm-alloc.h>
+
+#define N_REPS          10
+#define MAX_THREADS     4
+#define CACHE_LINE      64
+#define CHASE_MIN_BYTES (4 * 1024)
+#define CHASE_LOADS     (1 << 22)
+
+enum stream_op {
+  OP_COPY = 0,
+  OP_SCALE,
+  OP_ADD,
+  OP_TRIAD,
+  N_OPS
+};
+
+static const char * const op_names[N_OPS] = { "copy", "scale", "add", "triad" };
+
+/* Arrays touched per element - reads plus writes. */
+static const int op_arrays[N_OPS] = { 2, 2, 3, 3 };
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+static double now_ms(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+}
+
+/* STREAM kernels - one thread, elements [i0, i1). */
+
+struct stream_task {
+  int op;
+  double *a, *b, *c;
+  size_t i0, i1;
+};
+
+static void* stream_worker(void *arg)
+{
+  const struct stream_task *t = (const struct stream_task*)arg;
+  double * restrict a = t->a;
+  double * restrict b = t->b;
+  double * restrict c = t->c;
+  const double scalar = 3.0;
+
+  switch (t->op) {
+  case OP_COPY:
+    for (size_t i = t->i0; i < t->i1; i++) c[i] = a[i];
+    break;
+  case OP_SCALE:
+    for (size_t i = t->i0; i < t->i1; i++) b[i] = scalar * c[i];
+    break;
+  case OP_ADD:
+    for (size_t i = t->i0; i < t->i1; i++) c[i] = a[i] + b[i];
+    break;
+  case OP_TRIAD:
+    for (size_t i = t->i0; i < t->i1; i++) a[i] = b[i] + scalar * c[i];
+    break;
+  }
+  return NULL;
+}
+
+/* Run one STREAM op over n_threads, return the elapsed time in ms. */
+
+static double stream_run(int op, double *a, double *b, double *c, size_t n, int n_threads)
+{
+  struct stream_task tasks[MAX_THREADS];
+  pthread_t threads[MAX_THREADS];
+  int n_started = 1;
+
+  for (int t = 0; t < n_threads; t++) {
+    tasks[t].op = op;
+    tasks[t].a = a; tasks[t].b = b; tasks[t].c = c;
+    tasks[t].i0 = n * t / n_threads;
+    tasks[t].i1 = n * (t + 1) / n_threads;
+  }
+
+  double t0 = now_ms();
+
+  // Calling thread takes slice 0, a thread that fails to start is run
+  // inline afterwards.
+  for (; n_started < n_threads; n_started++)
+    if (pthread_create(&threads[n_started], NULL, stream_worker, &tasks[n_started]))
+      break;
+  stream_worker(&tasks[0]);
+  for (int t = n_started; t < n_threads; t++)
+    stream_worker(&tasks[t]);
+  for (int t = 1; t < n_started; t++)
+    pthread_join(threads[t], NULL);
+
+  return now_ms() - t0;
+}
+
+/*
+ * Pointer chase - each cache line of the working set holds the offset of
+ * the next one, lines linked in a single random cycle (Sattolo), so that
+ * neither the prefetcher nor MLP hide the latency.
+ */
+
+static double chase_run(uint8_t *buf, size_t ws_bytes)
+{
+  const size_t n_lines = ws_bytes / CACHE_LINE;
+  size_t *perm = (size_t*)malloc(n_lines * sizeof(size_t));
+  uint32_t lcg = 0x2468ace0;
+
+  if (perm == NULL)
+    return -1.0;
+
+  for (size_t i = 0; i < n_lines; i++)
+    perm[i] = i;
+  for (size_t i = n_lines - 1; i > 0; i--) {
+    lcg = lcg * 1664525 + 1013904223;
+    size_t j = (((uint64_t)lcg << 16) ^ (lcg >> 8)) % i;
+    size_t tmp = perm[i]; perm[i] = perm[j]; perm[j] = tmp;
+  }
+  for (size_t i = 0; i < n_lines; i++)
+    *(size_t*)(buf + i * CACHE_LINE) = perm[i] * CACHE_LINE;
+
+  free(perm);
+
+  // Warm up - one lap.
+  size_t off = 0;
+  for (size_t i = 0; i < n_lines; i++)
+    off = *(volatile size_t*)(buf + off);
+
+  double t0 = now_ms();
+  for (size_t i = 0; i < CHASE_LOADS; i++)
+    off = *(volatile size_t*)(buf + off);
+  double t_ms = now_ms() - t0;
+
+  // Keep the chain live.
+  if (off == (size_t)-1)
+    printf("%zu\n", off);
+
+  return t_ms * 1e6 / CHASE_LOADS;
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/*
+ * All tests over one backend: three arrays of array_bytes, carved
+ * consecutively out of the physical window at phys_base (/dev/mem only).
+ *
+ * Returns 0 on success, a negative errno if the backend is not available.
+ */
+
+static int bench_backend(int backend, size_t array_bytes, int n_threads, uint64_t phys_base, FILE *csv)
+{
+  const char *name = arm_mem_names[backend];
+  const size_t n = array_bytes / sizeof(double);
+  arm_buf bufs[3];
+  double best[N_OPS];
+  int status = 0;
+
+  for (int i = 0; i < 3; i++)
+    bufs[i].ptr = NULL;
+  for (int i = 0; i < 3 && !status; i++)
+    status = arm_buf_alloc(&bufs[i], backend, array_bytes, phys_base + i * array_bytes);
+
+  uint8_t *heap = (uint8_t*)malloc(array_bytes);
+  if (!status && heap == NULL)
+    status = -ENOMEM;
+  if (status)
+    goto free_bufs;
+
+  double *a = (double*)bufs[0].ptr;
+  double *b = (double*)bufs[1].ptr;
+  double *c = (double*)bufs[2].ptr;
+
+  /* STREAM. */
+
+  for (size_t i = 0; i < n; i++) {
+    a[i] = 1.0; b[i] = 2.0; c[i] = 0.0;
+  }
+
+  for (int op = 0; op < N_OPS; op++)
+    best[op] = 1e30;
+
+  for (int rep = 0; rep < N_REPS; rep++) {
+    for (int op = 0; op < N_OPS; op++) {
+      double t_ms = stream_run(op, a, b, c, n, n_threads);
+      if (t_ms < best[op]) best[op] = t_ms;
+    }
+  }
+
+  for (int op = 0; op < N_OPS; op++) {
+    double bytes = (double)op_arrays[op] * n * sizeof(double);
+    fprintf(csv, "%s,%s,%.0f,%d,%.1f,\n", name, op_names[op], bytes, n_threads, bytes / (best[op] * 1e3));
+  }
+
+  /* memcpy into and out of the backend. */
+
+  double best_in = 1e30, best_out = 1e30;
+  memset(heap, 0x5a, array_bytes);
+
+  for (int rep = 0; rep < N_REPS; rep++) {
+    double t0 = now_ms();
+    memcpy(bufs[0].ptr, heap, array_bytes);
+    double t1 = now_ms();
+    memcpy(heap, bufs[0].ptr, array_bytes);
+    double t2 = now_ms();
+    if (t1 - t0 < best_in) best_in = t1 - t0;
+    if (t2 - t1 < best_out) best_out = t2 - t1;
+  }
+
+  // Same accounting as STREAM copy: the copy size read plus written.
+  const double copy_bytes = 2.0 * array_bytes;
+  fprintf(csv, "%s,memcpy_in,%.0f,1,%.1f,\n", name, copy_bytes, copy_bytes / (best_in * 1e3));
+  fprintf(csv, "%s,memcpy_out,%.0f,1,%.1f,\n", name, copy_bytes, copy_bytes / (best_out * 1e3));
+
+  /* Pointer chase. */
+
+  for (size_t ws = CHASE_MIN_BYTES; ws <= array_bytes; ws *= 2) {
+    double ns = chase_run((uint8_t*)bufs[0].ptr, ws);
+    if (ns < 0) {
+      status = -ENOMEM;
+      break;
+    }
+    fprintf(csv, "%s,chase,%zu,1,,%.2f\n", name, ws, ns);
+  }
+
+  fflush(csv);
+
+free_bufs:
+  free(heap);
+  for (int i = 0; i < 3; i++)
+    arm_buf_free(&bufs[i]);
+
+  return status;
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+    "Usage: %s [-b backend[,backend...]] [-s array_kB] [-t n_threads]\n"
+    "          [-a phys_addr] [-o out.csv]\n"
+    "Backends:", prog);
+  for (int b = 0; b < ARM_MEM_N_BACKENDS; b++)
+    fprintf(stderr, " %s", arm_mem_names[b]);
+  fprintf(stderr, " (default: all)\n");
+}
+
+/*
+ *
+ *     HOST processor - Main program.
+ *
+ */
+
+int main(int argc, char *argv[])
+{
+  // 4 MB per array, i.e. 4x the A53 L2 - 12 MB out of the CMA window.
+  size_t array_bytes = 4 << 20;
+  int n_threads = 1;
+  uint64_t phys_base = CMA_ADDR;
+  int backends[ARM_MEM_N_BACKENDS];
+  int n_backends = 0;
+  const char *csv_path = "-";
+  int opt;
+
+  while ((opt = getopt(argc, argv, "b:s:t:a:o:")) != -1) {
+    switch (opt) {
+    case 'b':
+      for (char *name = strtok(optarg, ","); name; name = strtok(NULL, ",")) {
+        int b = arm_mem_backend_parse(name);
+        if (b < 0 || n_backends == ARM_MEM_N_BACKENDS) {
+          usage(argv[0]);
+          return -EINVAL;
+        }
+        backends[n_backends++] = b;
+      }
+      break;
+    case 's': array_bytes = (size_t)atoi(optarg) * 1024; break;
+    case 't': n_threads = atoi(optarg); break;
+    case 'a': phys_base = strtoull(optarg, NULL, 0); break;
+    case 'o': csv_path = optarg; break;
+    default:
+      usage(argv[0]);
+      return -EINVAL;
+    }
+  }
+
+  if (n_threads < 1 || n_threads > MAX_THREADS || array_bytes < CHASE_MIN_BYTES) {
+    usage(argv[0]);
+    return -EINVAL;
+  }
+
+  // Whole pages, so that the /dev/mem windows stay page aligned.
+  array_bytes = arm_mem_round(array_bytes, (size_t)sysconf(_SC_PAGESIZE));
+
+  if (!n_backends)
+    for (int b = 0; b < ARM_MEM_N_BACKENDS; b++)
+      backends[n_backends++] = b;
+
+  FILE *csv = strcmp(csv_path, "-") ? fopen(csv_path, "w") : stdout;
+  if (csv == NULL) {
+    fprintf(stderr, "Error: could not open file %s\n", csv_path);
+    return -1;
+  }
+
+  fprintf(csv, "backend,test,bytes,threads,mb_per_s,ns_per_access\n");
+
+  for (int i = 0; i < n_backends; i++) {
+    fprintf(stderr, "Running %s...\n", arm_mem_names[backends[i]]);
+    int status = bench_backend(backends[i], array_bytes, n_threads, phys_base, csv);
+    if (status)
+      fprintf(stderr, "  skipped: %s\n", strerror(-status));
+  }
+
+  if (csv != stdout) fclose(csv);
+
+  return 0;
+}
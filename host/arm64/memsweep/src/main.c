@@ -0,0 +1,409 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+    Memory-attribute sweep - runs the host matmul and convolution baselines
+    over buffers from every allocation backend of arm-alloc.h, i.e. heap,
+    hugepages, /dev/mem (cached and uncached) and a pinned stand-in for the
+    CMA region the accelerators share with the CPU.
+
+    Each run is split in three phases, each timed:
+    - init:     CPU writes the inputs, i.e. what precedes an offload.
+    - proc:     the kernel itself, inputs and outputs in backend memory.
+    - readback: CPU reads the outputs back (checksum), i.e. what follows
+                an offload.
+
+    Output is one CSV row per (backend, kernel):
+        backend,kernel,size,huge,init_ms,proc_ms,readback_ms,rate,rate_unit,ipc,dtlb_mpki,bytes_per_cycle,match
+    - huge: huge page backing obtained (hugepage backend), see arm-alloc.h.
+    - rate: GOPS for matmul, Mpixel/s for convolution.
+    - ipc, dtlb_mpki, bytes_per_cycle: from the HW counters, empty if not
+      available.
+    - match: output checksum equal to the malloc backend run.
+
+    TLB mode (-T) runs malloc against hugepage only and summarizes, per
+    kernel, dTLB misses and runtime with and without huge pages.
+*/
+
+/* Libraries. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+/* Include host timer struct and allocation backends. */
+#include <arm-bench.h>
+#include <arm-alloc.h>
+
+/* Include host kernels. */
+#include <mmult_sw.h>
+#include <convolution_sw.h>
+
+/* Kernels. */
+
+enum sweep_kernel {
+  K_MMULT_NAIVE = 0,
+  K_MMULT_BLOCKED,
+  K_CONV,
+  K_N_KERNELS
+};
+
+static const char * const kernel_names[K_N_KERNELS] = {
+  "mmult_naive", "mmult_blocked", "conv"
+};
+
+/* Sweep configuration. */
+
+struct sweep_cfg {
+  unsigned mat_dim;
+  unsigned width;
+  unsigned height;
+  int k;
+  int n_threads;
+  uint64_t phys_base;
+};
+
+/* Per-run results. */
+
+struct sweep_result {
+  uint64_t sum;         // output checksum
+  double proc_ms;
+  uint64_t dtlb;        // dTLB misses, valid if has_dtlb
+  int has_dtlb;
+  int huge;
+};
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+static double elapsed_ms(timer_host *t)
+{
+  t->t_meas = ((t->t1.tv_sec - t->t0.tv_sec) + (t->t1.tv_nsec - t->t0.tv_nsec)/1000000000.0)*1000.0;
+  return t->t_meas;
+}
+
+/*
+ * Run one kernel over one backend.
+ *
+ * Buffers are carved consecutively out of the physical window at
+ * phys_base, which only matters for the /dev/mem backends.
+ *
+ * Returns 0 on success, a negative errno if the backend is not available.
+ */
+
+static int sweep_run(
+  const struct sweep_cfg *cfg, int kernel, int backend,
+  struct sweep_result *res, FILE *csv, uint64_t ref_sum, int has_ref)
+{
+  const int is_mmult = kernel != K_CONV;
+  const size_t in_len = is_mmult ?
+    (size_t)cfg->mat_dim * cfg->mat_dim : (size_t)cfg->width * cfg->height;
+  const size_t in_bytes = in_len * sizeof(uint32_t);
+  const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+  // mmult: in1, in2, out - conv: src, dst
+  const int n_bufs = is_mmult ? 3 : 2;
+  arm_buf bufs[3];
+  uint64_t phys = cfg->phys_base;
+  int status = 0;
+
+  timer_host t_init, t_proc, t_read;
+  perf_group pg_proc;
+
+  for (int i = 0; i < n_bufs; i++)
+    bufs[i].ptr = NULL;
+  for (int i = 0; i < PERF_N_COUNTERS; i++)
+    pg_proc.fd[i] = -1;
+
+  for (int i = 0; i < n_bufs && !status; i++) {
+    status = arm_buf_alloc(&bufs[i], backend, in_bytes, phys);
+    phys += arm_mem_round(in_bytes, page);
+  }
+  if (status)
+    goto free_bufs;
+
+  /* Init - CPU writes the inputs, clears the output. */
+
+  uint32_t *in1 = (uint32_t*)bufs[0].ptr;
+  uint32_t *in2 = is_mmult ? (uint32_t*)bufs[1].ptr : NULL;
+  uint32_t *out = (uint32_t*)bufs[n_bufs - 1].ptr;
+  uint32_t lcg = 0x13579bdf;
+
+clock_gettime(CLOCK_REALTIME, &t_init.t0);
+
+  for (size_t i = 0; i < in_len; i++) {
+    lcg = lcg * 1664525 + 1013904223;
+    in1[i] = (lcg >> 16) & 0xff;
+    if (is_mmult) {
+      lcg = lcg * 1664525 + 1013904223;
+      in2[i] = (lcg >> 16) & 0xff;
+    }
+  }
+  memset(out, 0, in_bytes);
+
+clock_gettime(CLOCK_REALTIME, &t_init.t1);
+
+  /* Proc. */
+
+  uint32_t conv_coeffs[11];
+  for (int i = 0; i < cfg->k; i++) {
+    // Binomial row of K, i.e. a Gaussian approximation.
+    conv_coeffs[i] = i == 0 ? 1 : conv_coeffs[i - 1] * (cfg->k - i) / i;
+  }
+
+  perf_group_open(&pg_proc);
+
+clock_gettime(CLOCK_REALTIME, &t_proc.t0);
+perf_group_start(&pg_proc);
+
+  switch (kernel) {
+  case K_MMULT_NAIVE:
+    status = mmult_sw(in1, in2, out, cfg->mat_dim, MMULT_NAIVE, 1);
+    break;
+  case K_MMULT_BLOCKED:
+    status = mmult_sw(in1, in2, out, cfg->mat_dim, MMULT_BLOCKED, cfg->n_threads);
+    break;
+  default:
+    status = convolution_sw(in1, out, conv_coeffs, cfg->k, cfg->width, cfg->height);
+    break;
+  }
+
+perf_group_stop(&pg_proc);
+clock_gettime(CLOCK_REALTIME, &t_proc.t1);
+
+  if (status)
+    goto free_bufs;
+
+  /* Readback - CPU reads the output. */
+
+  uint64_t acc = 0;
+
+clock_gettime(CLOCK_REALTIME, &t_read.t0);
+
+  for (size_t i = 0; i < in_len; i++)
+    acc = acc * 31 + out[i];
+
+clock_gettime(CLOCK_REALTIME, &t_read.t1);
+
+  res->sum = acc;
+  res->huge = bufs[0].huge;
+  res->has_dtlb = pg_proc.fd[PERF_DTLB_MISSES] >= 0 && perf_group_valid(&pg_proc, PERF_INSTRUCTIONS);
+  res->dtlb = pg_proc.val[PERF_DTLB_MISSES];
+
+  /* Report. */
+
+  const double proc_ms = res->proc_ms = elapsed_ms(&t_proc);
+  double rate, bytes;
+  const char *rate_unit;
+
+  if (is_mmult) {
+    rate = 2.0 * cfg->mat_dim * cfg->mat_dim * cfg->mat_dim / (proc_ms * 1e6);
+    rate_unit = "GOPS";
+    bytes = 4.0 * in_bytes;
+  } else {
+    rate = (double)cfg->width * cfg->height / (proc_ms * 1e3);
+    rate_unit = "Mpix/s";
+    bytes = 2.0 * in_bytes;
+  }
+
+  fprintf(csv, "%s,%s,%u,%s,%.3f,%.3f,%.3f,%.3f,%s,",
+    arm_mem_names[backend], kernel_names[kernel],
+    is_mmult ? cfg->mat_dim : cfg->width * cfg->height,
+    arm_mem_huge_names[res->huge],
+    elapsed_ms(&t_init), proc_ms, elapsed_ms(&t_read),
+    rate, rate_unit);
+
+  if (perf_group_valid(&pg_proc, PERF_CYCLES) && perf_group_valid(&pg_proc, PERF_INSTRUCTIONS))
+    fprintf(csv, "%.3f,", (double)pg_proc.val[PERF_INSTRUCTIONS] / pg_proc.val[PERF_CYCLES]);
+  else
+    fprintf(csv, ",");
+  if (res->has_dtlb)
+    fprintf(csv, "%.3f,", res->dtlb * 1000.0 / pg_proc.val[PERF_INSTRUCTIONS]);
+  else
+    fprintf(csv, ",");
+  if (perf_group_valid(&pg_proc, PERF_CYCLES))
+    fprintf(csv, "%.3f,", bytes / pg_proc.val[PERF_CYCLES]);
+  else
+    fprintf(csv, ",");
+
+  fprintf(csv, "%d\n", !has_ref || acc == ref_sum);
+  fflush(csv);
+
+free_bufs:
+  // After the report: closing marks every counter -1 (n/a).
+  perf_group_close(&pg_proc);
+  for (int i = 0; i < n_bufs; i++)
+    arm_buf_free(&bufs[i]);
+
+  return status;
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+    "Usage: %s [-b backend[,backend...]] [-n mat_dim] [-W width] [-H height]\n"
+    "          [-k conv_dim] [-t n_threads] [-a phys_addr] [-o out.csv] [-T]\n"
+    "Backends:", prog);
+  for (int b = 0; b < ARM_MEM_N_BACKENDS; b++)
+    fprintf(stderr, " %s", arm_mem_names[b]);
+  fprintf(stderr, " (default: all)\n");
+}
+
+/*
+ *
+ *     HOST processor - Main program.
+ *
+ */
+
+int main(int argc, char *argv[])
+{
+  struct sweep_cfg cfg = {
+    .mat_dim   = 512,
+    .width     = 320,
+    .height    = 320,
+    .k         = 11,
+    .n_threads = MMULT_MAX_THREADS,
+    .phys_base = CMA_ADDR,
+  };
+  int backends[ARM_MEM_N_BACKENDS];
+  int n_backends = 0;
+  const char *csv_path = "-";
+  int tlb_mode = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "b:n:W:H:k:t:a:o:T")) != -1) {
+    switch (opt) {
+    case 'b':
+      for (char *name = strtok(optarg, ","); name; name = strtok(NULL, ",")) {
+        int b = arm_mem_backend_parse(name);
+        if (b < 0 || n_backends == ARM_MEM_N_BACKENDS) {
+          usage(argv[0]);
+          return -EINVAL;
+        }
+        backends[n_backends++] = b;
+      }
+      break;
+    case 'n': cfg.mat_dim = atoi(optarg); break;
+    case 'W': cfg.width = atoi(optarg); break;
+    case 'H': cfg.height = atoi(optarg); break;
+    case 'k': cfg.k = atoi(optarg); break;
+    case 't': cfg.n_threads = atoi(optarg); break;
+    case 'a': cfg.phys_base = strtoull(optarg, NULL, 0); break;
+    case 'o': csv_path = optarg; break;
+    case 'T': tlb_mode = 1; break;
+    default:
+      usage(argv[0]);
+      return -EINVAL;
+    }
+  }
+
+  if (cfg.k < 1 || cfg.k > 11 || !(cfg.k & 1)) {
+    fprintf(stderr, "Error: conv_dim must be odd, 1 to 11\n");
+    return -EINVAL;
+  }
+
+  if (tlb_mode) {
+    n_backends = 0;
+    backends[n_backends++] = ARM_MEM_MALLOC;
+    backends[n_backends++] = ARM_MEM_HUGEPAGE;
+  }
+
+  if (!n_backends)
+    for (int b = 0; b < ARM_MEM_N_BACKENDS; b++)
+      backends[n_backends++] = b;
+
+  FILE *csv = strcmp(csv_path, "-") ? fopen(csv_path, "w") : stdout;
+  if (csv == NULL) {
+    fprintf(stderr, "Error: could not open file %s\n", csv_path);
+    return -1;
+  }
+
+  fprintf(csv, "backend,kernel,size,huge,init_ms,proc_ms,readback_ms,rate,rate_unit,ipc,dtlb_mpki,bytes_per_cycle,match\n");
+
+  // Reference checksums - first successful run of each kernel, i.e. malloc
+  // if it is swept.
+  uint64_t ref_sum[K_N_KERNELS];
+  int has_ref[K_N_KERNELS] = { 0 };
+  int n_fail = 0;
+
+  // TLB mode: results of malloc [0] and hugepage [1].
+  struct sweep_result tlb_res[2][K_N_KERNELS];
+  int tlb_ok[2][K_N_KERNELS] = { { 0 } };
+
+  for (int i = 0; i < n_backends; i++) {
+    for (int kernel = 0; kernel < K_N_KERNELS; kernel++) {
+      struct sweep_result res;
+
+      fprintf(stderr, "Running %s on %s...\n", kernel_names[kernel], arm_mem_names[backends[i]]);
+
+      int status = sweep_run(&cfg, kernel, backends[i], &res, csv, ref_sum[kernel], has_ref[kernel]);
+      if (status) {
+        fprintf(stderr, "  skipped: %s\n", strerror(-status));
+        continue;
+      }
+
+      if (!has_ref[kernel]) {
+        ref_sum[kernel] = res.sum;
+        has_ref[kernel] = 1;
+      } else if (res.sum != ref_sum[kernel]) {
+        n_fail++;
+      }
+
+      if (tlb_mode) {
+        tlb_res[i][kernel] = res;
+        tlb_ok[i][kernel] = 1;
+      }
+    }
+  }
+
+  if (tlb_mode) {
+    fprintf(stderr, "\nHuge pages (%s) vs 4 KB pages:\n",
+      tlb_ok[1][0] ? arm_mem_huge_names[tlb_res[1][0].huge] : "n/a");
+    for (int kernel = 0; kernel < K_N_KERNELS; kernel++) {
+      const struct sweep_result *r4k = &tlb_res[0][kernel];
+      const struct sweep_result *rhp = &tlb_res[1][kernel];
+      if (!tlb_ok[0][kernel] || !tlb_ok[1][kernel])
+        continue;
+      fprintf(stderr, "  %-14s time %9.3f -> %9.3f ms (x%.2f)", kernel_names[kernel],
+        r4k->proc_ms, rhp->proc_ms, r4k->proc_ms / rhp->proc_ms);
+      if (r4k->has_dtlb && rhp->has_dtlb)
+        fprintf(stderr, ", dTLB misses %llu -> %llu\n",
+          (unsigned long long)r4k->dtlb, (unsigned long long)rhp->dtlb);
+      else
+        fprintf(stderr, ", dTLB misses n/a\n");
+    }
+    fprintf(stderr, "\n");
+  }
+
+  // Both matmul variants compute the same product.
+  if (has_ref[K_MMULT_NAIVE] && has_ref[K_MMULT_BLOCKED] &&
+      ref_sum[K_MMULT_NAIVE] != ref_sum[K_MMULT_BLOCKED])
+    n_fail++;
+
+  if (csv != stdout) fclose(csv);
+
+  if (n_fail)
+    fprintf(stderr, "!!! %d runs mismatch !!!\n", n_fail);
+  else
+    fprintf(stderr, "*** All runs match ***\n");
+
+  return n_fail ? -1 : 0;
+}
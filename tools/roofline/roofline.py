@@ -0,0 +1,361 @@
+#!/usr/bin/env python3
+#
+# Copyright 2019 ETH Zurich, University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Roofline report - places every measured kernel run against the compute
+and memory ceilings of its platform.
+
+Op counts and bytes moved are computed from each kernel's parameters
+(MAT_DIM, STRIPE_HEIGHT, K, image size, ...), runtimes come from the
+measurements. One markdown table and one SVG plot are written per platform.
+
+Inputs:
+  measurements CSV   platform,kernel,label,params,time_ms,cycles
+                     params: space separated key=value, e.g. "n=512 stripe=8"
+                     either time_ms or cycles (at the platform clock) is set
+  --bench CSV        xilinx/convolution/bench output, orig/strm rows go to
+                     zcu102_pl, sw rows to arm64
+  --membench CSV     host/arm64/membench output, the best triad of each
+                     backend becomes an arm64 memory ceiling
+  --platforms JSON   overrides of the platform peaks below
+"""
+
+import argparse
+import csv
+import json
+import math
+import os
+import sys
+
+# Platform peaks - nominal figures, to be overridden (--platforms) or
+# complemented (--membench) with measured ones.
+#   peak_gops:  compute ceiling, 1 MAC = 2 ops
+#   clk_mhz:    clock the cycle counts refer to
+#   mem_gbps:   memory ceilings, name -> GB/s
+#   roof:       the memory ceiling the '% of roof' column refers to
+PLATFORMS = {
+    "arm64": {
+        "desc": "ZCU102 PS, 4x Cortex-A53 @ 1.2 GHz, NEON int32 (4 lanes MLA)",
+        "clk_mhz": 1200.0,
+        "peak_gops": 4 * 1.2 * 4 * 2,
+        "mem_gbps": {"DDR4 PS, nominal": 19.2},
+        "roof": "DDR4 PS, nominal",
+    },
+    "zcu102_pl": {
+        "desc": "ZCU102 PL @ 150 MHz, 2520 DSP48E2",
+        "clk_mhz": 150.0,
+        "peak_gops": 2520 * 2 * 0.150,
+        "mem_gbps": {
+            "1x S_AXI_HP, 128 b": 16 * 0.150,
+            "4x S_AXI_HP, 128 b": 4 * 16 * 0.150,
+        },
+        # The accelerators master a single HP port.
+        "roof": "1x S_AXI_HP, 128 b",
+    },
+    "pulp": {
+        "desc": "HERO PULP cluster, 8x RI5CY @ 50 MHz, 1 MAC/cycle/core",
+        "clk_mhz": 50.0,
+        "peak_gops": 8 * 2 * 0.050,
+        "mem_gbps": {"cluster DMA, 64 b": 8 * 0.050},
+        "roof": "cluster DMA, 64 b",
+    },
+}
+
+# - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / -
+
+# Kernel models - (ops, bytes) from the parameters. 'ops' and 'bytes'
+# parameters override the model.
+
+
+def model_matmul(p):
+    # out = in1 * in2^T, n x n int32. With stripe, out is computed in
+    # stripe x stripe blocks, each reading stripe rows of in1 and in2
+    # (xilinx/matmul 02+). Without, compulsory traffic: in1, in2 read, out
+    # read-modify-write (host baselines).
+    n = p["n"]
+    ops = 2.0 * n ** 3
+    if "stripe" in p:
+        bytes_ = 4.0 * (2.0 * n ** 3 / p["stripe"] + n * n)
+    else:
+        bytes_ = 4.0 * 4 * n * n
+    return ops, bytes_
+
+
+def model_conv(p):
+    # K-tap convolution over w x h int32 pixels, separable by default
+    # (2K MACs per pixel) else KxK. Streaming: each pixel read and written
+    # once, 'bpp' overrides the bytes per pixel (e.g. bench bytes_per_pixel).
+    w, h, k = p["w"], p["h"], p["k"]
+    macs = 2 * k if p.get("sep", 1) else k * k
+    return 2.0 * macs * w * h, p.get("bpp", 8.0) * w * h
+
+
+def model_colordetect(p):
+    # RGB -> HSV (~30 ops), 3-channel range threshold (~8), 2x erode and
+    # 2x dilate 3x3 (4 x 8 min/max). RGB888 in, 8-bit mask out.
+    w, h = p["w"], p["h"]
+    return p.get("ops_px", 70.0) * w * h, 4.0 * w * h
+
+
+def model_fast(p):
+    # FAST-9: 16 circle pixels against both thresholds (32), score and 3x3
+    # non-maximum suppression (~16). 8-bit gray in, 8-bit mask out.
+    w, h = p["w"], p["h"]
+    return p.get("ops_px", 48.0) * w * h, 2.0 * w * h
+
+
+def model_generic(p):
+    return p["ops"], p["bytes"]
+
+
+MODELS = {
+    "matmul": model_matmul,
+    "conv": model_conv,
+    "colordetect": model_colordetect,
+    "fast": model_fast,
+    "generic": model_generic,
+}
+
+
+def parse_params(s):
+    p = {}
+    for kv in s.split():
+        k, v = kv.split("=", 1)
+        p[k] = float(v)
+    return p
+
+
+def kernel_cost(kernel, p):
+    if kernel not in MODELS:
+        raise ValueError("unknown kernel '%s' (one of %s)" % (kernel, ", ".join(MODELS)))
+    if "ops" in p and "bytes" in p:
+        return p["ops"], p["bytes"]
+    ops, bytes_ = MODELS[kernel](p)
+    return p.get("ops", ops), p.get("bytes", bytes_)
+
+# - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / -
+
+# Inputs.
+
+
+def read_measurements(path, runs):
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            runs.append({
+                "platform": row["platform"],
+                "kernel": row["kernel"],
+                "label": row.get("label") or row["kernel"],
+                "params": parse_params(row.get("params", "")),
+                "time_ms": float(row["time_ms"]) if row.get("time_ms") else None,
+                "cycles": float(row["cycles"]) if row.get("cycles") else None,
+            })
+
+
+def read_bench(path, runs):
+    # impl,width,height,k,cycles,cycles_src,time_ms,fps,bytes_per_pixel,match
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            impl = row["impl"]
+            runs.append({
+                "platform": "arm64" if impl == "sw" else "zcu102_pl",
+                "kernel": "conv",
+                "label": "conv_%s %sx%s K%s" % (impl, row["width"], row["height"], row["k"]),
+                "params": {
+                    "w": float(row["width"]), "h": float(row["height"]),
+                    "k": float(row["k"]), "bpp": float(row["bytes_per_pixel"]),
+                },
+                "time_ms": None,
+                "cycles": float(row["cycles"]),
+            })
+
+
+def read_membench(path, platforms):
+    # backend,test,bytes,threads,mb_per_s,ns_per_access
+    best = {}
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            if row["test"] != "triad" or not row["mb_per_s"]:
+                continue
+            key = "%s triad, %s thr (measured)" % (row["backend"], row["threads"])
+            best[key] = max(best.get(key, 0.0), float(row["mb_per_s"]) / 1e3)
+    platforms["arm64"]["mem_gbps"].update(best)
+    # Measured heap bandwidth supersedes the nominal figure.
+    heap = [k for k in best if k.startswith("malloc ")]
+    if heap:
+        platforms["arm64"]["roof"] = max(heap, key=lambda k: best[k])
+
+
+def load_platforms(path):
+    platforms = json.loads(json.dumps(PLATFORMS))
+    if path:
+        with open(path) as f:
+            for name, over in json.load(f).items():
+                platforms.setdefault(name, {"desc": name, "mem_gbps": {}}).update(over)
+    return platforms
+
+# - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / -
+
+# Roofline.
+
+
+def roof_gbps(plat):
+    if plat.get("roof") in plat["mem_gbps"]:
+        return plat["mem_gbps"][plat["roof"]]
+    return max(plat["mem_gbps"].values())
+
+
+def analyze(run, plat):
+    ops, bytes_ = kernel_cost(run["kernel"], run["params"])
+    if run["time_ms"] is not None:
+        t_s = run["time_ms"] * 1e-3
+    elif run["cycles"] is not None:
+        t_s = run["cycles"] / (plat["clk_mhz"] * 1e6)
+    else:
+        raise ValueError("run '%s' has neither time_ms nor cycles" % run["label"])
+
+    ai = ops / bytes_
+    gops = ops / t_s / 1e9
+    bw = roof_gbps(plat)
+    attainable = min(plat["peak_gops"], ai * bw)
+    return {
+        "label": run["label"], "ops": ops, "bytes": bytes_, "ai": ai,
+        "time_ms": t_s * 1e3, "gops": gops, "attainable": attainable,
+        "frac": gops / attainable,
+        "bound": "memory" if ai * bw < plat["peak_gops"] else "compute",
+    }
+
+
+def table(name, plat, rows):
+    out = []
+    out.append("## %s - %s\n" % (name, plat["desc"]))
+    out.append("Compute peak: %.2f GOPS" % plat["peak_gops"])
+    for n, bw in sorted(plat["mem_gbps"].items(), key=lambda kv: kv[1]):
+        out.append("Memory: %s - %.2f GB/s, ridge at %.2f ops/B%s" % (
+            n, bw, plat["peak_gops"] / bw, " (roof)" if bw == roof_gbps(plat) else ""))
+    out.append("")
+    out.append("| kernel | ops | bytes | ops/B | time (ms) | GOPS | roof (GOPS) | % of roof | bound |")
+    out.append("|--------|-----|-------|-------|-----------|------|-------------|-----------|-------|")
+    for r in rows:
+        out.append("| %s | %.3g | %.3g | %.3g | %.3f | %.3f | %.3f | %.1f | %s |" % (
+            r["label"], r["ops"], r["bytes"], r["ai"], r["time_ms"],
+            r["gops"], r["attainable"], 100.0 * r["frac"], r["bound"]))
+    out.append("")
+    return "\n".join(out)
+
+
+def svg(name, plat, rows):
+    W, H = 760, 500
+    ml, mr, mt, mb = 70, 200, 40, 50
+    pw, ph = W - ml - mr, H - mt - mb
+
+    # Axis ranges - whole decades around the points and ridge points.
+    xs = [r["ai"] for r in rows] + [plat["peak_gops"] / bw for bw in plat["mem_gbps"].values()]
+    ys = [r["gops"] for r in rows] + [plat["peak_gops"]]
+    x0, x1 = math.floor(math.log10(min(xs) / 2)), math.ceil(math.log10(max(xs) * 2))
+    y0, y1 = math.floor(math.log10(min(ys) / 2)), math.ceil(math.log10(max(ys) * 2))
+
+    def px(x):
+        return ml + (math.log10(x) - x0) / (x1 - x0) * pw
+
+    def py(y):
+        return mt + ph - (math.log10(y) - y0) / (y1 - y0) * ph
+
+    e = []
+    e.append('<svg xmlns="http://www.w3.org/2000/svg" width="%d" height="%d" '
+             'font-family="sans-serif" font-size="11">' % (W, H))
+    e.append('<rect width="100%" height="100%" fill="white"/>')
+    e.append('<text x="%d" y="20" font-size="14">%s - roofline</text>' % (ml, name))
+
+    # Grid and axes.
+    for d in range(x0, x1 + 1):
+        x = px(10.0 ** d)
+        e.append('<line x1="%.1f" y1="%d" x2="%.1f" y2="%d" stroke="#ddd"/>' % (x, mt, x, mt + ph))
+        e.append('<text x="%.1f" y="%d" text-anchor="middle">1e%d</text>' % (x, mt + ph + 15, d))
+    for d in range(y0, y1 + 1):
+        y = py(10.0 ** d)
+        e.append('<line x1="%d" y1="%.1f" x2="%d" y2="%.1f" stroke="#ddd"/>' % (ml, y, ml + pw, y))
+        e.append('<text x="%d" y="%.1f" text-anchor="end">1e%d</text>' % (ml - 5, y + 4, d))
+    e.append('<rect x="%d" y="%d" width="%d" height="%d" fill="none" stroke="black"/>' % (ml, mt, pw, ph))
+    e.append('<text x="%d" y="%d" text-anchor="middle">arithmetic intensity (ops/B)</text>'
+             % (ml + pw // 2, H - 10))
+    e.append('<text x="15" y="%d" text-anchor="middle" transform="rotate(-90 15 %d)">GOPS</text>'
+             % (mt + ph // 2, mt + ph // 2))
+
+    # Ceilings - one slanted roof per memory ceiling, flat compute roof.
+    xa, xb = 10.0 ** x0, 10.0 ** x1
+    peak = plat["peak_gops"]
+    for i, (n, bw) in enumerate(sorted(plat["mem_gbps"].items(), key=lambda kv: kv[1])):
+        ridge = peak / bw
+        xs_ = max(xa, 10.0 ** y0 / bw)
+        e.append('<polyline fill="none" stroke="#c33" stroke-dasharray="%s" points="%.1f,%.1f %.1f,%.1f %.1f,%.1f"/>'
+                 % ("" if i == 0 else "4,3", px(xs_), py(xs_ * bw), px(ridge), py(peak), px(xb), py(peak)))
+        e.append('<text x="%d" y="%d" fill="#c33">%s: %.2f GB/s</text>' % (ml + pw + 10, mt + 15 + 14 * i, n, bw))
+    e.append('<text x="%d" y="%.1f" fill="#c33">peak %.2f GOPS</text>' % (ml + pw + 10, py(peak) + 4, peak))
+
+    # Points.
+    for i, r in enumerate(rows):
+        x, y = px(r["ai"]), py(r["gops"])
+        e.append('<circle cx="%.1f" cy="%.1f" r="4" fill="#36c"/>' % (x, y))
+        e.append('<text x="%.1f" y="%.1f" fill="#36c">%s</text>' % (x + 6, y - 6 - 10 * (i % 2), r["label"]))
+
+    e.append("</svg>")
+    return "\n".join(e)
+
+# - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / -
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("measurements", nargs="*", help="measurements CSV files")
+    ap.add_argument("--bench", action="append", default=[], help="convolution bench CSV")
+    ap.add_argument("--membench", action="append", default=[], help="arm64 membench CSV")
+    ap.add_argument("--platforms", help="JSON overrides of the platform peaks")
+    ap.add_argument("-o", "--out-dir", default="roofline", help="output directory")
+    args = ap.parse_args()
+
+    platforms = load_platforms(args.platforms)
+    runs = []
+    for path in args.measurements:
+        read_measurements(path, runs)
+    for path in args.bench:
+        read_bench(path, runs)
+    for path in args.membench:
+        read_membench(path, platforms)
+
+    if not runs:
+        ap.error("no measurements given")
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    report = []
+    for name, plat in platforms.items():
+        rows = [analyze(r, plat) for r in runs if r["platform"] == name]
+        if not rows:
+            continue
+        report.append(table(name, plat, rows))
+        with open(os.path.join(args.out_dir, "roofline_%s.svg" % name), "w") as f:
+            f.write(svg(name, plat, rows))
+
+    unknown = sorted(set(r["platform"] for r in runs) - set(platforms))
+    if unknown:
+        print("Warning: no peaks for platform(s) %s, skipped" % ", ".join(unknown), file=sys.stderr)
+
+    text = "# Roofline report\n\n" + "\n".join(report)
+    with open(os.path.join(args.out_dir, "roofline.md"), "w") as f:
+        f.write(text)
+    print(text)
+
+
+if __name__ == "__main__":
+    main()
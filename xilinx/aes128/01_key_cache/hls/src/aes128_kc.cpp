@@ -0,0 +1,113 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Libraries. */
+
+#include "aes128_kc.h"
+#include "../../../common/aes128_rounds.h"
+
+/*
+ *
+ * AES-128 - Key-context accelerator (top).
+ *
+ */
+
+void aes128_kc(
+        hls::stream<aes_beat_t> &src,
+        hls::stream<aes_beat_t> &dst)
+{
+
+    /* Data streaming interface, free-running: one command per start. */
+    #pragma HLS INTERFACE axis port=&src
+    #pragma HLS INTERFACE axis port=&dst
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+
+    /*
+        Key-context slot table - the round keys of AES128_KC_SLOTS keys,
+        kept across commands. 16 banks, one round key per cycle.
+    */
+    static uint8_t slot_rk[AES128_KC_SLOTS][11][16];
+    #pragma HLS ARRAY_PARTITION variable=slot_rk dim=3 complete
+
+    /* Round keys of the current command, in registers. */
+    uint8_t rk[11][16];
+    #pragma HLS ARRAY_PARTITION variable=rk dim=0 complete
+
+    uint32_t hdr = src.read().data;
+    const uint32_t op = hdr >> 28;
+    const int fips = ((hdr >> 24) & 0xf) & AES128_KC_FIPS;
+    const int slot = (hdr >> 20) & (AES128_KC_SLOTS - 1);
+    const uint32_t nblocks = hdr & 0xfffff;
+
+    if (op == AES128_KC_OP_KEY) {
+        uint8_t key[16];
+        #pragma HLS ARRAY_PARTITION variable=key complete
+
+        Read_Key: for (int w = 0; w < 4; w++) {
+        #pragma HLS PIPELINE
+            uint32_t d = src.read().data;
+            for (int i = 0; i < 4; i++) {
+                key[4 * w + i] = (uint8_t)(d >> (8 * i));
+            }
+        }
+
+        aes_expand_key(key, fips, rk);
+
+        Store_Key: for (int r = 0; r < 11; r++) {
+        #pragma HLS PIPELINE
+            for (int i = 0; i < 16; i++) {
+                slot_rk[slot][r][i] = rk[r][i];
+            }
+        }
+    } else if (op == AES128_KC_OP_ENCRYPT) {
+        Load_Key: for (int r = 0; r < 11; r++) {
+        #pragma HLS PIPELINE
+            for (int i = 0; i < 16; i++) {
+                rk[r][i] = slot_rk[slot][r][i];
+            }
+        }
+
+        /* One block every 4 cycles, i.e. one 32-bit beat in and out per cycle. */
+        Blocks: for (uint32_t b = 0; b < nblocks; b++) {
+        #pragma HLS LOOP_TRIPCOUNT min=1 max=1023
+        #pragma HLS PIPELINE II=4
+            uint8_t s[16];
+            #pragma HLS ARRAY_PARTITION variable=s complete
+
+            Read_Block: for (int w = 0; w < 4; w++) {
+                uint32_t d = src.read().data;
+                for (int i = 0; i < 4; i++) {
+                    s[4 * w + i] = (uint8_t)(d >> (8 * i));
+                }
+            }
+
+            aes_encrypt_block(s, rk);
+
+            Write_Block: for (int w = 0; w < 4; w++) {
+                aes_beat_t beat;
+                beat.data = (uint32_t)s[4 * w] | ((uint32_t)s[4 * w + 1] << 8)
+                          | ((uint32_t)s[4 * w + 2] << 16) | ((uint32_t)s[4 * w + 3] << 24);
+                beat.keep = 0xf;
+                beat.strb = 0xf;
+                beat.user = 0;
+                beat.id = 0;
+                beat.dest = 0;
+                beat.last = (b == nblocks - 1) && (w == 3);
+                dst.write(beat);
+            }
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AES128_KC_H_
+#define AES128_KC_H_
+
+#include <stdint.h>
+#include <ap_axi_sdata.h>
+#include <hls_stream.h>
+
+/*
+    AES-128 with on-chip key expansion and a key-context slot table.
+
+    The host sends commands on one 32-bit AXI-Stream, the bytes packed in
+    the beats with byte 0 in lane 0 (AES128_BEAT_PACKED of the axis_aes128
+    driver), 4 beats per 128-bit key or block:
+
+    - KEY:     header, 4 key beats. The key is expanded on chip and its 11
+               round keys are kept in the slot until overwritten. No output.
+    - ENCRYPT: header, 4 * nblocks text beats. The blocks are encrypted with
+               the round keys of the slot, 4 * nblocks beats are sent back
+               with TLAST on the last one.
+
+    Header beat:
+        [31:28] op      AES128_KC_OP_*
+        [27:24] flags   AES128_KC_FIPS: FIPS-197 round constants, otherwise
+                        rcon = 0x01 in every round as the axis_aes128 design
+                        and the host software (AES_RCON_FIXED)
+        [23:20] slot
+        [19:0]  nblocks (ENCRYPT)
+
+    Commands can be chained in one DMA transaction, e.g. KEY then ENCRYPT
+    to switch to a key that is not in the table. Switching between keys
+    already in the table costs nothing on the host.
+*/
+
+#define AES128_KC_SLOTS 8
+
+#define AES128_KC_OP_KEY        0x1
+#define AES128_KC_OP_ENCRYPT    0x2
+
+#define AES128_KC_FIPS          0x1
+
+#define AES128_KC_HEADER(op, flags, slot, nblocks) \
+    (((uint32_t)(op) << 28) | ((uint32_t)(flags) << 24) | ((uint32_t)(slot) << 20) | ((uint32_t)(nblocks) & 0xfffff))
+
+typedef ap_axiu<32, 1, 1, 1> aes_beat_t;
+
+// External function prototypes
+void aes128_kc(
+        hls::stream<aes_beat_t> &src,
+        hls::stream<aes_beat_t> &dst);
+
+#endif // AES128_KC_H_ not defined
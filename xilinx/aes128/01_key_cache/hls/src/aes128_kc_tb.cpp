@@ -0,0 +1,283 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Libraries. */
+
+#include <string.h>
+#include <iostream>
+#include <iomanip>
+
+/* Include HLS source header. */
+
+#include "aes128_kc.h"
+
+using namespace std;
+
+/* Modeled accelerator clock (run_hls.tcl: 6.66 ns). */
+
+#define ACC_CLK_MHZ 150.0
+
+/* FIPS-197 Appendix C.1, and the same key and plaintext with rcon = 0x01. */
+
+static const uint8_t fips197_key[16] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const uint8_t fips197_pt[16] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const uint8_t fips197_ct[16] = {
+    0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+static const uint8_t fixed_rcon_ct[16] = {
+    0x89, 0x1a, 0x2a, 0xf9, 0x3d, 0xc9, 0xb7, 0x2a, 0xf8, 0xeb, 0x10, 0x88, 0x7a, 0x27, 0x2c, 0x14
+};
+
+/* Host reference - byte-oriented AES-128, S-box computed from GF(2^8). */
+
+static uint8_t ref_sbox[256];
+
+static uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+    uint8_t p = 0;
+    while (b) {
+        if (b & 1) p ^= a;
+        a = (uint8_t)((a << 1) ^ ((a & 0x80) ? 0x1b : 0));
+        b >>= 1;
+    }
+    return p;
+}
+
+static void ref_init(void)
+{
+    for (int x = 0; x < 256; x++) {
+        uint8_t inv = 0;
+        for (int y = 1; y < 256 && x; y++) {
+            if (gf_mul((uint8_t)x, (uint8_t)y) == 1) inv = (uint8_t)y;
+        }
+        uint8_t s = inv;
+        for (int i = 1; i < 5; i++) {
+            s ^= (uint8_t)((inv << i) | (inv >> (8 - i)));
+        }
+        ref_sbox[x] = s ^ 0x63;
+    }
+}
+
+static void ref_encrypt(const uint8_t key[16], int fips, const uint8_t in[16], uint8_t out[16])
+{
+    uint8_t w[176], s[16], t[16];
+    uint8_t rcon = 1;
+
+    memcpy(w, key, 16);
+    for (int i = 16; i < 176; i += 4) {
+        uint8_t tmp[4] = { w[i - 4], w[i - 3], w[i - 2], w[i - 1] };
+        if (i % 16 == 0) {
+            uint8_t t0 = tmp[0];
+            tmp[0] = ref_sbox[tmp[1]] ^ rcon;
+            tmp[1] = ref_sbox[tmp[2]];
+            tmp[2] = ref_sbox[tmp[3]];
+            tmp[3] = ref_sbox[t0];
+            if (fips) rcon = gf_mul(rcon, 2);
+        }
+        for (int j = 0; j < 4; j++) w[i + j] = w[i - 16 + j] ^ tmp[j];
+    }
+
+    for (int i = 0; i < 16; i++) s[i] = in[i] ^ w[i];
+    for (int r = 1; r <= 10; r++) {
+        for (int c = 0; c < 4; c++)
+            for (int i = 0; i < 4; i++)
+                t[4 * c + i] = ref_sbox[s[4 * ((c + i) & 3) + i]];
+        for (int c = 0; c < 4; c++) {
+            for (int i = 0; i < 4; i++) {
+                uint8_t v = t[4 * c + i];
+                if (r < 10) {
+                    v = gf_mul(t[4 * c + i], 2) ^ gf_mul(t[4 * c + ((i + 1) & 3)], 3)
+                      ^ t[4 * c + ((i + 2) & 3)] ^ t[4 * c + ((i + 3) & 3)];
+                }
+                s[4 * c + i] = v ^ w[16 * r + 4 * c + i];
+            }
+        }
+    }
+    memcpy(out, s, 16);
+}
+
+/* Command helpers - one accelerator start per command, as ap_ctrl_none. */
+
+static void put_words(hls::stream<aes_beat_t> &src, const uint8_t *bytes, int nbytes)
+{
+    for (int w = 0; w < nbytes / 4; w++) {
+        aes_beat_t beat;
+        beat.data = (uint32_t)bytes[4 * w] | ((uint32_t)bytes[4 * w + 1] << 8)
+                  | ((uint32_t)bytes[4 * w + 2] << 16) | ((uint32_t)bytes[4 * w + 3] << 24);
+        beat.last = 0;
+        src << beat;
+    }
+}
+
+static void kc_key(int slot, const uint8_t key[16], int fips)
+{
+    hls::stream<aes_beat_t> src("src"), dst("dst");
+    aes_beat_t hdr;
+
+    hdr.data = AES128_KC_HEADER(AES128_KC_OP_KEY, fips ? AES128_KC_FIPS : 0, slot, 0);
+    src << hdr;
+    put_words(src, key, 16);
+    aes128_kc(src, dst);
+}
+
+/* Returns the number of protocol errors: leftover input, output count or TLAST. */
+static int kc_encrypt(int slot, const uint8_t *in, uint8_t *out, int nblocks)
+{
+    hls::stream<aes_beat_t> src("src"), dst("dst");
+    aes_beat_t hdr;
+    int err = 0;
+
+    hdr.data = AES128_KC_HEADER(AES128_KC_OP_ENCRYPT, 0, slot, nblocks);
+    src << hdr;
+    put_words(src, in, 16 * nblocks);
+    aes128_kc(src, dst);
+
+    if (!src.empty()) err++;
+    for (int w = 0; w < 4 * nblocks; w++) {
+        if (dst.empty()) return err + 1;
+        aes_beat_t beat = dst.read();
+        for (int i = 0; i < 4; i++) out[4 * w + i] = (uint8_t)(beat.data >> (8 * i));
+        if ((int)beat.last != (w == 4 * nblocks - 1)) err++;
+    }
+    if (!dst.empty()) err++;
+
+    return err;
+}
+
+/* Cycle model, the II and the pipeline depth of the synthesis estimate. */
+
+static double model_cycles(int nblocks)
+{
+    const double header = 1, load_key = 11, depth = 12;
+    return header + load_key + depth + 4.0 * nblocks;
+}
+
+int main(void)
+{
+
+    /* Algorithm parameters declaration. */
+
+    const int n_keys = 2 * AES128_KC_SLOTS;
+    const int n_cmds = 200;
+    const int max_blocks = 64;
+    uint8_t keys[n_keys][16];
+    int slot_key[AES128_KC_SLOTS];
+    uint8_t pt[16 * max_blocks], ct[16 * max_blocks], ref[16 * max_blocks];
+    int err_cnt = 0;
+    int ret_val = 20;
+    uint32_t lcg = 0x13579bdf;
+
+    ref_init();
+
+    /* FIPS-197 vector, FIPS round constants, and the fixed-rcon variant. */
+
+    uint8_t out[16];
+    int vec_err = 0;
+
+    kc_key(0, fips197_key, 1);
+    kc_key(1, fips197_key, 0);
+    vec_err += kc_encrypt(0, fips197_pt, out, 1);
+    vec_err += memcmp(out, fips197_ct, 16) != 0;
+    vec_err += kc_encrypt(1, fips197_pt, out, 1);
+    vec_err += memcmp(out, fixed_rcon_ct, 16) != 0;
+    ref_encrypt(fips197_key, 1, fips197_pt, ref);
+    vec_err += memcmp(ref, fips197_ct, 16) != 0;
+    err_cnt += vec_err;
+    cout << "FIPS-197 C.1 and fixed rcon | " << vec_err << " mismatches" << endl;
+
+    /*
+        Slot table: more keys than slots, random commands. A key is loaded
+        only when it is not in the table, into the slot of the least
+        recently used one, as the driver does.
+    */
+
+    int slot_used[AES128_KC_SLOTS];
+    int key_loads = 0, blocks = 0, tbl_err = 0;
+    double cycles = 0;
+
+    for (int k = 0; k < n_keys; k++) {
+        for (int i = 0; i < 16; i++) {
+            lcg = lcg * 1664525 + 1013904223;
+            keys[k][i] = (uint8_t)(lcg >> 24);
+        }
+    }
+    for (int s = 0; s < AES128_KC_SLOTS; s++) {
+        slot_key[s] = -1;
+        slot_used[s] = -1;
+    }
+
+    for (int c = 0; c < n_cmds; c++) {
+        lcg = lcg * 1664525 + 1013904223;
+        /* Mostly the first AES128_KC_SLOTS keys, some misses. */
+        const int k = ((lcg >> 8) % 8) ? (lcg >> 12) % AES128_KC_SLOTS : (lcg >> 12) % n_keys;
+        const int nblocks = 1 + (lcg >> 20) % max_blocks;
+        int slot = -1, lru = 0;
+
+        for (int s = 0; s < AES128_KC_SLOTS; s++) {
+            if (slot_key[s] == k) slot = s;
+            if (slot_used[s] < slot_used[lru]) lru = s;
+        }
+        if (slot < 0) {
+            slot = lru;
+            slot_key[slot] = k;
+            kc_key(slot, keys[k], 0);
+            key_loads++;
+            cycles += 1 + 4 + 10 + 11;
+        }
+        slot_used[slot] = c;
+
+        for (int i = 0; i < 16 * nblocks; i++) {
+            lcg = lcg * 1664525 + 1013904223;
+            pt[i] = (uint8_t)(lcg >> 24);
+        }
+        tbl_err += kc_encrypt(slot, pt, ct, nblocks);
+        for (int b = 0; b < nblocks; b++) {
+            ref_encrypt(keys[k], 0, &pt[16 * b], &ref[16 * b]);
+        }
+        tbl_err += memcmp(ct, ref, 16 * nblocks) != 0;
+        blocks += nblocks;
+        cycles += model_cycles(nblocks);
+    }
+    err_cnt += tbl_err;
+
+    /* Performance model. */
+
+    double t_acc = cycles / (ACC_CLK_MHZ * 1e6);
+
+    cout << n_cmds << " commands, " << n_keys << " keys on " << AES128_KC_SLOTS << " slots"
+         << " | " << key_loads << " key loads"
+         << " | " << tbl_err << " mismatches"
+         << " | model " << (long)cycles << " cycles, "
+         << fixed << setprecision(1) << 16.0 * blocks / t_acc / 1e6 << " MB/s"
+         << " (peak " << 16.0 * ACC_CLK_MHZ / 4 << ")"
+         << endl;
+    cout << endl;
+
+    if (err_cnt == 0) {
+        cout << "*** TEST PASSED ***" << endl;
+        ret_val = 0;
+    } else {
+        cout << "!!! TEST FAILED - " << err_cnt << " mismatches detected !!!";
+        cout << endl;
+        ret_val = -1;
+    }
+
+    return ret_val;
+}
@@ -0,0 +1,586 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Pipelined AES-128 CTR throughput.
+ *
+ * aes128_ctr_hw is programmed over AXI-Lite (key, initial counter, number
+ * of blocks, mode), the text is streamed by an AXI DMA between CMA buffers
+ * and the accelerator, one 128-bit block per clock:
+ *  - Known-answer tests first (FIPS-197 C.1, SP 800-38A F.1.1 and F.5.1),
+ *    then random CTR / ECB / keystream runs against the host reference.
+ *  - Throughput over growing transfer sizes, per mode, against the host
+ *    reference, and the pipeline peak at the accelerator clock.
+ *
+ * Usage: app_exec [max_mbytes]
+ */
+
+/* Libraries. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/* Include accelerator drivers. */
+#include <xaes128_ctr_hw.h>
+#include <xaes128_ctr_hw_hw.h>
+
+/* Include host timer struct. */
+#include <xil-bench.h>
+
+/*
+ * Reserved address in Contiguous Memory.
+ * To check whether CMA has been correctly allocated: 'dmesg | grep Reserved'
+ */
+
+#define CMA_ADDR 0x10000000
+
+/* AXI DMA between CMA and the accelerator streams, see the block design. */
+
+#define DMA_ADDR 0xA0010000
+#define DMA_MAP  0x10000
+
+/*
+ * Buffer length register width of the DMA (block design: 26 bits), larger
+ * transfers are split in several starts.
+ */
+
+#define DMA_LEN_BITS  26
+#define DMA_MAX_BYTES (((1u << DMA_LEN_BITS) - 1) & ~15u)
+
+/* Modes and flags, see hls/src/aes128_ctr.h. */
+
+#define AES128_CTR_MODE_CTR 0
+#define AES128_CTR_MODE_ECB 1
+#define AES128_CTR_MODE_KS  2
+
+#define AES128_CTR_FIPS     0x1
+
+/* Accelerator clock (run_hls.tcl: 6.66 ns). */
+
+#define ACC_CLK_MHZ 150.0
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/* AXI DMA - direct register mode (PG021). */
+
+#define DMA_MM2S_CR   0x00
+#define DMA_MM2S_SR   0x04
+#define DMA_MM2S_SA   0x18
+#define DMA_MM2S_LEN  0x28
+#define DMA_S2MM_CR   0x30
+#define DMA_S2MM_SR   0x34
+#define DMA_S2MM_DA   0x48
+#define DMA_S2MM_LEN  0x58
+
+#define DMA_CR_RUN    0x1
+#define DMA_CR_RESET  0x4
+#define DMA_SR_IDLE   0x2
+#define DMA_SR_IOC    0x1000
+#define DMA_SR_ERR    0x770
+
+static inline void dma_set(volatile uint32_t* dma, uint32_t offs, uint32_t val)
+{
+  dma[offs >> 2] = val;
+}
+
+static inline uint32_t dma_get(volatile uint32_t* dma, uint32_t offs)
+{
+  return dma[offs >> 2];
+}
+
+static void dma_reset(volatile uint32_t* dma)
+{
+  dma_set(dma, DMA_MM2S_CR, DMA_CR_RESET);
+  dma_set(dma, DMA_S2MM_CR, DMA_CR_RESET);
+  while (dma_get(dma, DMA_MM2S_CR) & DMA_CR_RESET);
+  dma_set(dma, DMA_MM2S_CR, DMA_CR_RUN);
+  dma_set(dma, DMA_S2MM_CR, DMA_CR_RUN);
+}
+
+/* Waits for the channel, returns the error bits of the status register. */
+
+static uint32_t dma_wait(volatile uint32_t* dma, uint32_t sr)
+{
+  uint32_t s;
+
+  do {
+    s = dma_get(dma, sr);
+  } while (!(s & (DMA_SR_IOC | DMA_SR_IDLE | DMA_SR_ERR)));
+
+  dma_set(dma, sr, DMA_SR_IOC);
+  return s & DMA_SR_ERR;
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/* Host reference - byte-oriented AES-128, S-box computed from GF(2^8). */
+
+static uint8_t ref_sbox[256];
+
+static uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+  uint8_t p = 0;
+  while (b) {
+    if (b & 1) p ^= a;
+    a = (uint8_t)((a << 1) ^ ((a & 0x80) ? 0x1b : 0));
+    b >>= 1;
+  }
+  return p;
+}
+
+static void ref_init(void)
+{
+  for (int x = 0; x < 256; x++) {
+    uint8_t inv = 0;
+    for (int y = 1; y < 256 && x; y++) {
+      if (gf_mul((uint8_t)x, (uint8_t)y) == 1) inv = (uint8_t)y;
+    }
+    uint8_t s = inv;
+    for (int i = 1; i < 5; i++) {
+      s ^= (uint8_t)((inv << i) | (inv >> (8 - i)));
+    }
+    ref_sbox[x] = s ^ 0x63;
+  }
+}
+
+static void ref_expand(const uint8_t key[16], int fips, uint8_t w[176])
+{
+  uint8_t rcon = 1;
+
+  memcpy(w, key, 16);
+  for (int i = 16; i < 176; i += 4) {
+    uint8_t tmp[4] = { w[i - 4], w[i - 3], w[i - 2], w[i - 1] };
+    if (i % 16 == 0) {
+      uint8_t t0 = tmp[0];
+      tmp[0] = ref_sbox[tmp[1]] ^ rcon;
+      tmp[1] = ref_sbox[tmp[2]];
+      tmp[2] = ref_sbox[tmp[3]];
+      tmp[3] = ref_sbox[t0];
+      if (fips) rcon = gf_mul(rcon, 2);
+    }
+    for (int j = 0; j < 4; j++) w[i + j] = w[i - 16 + j] ^ tmp[j];
+  }
+}
+
+static void ref_block(const uint8_t w[176], const uint8_t in[16], uint8_t out[16])
+{
+  uint8_t s[16], t[16];
+
+  for (int i = 0; i < 16; i++) s[i] = in[i] ^ w[i];
+  for (int r = 1; r <= 10; r++) {
+    for (int c = 0; c < 4; c++)
+      for (int i = 0; i < 4; i++)
+        t[4 * c + i] = ref_sbox[s[4 * ((c + i) & 3) + i]];
+    for (int c = 0; c < 4; c++) {
+      for (int i = 0; i < 4; i++) {
+        uint8_t v = t[4 * c + i];
+        if (r < 10) {
+          v = gf_mul(t[4 * c + i], 2) ^ gf_mul(t[4 * c + ((i + 1) & 3)], 3)
+            ^ t[4 * c + ((i + 2) & 3)] ^ t[4 * c + ((i + 3) & 3)];
+        }
+        s[4 * c + i] = v ^ w[16 * r + 4 * c + i];
+      }
+    }
+  }
+  memcpy(out, s, 16);
+}
+
+/* Same computation as the accelerator, the counter is advanced by nblocks. */
+
+static void aes_sw(
+  const uint8_t key[16], uint8_t ctr[16], int mode, int fips,
+  const uint8_t* in, uint8_t* out, uint32_t nblocks)
+{
+  uint8_t w[176], ks[16];
+
+  ref_expand(key, fips, w);
+
+  for (uint32_t b = 0; b < nblocks; b++) {
+    if (mode == AES128_CTR_MODE_ECB) {
+      ref_block(w, &in[16 * b], &out[16 * b]);
+      continue;
+    }
+    ref_block(w, ctr, ks);
+    for (int i = 0; i < 16; i++)
+      out[16 * b + i] = (mode == AES128_CTR_MODE_KS) ? ks[i] : in[16 * b + i] ^ ks[i];
+    for (int i = 15; i >= 0 && ++ctr[i] == 0; i--);
+  }
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/* Accelerator - one run, split in DMA-sized starts. The counter is advanced by nblocks. */
+
+static inline uint32_t word_le(const uint8_t* b)
+{
+  return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+static int xil_run(
+  XAes128_ctr_hw* hw_acc,
+  volatile uint32_t* dma,
+  const uint8_t key[16], uint8_t ctr[16], int mode, int fips,
+  uint32_t const buffer_in,
+  uint32_t const buffer_out,
+  uint32_t nblocks)
+{
+  uint32_t offs = 0;
+  uint32_t err = 0;
+
+  XAes128_ctr_hw_Set_key_0(hw_acc, word_le(&key[0]));
+  XAes128_ctr_hw_Set_key_1(hw_acc, word_le(&key[4]));
+  XAes128_ctr_hw_Set_key_2(hw_acc, word_le(&key[8]));
+  XAes128_ctr_hw_Set_key_3(hw_acc, word_le(&key[12]));
+  XAes128_ctr_hw_Set_mode(hw_acc, mode);
+  XAes128_ctr_hw_Set_flags(hw_acc, fips ? AES128_CTR_FIPS : 0);
+
+  while (nblocks) {
+    const uint32_t n = (nblocks > DMA_MAX_BYTES / 16) ? DMA_MAX_BYTES / 16 : nblocks;
+
+    XAes128_ctr_hw_Set_ctr_0(hw_acc, word_le(&ctr[0]));
+    XAes128_ctr_hw_Set_ctr_1(hw_acc, word_le(&ctr[4]));
+    XAes128_ctr_hw_Set_ctr_2(hw_acc, word_le(&ctr[8]));
+    XAes128_ctr_hw_Set_ctr_3(hw_acc, word_le(&ctr[12]));
+    XAes128_ctr_hw_Set_nblocks(hw_acc, n);
+    XAes128_ctr_hw_Start(hw_acc);
+
+    /* S2MM first, so the output stream never stalls the pipeline. */
+
+    dma_set(dma, DMA_S2MM_DA, buffer_out + offs);
+    dma_set(dma, DMA_S2MM_LEN, 16 * n);
+    if (mode != AES128_CTR_MODE_KS) {
+      dma_set(dma, DMA_MM2S_SA, buffer_in + offs);
+      dma_set(dma, DMA_MM2S_LEN, 16 * n);
+      err |= dma_wait(dma, DMA_MM2S_SR);
+    }
+    err |= dma_wait(dma, DMA_S2MM_SR);
+    while (!XAes128_ctr_hw_IsDone(hw_acc));
+
+    if (mode != AES128_CTR_MODE_ECB) {
+      uint32_t c = n;
+      for (int i = 15; i >= 0 && c; i--) {
+        c += ctr[i];
+        ctr[i] = (uint8_t)c;
+        c >>= 8;
+      }
+    }
+    offs += 16 * n;
+    nblocks -= n;
+  }
+
+  return err ? -EIO : 0;
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/* Known answers - FIPS-197 C.1, SP 800-38A F.1.1 (ECB-AES128), F.5.1 (CTR-AES128). */
+
+static const uint8_t fips197_key[16] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const uint8_t fips197_pt[16] = {
+  0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const uint8_t fips197_ct[16] = {
+  0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+
+static const uint8_t sp800_key[16] = {
+  0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const uint8_t sp800_ctr[16] = {
+  0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+static const uint8_t sp800_pt[64] = {
+  0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+  0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+  0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+  0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+static const uint8_t sp800_ecb_ct[64] = {
+  0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97,
+  0xf5, 0xd3, 0xd5, 0x85, 0x03, 0xb9, 0x69, 0x9d, 0xe7, 0x85, 0x89, 0x5a, 0x96, 0xfd, 0xba, 0xaf,
+  0x43, 0xb1, 0xcd, 0x7f, 0x59, 0x8e, 0xce, 0x23, 0x88, 0x1b, 0x00, 0xe3, 0xed, 0x03, 0x06, 0x88,
+  0x7b, 0x0c, 0x78, 0x5e, 0x27, 0xe8, 0xad, 0x3f, 0x82, 0x23, 0x20, 0x71, 0x04, 0x72, 0x5d, 0xd4
+};
+static const uint8_t sp800_ctr_ct[64] = {
+  0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+  0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+  0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+  0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+static const char* mode_name[] = { "CTR", "ECB", "KS" };
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/*
+ *
+ *     HOST processor - Main program.
+ *
+ */
+
+int main(int argc, char *argv[])
+{
+  printf("\n|-------------------|\n");
+  printf("| Test - Beginning. |");
+  printf("\n|-------------------|\n");
+
+  /* Largest transfer of the throughput sweep. */
+
+  unsigned max_mbytes     = 16;
+
+  if (argc > 1)
+    max_mbytes = atoi(argv[1]);
+  if (max_mbytes < 1) {
+    printf("Usage: %s [max_mbytes >= 1]\n", argv[0]);
+    return -EINVAL;
+  }
+
+  const uint64_t map_dim = (uint64_t)max_mbytes << 20;
+  const uint32_t max_blocks = (uint32_t)(map_dim / 16);
+
+  int status = 0;
+  int err_cnt = 0;
+  int fd;
+
+  ref_init();
+  srand(0x5eed);
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|----------------------------------------------------|\n");
+  printf("| DRAM - Declaration, allocation and initialization. |");
+  printf("\n|----------------------------------------------------|\n\n");
+
+  /* Host arrays. */
+
+  uint8_t* l3_in        = (uint8_t*)malloc(map_dim);
+  uint8_t* l3_golden    = (uint8_t*)malloc(map_dim);
+
+  if ( (l3_in == NULL) || (l3_golden == NULL) ) {
+    printf("ERROR: malloc() failed!\n");
+    return -ENOMEM;
+  }
+
+  for (uint64_t i = 0; i < map_dim; i++)
+    l3_in[i] = rand() & 0xff;
+
+  /* Map reserved addresses in memory. */
+
+  if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) {
+      printf("\n\n\n/dev/mem could not be opened.\n");
+      perror("open");
+      return -1;
+  } else {
+      printf("\n\n\n/dev/mem opened.\n\n");
+  }
+
+  uint8_t* _l3_in       = (uint8_t*) mmap(NULL, map_dim, PROT_READ | PROT_WRITE, MAP_SHARED, fd, CMA_ADDR);
+  uint8_t* _l3_test     = (uint8_t*) mmap(NULL, map_dim, PROT_READ | PROT_WRITE, MAP_SHARED, fd, CMA_ADDR + map_dim);
+  volatile uint32_t* dma = (volatile uint32_t*) mmap(NULL, DMA_MAP, PROT_READ | PROT_WRITE, MAP_SHARED, fd, DMA_ADDR);
+
+  if( (_l3_in == MAP_FAILED) || (_l3_test == MAP_FAILED) || (dma == MAP_FAILED) ){
+    printf("Mmap Failed: %s\n",strerror(errno));
+    return -1;
+  }
+
+  memcpy(_l3_in, l3_in, map_dim);
+  memset(_l3_test, 0, map_dim);
+
+  const uint32_t buffer_in  = (uint32_t)(CMA_ADDR);
+  const uint32_t buffer_out = (uint32_t)(CMA_ADDR + map_dim);
+
+  printf("AES-128 CTR pipeline parameters\n");
+  printf("Max transfer          - %u MB     \n", max_mbytes           );
+  printf("DMA max per start     - %u B      \n", DMA_MAX_BYTES        );
+  printf("Accelerator clock     - %.1f MHz  \n", ACC_CLK_MHZ          );
+
+  /* Accelerator. */
+
+  XAes128_ctr_hw hw_acc;
+
+  /*
+   * Former argument of the following API must match the content of '/sys/class/uio/UIO_DEVICE/name'.
+   * 'UIO_DEVICE' might vary form case to case. Check it on the board after boot.
+   */
+
+  status = XAes128_ctr_hw_Initialize(&hw_acc,"aes128_ctr_hw");
+
+  if (status != XST_SUCCESS) {
+    printf("Init Error RM %d\n",status);
+    return status;
+  }
+
+  dma_reset(dma);
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|-----------------------------------|\n");
+  printf("| Accelerator - Known-answer tests. |");
+  printf("\n|-----------------------------------|\n\n");
+
+  uint8_t key[16], ctr[16], ctr_sw[16];
+  int vec_err;
+
+  /* FIPS-197 C.1, FIPS round constants. */
+
+  memcpy(_l3_in, fips197_pt, 16);
+  memcpy(ctr, sp800_ctr, 16);
+  vec_err  = xil_run(&hw_acc, dma, fips197_key, ctr, AES128_CTR_MODE_ECB, 1, buffer_in, buffer_out, 1) != 0;
+  vec_err += memcmp(_l3_test, fips197_ct, 16) != 0;
+  err_cnt += vec_err;
+  printf("FIPS-197 C.1 ECB           | %d mismatches\n", vec_err);
+
+  /* SP 800-38A F.1.1, ECB-AES128. */
+
+  memcpy(_l3_in, sp800_pt, 64);
+  vec_err  = xil_run(&hw_acc, dma, sp800_key, ctr, AES128_CTR_MODE_ECB, 1, buffer_in, buffer_out, 4) != 0;
+  vec_err += memcmp(_l3_test, sp800_ecb_ct, 64) != 0;
+  err_cnt += vec_err;
+  printf("SP 800-38A F.1.1 ECB       | %d mismatches\n", vec_err);
+
+  /* SP 800-38A F.5.1, CTR-AES128, also one block at a time: the counter is carried by the host. */
+
+  memcpy(ctr, sp800_ctr, 16);
+  vec_err  = xil_run(&hw_acc, dma, sp800_key, ctr, AES128_CTR_MODE_CTR, 1, buffer_in, buffer_out, 4) != 0;
+  vec_err += memcmp(_l3_test, sp800_ctr_ct, 64) != 0;
+  memcpy(ctr, sp800_ctr, 16);
+  for (int b = 0; b < 4; b++) {
+    vec_err += xil_run(&hw_acc, dma, sp800_key, ctr, AES128_CTR_MODE_CTR, 1,
+      buffer_in + 16 * b, buffer_out + 16 * b, 1) != 0;
+  }
+  vec_err += memcmp(_l3_test, sp800_ctr_ct, 64) != 0;
+  err_cnt += vec_err;
+  printf("SP 800-38A F.5.1 CTR       | %d mismatches\n", vec_err);
+
+  /* Random runs - every mode, both key schedules, counters crossing 2^64. */
+
+  vec_err = 0;
+  memcpy(_l3_in, l3_in, map_dim);
+
+  for (int r = 0; r < 12; r++) {
+    const int mode = r % 3;
+    const int fips = (r / 3) & 1;
+    const uint32_t nblocks = 1 + rand() % (max_blocks < 4096 ? max_blocks : 4096);
+
+    for (int i = 0; i < 16; i++) {
+      key[i] = rand() & 0xff;
+      ctr[i] = (i >= 8 && i < 15) ? 0xff : rand() & 0xff;
+    }
+    memcpy(ctr_sw, ctr, 16);
+
+    vec_err += xil_run(&hw_acc, dma, key, ctr, mode, fips, buffer_in, buffer_out, nblocks) != 0;
+    aes_sw(key, ctr_sw, mode, fips, l3_in, l3_golden, nblocks);
+    vec_err += memcmp(_l3_test, l3_golden, 16 * nblocks) != 0;
+    vec_err += memcmp(ctr, ctr_sw, 16) != 0;
+  }
+  err_cnt += vec_err;
+  printf("Random CTR / ECB / KS      | %d mismatches\n", vec_err);
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|--------------------------------------|\n");
+  printf("| Results - Throughput vs. size (ARM). |");
+  printf("\n|--------------------------------------|\n\n");
+
+  /*
+   * Accelerator: programming, DMA and completion, the data already in CMA.
+   * Host: the reference above, one pass per size - it is only there to
+   * check the output of the largest run.
+   */
+
+  timer_host t_acc, t_host;
+
+  printf("  %4s %10s %8s %14s %14s\n", "mode", "bytes", "runs", "accel (MB/s)", "host (MB/s)");
+
+  for (int mode = 0; mode < 3; mode++) {
+    for (uint64_t bytes = 16; bytes <= map_dim; bytes *= 16) {
+      const uint32_t nblocks = (uint32_t)(bytes / 16);
+      const unsigned n_runs = (bytes < (1u << 20)) ? (unsigned)((1u << 20) / bytes) : 4;
+
+      memset(key, 0x5a, 16);
+      memset(ctr, 0, 16);
+
+      uint8_t ctr_last[16];
+
+      clock_gettime(CLOCK_REALTIME, &t_acc.t0);
+      for (unsigned r = 0; r < n_runs; r++) {
+        memcpy(ctr_last, ctr, 16);
+        status |= xil_run(&hw_acc, dma, key, ctr, mode, 0, buffer_in, buffer_out, nblocks);
+      }
+      clock_gettime(CLOCK_REALTIME, &t_acc.t1);
+      t_acc.t_meas = ((t_acc.t1.tv_sec - t_acc.t0.tv_sec) + (t_acc.t1.tv_nsec - t_acc.t0.tv_nsec)/1000000000.0)*1000.0;
+
+      /* Last run against the host, same counter. */
+
+      clock_gettime(CLOCK_REALTIME, &t_host.t0);
+      aes_sw(key, ctr_last, mode, 0, l3_in, l3_golden, nblocks);
+      clock_gettime(CLOCK_REALTIME, &t_host.t1);
+      t_host.t_meas = ((t_host.t1.tv_sec - t_host.t0.tv_sec) + (t_host.t1.tv_nsec - t_host.t0.tv_nsec)/1000000000.0)*1000.0;
+
+      if (memcmp(_l3_test, l3_golden, bytes)) {
+        printf("ERROR: %s output mismatch at %llu bytes\n", mode_name[mode], (unsigned long long)bytes);
+        err_cnt++;
+      }
+
+      printf("  %4s %10llu %8u %14.1f %14.1f\n", mode_name[mode], (unsigned long long)bytes, n_runs,
+        (double)bytes * n_runs / (t_acc.t_meas * 1000.0),
+        (double)bytes / (t_host.t_meas * 1000.0));
+    }
+  }
+
+  printf("\nPipeline peak (1 block / clock): %.1f MB/s\n", 16.0 * ACC_CLK_MHZ);
+
+  if (status)
+    printf("ERROR: DMA error during the throughput runs\n");
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|----------|\n");
+  printf("| Cleanup. |");
+  printf("\n|----------|\n\n");
+
+  XAes128_ctr_hw_Release(&hw_acc);
+
+  munmap(_l3_in,   map_dim);
+  munmap(_l3_test, map_dim);
+  munmap((void*)dma, DMA_MAP);
+  close(fd);
+
+  free(l3_in);
+  free(l3_golden);
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  if (err_cnt == 0 && status == 0)
+    printf("\n*** TEST PASSED ***\n");
+  else
+    printf("\n!!! TEST FAILED - %d mismatches detected !!!\n", err_cnt);
+
+  printf("\n|-------------|\n");
+  printf("| Test - End. |");
+  printf("\n|-------------|\n\n");
+
+  return 0;
+}
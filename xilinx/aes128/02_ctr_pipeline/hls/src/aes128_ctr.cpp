@@ -0,0 +1,131 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Libraries. */
+
+#include "aes128_ctr.h"
+#include "../../../common/aes128_rounds.h"
+
+/*
+ *
+ * AES-128 - CTR pipeline (top).
+ *
+ */
+
+static void word_bytes(uint32_t w, uint8_t *b)
+{
+    #pragma HLS INLINE
+    for (int i = 0; i < 4; i++) {
+        b[i] = (uint8_t)(w >> (8 * i));
+    }
+}
+
+void aes128_ctr_hw(
+        uint32_t key_0, uint32_t key_1, uint32_t key_2, uint32_t key_3,
+        uint32_t ctr_0, uint32_t ctr_1, uint32_t ctr_2, uint32_t ctr_3,
+        uint32_t nblocks, uint32_t mode, uint32_t flags,
+        hls::stream<aes_blk_t> &src,
+        hls::stream<aes_blk_t> &dst)
+{
+
+    /* Control interface. */
+    #pragma HLS INTERFACE s_axilite port=key_0   bundle=control
+    #pragma HLS INTERFACE s_axilite port=key_1   bundle=control
+    #pragma HLS INTERFACE s_axilite port=key_2   bundle=control
+    #pragma HLS INTERFACE s_axilite port=key_3   bundle=control
+    #pragma HLS INTERFACE s_axilite port=ctr_0   bundle=control
+    #pragma HLS INTERFACE s_axilite port=ctr_1   bundle=control
+    #pragma HLS INTERFACE s_axilite port=ctr_2   bundle=control
+    #pragma HLS INTERFACE s_axilite port=ctr_3   bundle=control
+    #pragma HLS INTERFACE s_axilite port=nblocks bundle=control
+    #pragma HLS INTERFACE s_axilite port=mode    bundle=control
+    #pragma HLS INTERFACE s_axilite port=flags   bundle=control
+    #pragma HLS INTERFACE s_axilite port=return  bundle=control
+
+    /* Data streaming interface. */
+    #pragma HLS INTERFACE axis port=&src
+    #pragma HLS INTERFACE axis port=&dst
+
+    uint8_t key[16];
+    #pragma HLS ARRAY_PARTITION variable=key complete
+    uint8_t rk[11][16];
+    #pragma HLS ARRAY_PARTITION variable=rk dim=0 complete
+
+    word_bytes(key_0, &key[0]);
+    word_bytes(key_1, &key[4]);
+    word_bytes(key_2, &key[8]);
+    word_bytes(key_3, &key[12]);
+
+    aes_expand_key(key, flags & AES128_CTR_FIPS, rk);
+
+    /*
+        - Counter -
+        Two 64-bit halves, big-endian: byte 0 of the block is the most
+        significant byte of hi. The carry into hi is the only logic across
+        iterations, i.e. the loop-carried dependency stays in one cycle.
+    */
+    uint64_t hi = 0, lo = 0;
+    const uint32_t ctr_w[4] = { ctr_0, ctr_1, ctr_2, ctr_3 };
+
+    Load_Ctr: for (int i = 0; i < 16; i++) {
+    #pragma HLS UNROLL
+        uint8_t b = (uint8_t)(ctr_w[i / 4] >> (8 * (i % 4)));
+        if (i < 8)
+            hi = (hi << 8) | b;
+        else
+            lo = (lo << 8) | b;
+    }
+
+    /* One block per clock. */
+    Blocks: for (uint32_t n = 0; n < nblocks; n++) {
+    #pragma HLS LOOP_TRIPCOUNT min=1 max=65536
+    #pragma HLS PIPELINE II=1
+        uint8_t s[16], x[16];
+        #pragma HLS ARRAY_PARTITION variable=s complete
+        #pragma HLS ARRAY_PARTITION variable=x complete
+        aes_blk_t in, out;
+
+        if (mode != AES128_CTR_MODE_KS) {
+            in = src.read();
+        } else {
+            in.data = 0;
+        }
+
+        Unpack: for (int i = 0; i < 16; i++) {
+            x[i] = (uint8_t)in.data.range(8 * i + 7, 8 * i);
+            if (mode == AES128_CTR_MODE_ECB)
+                s[i] = x[i];
+            else
+                s[i] = (uint8_t)((i < 8 ? hi >> (8 * (7 - i)) : lo >> (8 * (15 - i))));
+        }
+
+        if (++lo == 0)
+            hi++;
+
+        aes_encrypt_block(s, rk);
+
+        Pack: for (int i = 0; i < 16; i++) {
+            out.data.range(8 * i + 7, 8 * i) = (mode == AES128_CTR_MODE_CTR) ? (uint8_t)(s[i] ^ x[i]) : s[i];
+        }
+        out.keep = -1;
+        out.strb = -1;
+        out.user = 0;
+        out.id = 0;
+        out.dest = 0;
+        out.last = (n == nblocks - 1);
+        dst.write(out);
+    }
+}
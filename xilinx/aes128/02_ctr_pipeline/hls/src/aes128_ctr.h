@@ -0,0 +1,57 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AES128_CTR_H_
+#define AES128_CTR_H_
+
+#include <stdint.h>
+#include <ap_int.h>
+#include <ap_axi_sdata.h>
+#include <hls_stream.h>
+
+/*
+    Fully pipelined AES-128: the 10 rounds unrolled, one 128-bit block per
+    clock in and out on AXI-Stream, byte i of a block in bits [8i+7:8i].
+
+    Key and initial counter are written over AXI-Lite as 32-bit words, byte
+    0 in bits [7:0] of word 0. The key is expanded once per start, the
+    counter is the 128-bit big-endian counter of SP 800-38A (and of
+    AES_Util_Increment() on the host), incremented per block.
+*/
+
+/* Modes. */
+
+#define AES128_CTR_MODE_CTR     0   // dst = src ^ E(ctr++)
+#define AES128_CTR_MODE_ECB     1   // dst = E(src)
+#define AES128_CTR_MODE_KS      2   // dst = E(ctr++), no input: keystream only
+
+/* Flags. */
+
+#define AES128_CTR_FIPS         0x1 // FIPS-197 round constants, otherwise
+                                    // rcon = 0x01 in every round as the
+                                    // axis_aes128 design (AES_RCON_FIXED)
+
+typedef ap_axiu<128, 1, 1, 1> aes_blk_t;
+
+// External function prototypes
+void aes128_ctr_hw(
+        uint32_t key_0, uint32_t key_1, uint32_t key_2, uint32_t key_3,
+        uint32_t ctr_0, uint32_t ctr_1, uint32_t ctr_2, uint32_t ctr_3,
+        uint32_t nblocks, uint32_t mode, uint32_t flags,
+        hls::stream<aes_blk_t> &src,
+        hls::stream<aes_blk_t> &dst);
+
+#endif // AES128_CTR_H_ not defined
@@ -0,0 +1,304 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Libraries. */
+
+#include <string.h>
+#include <iostream>
+#include <iomanip>
+
+/* Include HLS source header. */
+
+#include "aes128_ctr.h"
+
+using namespace std;
+
+/* Modeled accelerator clock (run_hls.tcl: 6.66 ns). */
+
+#define ACC_CLK_MHZ 150.0
+
+/* FIPS-197 Appendix C.1. */
+
+static const uint8_t fips197_key[16] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const uint8_t fips197_pt[16] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const uint8_t fips197_ct[16] = {
+    0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+
+/* SP 800-38A F.1.1 (ECB-AES128) and F.5.1 (CTR-AES128), same key and plaintext. */
+
+static const uint8_t sp800_key[16] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const uint8_t sp800_ctr[16] = {
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+static const uint8_t sp800_pt[64] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+static const uint8_t sp800_ecb_ct[64] = {
+    0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97,
+    0xf5, 0xd3, 0xd5, 0x85, 0x03, 0xb9, 0x69, 0x9d, 0xe7, 0x85, 0x89, 0x5a, 0x96, 0xfd, 0xba, 0xaf,
+    0x43, 0xb1, 0xcd, 0x7f, 0x59, 0x8e, 0xce, 0x23, 0x88, 0x1b, 0x00, 0xe3, 0xed, 0x03, 0x06, 0x88,
+    0x7b, 0x0c, 0x78, 0x5e, 0x27, 0xe8, 0xad, 0x3f, 0x82, 0x23, 0x20, 0x71, 0x04, 0x72, 0x5d, 0xd4
+};
+static const uint8_t sp800_ctr_ct[64] = {
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+    0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+    0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+/* Host reference - byte-oriented AES-128, S-box computed from GF(2^8). */
+
+static uint8_t ref_sbox[256];
+
+static uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+    uint8_t p = 0;
+    while (b) {
+        if (b & 1) p ^= a;
+        a = (uint8_t)((a << 1) ^ ((a & 0x80) ? 0x1b : 0));
+        b >>= 1;
+    }
+    return p;
+}
+
+static void ref_init(void)
+{
+    for (int x = 0; x < 256; x++) {
+        uint8_t inv = 0;
+        for (int y = 1; y < 256 && x; y++) {
+            if (gf_mul((uint8_t)x, (uint8_t)y) == 1) inv = (uint8_t)y;
+        }
+        uint8_t s = inv;
+        for (int i = 1; i < 5; i++) {
+            s ^= (uint8_t)((inv << i) | (inv >> (8 - i)));
+        }
+        ref_sbox[x] = s ^ 0x63;
+    }
+}
+
+static void ref_encrypt(const uint8_t key[16], int fips, const uint8_t in[16], uint8_t out[16])
+{
+    uint8_t w[176], s[16], t[16];
+    uint8_t rcon = 1;
+
+    memcpy(w, key, 16);
+    for (int i = 16; i < 176; i += 4) {
+        uint8_t tmp[4] = { w[i - 4], w[i - 3], w[i - 2], w[i - 1] };
+        if (i % 16 == 0) {
+            uint8_t t0 = tmp[0];
+            tmp[0] = ref_sbox[tmp[1]] ^ rcon;
+            tmp[1] = ref_sbox[tmp[2]];
+            tmp[2] = ref_sbox[tmp[3]];
+            tmp[3] = ref_sbox[t0];
+            if (fips) rcon = gf_mul(rcon, 2);
+        }
+        for (int j = 0; j < 4; j++) w[i + j] = w[i - 16 + j] ^ tmp[j];
+    }
+
+    for (int i = 0; i < 16; i++) s[i] = in[i] ^ w[i];
+    for (int r = 1; r <= 10; r++) {
+        for (int c = 0; c < 4; c++)
+            for (int i = 0; i < 4; i++)
+                t[4 * c + i] = ref_sbox[s[4 * ((c + i) & 3) + i]];
+        for (int c = 0; c < 4; c++) {
+            for (int i = 0; i < 4; i++) {
+                uint8_t v = t[4 * c + i];
+                if (r < 10) {
+                    v = gf_mul(t[4 * c + i], 2) ^ gf_mul(t[4 * c + ((i + 1) & 3)], 3)
+                      ^ t[4 * c + ((i + 2) & 3)] ^ t[4 * c + ((i + 3) & 3)];
+                }
+                s[4 * c + i] = v ^ w[16 * r + 4 * c + i];
+            }
+        }
+    }
+    memcpy(out, s, 16);
+}
+
+static void ref_ctr(const uint8_t key[16], int fips, const uint8_t ctr0[16],
+                    const uint8_t *in, uint8_t *out, int nblocks)
+{
+    uint8_t ctr[16], ks[16];
+
+    memcpy(ctr, ctr0, 16);
+    for (int b = 0; b < nblocks; b++) {
+        ref_encrypt(key, fips, ctr, ks);
+        for (int i = 0; i < 16; i++) out[16 * b + i] = (in ? in[16 * b + i] : 0) ^ ks[i];
+        for (int i = 15; i >= 0 && ++ctr[i] == 0; i--)
+            ;
+    }
+}
+
+/* DUT run - returns the number of protocol errors: leftover input, output count or TLAST. */
+
+static uint32_t le_word(const uint8_t *b)
+{
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+static int dut_run(const uint8_t key[16], const uint8_t ctr[16], int mode, int flags,
+                   const uint8_t *in, uint8_t *out, int nblocks)
+{
+    hls::stream<aes_blk_t> src("src"), dst("dst");
+    int err = 0;
+
+    if (mode != AES128_CTR_MODE_KS) {
+        for (int b = 0; b < nblocks; b++) {
+            aes_blk_t blk;
+            for (int i = 0; i < 16; i++) blk.data.range(8 * i + 7, 8 * i) = in[16 * b + i];
+            blk.last = (b == nblocks - 1);
+            src << blk;
+        }
+    }
+
+    aes128_ctr_hw(
+        le_word(&key[0]), le_word(&key[4]), le_word(&key[8]), le_word(&key[12]),
+        le_word(&ctr[0]), le_word(&ctr[4]), le_word(&ctr[8]), le_word(&ctr[12]),
+        nblocks, mode, flags, src, dst);
+
+    if (!src.empty()) err++;
+    for (int b = 0; b < nblocks; b++) {
+        if (dst.empty()) return err + 1;
+        aes_blk_t blk = dst.read();
+        for (int i = 0; i < 16; i++) out[16 * b + i] = (uint8_t)blk.data.range(8 * i + 7, 8 * i);
+        if ((int)blk.last != (b == nblocks - 1)) err++;
+    }
+    if (!dst.empty()) err++;
+
+    return err;
+}
+
+/* Cycle model: key expansion, pipeline depth, then one block per clock. */
+
+static double model_cycles(int nblocks)
+{
+    const double expand = 10, depth = 12;
+    return expand + depth + nblocks;
+}
+
+int main(void)
+{
+
+    /* Algorithm parameters declaration. */
+
+    const int n_runs = 20;
+    const int max_blocks = 512;
+    uint8_t key[16], ctr[16];
+    uint8_t pt[16 * max_blocks], ct[16 * max_blocks], ref[16 * max_blocks];
+    int err_cnt = 0;
+    int ret_val = 20;
+    uint32_t lcg = 0x2468ace1;
+
+    ref_init();
+
+    /* Standard vectors, FIPS round constants. */
+
+    int vec_err = 0;
+
+    vec_err += dut_run(fips197_key, fips197_key, AES128_CTR_MODE_ECB, AES128_CTR_FIPS, fips197_pt, ct, 1);
+    vec_err += memcmp(ct, fips197_ct, 16) != 0;
+    cout << "FIPS-197 C.1 ECB           | " << vec_err << " mismatches" << endl;
+    err_cnt += vec_err;
+
+    vec_err = dut_run(sp800_key, sp800_ctr, AES128_CTR_MODE_ECB, AES128_CTR_FIPS, sp800_pt, ct, 4);
+    vec_err += memcmp(ct, sp800_ecb_ct, 64) != 0;
+    cout << "SP 800-38A F.1.1 ECB       | " << vec_err << " mismatches" << endl;
+    err_cnt += vec_err;
+
+    vec_err = dut_run(sp800_key, sp800_ctr, AES128_CTR_MODE_CTR, AES128_CTR_FIPS, sp800_pt, ct, 4);
+    vec_err += memcmp(ct, sp800_ctr_ct, 64) != 0;
+    vec_err += dut_run(sp800_key, sp800_ctr, AES128_CTR_MODE_CTR, AES128_CTR_FIPS, sp800_ctr_ct, ct, 4);
+    vec_err += memcmp(ct, sp800_pt, 64) != 0;
+    cout << "SP 800-38A F.5.1/F.5.2 CTR | " << vec_err << " mismatches" << endl;
+    err_cnt += vec_err;
+
+    /*
+        Random runs against the reference, both key schedules and all
+        modes. The counters start close to 2^64 and 2^128 to carry across
+        the halves and wrap.
+    */
+
+    long blocks = 0;
+    double cycles = 0;
+    int rnd_err = 0;
+
+    for (int r = 0; r < n_runs; r++) {
+        const int mode = r % 3;
+        const int flags = (r / 3) & 1 ? AES128_CTR_FIPS : 0;
+        int nblocks;
+
+        lcg = lcg * 1664525 + 1013904223;
+        nblocks = 1 + (lcg >> 8) % max_blocks;
+        for (int i = 0; i < 16; i++) {
+            lcg = lcg * 1664525 + 1013904223;
+            key[i] = (uint8_t)(lcg >> 24);
+            ctr[i] = (i < 8) ? (uint8_t)(lcg >> 16) : 0xff;
+        }
+        if (r & 1) memset(ctr, 0xff, 8);
+        ctr[15] = (uint8_t)(0x100 - nblocks / 2);
+        for (int i = 0; i < 16 * nblocks; i++) {
+            lcg = lcg * 1664525 + 1013904223;
+            pt[i] = (uint8_t)(lcg >> 24);
+        }
+
+        rnd_err += dut_run(key, ctr, mode, flags, pt, ct, nblocks);
+        if (mode == AES128_CTR_MODE_ECB) {
+            for (int b = 0; b < nblocks; b++) ref_encrypt(key, flags, &pt[16 * b], &ref[16 * b]);
+        } else {
+            ref_ctr(key, flags, ctr, mode == AES128_CTR_MODE_CTR ? pt : NULL, ref, nblocks);
+        }
+        rnd_err += memcmp(ct, ref, 16 * nblocks) != 0;
+
+        blocks += nblocks;
+        cycles += model_cycles(nblocks);
+    }
+    err_cnt += rnd_err;
+
+    /* Performance model. */
+
+    const int big = 65536;
+    double t_acc = cycles / (ACC_CLK_MHZ * 1e6);
+
+    cout << n_runs << " random runs, " << blocks << " blocks"
+         << " | " << rnd_err << " mismatches"
+         << " | model " << (long)cycles << " cycles, "
+         << fixed << setprecision(1) << 16.0 * blocks / t_acc / 1e6 << " MB/s" << endl;
+    cout << big << " blocks per start"
+         << " | model " << (long)model_cycles(big) << " cycles, "
+         << 16.0 * big / (model_cycles(big) / (ACC_CLK_MHZ * 1e6)) / 1e6 << " MB/s"
+         << " (peak " << 16.0 * ACC_CLK_MHZ << ")" << endl;
+    cout << endl;
+
+    if (err_cnt == 0) {
+        cout << "*** TEST PASSED ***" << endl;
+        ret_val = 0;
+    } else {
+        cout << "!!! TEST FAILED - " << err_cnt << " mismatches detected !!!";
+        cout << endl;
+        ret_val = -1;
+    }
+
+    return ret_val;
+}
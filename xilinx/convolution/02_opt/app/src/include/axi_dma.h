@@ -0,0 +1,146 @@
+/************************************************************************
+ * Filename:        axi_dma.h
+ * Description:     Register-level AXI DMA (direct register mode) helpers
+ *                  for streaming frames through an AXI4-Stream accelerator.
+ ************************************************************************/
+
+#ifndef AXI_DMA_H
+#define AXI_DMA_H
+
+#include <stdint.h>
+
+/************************* Constant Definitions ************************/
+
+// Base address of the AXI DMA feeding the accelerator (see address editor).
+#define AXI_DMA_ADDR 0xA0000000
+#define AXI_DMA_MAP_SIZE 0x10000
+
+// offsets specified in AXI DMA reference guide
+// https://www.xilinx.com/support/documentation/ip_documentation/axi_dma/v7_1/pg021_axi_dma.pdf
+#define MM2S_CONTROL_REGISTER 0x00
+#define MM2S_STATUS_REGISTER 0x04
+#define MM2S_SRC_ADDRESS_REGISTER 0x18
+#define MM2S_SRC_ADDRESS_MSB_REGISTER 0x1C
+#define MM2S_TRNSFR_LENGTH_REGISTER 0x28
+
+#define S2MM_CONTROL_REGISTER 0x30
+#define S2MM_STATUS_REGISTER 0x34
+#define S2MM_DST_ADDRESS_REGISTER 0x48
+#define S2MM_DST_ADDRESS_MSB_REGISTER 0x4C
+#define S2MM_BUFF_LENGTH_REGISTER 0x58
+
+// control
+#define RUN_DMA 0x00000001
+#define RESET_DMA 0x00000004
+
+// status
+#define STATUS_HALTED 0x00000001
+#define STATUS_IDLE 0x00000002
+#define STATUS_ERR_MASK 0x00000770 // internal, slave, decode errors (DMA and SG)
+#define STATUS_IOC_IRQ 0x00001000
+
+/*
+ * Note: a single transfer moves one whole frame, i.e. the 'Width of Buffer
+ * Length Register' of the AXI DMA must be set to at least 19 bits for
+ * 320x320x4 B frames (default is 14 bits, 16 KB).
+ */
+
+/************************ Functions Definitions ************************/
+
+/*  axi_dma_write():            write a DMA register
+ *
+ *	volatile uint32_t *regs:    virtual base address of the DMA registers
+ *	int offset:                 register offset
+ *	uint32_t value:             the value to write
+ */
+static inline void axi_dma_write(volatile uint32_t *regs, int offset, uint32_t value)
+{
+    regs[offset >> 2] = value;
+}
+
+/*  axi_dma_read():             read a DMA register
+ *
+ *	volatile uint32_t *regs:    virtual base address of the DMA registers
+ *	int offset:                 register offset
+ *
+ * 	return the read value
+ */
+static inline uint32_t axi_dma_read(volatile uint32_t *regs, int offset)
+{
+    return regs[offset >> 2];
+}
+
+/*  axi_dma_init():             reset both channels and set them running
+ *
+ * 	return 0 on success, -1 if the channels do not leave the halted state
+ */
+static inline int axi_dma_init(volatile uint32_t *regs)
+{
+    // Resetting one channel resets the whole core.
+    axi_dma_write(regs, MM2S_CONTROL_REGISTER, RESET_DMA);
+    while (axi_dma_read(regs, MM2S_CONTROL_REGISTER) & RESET_DMA);
+
+    // Run, interrupts disabled - completion is polled.
+    axi_dma_write(regs, MM2S_CONTROL_REGISTER, RUN_DMA);
+    axi_dma_write(regs, S2MM_CONTROL_REGISTER, RUN_DMA);
+
+    if ((axi_dma_read(regs, MM2S_STATUS_REGISTER) & STATUS_HALTED) ||
+        (axi_dma_read(regs, S2MM_STATUS_REGISTER) & STATUS_HALTED))
+        return -1;
+    return 0;
+}
+
+/*  axi_dma_mm2s_start():       kick off a memory-mapped to stream transfer
+ *
+ *  uint64_t addr:              physical source address
+ *  uint32_t n_bytes:           transfer length, writing it starts the DMA
+ */
+static inline void axi_dma_mm2s_start(volatile uint32_t *regs, uint64_t addr, uint32_t n_bytes)
+{
+    axi_dma_write(regs, MM2S_STATUS_REGISTER, STATUS_IOC_IRQ); // clear IOC (W1C)
+    axi_dma_write(regs, MM2S_SRC_ADDRESS_REGISTER, (uint32_t)addr);
+    axi_dma_write(regs, MM2S_SRC_ADDRESS_MSB_REGISTER, (uint32_t)(addr >> 32));
+    axi_dma_write(regs, MM2S_TRNSFR_LENGTH_REGISTER, n_bytes);
+}
+
+/*  axi_dma_s2mm_start():       arm a stream to memory-mapped transfer
+ *
+ *  uint64_t addr:              physical destination address
+ *  uint32_t n_bytes:           buffer length, the transfer ends on TLAST
+ */
+static inline void axi_dma_s2mm_start(volatile uint32_t *regs, uint64_t addr, uint32_t n_bytes)
+{
+    axi_dma_write(regs, S2MM_STATUS_REGISTER, STATUS_IOC_IRQ); // clear IOC (W1C)
+    axi_dma_write(regs, S2MM_DST_ADDRESS_REGISTER, (uint32_t)addr);
+    axi_dma_write(regs, S2MM_DST_ADDRESS_MSB_REGISTER, (uint32_t)(addr >> 32));
+    axi_dma_write(regs, S2MM_BUFF_LENGTH_REGISTER, n_bytes);
+}
+
+/*  axi_dma_s2mm_length():      bytes received by the last S2MM transfer
+ *
+ *  Valid once the transfer is complete: a stream ending on an early TLAST
+ *  reads back less than the armed buffer length.
+ */
+static inline uint32_t axi_dma_s2mm_length(volatile uint32_t *regs)
+{
+    return axi_dma_read(regs, S2MM_BUFF_LENGTH_REGISTER);
+}
+
+/*  axi_dma_wait():             wait for a channel to complete its transfer
+ *
+ *  int status_reg:             MM2S_STATUS_REGISTER or S2MM_STATUS_REGISTER
+ *
+ * 	return 0 once the channel is idle, -1 on DMA error
+ */
+static inline int axi_dma_wait(volatile uint32_t *regs, int status_reg)
+{
+    uint32_t status;
+    do {
+        status = axi_dma_read(regs, status_reg);
+        if (status & STATUS_ERR_MASK)
+            return -1;
+    } while (!(status & STATUS_IOC_IRQ) || !(status & STATUS_IDLE));
+    return 0;
+}
+
+#endif
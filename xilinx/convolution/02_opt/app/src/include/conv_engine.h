@@ -0,0 +1,102 @@
+/************************************************************************
+ * Filename:        conv_engine.h
+ * Description:     Host-side engine selection for a KxK convolution
+ *                  kernel: rank-1 kernels are factored into the taps of
+ *                  the separable engine (filter11x11_strm / _video), any
+ *                  other kernel runs on the window engine
+ *                  (filter11x11_2d_strm). Plain C, shared by the app, the
+ *                  HLS testbench and the benchmark.
+ ************************************************************************/
+
+#ifndef CONV_ENGINE_H
+#define CONV_ENGINE_H
+
+#include <stdint.h>
+
+/************************* Constant Definitions ************************/
+
+#define CONV_ENGINE_SEPARABLE 0 // hcoeffs, vcoeffs: 2 * K MACs per pixel
+#define CONV_ENGINE_2D        1 // coeffs: K * K MACs per pixel
+
+static const char * const conv_engine_names[] = { "separable", "2d" };
+
+/************************ Functions Definitions ************************/
+
+static inline uint32_t conv_gcd(uint32_t a, uint32_t b)
+{
+    while (b) { uint32_t t = a % b; a = b; b = t; }
+    return a;
+}
+
+/*  conv_filter_rank1():        factor a KxK kernel as the outer product
+ *                              vcoeffs x hcoeffs of two integer vectors,
+ *                              i.e. coeffs[i * k + j] == vcoeffs[i] * hcoeffs[j]
+ *
+ *	const uint32_t *coeffs:     k * k taps, row-major
+ *	int k:                      window size
+ *	uint32_t *hcoeffs:          k horizontal taps, out
+ *	uint32_t *vcoeffs:          k vertical taps, out
+ *
+ *	return 1 (rank <= 1) if the separable engine can be used, 0 otherwise
+ */
+static inline int conv_filter_rank1(
+    const uint32_t *coeffs, int k,
+    uint32_t *hcoeffs, uint32_t *vcoeffs)
+{
+    int p = -1, q = -1;
+    uint32_t g = 0;
+
+    // Find a pivot entry; an all-zero kernel is trivially separable.
+    for (int i = 0; i < k * k && p < 0; i++) {
+        if (coeffs[i]) { p = i / k; q = i % k; }
+    }
+    if (p < 0) {
+        for (int i = 0; i < k; i++) hcoeffs[i] = vcoeffs[i] = 0;
+        return 1;
+    }
+
+    // Rank-1 check: every 2x2 minor through the pivot must vanish.
+    for (int i = 0; i < k; i++) {
+        for (int j = 0; j < k; j++) {
+            uint64_t lhs = (uint64_t)coeffs[i * k + j] * coeffs[p * k + q];
+            uint64_t rhs = (uint64_t)coeffs[i * k + q] * coeffs[p * k + j];
+            if (lhs != rhs) return 0;
+        }
+    }
+
+    // Horizontal taps: pivot row reduced by its gcd, vertical taps: pivot
+    // column divided by the matching horizontal tap.
+    for (int j = 0; j < k; j++) g = conv_gcd(g, coeffs[p * k + j]);
+    for (int j = 0; j < k; j++) hcoeffs[j] = coeffs[p * k + j] / g;
+    for (int i = 0; i < k; i++) {
+        if (coeffs[i * k + q] % hcoeffs[q]) return 0;
+        vcoeffs[i] = coeffs[i * k + q] / hcoeffs[q];
+    }
+
+    // Integer factors must reproduce the kernel exactly.
+    for (int i = 0; i < k; i++) {
+        for (int j = 0; j < k; j++) {
+            if (vcoeffs[i] * hcoeffs[j] != coeffs[i * k + j]) return 0;
+        }
+    }
+    return 1;
+}
+
+/*  conv_engine_select():       engine for a KxK kernel
+ *
+ *	const uint32_t *coeffs:     k * k taps, row-major
+ *	int k:                      window size
+ *	uint32_t *hcoeffs:          k horizontal taps, out (separable only)
+ *	uint32_t *vcoeffs:          k vertical taps, out (separable only)
+ *
+ *	return CONV_ENGINE_SEPARABLE or CONV_ENGINE_2D
+ */
+static inline int conv_engine_select(
+    const uint32_t *coeffs, int k,
+    uint32_t *hcoeffs, uint32_t *vcoeffs)
+{
+    return conv_filter_rank1(coeffs, k, hcoeffs, vcoeffs) ?
+        CONV_ENGINE_SEPARABLE : CONV_ENGINE_2D;
+}
+
+#endif
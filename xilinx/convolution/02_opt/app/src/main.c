@@ -25,14 +25,20 @@
 #include <time.h>
 #include <errno.h>
 
-/* Include accelerator drivers. */
-#include <xfilter11x11_orig.h>
-#include <xfilter11x11_orig_hw.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 
-/* Include DMA drivers. */
-// #include "include/embeddedsw/XilinxProcessorIPLib/drivers/axidma/src/xaxidma.h"
-#include "include/embeddedsw/XilinxProcessorIPLib/drivers/scugic/src/xscugic.h"
-// #include "include/dma_accel.h"
+/* 
+ * The video accelerator (filter11x11_video) is free-running (ap_ctrl_none)
+ * and its coefficients are tied in the block design, hence it needs no
+ * driver: frames are moved in and out by the AXI DMA only.
+ */
+
+/* Include DMA register helpers. */
+#include "include/axi_dma.h"
+
+/* Include host engine selection. */
+#include "include/conv_engine.h"
 
 /* Include host timer struct. */
 #include <xil-bench.h>
@@ -52,6 +58,20 @@
 #define UAV_DATA_SIZE UAV_ROWS*UAV_COLS
 #define UAV_FILTER_DIM 11 // Window size
 
+/* 
+ * Filter taps tied to the separable engine in the block design, i.e. the
+ * Gaussian the golden results are made with. Default KxK kernel of the
+ * run: their outer product.
+ */
+static const uint32_t conv_tied_taps[UAV_FILTER_DIM] = {
+  36, 111, 266, 498, 724, 821, 724, 498, 266, 111, 36
+};
+
+/* Video streaming. */
+#define N_FRAMES 100      // Default number of streamed frames
+#define N_FRAME_BUFS 4    // Pre-allocated source/destination frame buffers in CMA
+                          // (plus one scratch frame past the destination ones)
+
 
 /* Checksum. */
 
@@ -88,87 +108,124 @@ void check_result(
     }
 }
 
-/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+/* Latency percentiles. */
 
-/* Accelerator - Programming. */
-
-timer_xil_exec xil_exec( 
-  XFilter11x11_orig hw_acc,
-  uint64_t const buffer_src,
-  uint64_t const buffer_dst) 
+static int cmp_float(const void *a, const void *b)
 {
+  float fa = *(const float *)a;
+  float fb = *(const float *)b;
+  return (fa > fb) - (fa < fb);
+}
 
-  /* Timers. */
-
-  timer_host      t_acc_progr;
-  timer_host      t_proc;
-  timer_xil_exec  t_out;
+float percentile(float *sorted, unsigned n, float pct)
+{
+  unsigned idx = (unsigned)(pct / 100.0 * (n - 1) + 0.5);
+  return sorted[idx];
+}
 
-  /* DRAM offsets. */
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
 
-  uint64_t src_dram_offset;
-  uint64_t dst_dram_offset;
+/* Accelerator - Video streaming. */
 
-  /* Initialize timers. */
+/*
+ * Stream 'n_frames' frames back-to-back through the accelerator, cycling
+ * over the pre-allocated frame buffers. The next input frame is submitted
+ * as soon as MM2S is idle, so that the free-running accelerator is never
+ * starved; S2MM is re-armed as soon as the previous output frame landed.
+ * Per-frame latency spans input submission to output completion.
+ *
+ * The accelerator output trails its input by CONV_LAG_ROWS (16) rows, i.e.
+ * an output frame completes while the next input frame comes in: one more
+ * (flush) frame is sent at the end, its output drained into buffer_scratch.
+ * The last rows of the flush frame stay in the accelerator; they reach the
+ * next run as a short first transfer, which is dropped.
+ */
 
-  t_acc_progr.t_meas = 0.0;
-  t_proc.t_meas = 0.0;
+int xil_stream(
+  volatile uint32_t *dma_regs,
+  uint64_t const buffer_src,
+  uint64_t const buffer_dst,
+  uint64_t const buffer_scratch,
+  uint32_t const frame_bytes,
+  unsigned const n_frames,
+  float *t_lat,
+  timer_host *t_stream) 
+{
+  /* Timers. */
 
-  if (XFilter11x11_orig_IsReady(&hw_acc)) {
+  struct timespec *t_submit = (struct timespec *)malloc(n_frames * sizeof(struct timespec));
+  struct timespec t_done;
 
-    /* DMA */
+  if (t_submit == NULL) {
+    printf("ERROR: malloc() failed!\n");
+    return -ENOMEM;
+  }
 
-    // Kick off MM2S transfer
-    status = XAxiDma_SimpleTransfer
-    (
-      &p_dma_accel_inst->periphs.dma_inst,
-      (int)p_dma_accel_inst->p_stim_buf,
-      num_bytes,
-      XAXIDMA_DMA_TO_DEVICE
-    );
-    if (status != DMA_ACCEL_SUCCESS)
-    {
-      xil_printf("ERROR! Failed to kick off MM2S transfer!\n\r");
-      return DMA_ACCEL_XFER_FAIL;
-    }
+  clock_gettime(CLOCK_REALTIME, &t_stream->t0);
 
-    /* Accelerator programming. */
+  /* Prime both channels with frame 0. */
 
-    clock_gettime(CLOCK_REALTIME, &t_acc_progr.t0);
+  axi_dma_s2mm_start(dma_regs, buffer_dst, frame_bytes);
+  clock_gettime(CLOCK_REALTIME, &t_submit[0]);
+  axi_dma_mm2s_start(dma_regs, buffer_src, frame_bytes);
 
-    /* Update DRAM offsets. */
+  for (unsigned f = 0; f < n_frames; f++) {
 
-    // src_dram_offset = buffer_src; 
-    // dst_dram_offset = buffer_dst;
+    /* Submit next input frame once the current one has been read out. */
 
-    /* Accelerator programming. */
+    if (axi_dma_wait(dma_regs, MM2S_STATUS_REGISTER)) {
+      printf("ERROR: MM2S transfer failed at frame %u!\n", f);
+      free(t_submit);
+      return -1;
+    }
 
-    // XFilter11x11_orig_Set_src(&hw_acc, (uint64_t)(src_dram_offset));
-    // XFilter11x11_orig_Set_dst(&hw_acc, (uint64_t)(dst_dram_offset));
+    {
+      uint64_t src = buffer_src + ((f + 1) % N_FRAME_BUFS) * (uint64_t)frame_bytes;
+      if (f + 1 < n_frames)
+        clock_gettime(CLOCK_REALTIME, &t_submit[f + 1]);
+      axi_dma_mm2s_start(dma_regs, src, frame_bytes);
+    }
 
-    clock_gettime(CLOCK_REALTIME, &t_acc_progr.t1);
-    t_acc_progr.t_meas += ((t_acc_progr.t1.tv_sec - t_acc_progr.t0.tv_sec) + (t_acc_progr.t1.tv_nsec - t_acc_progr.t0.tv_nsec)/1000000000.0)*1000.0;
+    /* Collect output frame, then re-arm S2MM for the next one. */
 
-    /* Processing. */
+    if (axi_dma_wait(dma_regs, S2MM_STATUS_REGISTER)) {
+      printf("ERROR: S2MM transfer failed at frame %u!\n", f);
+      free(t_submit);
+      return -1;
+    }
 
-    clock_gettime(CLOCK_REALTIME, &t_proc.t0);
+    if (f == 0 && axi_dma_s2mm_length(dma_regs) < frame_bytes) {
+      axi_dma_s2mm_start(dma_regs, buffer_dst, frame_bytes);
+      if (axi_dma_wait(dma_regs, S2MM_STATUS_REGISTER)) {
+        printf("ERROR: S2MM transfer failed at frame %u!\n", f);
+        free(t_submit);
+        return -1;
+      }
+    }
 
-    // XFilter11x11_orig_Start(&hw_acc);
-    // while(!XFilter11x11_orig_IsDone(&hw_acc));
+    clock_gettime(CLOCK_REALTIME, &t_done);
+    t_lat[f] = ((t_done.tv_sec - t_submit[f].tv_sec) + (t_done.tv_nsec - t_submit[f].tv_nsec)/1000000000.0)*1000.0;
 
-    clock_gettime(CLOCK_REALTIME, &t_proc.t1);
-    t_proc.t_meas += ((t_proc.t1.tv_sec - t_proc.t0.tv_sec) + (t_proc.t1.tv_nsec - t_proc.t0.tv_nsec)/1000000000.0)*1000.0;
+    {
+      uint64_t dst = f + 1 < n_frames ?
+        buffer_dst + ((f + 1) % N_FRAME_BUFS) * (uint64_t)frame_bytes : buffer_scratch;
+      axi_dma_s2mm_start(dma_regs, dst, frame_bytes);
+    }
+  }
 
-  } else {
+  clock_gettime(CLOCK_REALTIME, &t_stream->t1);
+  t_stream->t_meas = ((t_stream->t1.tv_sec - t_stream->t0.tv_sec) + (t_stream->t1.tv_nsec - t_stream->t0.tv_nsec)/1000000000.0)*1000.0;
 
-    printf("Accelerator is not ready..\n");
+  /* Let the whole flush frame in, leaving the accelerator between frames. */
 
+  if (axi_dma_wait(dma_regs, MM2S_STATUS_REGISTER)) {
+    printf("ERROR: MM2S transfer failed at flush frame!\n");
+    free(t_submit);
+    return -1;
   }
 
-  t_out.t_meas_progr    = t_acc_progr.t_meas;
-  t_out.t_meas_compute  = t_proc.t_meas;
-
-  return t_out;
+  free(t_submit);
+  return 0;
 }
 
 
@@ -191,12 +248,9 @@ int main(int argc, char *argv[])
   timer_host t_alloc;
   timer_host t_memcpy_in;
   timer_host t_acc_progr;
-  timer_host t_proc;
-  timer_host t_memcpy_out;
+  timer_host t_stream;
   timer_host t_clean;
 
-  timer_xil_exec t_acc_exec;
-
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
   printf("\n|----------------------------------------------------|\n");
@@ -215,26 +269,69 @@ clock_gettime(CLOCK_REALTIME, &t_alloc.t0);
   const int chkr_size = 5;
   const uint32_t max_pix_val = 255;
   const uint32_t min_pix_val = 0;
-  int err_cnt = 0;
-  int ret_val = 20;
 
   uint32_t width = IM_UAV_ROWS; 
   uint32_t height = IM_UAV_COLS; 
 
-  /* Filter components. */
-  
-  uint32_t filter_coeffs[UAV_FILTER_DIM] = {
-      36, 111, 266, 498, 724, 821, 724, 498, 266, 111, 36
-  };
+  /* Video streaming parameters - app_exec [n_frames] [kernel file]. */
+
+  unsigned n_frames = (argc > 1) ? (unsigned)atoi(argv[1]) : N_FRAMES;
+  if (n_frames == 0) n_frames = N_FRAMES;
+
+  /* Filter kernel - K*K taps, row-major, from the kernel file if any. */
+
+  uint32_t conv_kernel[UAV_FILTER_DIM * UAV_FILTER_DIM];
+  uint32_t hcoeffs[UAV_FILTER_DIM], vcoeffs[UAV_FILTER_DIM];
+
+  for (int i = 0; i < UAV_FILTER_DIM; i++) {
+    for (int j = 0; j < UAV_FILTER_DIM; j++) {
+      conv_kernel[i * UAV_FILTER_DIM + j] = conv_tied_taps[i] * conv_tied_taps[j];
+    }
+  }
+
+  if (argc > 2) {
+    FILE *fk = fopen(argv[2], "r");
+    if (fk == NULL) {
+      printf("Error: could not open file %s\n", argv[2]);
+      return 1;
+    }
+    for (int i = 0; i < UAV_FILTER_DIM * UAV_FILTER_DIM; i++) {
+      if (fscanf(fk, "%u", &conv_kernel[i]) != 1) {
+        printf("Error: %s holds fewer than %d taps\n", argv[2], UAV_FILTER_DIM * UAV_FILTER_DIM);
+        fclose(fk);
+        return 1;
+      }
+    }
+    fclose(fk);
+  }
+
+  /* 
+   * Engine selection - rank-1 kernels run on the separable engine, any
+   * other one needs the window engine (filter11x11_2d_strm). This
+   * bitstream holds the separable video engine with its taps tied.
+   */
+
+  int engine = conv_engine_select(conv_kernel, UAV_FILTER_DIM, hcoeffs, vcoeffs);
+
+  printf("Kernel %dx%d -> %s engine\n", UAV_FILTER_DIM, UAV_FILTER_DIM, conv_engine_names[engine]);
+
+  if (engine != CONV_ENGINE_SEPARABLE 
+      || memcmp(hcoeffs, conv_tied_taps, sizeof(hcoeffs)) 
+      || memcmp(vcoeffs, conv_tied_taps, sizeof(vcoeffs))) {
+    printf("ERROR: kernel not supported by this bitstream (separable engine, tied taps)!\n");
+    return -1;
+  }
 
-  uint64_t map_dim = 256 * 4 * 1024;  // Need to map at least 4KB
+  uint32_t frame_bytes = width * height * sizeof(uint32_t);
+  uint64_t map_dim = N_FRAME_BUFS * (uint64_t)frame_bytes;  // Multiple of 4KB
 
   /* Allocate DRAM arrays. */
 
-  uint32_t* l3_src_img     = (uint32_t*)malloc(width*height*sizeof(uint32_t));
-  uint32_t* l3_dst_img     = (uint32_t*)malloc(width*height*sizeof(uint32_t)); 
+  uint32_t* l3_src_img     = (uint32_t*)malloc(frame_bytes);
+  uint32_t* l3_dst_img     = (uint32_t*)malloc(frame_bytes); 
+  float*    t_lat          = (float*)malloc(n_frames * sizeof(float));
 
-  if ( (l3_src_img == NULL) || (l3_dst_img == NULL) ) {
+  if ( (l3_src_img == NULL) || (l3_dst_img == NULL) || (t_lat == NULL) ) {
     printf("ERROR: malloc() failed!\n");
     return -ENOMEM;
   }
@@ -249,18 +346,15 @@ clock_gettime(CLOCK_REALTIME, &t_alloc.t0);
       printf("\n\n\n/dev/mem opened.\n\n");
   }
 
-  uint64_t* _l3_src_img = (uint64_t *) mmap(NULL, map_dim, PROT_READ | PROT_WRITE, MAP_SHARED, fd, CMA_ADDR);
-  uint64_t* _l3_dst_img = (uint64_t *) mmap(NULL, map_dim, PROT_READ | PROT_WRITE, MAP_SHARED, fd, CMA_ADDR + map_dim);
+  uint32_t* _l3_src_img = (uint32_t *) mmap(NULL, map_dim, PROT_READ | PROT_WRITE, MAP_SHARED, fd, CMA_ADDR);
+  uint32_t* _l3_dst_img = (uint32_t *) mmap(NULL, map_dim, PROT_READ | PROT_WRITE, MAP_SHARED, fd, CMA_ADDR + map_dim);
+  volatile uint32_t* dma_regs = (volatile uint32_t *) mmap(NULL, AXI_DMA_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, AXI_DMA_ADDR);
 
-  if( (_l3_src_img == MAP_FAILED) || (_l3_dst_img == MAP_FAILED) ){
+  if( (_l3_src_img == MAP_FAILED) || (_l3_dst_img == MAP_FAILED) || (dma_regs == MAP_FAILED) ){
     printf("Mmap Failed: %s\n",strerror(errno));
     return -1;
   }
 
-  /* Accelerator. */
-
-  XFilter11x11_orig hw_acc;
-
 clock_gettime(CLOCK_REALTIME, &t_alloc.t1);
 
 t_alloc.t_meas = ((t_alloc.t1.tv_sec - t_alloc.t0.tv_sec) + (t_alloc.t1.tv_nsec - t_alloc.t0.tv_nsec)/1000000000.0)*1000.0;
@@ -282,7 +376,7 @@ t_alloc.t_meas = ((t_alloc.t1.tv_sec - t_alloc.t0.tv_sec) + (t_alloc.t1.tv_nsec
     }
   }
 
-  memset(l3_dst_img, 0, width * height * sizeof(uint32_t));
+  memset(l3_dst_img, 0, frame_bytes);
 
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -296,7 +390,7 @@ t_alloc.t_meas = ((t_alloc.t1.tv_sec - t_alloc.t0.tv_sec) + (t_alloc.t1.tv_nsec
     return 1;
   }
 
-  uint32_t* l3_golden = (uint32_t*)malloc(width*height*sizeof(uint32_t)); 
+  uint32_t* l3_golden = (uint32_t*)malloc(frame_bytes); 
   if ( l3_golden == NULL ) {
     printf("ERROR: malloc() failed!\n");
     return -ENOMEM;
@@ -318,9 +412,11 @@ t_alloc.t_meas = ((t_alloc.t1.tv_sec - t_alloc.t0.tv_sec) + (t_alloc.t1.tv_nsec
 
 clock_gettime(CLOCK_REALTIME, &t_memcpy_in.t0);
 
-  /* Memcpy to CMA. */
+  /* Memcpy to CMA - same frame in every source buffer. */
 
-  memcpy(_l3_src_img, l3_src_img, width*height*sizeof(uint32_t) );
+  for (int b = 0; b < N_FRAME_BUFS; b++) {
+    memcpy(_l3_src_img + b * width * height, l3_src_img, frame_bytes);
+  }
 
 clock_gettime(CLOCK_REALTIME, &t_memcpy_in.t1);
 
@@ -328,23 +424,20 @@ t_memcpy_in.t_meas = ((t_memcpy_in.t1.tv_sec - t_memcpy_in.t0.tv_sec) + (t_memcp
 
   /* Initialize CMA output portion. */
 
-  memcpy(_l3_dst_img, l3_dst_img, width*height*sizeof(uint32_t) );
+  for (int b = 0; b < N_FRAME_BUFS; b++) {
+    memcpy(_l3_dst_img + b * width * height, l3_dst_img, frame_bytes);
+  }
 
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 clock_gettime(CLOCK_REALTIME, &t_acc_progr.t0);
 
-  /* Accelerator initialization. */
-
-  /* 
-   * Former argument of the following API must match the content of '/sys/class/uio/UIO_DEVICE/name'. 
-   * 'UIO_DEVICE' might vary form case to case. Check it on the board after boot.
-   */
+  /* DMA initialization. */
 
-  status = XFilter11x11_orig_Initialize(&hw_acc,"filter11x11_orig"); 
+  status = axi_dma_init(dma_regs);
 
-  if (status != XST_SUCCESS) {
-    printf("Init Error RM %d\n",status);
+  if (status) {
+    printf("Init Error DMA %d\n",status);
     return status;
   }
 
@@ -354,42 +447,47 @@ t_acc_progr.t_meas = ((t_acc_progr.t1.tv_sec - t_acc_progr.t0.tv_sec) + (t_acc_p
 
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-  printf("\n|------------------------|\n");
-  printf("| Execute CONVO on FPGA. |");
-  printf("\n|------------------------|\n\n");
+  printf("\n|--------------------------|\n");
+  printf("| Stream CONVO on FPGA.    |");
+  printf("\n|--------------------------|\n\n");
 
-  /* Execute hardware convolution on FPGA. */
+  /* Stream frames through hardware convolution on FPGA. */
 
-  t_acc_exec = xil_exec( hw_acc, (uint64_t)(CMA_ADDR), (uint64_t)(CMA_ADDR + map_dim)); 
+  printf("Streaming %u frames (%d buffers)...\n", n_frames, N_FRAME_BUFS);
 
-t_acc_progr.t_meas += t_acc_exec.t_meas_progr;
-t_proc.t_meas = t_acc_exec.t_meas_compute;
+  status = xil_stream(dma_regs, (uint64_t)(CMA_ADDR), (uint64_t)(CMA_ADDR + map_dim), (uint64_t)(CMA_ADDR + 2 * map_dim), frame_bytes, n_frames, t_lat, &t_stream);
 
-  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+  if (status) {
+    printf("DMA status - MM2S 0x%08x, S2MM 0x%08x\n", 
+      axi_dma_read(dma_regs, MM2S_STATUS_REGISTER), axi_dma_read(dma_regs, S2MM_STATUS_REGISTER));
+    return status;
+  }
 
-  printf("\n|-----------------|\n");
-  printf("| Memcpy from CMA. |");
-  printf("\n|-----------------|\n\n");
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-clock_gettime(CLOCK_REALTIME, &t_memcpy_out.t0);
+  printf("\n|-----------|\n");
+  printf("| Checksum. |");
+  printf("\n|-----------|\n\n");
 
-  /* Memcpy from CMA. */
+  /* Post-computation checksum - every frame buffer written by the stream. */
 
-  memcpy(l3_dst_img, _l3_dst_img, width*height*sizeof(uint32_t) );
+  unsigned n_bufs_written = n_frames < N_FRAME_BUFS ? n_frames : N_FRAME_BUFS;
 
-clock_gettime(CLOCK_REALTIME, &t_memcpy_out.t1);
-t_memcpy_out.t_meas = ((t_memcpy_out.t1.tv_sec - t_memcpy_out.t0.tv_sec) + (t_memcpy_out.t1.tv_nsec - t_memcpy_out.t0.tv_nsec)/1000000000.0)*1000.0;
+  for (unsigned b = 0; b < n_bufs_written; b++) {
+    memcpy(l3_dst_img, _l3_dst_img + b * width * height, frame_bytes);
+    printf("Post-computation checksum (buffer %u)... ", b);
+    check_result(l3_dst_img, l3_golden, width, height);
+  }
 
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-  printf("\n|-----------|\n");
-  printf("| Checksum. |");
-  printf("\n|-----------|\n\n");
+  /* Latency percentiles. */
 
-  /* Post-computation checksum. */
+  float t_lat_mean = 0.0;
+  for (unsigned f = 0; f < n_frames; f++) t_lat_mean += t_lat[f];
+  t_lat_mean /= n_frames;
 
-  printf("Post-computation checksum... ");
-  check_result(l3_dst_img, l3_golden, width, height);
+  qsort(t_lat, n_frames, sizeof(float), cmp_float);
 
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -403,6 +501,8 @@ clock_gettime(CLOCK_REALTIME, &t_clean.t0);
 
   munmap(_l3_src_img,  map_dim);
   munmap(_l3_dst_img, map_dim);
+  munmap((void *)dma_regs, AXI_DMA_MAP_SIZE);
+  close(fd);
 
   free(l3_src_img);
   free(l3_dst_img);
@@ -426,18 +526,27 @@ t_clean.t_meas = ((t_clean.t1.tv_sec - t_clean.t0.tv_sec) + (t_clean.t1.tv_nsec
   printf("\n  - Memcpy to CMA:\n");
   printf("  -     - Execution time (ms):    %.3f ms\n", t_memcpy_in.t_meas );
 
-  printf("\n  - Accelerator programming:\n");
+  printf("\n  - DMA programming:\n");
   printf("  -     - Execution time (ms):    %.3f ms\n", t_acc_progr.t_meas );
 
-  printf("\n  - Accelerator execution:\n");
-  printf("  -     - Execution time (ms):    %.3f ms\n", t_proc.t_meas );
+  printf("\n  - Video streaming (%u frames):\n", n_frames);
+  printf("  -     - Execution time (ms):    %.3f ms\n", t_stream.t_meas );
+  printf("  -     - Sustained rate (fps):   %.2f fps\n", n_frames / (t_stream.t_meas / 1000.0) );
+  printf("  -     - Bandwidth (MB/s):       %.2f MB/s (in + out)\n", 2.0 * n_frames * frame_bytes / (t_stream.t_meas * 1000.0) );
 
-  printf("\n  - Memcpy from CMA:\n");
-  printf("  -     - Execution time (ms):    %.3f ms\n", t_memcpy_out.t_meas );
+  printf("\n  - Frame latency:\n");
+  printf("  -     - Mean (ms):              %.3f ms\n", t_lat_mean );
+  printf("  -     - Min (ms):               %.3f ms\n", t_lat[0] );
+  printf("  -     - p50 (ms):               %.3f ms\n", percentile(t_lat, n_frames, 50.0) );
+  printf("  -     - p90 (ms):               %.3f ms\n", percentile(t_lat, n_frames, 90.0) );
+  printf("  -     - p99 (ms):               %.3f ms\n", percentile(t_lat, n_frames, 99.0) );
+  printf("  -     - Max (ms):               %.3f ms\n", t_lat[n_frames - 1] );
 
   printf("\n  - Cleaning:\n");
   printf("  -     - Execution time (ms):    %.3f ms\n", t_clean.t_meas );
 
+  free(t_lat);
+
   /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
   printf("\n|-------------|\n");
@@ -445,4 +554,4 @@ t_clean.t_meas = ((t_clean.t1.tv_sec - t_clean.t0.tv_sec) + (t_clean.t1.tv_nsec
   printf("\n|-------------|\n\n");
 
   return 0;
-}
\ No newline at end of file
+}
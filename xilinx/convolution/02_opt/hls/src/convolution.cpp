@@ -18,6 +18,81 @@
 
 #include "convolution.h"
 
+/*
+ *
+ * 2D convolution - Border modes.
+ *
+ */
+
+// Map an image coordinate onto the valid interior, given in interior
+// coordinates, i.e. [0, n - (K - 1)). Returns -1 for a constant border.
+template<int K>
+static int border_map(int idx, int n, int border_mode)
+{
+    #pragma HLS INLINE
+
+    const int border_width = int(K / 2);
+    const int last = n - K; // last valid interior index
+    int k = idx - border_width;
+
+    if (k >= 0 && k <= last)
+        return k;
+    if (border_mode == BORDER_CONSTANT)
+        return -1;
+    if (border_mode == BORDER_REFLECT_101)
+        k = k < 0 ? -k : 2 * last - k;
+    // Replicate - also clamps reflection on interiors narrower than the border.
+    return k < 0 ? 0 : (k > last ? last : k);
+}
+
+// Rows an output row is emitted after the matching input row, such that
+// every interior row it maps onto has been computed by the vertical pass.
+// Sized for reflect-101, the deepest mode, so that the output skew does not
+// change with border_mode between frames (see CONV_LAG_ROWS). A flushed
+// call drains these rows after its input, an overlapped one emits them
+// at the start of the next call.
+template<int K>
+static int border_lag()
+{
+    #pragma HLS INLINE
+
+    const int border_width = int(K / 2);
+    return 3 * border_width + 1;
+}
+
+/*
+ *
+ * 2D convolution - Reference border pass.
+ *
+ */
+
+template<typename T, int K>
+static void border_orig(
+        int width, int height, T *dst,
+        int border_mode, T border_val)
+{
+    const int border_width = int(K / 2);
+
+    // Populate borders in a single pass over the frame, reading the valid
+    // interior pixel each border pixel maps onto (interior is left as is).
+    Border_H:for(int col = 0; col < height; col++){
+        int src_col = border_map<K>(col, height, border_mode);
+        Border_W:for(int row = 0; row < width; row++){
+            int pixel = col * width + row;
+            bool interior = col >= border_width && col < height - border_width
+                && row >= border_width && row < width - border_width;
+            if (interior)
+                continue;
+            int src_row = border_map<K>(row, width, border_mode);
+            if (src_col < 0 || src_row < 0)
+                dst[pixel] = border_val;
+            else
+                dst[pixel] = dst[(src_col + border_width) * width + src_row + border_width];
+        }
+    }
+}
+
+
 /*
  *
  * 2D convolution - Reference (body).
@@ -28,7 +103,8 @@ template<typename T, int K>
 static void convolution_orig(
         int width, int height,
         const T *src, T *dst,
-        const T *hcoeff, const T *vcoeff)
+        const T *hcoeff, const T *vcoeff,
+        int border_mode, T border_val)
 {
     // Convolution kernel size
     const int conv_size = K;
@@ -70,52 +146,182 @@ static void convolution_orig(
             }
         }
     }
-    // Populate borders by replicating adjacent valid pixels - uses a separate
-    // set of loop nest for each vertical border region - top border; left/right
-    // of valid vertical range; bottom. This is problematic for performance...
-    int border_width_offset = border_width * width;
-    int border_height_offset = (height - border_width - 1) * width;
-    Top_Border:for(int col = 0; col < border_width; col++){
-        int offset = col * width;
-        Top_Left:for(int row = 0; row < border_width; row++){
-            int pixel = offset + row;
-            dst[pixel] = dst[border_width_offset + border_width];
-        }
-        Top_Row:for(int row = border_width; row < width - border_width; row++){
-            int pixel = offset + row;
-            dst[pixel] = dst[border_width_offset + row];
-        }
-        Top_Right:for(int row = width - border_width; row < width; row++){
-            int pixel = offset + row;
-            dst[pixel] = dst[border_width_offset + width - border_width - 1];
-        }
+    // Populate borders
+    border_orig<T, K>(width, height, dst, border_mode, border_val);
+#ifndef __SYNTHESIS__
+    delete [] local;
+#endif
+}
+
+/*
+ *
+ * 2D convolution - Reference, non-separable KxK window (body).
+ *
+ */
+
+template<typename T, int K>
+static void convolution_orig_2d(
+        int width, int height,
+        const T *src, T *dst,
+        const T *coeff,
+        int border_mode, T border_val)
+{
+    // Half the convolution window - rounded down - i.e. the border width
+    const int border_width = int(K / 2);
+
+    // Clear dst storage
+    Clear_Dst:for(int i = 0; i < height * width; i++){
+        dst[i]=0;
     }
-    Side_Border:for(int col = border_width; col < height - border_width; col++){
-        int offset = col * width;
-        Left_Col:for(int row = 0; row < border_width; row++){
-            int pixel = offset + row;
-            dst[pixel] = dst[offset + border_width];
-        }
-        Right_Col:for(int row = width - border_width; row < width; row++){
-            int pixel = offset + row;
-            dst[pixel] = dst[offset + width - border_width - 1];
+    // Window convolution pass - makes O(K*K) reads from input image per
+    // output pixel, only interior pixels being valid
+    ConvH:for(int col = border_width; col < height - border_width; col++){
+        ConvW:for(int row = border_width; row < width - border_width; row++){
+            int pixel = col * width + row;
+            Conv:for(int i = - border_width; i <= border_width; i++){
+                for(int j = - border_width; j <= border_width; j++){
+                    dst[pixel] += src[pixel + i * width + j]
+                        * coeff[(i + border_width) * K + j + border_width];
+                }
+            }
         }
     }
-    Bottom_Border:for(int col = height - border_width; col < height; col++){
-        int offset = col * width;
-        Bottom_Left:for(int row = 0; row < border_width; row++){
-            int pixel = offset + row;
-            dst[pixel] = dst[border_height_offset + border_width];
-        }
-        Bottom_Row:for(int row = border_width; row < width - border_width; row++){
-            int pixel = offset + row;
-            dst[pixel] = dst[border_height_offset + row];
+    // Populate borders
+    border_orig<T, K>(width, height, dst, border_mode, border_val);
+}
+
+/*
+ *
+ * 2D convolution - Streaming border emission.
+ *
+ */
+
+// Select an output pixel from the ring of interior rows written by the
+// vertical pass. Shared by both streaming engines.
+template<typename T, int K>
+static T border_emit(
+    T ring[K + 1][MAX_IMG_COLS - (K - 1)],
+    int ring_row, int row, int width,
+    int border_mode, T border_val)
+{
+    #pragma HLS INLINE
+
+    int src_row = border_map<K>(row, width, border_mode);
+    if (ring_row < 0 || src_row < 0)
+        return border_val;
+    return ring[ring_row][src_row];
+}
+
+/*
+ *
+ * 2D convolution - Video stream adapters.
+ *
+ */
+
+template<typename T, typename AXI_T>
+static void axis_unpack(
+    int width, int height,
+    hls::stream<AXI_T> &src, 
+    hls::stream<T> &dst)
+{
+    /* Optimizations. */
+    #pragma HLS INLINE // Into a DATAFLOW region
+
+    // Frame synchronization state, carried over between frames. A frame
+    // starts at the first beat with TUSER set. Sources not driving TUSER
+    // (e.g. AXI DMA MM2S) start a frame at the beat following a TLAST.
+    static bool eof_seen = true;
+    static bool sof_seen = false;
+    // Start of frame read while unpacking the previous (truncated) frame.
+    static bool sof_pending = false;
+    static AXI_T sof_beat;
+
+    AXI_T beat;
+    bool sof;
+    bool cut = false;
+
+    /* 
+        - Start of frame -
+        Drop beats until start of frame, so that a partial frame left
+        in the stream does not shift the following ones.
+    */
+
+    if (sof_pending) {
+        beat = sof_beat;
+        sof_pending = false;
+    } else {
+        SOF_Sync: do {
+        #pragma HLS PIPELINE
+            beat = src.read();
+            sof_seen |= (beat.user != 0);
+            sof = (beat.user != 0) || (!sof_seen && eof_seen);
+            eof_seen = (beat.last != 0);
+        } while (!sof);
+    }
+
+    /* 
+        - Frame -
+        A TLAST before the last pixel, or a TUSER within the frame, ends
+        the frame early: the missing pixels are padded with zeros, so that
+        the filter stays frame-locked, and a TUSER beat is kept as the
+        start of the next frame.
+    */
+
+    Unpack_A: for (int i = 0; i < height; i++) {
+    #pragma HLS LOOP_TRIPCOUNT min=height max=height
+        Unpack_B: for (int j = 0; j < width; j++) {
+        #pragma HLS LOOP_TRIPCOUNT min=width max=width
+        #pragma HLS PIPELINE
+            if (!cut && (i > 0 || j > 0)) {
+                beat = src.read();
+                eof_seen = (beat.last != 0);
+                if (beat.user != 0) {
+                    sof_seen = true;
+                    sof_pending = true;
+                    sof_beat = beat;
+                    cut = true;
+                }
+            }
+            dst << (cut ? (T)0 : (T)beat.data);
+            if (beat.last != 0)
+                cut = true;
         }
-        Bottom_Right:for(int row = width - border_width; row < width; row++){
-            int pixel = offset + row;
-            dst[pixel] = dst[border_height_offset + width - border_width - 1];
+    }
+}
+
+// The filter output trails its input by lag rows: the first lag rows of a
+// call end the previous frame, TUSER and TLAST are placed accordingly. The
+// first call after reset has no previous frame, its first lag rows are
+// dropped so that only whole frames leave the core.
+template<typename T, typename AXI_T>
+static void axis_pack(
+    int width, int height, int lag,
+    hls::stream<T> &src, 
+    hls::stream<AXI_T> &dst)
+{
+    /* Optimizations. */
+    #pragma HLS INLINE // Into a DATAFLOW region
+
+    static bool primed = false;
+
+    Pack_A: for (int i = 0; i < height; i++) {
+    #pragma HLS LOOP_TRIPCOUNT min=height max=height
+        Pack_B: for (int j = 0; j < width; j++) {
+        #pragma HLS LOOP_TRIPCOUNT min=width max=width
+        #pragma HLS PIPELINE
+            AXI_T beat;
+            beat.data = src.read();
+            beat.keep = -1;
+            beat.strb = -1;
+            beat.user = (i == lag && j == 0);
+            beat.last = (i == lag - 1 && j == width - 1);
+            beat.id = 0;
+            beat.dest = 0;
+            if (primed || i >= lag)
+                dst << beat;
         }
     }
+    primed = true;
 }
 
 /*
@@ -124,16 +330,22 @@ static void convolution_orig(
  *
  */
 
-template<typename T, int K>
+// ID distinguishes instances within one DATAFLOW region (see chain top),
+// each instance owning its static line-buffers. flush: the call emits its
+// own frame, lag rows after its input ends; otherwise calls overlap by lag
+// rows, as the free-running video top does.
+template<typename T, int K, int ID = 0>
 static void convolution_strm(
-    int width, int height,
+    int width, int height, bool flush,
     hls::stream<T> &src, 
     hls::stream<T> &dst,
-    const T *hcoeff, const T *vcoeff)
+    const T *hcoeff, const T *vcoeff,
+    int border_mode, T border_val)
 {
     /* Algorithm parameters. */
-    const int border_width = int(K / 2);
     const int vconv_xlim = width - (K - 1);
+    const int lag = border_lag<K>();
+    const int rows = flush ? height + lag : height;
 
     /* ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ */
 
@@ -149,7 +361,6 @@ static void convolution_strm(
 
     // Vertical.
     // T vwin[K];
-    hls::stream<T> vconv("vconv");
 
     /* ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ */
 
@@ -158,14 +369,22 @@ static void convolution_strm(
     // Line-buffers allowing full pixel reuse in vertical pass.
     static T linebuf[K - 1][MAX_IMG_COLS];
     #pragma HLS ARRAY_PARTITION variable=linebuf dim=1 complete
-    
-    // Line-buffer for border pixel replication.
-    T borderbuf[MAX_IMG_COLS - (K - 1)];
+
+    // Ring of valid interior rows, read back to emit border pixels.
+    static T ring[K + 1][MAX_IMG_COLS - (K - 1)];
+    #pragma HLS ARRAY_PARTITION variable=ring dim=1 complete
+
+    // Interior rows are numbered across frames: ring slots of interior
+    // row 0 of the frame being written and of the frame before it.
+    static int ring_base = 0;
+    static int prev_base = 0;
 
     // These assertions let HLS know the upper bounds of loops
     assert(height < MAX_IMG_ROWS);
     assert(width < MAX_IMG_COLS);
     assert(vconv_xlim < MAX_IMG_COLS - (K - 1));
+    // The previous frame is flushed within the first rows of this one.
+    assert(height > lag);
 
     /* ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ */
 
@@ -201,91 +420,269 @@ static void convolution_strm(
     /* ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ */
 
     /* 
-        - Vertical convolution -
+        - Vertical convolution and borders -
         This consumes stream generated by the horizontal
-        pass; generates a stream of only the pixels in the valid interior
-        region, i.e. (height - (K - 1)) * (width - (K - 1)) values.
+        pass; only the valid interior region, i.e.
+        (height - (K - 1)) * (width - (K - 1)) values, is computed and
+        stored into the ring. The same loop emits the full output frame,
+        lag rows behind, selecting either an interior pixel from the ring
+        or a border pixel according to border_mode - no separate border
+        pass over the frame. Flushed, the loop runs lag more rows once the
+        input has ended. Overlapped, it runs height rows, the first lag of
+        which emit the last lag rows of the previous frame, i.e. a frame is
+        flushed by the fill of the next one.
     */
 
-    VConv_A: for(int col = 0; col < height; col++) {
-    #pragma HLS LOOP_TRIPCOUNT min=height max=height
-        VConv_B: for(int row = 0; row < vconv_xlim; row++) {
-        #pragma HLS LOOP_TRIPCOUNT min=vconv_xlim max=vconv_xlim
+    VConv_A: for(int col = 0; col < rows; col++) {
+    #pragma HLS LOOP_TRIPCOUNT min=height max=height+3*(K/2)+1
+        if (col == 0) {
+            prev_base = ring_base;
+            ring_base = (ring_base + height - (K - 1)) % (K + 1);
+        }
+        // Ring slot written in this row, and read for the output row.
+        const bool tail = col < lag;
+        const bool emit = !flush || !tail;
+        const int out_col = tail ? height - lag + col : col - lag;
+        const int wr_slot = (ring_base + col - (K - 1)) % (K + 1);
+        const int map_col = border_map<K>(out_col, height, border_mode);
+        const int rd_slot = map_col < 0 ? -1 : ((tail ? prev_base : ring_base) + map_col) % (K + 1);
+
+        VConv_B: for(int row = 0; row < width; row++) {
+        #pragma HLS LOOP_TRIPCOUNT min=width max=width
         #pragma HLS DEPENDENCE variable=linebuf inter false
+        #pragma HLS DEPENDENCE variable=ring inter false
+        #pragma HLS DEPENDENCE variable=ring intra false
         #pragma HLS PIPELINE
 
-            // Read stream from HConv.
-            T in_val = hconv.read();
+            if (col < height && row < vconv_xlim) {
 
-            // Reset pixel value on-the-fly - eliminates an O(height*width) loop
-            T out_val = 0;
-            VConv:for(int i = 0; i < K; i++) {
-            #pragma HLS LOOP_TRIPCOUNT min=K max=K
-                T vwin_val = i < K - 1 ? linebuf[i][row] : in_val;
-                out_val += vwin_val * vcoeff[i];
-                if (i > 0)
-                    linebuf[i - 1][row] = vwin_val;
+                // Read stream from HConv.
+                T in_val = hconv.read();
+
+                // Reset pixel value on-the-fly - eliminates an O(height*width) loop
+                T out_val = 0;
+                VConv:for(int i = 0; i < K; i++) {
+                #pragma HLS LOOP_TRIPCOUNT min=K max=K
+                    T vwin_val = i < K - 1 ? linebuf[i][row] : in_val;
+                    out_val += vwin_val * vcoeff[i];
+                    if (i > 0)
+                        linebuf[i - 1][row] = vwin_val;
+                }
+                if (col >= K - 1)
+                    ring[wr_slot][row] = out_val;
             }
-            if (col >= K - 1)
-                vconv << out_val;
+
+            if (emit)
+                dst << border_emit<T, K>(ring, rd_slot, row, width, border_mode, border_val);
         }
     }
+}
+
+/*
+ *
+ * 2D convolution - Streaming accelerator, non-separable KxK window (body).
+ *
+ */
+
+// flush as for convolution_strm().
+template<typename T, int K>
+static void convolution_2d_strm(
+    int width, int height, bool flush,
+    hls::stream<T> &src, 
+    hls::stream<T> &dst,
+    const T *coeff,
+    int border_mode, T border_val)
+{
+    /* Algorithm parameters. */
+    const int lag = border_lag<K>();
+    const int rows = flush ? height + lag : height;
+
+    /* Optimizations. */
+    #pragma HLS INLINE // Into a DATAFLOW region
+
+    /* ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ */
+    
+    /* Pixel window (cache). */
+    T win[K][K];
+    #pragma HLS ARRAY_PARTITION variable=win dim=0 complete
+
+    /* ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ */
+
+    /* Line buffers. */
+
+    // Line-buffers holding the K - 1 previous source rows, same scheme as
+    // the vertical pass of the separable engine.
+    static T linebuf[K - 1][MAX_IMG_COLS];
+    #pragma HLS ARRAY_PARTITION variable=linebuf dim=1 complete
+
+    // Ring of valid interior rows, read back to emit border pixels.
+    static T ring[K + 1][MAX_IMG_COLS - (K - 1)];
+    #pragma HLS ARRAY_PARTITION variable=ring dim=1 complete
+
+    // Interior rows are numbered across frames: ring slots of interior
+    // row 0 of the frame being written and of the frame before it.
+    static int ring_base = 0;
+    static int prev_base = 0;
+
+    // These assertions let HLS know the upper bounds of loops
+    assert(height < MAX_IMG_ROWS);
+    assert(width < MAX_IMG_COLS);
+    // The previous frame is flushed within the first rows of this one.
+    assert(height > lag);
 
     /* ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ */
 
     /* 
-        - Borders -
-        Handle border by replicating the exact same pixels as orig, but in
-        a single loop taking the minimum (height*width) number of cycles.
+        - Window convolution and borders -
+        This consumes each pixel in source image exactly once. The new
+        pixel and the K - 1 line-buffered pixels above it form a column
+        that is shifted into the KxK window; K*K products per output pixel
+        are computed in parallel. As for the vertical pass of the separable
+        engine, only the valid interior region is computed and stored
+        into the ring, while the full output frame is emitted lag rows
+        behind, border pixels included: drained by lag more rows when
+        flushed, by the first lag rows of the next call otherwise.
     */
-    
-    border_A :for (int i = 0; i < height; i++) {
-    #pragma HLS LOOP_TRIPCOUNT min=height max=height
-        border_B: for (int j = 0; j < width; j++) {
+
+    Conv2D_A: for(int col = 0; col < rows; col++) {
+    #pragma HLS LOOP_TRIPCOUNT min=height max=height+3*(K/2)+1
+        if (col == 0) {
+            prev_base = ring_base;
+            ring_base = (ring_base + height - (K - 1)) % (K + 1);
+        }
+        // Ring slot written in this row, and read for the output row.
+        const bool tail = col < lag;
+        const bool emit = !flush || !tail;
+        const int out_col = tail ? height - lag + col : col - lag;
+        const int wr_slot = (ring_base + col - (K - 1)) % (K + 1);
+        const int map_col = border_map<K>(out_col, height, border_mode);
+        const int rd_slot = map_col < 0 ? -1 : ((tail ? prev_base : ring_base) + map_col) % (K + 1);
+
+        Conv2D_B: for(int row = 0; row < width; row++) {
         #pragma HLS LOOP_TRIPCOUNT min=width max=width
+        #pragma HLS DEPENDENCE variable=linebuf inter false
+        #pragma HLS DEPENDENCE variable=ring inter false
+        #pragma HLS DEPENDENCE variable=ring intra false
         #pragma HLS PIPELINE
-            
-            // Loop variables
-            T pix_in, l_edge_pix, r_edge_pix, pix_out;
-            
-            if (i == 0 || (i > border_width && i < height - border_width)) {
-
-                // read a pixel out of the input stream and cache it for
-                // immediate use and later replication purposes
-                if (j < width - (K - 1)) {
-                    pix_in = vconv.read();
-                    borderbuf[j] = pix_in;
-                }
-                if (j == 0) {
-                    l_edge_pix = pix_in;
+
+            if (col < height) {
+
+                // Read input stream.
+                T in_val = src.read();
+
+                // Shift window left, then load the new column from line-buffers.
+                Conv2D_Col: for(int i = 0; i < K; i++) {
+                #pragma HLS LOOP_TRIPCOUNT min=K max=K
+                    T col_val = i < K - 1 ? linebuf[i][row] : in_val;
+                    if (i > 0)
+                        linebuf[i - 1][row] = col_val;
+                    for(int j = 0; j < K - 1; j++)
+                        win[i][j] = win[i][j + 1];
+                    win[i][K - 1] = col_val;
                 }
-                if (j == width - K) {
-                    r_edge_pix = pix_in;
+
+                // Reset pixel value on-the-fly - eliminates an O(height*width) loop
+                T out_val = 0;
+                Conv2D_Win: for(int i = 0; i < K; i++) {
+                #pragma HLS LOOP_TRIPCOUNT min=K max=K
+                    for(int j = 0; j < K; j++)
+                        out_val += win[i][j] * coeff[i * K + j];
                 }
-            }
 
-            // Select output value from the appropriate cache resource
-            if (j <= border_width) {
-                pix_out = l_edge_pix;
-            } else if (j >= width - border_width - 1) {
-                pix_out = r_edge_pix;
-            } else {
-                pix_out = borderbuf[j - border_width];
+                if (col >= K - 1 && row >= K - 1)
+                    ring[wr_slot][row - (K - 1)] = out_val;
             }
-            dst << pix_out;
+
+            if (emit)
+                dst << border_emit<T, K>(ring, rd_slot, row, width, border_mode, border_val);
         }
     }
+}
 
-    /* ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ */
+/*
+ *
+ * 2D convolution - Cascaded filter chain (body).
+ *
+ */
+
+// Point-wise threshold to zero, closing the chain - thresh = 0 is a no-op.
+template<typename T>
+static void threshold_strm(
+    int width, int height, T thresh,
+    hls::stream<T> &src, 
+    hls::stream<T> &dst)
+{
+    /* Optimizations. */
+    #pragma HLS INLINE // Into a DATAFLOW region
+
+    Thresh_A: for (int i = 0; i < height; i++) {
+    #pragma HLS LOOP_TRIPCOUNT min=height max=height
+        Thresh_B: for (int j = 0; j < width; j++) {
+        #pragma HLS LOOP_TRIPCOUNT min=width max=width
+        #pragma HLS PIPELINE
+            T pix = src.read();
+            dst << (pix >= thresh ? pix : (T)0);
+        }
+    }
 }
 
+// Stages N-1 .. 0 of the chain, unrolled at compile time so that each one
+// is a separate DATAFLOW process with its own line-buffers, connected to
+// the next one by an hls::stream.
+template<typename T, int K, int N>
+struct convolution_chain {
+    static void run(
+        int width, int height,
+        hls::stream<T> &src, 
+        hls::stream<T> &dst,
+        const T hcoeff[][K], const T vcoeff[][K],
+        int border_mode, T border_val)
+    {
+        #pragma HLS INLINE
+        hls::stream<T> stage_out("stage_out");
+
+        convolution_strm<T, K, N>(
+            width, height, true,
+            src, stage_out,
+            hcoeff[0], vcoeff[0],
+            border_mode, border_val);
+
+        convolution_chain<T, K, N - 1>::run(
+            width, height,
+            stage_out, dst,
+            hcoeff + 1, vcoeff + 1,
+            border_mode, border_val);
+    }
+};
+
+template<typename T, int K>
+struct convolution_chain<T, K, 1> {
+    static void run(
+        int width, int height,
+        hls::stream<T> &src, 
+        hls::stream<T> &dst,
+        const T hcoeff[][K], const T vcoeff[][K],
+        int border_mode, T border_val)
+    {
+        #pragma HLS INLINE
+        convolution_strm<T, K, 1>(
+            width, height, true,
+            src, dst,
+            hcoeff[0], vcoeff[0],
+            border_mode, border_val);
+    }
+};
+
 /*
  *
  * 2D convolution - Reference (top).
  *
  */
 
-void filter11x11_orig(int width, int height, const data_t *src, data_t *dst)
+void filter11x11_orig(
+        int width, int height, 
+        int border_mode, data_t border_val,
+        const data_t *src, data_t *dst)
 {
 
 #pragma HLS INTERFACE m_axi port=src depth=32400 offset=slave bundle=port_src
@@ -296,6 +693,8 @@ void filter11x11_orig(int width, int height, const data_t *src, data_t *dst)
 
 #pragma HLS INTERFACE s_axilite port=width  bundle=control 
 #pragma HLS INTERFACE s_axilite port=height bundle=control 
+#pragma HLS INTERFACE s_axilite port=border_mode bundle=control 
+#pragma HLS INTERFACE s_axilite port=border_val  bundle=control 
 #pragma HLS INTERFACE s_axilite port=return bundle=control 
 
 #pragma HLS INLINE
@@ -312,7 +711,42 @@ void filter11x11_orig(int width, int height, const data_t *src, data_t *dst)
     convolution_orig<data_t, 11>(
         im_w, im_h,
         src, dst,
-        filt11_coeff, filt11_coeff);
+        filt11_coeff, filt11_coeff,
+        border_mode, border_val);
+}
+
+/*
+ *
+ * 2D convolution - Reference, non-separable KxK window (top).
+ *
+ */
+
+void filter11x11_2d_orig(
+        int width, int height, 
+        const data_t coeffs[UAV_FILTER_DIM * UAV_FILTER_DIM],
+        int border_mode, data_t border_val,
+        const data_t *src, data_t *dst)
+{
+
+#pragma HLS INTERFACE m_axi port=src depth=32400 offset=slave bundle=port_src
+#pragma HLS INTERFACE m_axi port=dst depth=32400 offset=slave bundle=port_dst
+
+#pragma HLS INTERFACE s_axilite port=width  bundle=control 
+#pragma HLS INTERFACE s_axilite port=height bundle=control 
+#pragma HLS INTERFACE s_axilite port=coeffs bundle=control 
+#pragma HLS INTERFACE s_axilite port=border_mode bundle=control 
+#pragma HLS INTERFACE s_axilite port=border_val  bundle=control 
+#pragma HLS INTERFACE s_axilite port=return bundle=control 
+
+    /* Image variables. */
+    const int im_w = IM_UAV_COLS;
+    const int im_h = IM_UAV_ROWS;
+
+    convolution_orig_2d<data_t, UAV_FILTER_DIM>(
+        im_w, im_h,
+        src, dst,
+        coeffs,
+        border_mode, border_val);
 }
 
 /*
@@ -322,6 +756,10 @@ void filter11x11_orig(int width, int height, const data_t *src, data_t *dst)
  */
 
 void filter11x11_strm(
+    data_t hcoeffs[UAV_FILTER_DIM],
+    data_t vcoeffs[UAV_FILTER_DIM],
+    int border_mode,
+    data_t border_val,
 	hls::stream<data_t> &src, 
     hls::stream<data_t> &dst)
 {
@@ -330,6 +768,14 @@ void filter11x11_strm(
     #pragma HLS INTERFACE axis port=&src 
     #pragma HLS INTERFACE axis port=&dst 
 
+    /* Register data ports. */
+    #pragma HLS INTERFACE ap_none port=hcoeffs  // infer no protocol usage
+    #pragma HLS INTERFACE ap_none port=vcoeffs  // infer no protocol usage
+    #pragma HLS array_partition variable=hcoeffs // private data port for each filter coefficient
+    #pragma HLS array_partition variable=vcoeffs // private data port for each filter coefficient
+    #pragma HLS INTERFACE ap_none port=border_mode
+    #pragma HLS INTERFACE ap_none port=border_val
+
     /* Hardware optimizations. */
     #pragma HLS DATAFLOW
     #pragma HLS INLINE // bring loops in sub-functions to this DATAFLOW region
@@ -338,15 +784,160 @@ void filter11x11_strm(
     const int im_w = IM_UAV_COLS;
     const int im_h = IM_UAV_ROWS;
 
-    /* Filter components. */
-    const data_t filter_coeffs[UAV_FILTER_DIM] = {
-        36, 111, 266, 498, 724, 821, 724, 498, 266, 111, 36
-    };
+    /* Convolutional 2D filter, the whole frame out within the call. */
+    convolution_strm<data_t, UAV_FILTER_DIM>(
+        im_w, 
+        im_h,
+        true,
+        src, dst,
+        hcoeffs, vcoeffs,
+        border_mode, border_val);
+}
+
+/*
+ *
+ * 2D convolution - Free-running video accelerator (top).
+ *
+ */
+
+void filter11x11_video(
+    data_t hcoeffs[UAV_FILTER_DIM],
+    data_t vcoeffs[UAV_FILTER_DIM],
+    int border_mode,
+    data_t border_val,
+	hls::stream<video_pix_t> &src, 
+    hls::stream<video_pix_t> &dst)
+{
+
+    /* Data streaming interface. */
+    #pragma HLS INTERFACE axis port=&src 
+    #pragma HLS INTERFACE axis port=&dst 
+
+    /* Register data ports. */
+    #pragma HLS INTERFACE ap_none port=hcoeffs  // infer no protocol usage
+    #pragma HLS INTERFACE ap_none port=vcoeffs  // infer no protocol usage
+    #pragma HLS array_partition variable=hcoeffs // private data port for each filter coefficient
+    #pragma HLS array_partition variable=vcoeffs // private data port for each filter coefficient
+    #pragma HLS INTERFACE ap_none port=border_mode
+    #pragma HLS INTERFACE ap_none port=border_val
+
+    /* Free-running: no start/done handshake, restarts on every frame. */
+    #pragma HLS INTERFACE ap_ctrl_none port=return
+
+    /* Hardware optimizations. */
+    #pragma HLS DATAFLOW
+    #pragma HLS INLINE // bring loops in sub-functions to this DATAFLOW region
+
+    /* Image variables. */
+    const int im_w = IM_UAV_COLS;
+    const int im_h = IM_UAV_ROWS;
+
+    /* Pixel streams. */
+    hls::stream<data_t> src_pix("src_pix");
+    hls::stream<data_t> dst_pix("dst_pix");
+
+    /* Frame sync, convolutional 2D filter, frame markers. */
+    axis_unpack<data_t, video_pix_t>(im_w, im_h, src, src_pix);
 
-    /* Convolutional 2D filter. */
     convolution_strm<data_t, UAV_FILTER_DIM>(
         im_w, 
         im_h,
+        false,
+        src_pix, dst_pix,
+        hcoeffs, vcoeffs,
+        border_mode, border_val);
+
+    axis_pack<data_t, video_pix_t>(im_w, im_h, border_lag<UAV_FILTER_DIM>(), dst_pix, dst);
+}
+
+/*
+ *
+ * 2D convolution - Streaming accelerator, non-separable KxK window (top).
+ *
+ */
+
+void filter11x11_2d_strm(
+    data_t coeffs[UAV_FILTER_DIM * UAV_FILTER_DIM],
+    int border_mode,
+    data_t border_val,
+	hls::stream<data_t> &src, 
+    hls::stream<data_t> &dst)
+{
+
+    /* Data streaming interface. */
+    #pragma HLS INTERFACE axis port=&src 
+    #pragma HLS INTERFACE axis port=&dst 
+
+    /* Register data ports. */
+    #pragma HLS INTERFACE ap_none port=coeffs  // infer no protocol usage
+    #pragma HLS array_partition variable=coeffs // private data port for each filter coefficient
+    #pragma HLS INTERFACE ap_none port=border_mode
+    #pragma HLS INTERFACE ap_none port=border_val
+
+    /* Hardware optimizations. */
+    #pragma HLS DATAFLOW
+    #pragma HLS INLINE // bring loops in sub-functions to this DATAFLOW region
+
+    /* Image variables. */
+    const int im_w = IM_UAV_COLS;
+    const int im_h = IM_UAV_ROWS;
+
+    /* Convolutional 2D filter, the whole frame out within the call. */
+    convolution_2d_strm<data_t, UAV_FILTER_DIM>(
+        im_w, 
+        im_h,
+        true,
         src, dst,
-        filter_coeffs, filter_coeffs);
+        coeffs,
+        border_mode, border_val);
+}
+
+/*
+ *
+ * 2D convolution - Cascaded filter chain (top).
+ *
+ */
+
+void filter11x11_chain(
+    data_t hcoeffs[CHAIN_STAGES][UAV_FILTER_DIM],
+    data_t vcoeffs[CHAIN_STAGES][UAV_FILTER_DIM],
+    int border_mode,
+    data_t border_val,
+    data_t thresh,
+	hls::stream<data_t> &src, 
+    hls::stream<data_t> &dst)
+{
+
+    /* Data streaming interface. */
+    #pragma HLS INTERFACE axis port=&src 
+    #pragma HLS INTERFACE axis port=&dst 
+
+    /* Register data ports. */
+    #pragma HLS INTERFACE ap_none port=hcoeffs  // infer no protocol usage
+    #pragma HLS INTERFACE ap_none port=vcoeffs  // infer no protocol usage
+    #pragma HLS array_partition variable=hcoeffs dim=0 // private data port for each filter coefficient
+    #pragma HLS array_partition variable=vcoeffs dim=0 // private data port for each filter coefficient
+    #pragma HLS INTERFACE ap_none port=border_mode
+    #pragma HLS INTERFACE ap_none port=border_val
+    #pragma HLS INTERFACE ap_none port=thresh
+
+    /* Hardware optimizations. */
+    #pragma HLS DATAFLOW
+    #pragma HLS INLINE // bring loops in sub-functions to this DATAFLOW region
+
+    /* Image variables. */
+    const int im_w = IM_UAV_COLS;
+    const int im_h = IM_UAV_ROWS;
+
+    /* Chain output, before thresholding. */
+    hls::stream<data_t> chain_out("chain_out");
+
+    /* CHAIN_STAGES convolutional 2D filters, back to back on chip. */
+    convolution_chain<data_t, UAV_FILTER_DIM, CHAIN_STAGES>::run(
+        im_w, im_h,
+        src, chain_out,
+        hcoeffs, vcoeffs,
+        border_mode, border_val);
+
+    threshold_strm<data_t>(im_w, im_h, thresh, chain_out, dst);
 }
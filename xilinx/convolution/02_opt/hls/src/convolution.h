@@ -20,11 +20,16 @@
 #include <assert.h>
 #include <stdint.h>
 #include <hls_stream.h>
+#include <ap_axi_sdata.h>
 
-/* Original parameters */
+/* Original parameters - may be raised at build time, e.g. 4K benchmarks */
 
+#ifndef MAX_IMG_ROWS
 #define MAX_IMG_ROWS 1080
+#endif
+#ifndef MAX_IMG_COLS
 #define MAX_IMG_COLS 1920
+#endif
 
 #define TEST_IMG_ROWS 135
 #define TEST_IMG_COLS 240
@@ -50,14 +55,74 @@
 
 #define UAV_FILTER_DIM 11 // Window size
 
+// Filters cascaded in the chain accelerator, e.g. smooth, gradient, smooth.
+#ifndef CHAIN_STAGES
+#define CHAIN_STAGES 3
+#endif
+
 typedef uint32_t data_t;
 
+// Border modes - border pixels are derived from the valid interior of the
+// output, i.e. (height - (K - 1)) * (width - (K - 1)) pixels.
+#define BORDER_CONSTANT     0 // border_val
+#define BORDER_REPLICATE    1 // aaaaaa|abcdefgh|hhhhhhh
+#define BORDER_REFLECT_101  2 // fedcb|abcdefgh|gfedcba
+
+// Output lag of the streaming engines, in rows: an output row leaves
+// CONV_LAG_ROWS rows after the matching input row. Per top:
+// - filter11x11_strm, filter11x11_2d_strm: one call, one complete frame
+//   out; the last CONV_LAG_ROWS rows are drained once the input has ended,
+//   i.e. (height + CONV_LAG_ROWS) * width cycles per call.
+// - filter11x11_chain: one call, one complete frame out; each stage drains
+//   its own CONV_LAG_ROWS rows behind the stage ahead, i.e.
+//   (height + CHAIN_STAGES * CONV_LAG_ROWS) * width cycles per call.
+// - filter11x11_video: free-running, calls overlap by CONV_LAG_ROWS rows,
+//   i.e. height * width cycles per frame. The rows of frame n still in
+//   flight leave the core ahead of frame n + 1 (TLAST on its last row,
+//   TUSER on the first row of frame n + 1); the last frame of a stream
+//   needs one more frame (any data) to leave.
+#define CONV_LAG_ROWS (3 * (UAV_FILTER_DIM / 2) + 1)
+
+// Video stream beat - TUSER marks start of frame, TLAST end of frame.
+typedef ap_axiu<32, 1, 1, 1> video_pix_t;
+
 // External function prototypes
 void filter11x11_orig(
         int w, int h,
+        int border_mode, data_t border_val,
+        const data_t *src_image, data_t *dst_image);
+
+void filter11x11_2d_orig(
+        int w, int h,
+        const data_t coeffs[UAV_FILTER_DIM * UAV_FILTER_DIM],
+        int border_mode, data_t border_val,
         const data_t *src_image, data_t *dst_image);
 
 void filter11x11_strm(
+        data_t hcoeffs[UAV_FILTER_DIM],
+        data_t vcoeffs[UAV_FILTER_DIM],
+        int border_mode, data_t border_val,
+        hls::stream<data_t> &src_image, 
+        hls::stream<data_t> &dst_image);
+
+void filter11x11_video(
+        data_t hcoeffs[UAV_FILTER_DIM],
+        data_t vcoeffs[UAV_FILTER_DIM],
+        int border_mode, data_t border_val,
+        hls::stream<video_pix_t> &src_video, 
+        hls::stream<video_pix_t> &dst_video);
+
+void filter11x11_2d_strm(
+        data_t coeffs[UAV_FILTER_DIM * UAV_FILTER_DIM],
+        int border_mode, data_t border_val,
+        hls::stream<data_t> &src_image, 
+        hls::stream<data_t> &dst_image);
+
+void filter11x11_chain(
+        data_t hcoeffs[CHAIN_STAGES][UAV_FILTER_DIM],
+        data_t vcoeffs[CHAIN_STAGES][UAV_FILTER_DIM],
+        int border_mode, data_t border_val,
+        data_t thresh,
         hls::stream<data_t> &src_image, 
         hls::stream<data_t> &dst_image);
 
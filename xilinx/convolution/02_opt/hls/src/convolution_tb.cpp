@@ -19,13 +19,189 @@
 #include <fstream>
 #include <string>
 #include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
 
 /* Include HLS source header. */
 
 #include "convolution.h"
 
+/* Include host engine selection. */
+
+#include "../../app/src/include/conv_engine.h"
+
 using namespace std;
 
+/* Modeled accelerator clock (run_hls.tcl: 6.66 ns). */
+
+#define ACC_CLK_MHZ 150.0
+
+/* 
+    Border reference written directly from the mode definitions, used to
+    cross-check the shared border mapping of the accelerators.
+*/
+
+static int border_ref_idx(int idx, int n, int border_mode)
+{
+    const int lo = UAV_FILTER_DIM / 2;
+    const int hi = n - 1 - UAV_FILTER_DIM / 2;
+    if (idx >= lo && idx <= hi) return idx;
+    if (border_mode == BORDER_CONSTANT) return -1;
+    if (border_mode == BORDER_REPLICATE) return idx < lo ? lo : hi;
+    return idx < lo ? 2 * lo - idx : 2 * hi - idx;
+}
+
+static int check_border(
+        const data_t *img, int border_mode, data_t border_val)
+{
+    int err_cnt = 0;
+    for (int i = 0; i < IM_UAV_ROWS; i++) {
+        for (int j = 0; j < IM_UAV_COLS; j++) {
+            int si = border_ref_idx(i, IM_UAV_ROWS, border_mode);
+            int sj = border_ref_idx(j, IM_UAV_COLS, border_mode);
+            data_t exp_val = (si < 0 || sj < 0) ? 
+                border_val : img[si * IM_UAV_COLS + sj];
+            if (img[i * IM_UAV_COLS + j] != exp_val) err_cnt++;
+        }
+    }
+    return err_cnt;
+}
+
+/* Drop n pixels of an overlapped (video) output stream. */
+
+template<typename S>
+static void skip_strm(hls::stream<S> &strm, int n)
+{
+    for (int i = 0; i < n; i++)
+        strm.read();
+}
+
+/* Run one of the two streaming engines on src and time the C-sim. */
+
+static double run_strm(
+        bool separable, data_t *coeffs,
+        data_t *hcoeffs, data_t *vcoeffs,
+        int border_mode, data_t border_val,
+        const data_t *src, data_t *dst)
+{
+    hls::stream<data_t> src_strm("src_strm");
+    hls::stream<data_t> dst_strm("dst_strm");
+
+    for (int i = 0; i < IM_UAV_ROWS * IM_UAV_COLS; i++)
+        src_strm << src[i];
+
+    auto t_start = std::chrono::steady_clock::now();
+    if (separable)
+        filter11x11_strm(hcoeffs, vcoeffs, border_mode, border_val, src_strm, dst_strm);
+    else
+        filter11x11_2d_strm(coeffs, border_mode, border_val, src_strm, dst_strm);
+    auto t_end = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < IM_UAV_ROWS * IM_UAV_COLS; i++)
+        dst[i] = dst_strm.read();
+
+    return std::chrono::duration<double>(t_end - t_start).count();
+}
+
+/* Generate a checker-board test frame, shifted by 'shift' pixels. */
+
+static void gen_frame(
+        data_t *img, int shift, int chkr_size,
+        data_t max_pix_val, data_t min_pix_val)
+{
+    for (int i = 0; i < IM_UAV_ROWS; i++) {
+        for (int j = 0; j < IM_UAV_COLS; j++) {
+            bool odd = (((i + shift) / chkr_size) + ((j + shift) / chkr_size)) % 2;
+            img[i * IM_UAV_COLS + j] = odd ? min_pix_val : max_pix_val;
+        }
+    }
+}
+
+/* Push a frame as video beats, with or without TUSER start of frame. */
+
+static void push_frame(
+        hls::stream<video_pix_t> &strm, const data_t *img, bool use_tuser)
+{
+    for (int i = 0; i < IM_UAV_ROWS * IM_UAV_COLS; i++) {
+        video_pix_t beat;
+        beat.data = img[i];
+        beat.keep = -1;
+        beat.strb = -1;
+        beat.user = use_tuser && (i == 0);
+        beat.last = (i == IM_UAV_ROWS * IM_UAV_COLS - 1);
+        beat.id = 0;
+        beat.dest = 0;
+        strm << beat;
+    }
+}
+
+/* 
+    Push the first n_beats of a frame, ended either by TLAST (DMA source)
+    or by the TUSER of the frame that follows (camera source).
+*/
+
+static void push_truncated(
+        hls::stream<video_pix_t> &strm, int n_beats, bool use_tuser)
+{
+    for (int i = 0; i < n_beats; i++) {
+        video_pix_t beat;
+        beat.data = 3 * i + 1;
+        beat.keep = -1;
+        beat.strb = -1;
+        beat.user = use_tuser && (i == 0);
+        beat.last = !use_tuser && (i == n_beats - 1);
+        beat.id = 0;
+        beat.dest = 0;
+        strm << beat;
+    }
+}
+
+/* Pop a frame of video beats, checking data and frame markers. */
+
+static int pop_frame(
+        hls::stream<video_pix_t> &strm, const data_t *ref)
+{
+    int err_cnt = 0;
+    for (int i = 0; i < IM_UAV_ROWS * IM_UAV_COLS; i++) {
+        video_pix_t beat = strm.read();
+        bool sof = (i == 0);
+        bool eof = (i == IM_UAV_ROWS * IM_UAV_COLS - 1);
+        if ((data_t)beat.data != ref[i]) err_cnt++;
+        if ((beat.user != 0) != sof || (beat.last != 0) != eof) err_cnt++;
+    }
+    return err_cnt;
+}
+
+static int compare(const data_t *dut, const data_t *ref)
+{
+    int err_cnt = 0;
+    for (int i = 0; i < IM_UAV_ROWS * IM_UAV_COLS; i++) {
+        if (dut[i] != ref[i]) err_cnt++;
+    }
+    return err_cnt;
+}
+
+static void print_perf(const char *engine, double t_sim)
+{
+    const double n_pix = (double)IM_UAV_ROWS * IM_UAV_COLS;
+    // Both engines are II=1 DATAFLOW pipelines: one pixel per clock, plus
+    // the CONV_LAG_ROWS rows drained at the end of the call. The model is
+    // thus identical for both by construction, the engines differing in
+    // MACs (DSPs) per pixel; only the C-sim figure is measured.
+    const double cycles = (double)(IM_UAV_ROWS + CONV_LAG_ROWS) * IM_UAV_COLS;
+    const int macs = (string(engine) == "separable") ?
+        2 * UAV_FILTER_DIM : UAV_FILTER_DIM * UAV_FILTER_DIM;
+
+    cout << "    " << setw(10) << left << engine << right
+         << " | csim " << setw(8) << fixed << setprecision(2) 
+         << n_pix / t_sim / 1e6 << " MPix/s"
+         << " | II=1 model (same for both) " << setw(8) << (long)cycles << " cycles, "
+         << setw(7) << ACC_CLK_MHZ * 1e6 / cycles << " fps @ "
+         << (int)ACC_CLK_MHZ << " MHz, "
+         << macs << " MAC/pix" << endl;
+}
+
 int main(void)
 {
 
@@ -67,11 +243,11 @@ int main(void)
 
     /* Generate reference convolution image */
 
-    filter11x11_orig(IM_UAV_COLS, IM_UAV_ROWS, src_img, ref_img);
+    filter11x11_orig(IM_UAV_COLS, IM_UAV_ROWS, BORDER_REPLICATE, 0, src_img, ref_img);
 
     /* Generate DUT convolution image */
     
-    filter11x11_strm(src_img_strm, dut_img_strm);
+    filter11x11_strm(filter_coeffs, filter_coeffs, BORDER_REPLICATE, 0, src_img_strm, dut_img_strm);
 
     /* Check DUT vs reference result */
     std::ofstream out("output.txt");
@@ -96,6 +272,250 @@ int main(void)
         }
     }
     out.close();
+    // One call, one frame - nothing left behind.
+    if (!src_img_strm.empty() || !dut_img_strm.empty()) err_cnt++;
+    cout << endl;
+
+    /* 
+        Engine dispatch - the host factors the KxK kernel and selects the
+        separable engine for rank-1 kernels, the window engine otherwise.
+        Each case is checked against the non-separable reference.
+    */
+
+    const int K = UAV_FILTER_DIM;
+    const int bw = K / 2;
+    const int n_cases = 3;
+    const char *case_name[n_cases] = {
+        "gaussian", "pyramid", "random"
+    };
+    data_t * const kernels = new data_t[n_cases * K * K];
+    data_t * const dut_img = new data_t[IM_UAV_ROWS*IM_UAV_COLS];
+    uint32_t lcg = 0x12345678;
+
+    for (int i = 0; i < K; i++) {
+        for (int j = 0; j < K; j++) {
+            int di = i < bw ? bw - i : i - bw;
+            int dj = j < bw ? bw - j : j - bw;
+            // Separable: outer product of the default taps.
+            kernels[0 * K * K + i * K + j] = filter_coeffs[i] * filter_coeffs[j];
+            // Non-separable: pyramid (Chebyshev distance) profile.
+            kernels[1 * K * K + i * K + j] = bw + 1 - (di > dj ? di : dj);
+            // Non-separable: learned-like random taps.
+            lcg = lcg * 1664525 + 1013904223;
+            kernels[2 * K * K + i * K + j] = (lcg >> 16) & 0xff;
+        }
+    }
+
+    for (int c = 0; c < n_cases; c++) {
+        data_t *coeffs = &kernels[c * K * K];
+        data_t hcoeffs[UAV_FILTER_DIM], vcoeffs[UAV_FILTER_DIM];
+        bool separable = conv_engine_select(coeffs, K, hcoeffs, vcoeffs) == CONV_ENGINE_SEPARABLE;
+
+        filter11x11_2d_orig(IM_UAV_COLS, IM_UAV_ROWS, coeffs, BORDER_REPLICATE, 0, src_img, ref_img);
+
+        cout << "Kernel '" << case_name[c] << "' -> " 
+             << (separable ? "separable" : "2d") << " engine" << endl;
+
+        // Selected engine.
+        double t_sel = run_strm(separable, coeffs, hcoeffs, vcoeffs, BORDER_REPLICATE, 0, src_img, dut_img);
+        int sel_err = compare(dut_img, ref_img);
+        err_cnt += sel_err;
+        print_perf(separable ? "separable" : "2d", t_sel);
+
+        // The window engine must also match on separable kernels.
+        if (separable) {
+            double t_2d = run_strm(false, coeffs, hcoeffs, vcoeffs, BORDER_REPLICATE, 0, src_img, dut_img);
+            err_cnt += compare(dut_img, ref_img);
+            print_perf("2d", t_2d);
+        }
+    }
+    cout << endl;
+
+    delete [] dut_img;
+
+    /* 
+        Border modes - both engines against the reference, for every mode;
+        the reference border itself is checked against the definitions.
+    */
+
+    const int n_modes = 3;
+    const int border_modes[n_modes] = {
+        BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101
+    };
+    const char *mode_name[n_modes] = {
+        "constant", "replicate", "reflect-101"
+    };
+    const data_t border_val = 0xdeadbeef;
+    data_t * const mode_img = new data_t[IM_UAV_ROWS*IM_UAV_COLS];
+
+    for (int m = 0; m < n_modes; m++) {
+        data_t *coeffs = &kernels[2 * K * K];
+        data_t hcoeffs[UAV_FILTER_DIM], vcoeffs[UAV_FILTER_DIM];
+        int mode_err = 0;
+
+        filter11x11_orig(IM_UAV_COLS, IM_UAV_ROWS, border_modes[m], border_val, src_img, ref_img);
+        mode_err += check_border(ref_img, border_modes[m], border_val);
+        run_strm(true, coeffs, filter_coeffs, filter_coeffs, border_modes[m], border_val, src_img, mode_img);
+        mode_err += compare(mode_img, ref_img);
+
+        filter11x11_2d_orig(IM_UAV_COLS, IM_UAV_ROWS, coeffs, border_modes[m], border_val, src_img, ref_img);
+        mode_err += check_border(ref_img, border_modes[m], border_val);
+        run_strm(false, coeffs, hcoeffs, vcoeffs, border_modes[m], border_val, src_img, mode_img);
+        mode_err += compare(mode_img, ref_img);
+
+        cout << "Border '" << mode_name[m] << "': " << mode_err << " mismatches" << endl;
+        err_cnt += mode_err;
+    }
+    cout << endl;
+
+    delete [] mode_img;
+    delete [] kernels;
+
+    /* 
+        Filter chain - CHAIN_STAGES filters (smooth, gradient, box, ...) and
+        a threshold in a single pass, checked against sequential passes of
+        the reference, each one a DRAM round trip.
+    */
+
+    static data_t chain_h[CHAIN_STAGES][UAV_FILTER_DIM];
+    static data_t chain_v[CHAIN_STAGES][UAV_FILTER_DIM];
+    const data_t chain_thresh = 1u << 24;
+    data_t * const chain_img = new data_t[IM_UAV_ROWS*IM_UAV_COLS];
+    data_t * const stage_img = new data_t[IM_UAV_ROWS*IM_UAV_COLS];
+    data_t * const stage_coeffs = new data_t[K * K];
+
+    for (int st = 0; st < CHAIN_STAGES; st++) {
+        for (int i = 0; i < K; i++) {
+            switch (st % 3) {
+            case 0: // smooth
+                chain_h[st][i] = filter_coeffs[i];
+                chain_v[st][i] = filter_coeffs[i];
+                break;
+            case 1: // horizontal gradient, i.e. central difference
+                chain_h[st][i] = (i == bw + 1) ? 1 : (i == bw - 1) ? (data_t)-1 : 0;
+                chain_v[st][i] = (i == bw) ? 2 : (i == bw - 1 || i == bw + 1) ? 1 : 0;
+                break;
+            default: // box
+                chain_h[st][i] = 1;
+                chain_v[st][i] = 1;
+                break;
+            }
+        }
+    }
+
+    // Sequential reference - one full frame pass per stage.
+    memcpy(chain_img, src_img, sizeof(data_t) * IM_UAV_ROWS * IM_UAV_COLS);
+    for (int st = 0; st < CHAIN_STAGES; st++) {
+        for (int i = 0; i < K; i++)
+            for (int j = 0; j < K; j++)
+                stage_coeffs[i * K + j] = chain_v[st][i] * chain_h[st][j];
+        filter11x11_2d_orig(IM_UAV_COLS, IM_UAV_ROWS, stage_coeffs, BORDER_REPLICATE, 0, chain_img, stage_img);
+        memcpy(chain_img, stage_img, sizeof(data_t) * IM_UAV_ROWS * IM_UAV_COLS);
+    }
+    for (int i = 0; i < IM_UAV_ROWS * IM_UAV_COLS; i++) {
+        ref_img[i] = chain_img[i] >= chain_thresh ? chain_img[i] : 0;
+    }
+
+    // Chained accelerator - one pass, the whole frame out within the call.
+    {
+        hls::stream<data_t> src_strm("chain_src");
+        hls::stream<data_t> dst_strm("chain_dst");
+        for (int i = 0; i < IM_UAV_ROWS * IM_UAV_COLS; i++)
+            src_strm << src_img[i];
+        filter11x11_chain(chain_h, chain_v, BORDER_REPLICATE, 0, chain_thresh, src_strm, dst_strm);
+        for (int i = 0; i < IM_UAV_ROWS * IM_UAV_COLS; i++)
+            chain_img[i] = dst_strm.read();
+        if (!dst_strm.empty()) err_cnt++;
+    }
+    int chain_err = compare(chain_img, ref_img);
+    err_cnt += chain_err;
+
+    {
+        const double frame_bytes = 2.0 * IM_UAV_ROWS * IM_UAV_COLS * sizeof(data_t);
+        const double seq_cycles = (double)CHAIN_STAGES * (IM_UAV_ROWS + CONV_LAG_ROWS) * IM_UAV_COLS;
+        const double chain_cycles = (double)(IM_UAV_ROWS + CHAIN_STAGES * CONV_LAG_ROWS) * IM_UAV_COLS;
+
+        cout << "Filter chain: " << CHAIN_STAGES << " stages + threshold, " 
+             << chain_err << " mismatches" << endl;
+        cout << "    DRAM traffic | sequential " << CHAIN_STAGES * frame_bytes / 1024 
+             << " KiB, chained " << frame_bytes / 1024 << " KiB (-" 
+             << 100.0 * (CHAIN_STAGES - 1) / CHAIN_STAGES << "%)" << endl;
+        cout << "    model        | sequential " << (long)seq_cycles << " cycles, chained "
+             << (long)chain_cycles << " cycles @ " << (int)ACC_CLK_MHZ << " MHz" << endl;
+    }
+    cout << endl;
+
+    delete [] chain_img;
+    delete [] stage_img;
+    delete [] stage_coeffs;
+
+    /* 
+        Video mode - frames are streamed back-to-back through the
+        free-running top, line buffers are not reset in between. The first
+        frames emulate a DMA source (TLAST only), the following ones a camera
+        source (TUSER start of frame) with a partial frame to be dropped.
+        A truncated frame precedes frames 1 (early TLAST) and 5 (early
+        TUSER): it is padded, and the good frame behind it must be intact.
+        Frame f leaves the core during calls f and f + 1, a last frame
+        flushes the stream.
+    */
+
+    const int n_frames = 6;
+    const int n_dma_frames = 3;
+    const int n_junk_beats = 1000;
+    const int n_cut_beats = IM_UAV_ROWS * IM_UAV_COLS / 2 + 7;
+    hls::stream<video_pix_t> src_video("src_video");
+    hls::stream<video_pix_t> dst_video("dst_video");
+    data_t * const prev_ref = new data_t[IM_UAV_ROWS*IM_UAV_COLS];
+    int video_err = 0;
+    double t_video = 0;
+
+    for (int f = 0; f <= n_frames; f++) {
+        gen_frame(src_img, f, chkr_size, max_pix_val, min_pix_val);
+        memcpy(prev_ref, ref_img, sizeof(data_t) * IM_UAV_ROWS * IM_UAV_COLS);
+        filter11x11_orig(IM_UAV_COLS, IM_UAV_ROWS, BORDER_REPLICATE, 0, src_img, ref_img);
+
+        if (f == n_dma_frames + 1) {
+            for (int i = 0; i < n_junk_beats; i++) {
+                video_pix_t beat;
+                beat.data = i; beat.keep = -1; beat.strb = -1;
+                beat.user = 0; beat.last = 0; beat.id = 0; beat.dest = 0;
+                src_video << beat;
+            }
+        }
+        bool cut = (f == 1 || f == n_dma_frames + 2);
+        if (cut)
+            push_truncated(src_video, n_cut_beats, f >= n_dma_frames);
+        push_frame(src_video, src_img, f >= n_dma_frames);
+
+        // The truncated frame comes out in place of a good one, not checked.
+        if (cut) {
+            filter11x11_video(filter_coeffs, filter_coeffs, BORDER_REPLICATE, 0, src_video, dst_video);
+            video_err += pop_frame(dst_video, prev_ref);
+        }
+
+        auto t_start = std::chrono::steady_clock::now();
+        filter11x11_video(filter_coeffs, filter_coeffs, BORDER_REPLICATE, 0, src_video, dst_video);
+        auto t_end = std::chrono::steady_clock::now();
+        if (f < n_frames)
+            t_video += std::chrono::duration<double>(t_end - t_start).count();
+
+        if (cut)
+            skip_strm(dst_video, IM_UAV_ROWS * IM_UAV_COLS);
+        else if (f > 0)
+            video_err += pop_frame(dst_video, prev_ref);
+    }
+    // Flush frame, up to its last CONV_LAG_ROWS rows.
+    skip_strm(dst_video, (IM_UAV_ROWS - CONV_LAG_ROWS) * IM_UAV_COLS);
+    if (!src_video.empty() || !dst_video.empty()) video_err++;
+    err_cnt += video_err;
+    delete [] prev_ref;
+
+    cout << "Video mode: " << n_frames << " frames, " 
+         << video_err << " mismatches | csim " 
+         << fixed << setprecision(2) << n_frames / t_video << " fps | model "
+         << ACC_CLK_MHZ * 1e6 / ((double)IM_UAV_ROWS * IM_UAV_COLS) 
+         << " fps @ " << (int)ACC_CLK_MHZ << " MHz" << endl;
     cout << endl;
 
     if (err_cnt == 0) {
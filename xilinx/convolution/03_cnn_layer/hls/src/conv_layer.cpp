@@ -0,0 +1,238 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Libraries. */
+
+#include "conv_layer.h"
+
+/*
+ *
+ * Convolution layer - Weight memory (body).
+ *
+ */
+
+template<int K>
+static void load_weights(
+    int c_in, int c_out,
+    const wgt_t *weights, const acc_t *biases,
+    wgt_t wbuf[CO_PAR][MAX_CO / CO_PAR][MAX_CI][K * K],
+    acc_t bbuf[CO_PAR][MAX_CO / CO_PAR])
+{
+    /*
+        - Weights -
+        Weights are stored in DRAM as [c_out][c_in][K][K] and read in a
+        single burst. Output channel co lands into bank (co % CO_PAR), so
+        that CO_PAR output channels are read in parallel by the compute
+        loop.
+    */
+
+    Load_Wgt_A: for (int co = 0; co < c_out; co++) {
+    #pragma HLS LOOP_TRIPCOUNT min=MAX_CO max=MAX_CO
+        Load_Wgt_B: for (int ci = 0; ci < c_in; ci++) {
+        #pragma HLS LOOP_TRIPCOUNT min=MAX_CI max=MAX_CI
+            Load_Wgt_C: for (int k = 0; k < K * K; k++) {
+            #pragma HLS PIPELINE
+                wbuf[co % CO_PAR][co / CO_PAR][ci][k] =
+                    weights[(co * c_in + ci) * K * K + k];
+            }
+        }
+    }
+
+    Load_Bias: for (int co = 0; co < c_out; co++) {
+    #pragma HLS LOOP_TRIPCOUNT min=MAX_CO max=MAX_CO
+    #pragma HLS PIPELINE
+        bbuf[co % CO_PAR][co / CO_PAR] = biases[co];
+    }
+}
+
+/*
+ *
+ * Convolution layer - Streaming accelerator (body).
+ *
+ */
+
+template<int K>
+static void conv_layer_body(
+    int width, int height,
+    int c_in, int c_out,
+    int shift, int relu,
+    wgt_t wbuf[CO_PAR][MAX_CO / CO_PAR][MAX_CI][K * K],
+    acc_t bbuf[CO_PAR][MAX_CO / CO_PAR],
+    hls::stream<act_t> &src,
+    hls::stream<act_t> &dst)
+{
+    /* Algorithm parameters. */
+    const int n_groups = (c_out + CO_PAR - 1) / CO_PAR;
+
+    /* ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ */
+
+    /* Pixel windows (cache) - one KxK window per input channel. */
+    static act_t win[MAX_CI][K][K];
+    #pragma HLS ARRAY_PARTITION variable=win dim=2 complete
+    #pragma HLS ARRAY_PARTITION variable=win dim=3 complete
+
+    /* ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ */
+
+    /* Line buffers. */
+
+    // Channel-interleaved line-buffers, i.e. entry (col * c_in + ci),
+    // same scheme as the vertical pass of convolution_strm.
+    static act_t linebuf[K - 1][MAX_FM_COLS * MAX_CI];
+    #pragma HLS ARRAY_PARTITION variable=linebuf dim=1 complete
+
+    // These assertions let HLS know the upper bounds of loops
+    assert(height <= MAX_FM_ROWS);
+    assert(width <= MAX_FM_COLS);
+    assert(c_in <= MAX_CI);
+    assert(c_out <= MAX_CO);
+
+    /* ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ */
+
+    Layer_A: for (int col = 0; col < height; col++) {
+    #pragma HLS LOOP_TRIPCOUNT min=MAX_FM_ROWS max=MAX_FM_ROWS
+        Layer_B: for (int row = 0; row < width; row++) {
+        #pragma HLS LOOP_TRIPCOUNT min=MAX_FM_COLS max=MAX_FM_COLS
+
+            /*
+                - Load -
+                The c_in channels of the incoming pixel, together with
+                the K - 1 line-buffered pixels above each of them, are
+                shifted into the per-channel windows, one channel per clock.
+            */
+
+            Load_Ch: for (int ci = 0; ci < c_in; ci++) {
+            #pragma HLS LOOP_TRIPCOUNT min=MAX_CI max=MAX_CI
+            #pragma HLS DEPENDENCE variable=linebuf inter false
+            #pragma HLS PIPELINE
+
+                // Read input stream.
+                act_t in_val = src.read();
+                int lb_idx = row * c_in + ci;
+
+                Load_Win: for (int i = 0; i < K; i++) {
+                    act_t col_val = i < K - 1 ? linebuf[i][lb_idx] : in_val;
+                    if (i > 0)
+                        linebuf[i - 1][lb_idx] = col_val;
+                    for (int j = 0; j < K - 1; j++)
+                        win[ci][i][j] = win[ci][i][j + 1];
+                    win[ci][i][K - 1] = col_val;
+                }
+            }
+
+            /*
+                - Compute -
+                Only for valid window positions. Output channels are
+                processed in groups of CO_PAR, each accumulating one input
+                channel per clock, i.e. CO_PAR * K * K MACs per clock.
+            */
+
+            if (col >= K - 1 && row >= K - 1) {
+
+                Comp_Grp: for (int g = 0; g < n_groups; g++) {
+                #pragma HLS LOOP_TRIPCOUNT min=MAX_CO/CO_PAR max=MAX_CO/CO_PAR
+
+                    acc_t acc[CO_PAR];
+                    #pragma HLS ARRAY_PARTITION variable=acc complete
+
+                    Comp_Init: for (int p = 0; p < CO_PAR; p++) {
+                    #pragma HLS UNROLL
+                        acc[p] = bbuf[p][g];
+                    }
+
+                    Comp_Ch: for (int ci = 0; ci < c_in; ci++) {
+                    #pragma HLS LOOP_TRIPCOUNT min=MAX_CI max=MAX_CI
+                    #pragma HLS PIPELINE
+                        Comp_Par: for (int p = 0; p < CO_PAR; p++) {
+                            acc_t sum = 0;
+                            for (int i = 0; i < K; i++)
+                                for (int j = 0; j < K; j++)
+                                    sum += win[ci][i][j] * wbuf[p][g][ci][i * K + j];
+                            acc[p] += sum;
+                        }
+                    }
+
+                    // Requantize to activations: shift, optional ReLU, saturate.
+                    Store: for (int p = 0; p < CO_PAR; p++) {
+                    #pragma HLS PIPELINE
+                        if (g * CO_PAR + p < c_out) {
+                            acc_t out_val = acc[p] >> shift;
+                            if (relu && out_val < 0)
+                                out_val = 0;
+                            if (out_val > INT16_MAX)
+                                out_val = INT16_MAX;
+                            if (out_val < INT16_MIN)
+                                out_val = INT16_MIN;
+                            dst << (act_t)out_val;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*
+ *
+ * Convolution layer - Streaming accelerator (top).
+ *
+ */
+
+void conv_layer_strm(
+    int width, int height,
+    int c_in, int c_out,
+    int shift, int relu,
+    const wgt_t *weights, const acc_t *biases,
+	hls::stream<act_t> &src,
+    hls::stream<act_t> &dst)
+{
+
+    /* Weight memory interface - depths: MAX_WEIGHTS and MAX_CO. */
+    #pragma HLS INTERFACE m_axi port=weights depth=4608 offset=slave bundle=port_wgt
+    #pragma HLS INTERFACE m_axi port=biases  depth=32   offset=slave bundle=port_wgt
+
+    /* Control interface. */
+    #pragma HLS INTERFACE s_axilite port=width   bundle=control
+    #pragma HLS INTERFACE s_axilite port=height  bundle=control
+    #pragma HLS INTERFACE s_axilite port=c_in    bundle=control
+    #pragma HLS INTERFACE s_axilite port=c_out   bundle=control
+    #pragma HLS INTERFACE s_axilite port=shift   bundle=control
+    #pragma HLS INTERFACE s_axilite port=relu    bundle=control
+    #pragma HLS INTERFACE s_axilite port=weights bundle=control
+    #pragma HLS INTERFACE s_axilite port=biases  bundle=control
+    #pragma HLS INTERFACE s_axilite port=return  bundle=control
+
+    /* Data streaming interface. */
+    #pragma HLS INTERFACE axis port=&src
+    #pragma HLS INTERFACE axis port=&dst
+
+    /* On-chip weight memory - one bank per parallel output channel. */
+    wgt_t wbuf[CO_PAR][MAX_CO / CO_PAR][MAX_CI][CONV_K * CONV_K];
+    #pragma HLS ARRAY_PARTITION variable=wbuf dim=1 complete
+    #pragma HLS ARRAY_PARTITION variable=wbuf dim=4 complete
+
+    acc_t bbuf[CO_PAR][MAX_CO / CO_PAR];
+    #pragma HLS ARRAY_PARTITION variable=bbuf dim=1 complete
+
+    /* Load weights, then stream the feature map through the layer. */
+    load_weights<CONV_K>(c_in, c_out, weights, biases, wbuf, bbuf);
+
+    conv_layer_body<CONV_K>(
+        width, height,
+        c_in, c_out,
+        shift, relu,
+        wbuf, bbuf,
+        src, dst);
+}
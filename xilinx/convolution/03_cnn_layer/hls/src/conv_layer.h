@@ -0,0 +1,69 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CONV_LAYER_H_
+#define CONV_LAYER_H_
+
+#include <assert.h>
+#include <stdint.h>
+#include <hls_stream.h>
+
+/*
+    Multi-channel convolution layer, built on the line-buffer scheme of
+    convolution_strm (02_opt). Feature maps are streamed pixel by pixel,
+    channels interleaved, i.e. (row, col, ch) with ch fastest. Only the
+    valid region is produced, i.e. (height - (K - 1)) x (width - (K - 1))
+    pixels of c_out channels each.
+*/
+
+/* Feature-map bounds - sized after the 02_opt UAV frames. */
+
+#define MAX_FM_ROWS 320
+#define MAX_FM_COLS 320
+
+#define MAX_CI 16 // Input channels
+#define MAX_CO 32 // Output channels
+
+#define CONV_K 3 // Window size
+
+/*
+    Output-channel parallelism - number of output channels computed
+    concurrently, i.e. CO_PAR * K * K MACs per clock.
+    Must divide MAX_CO.
+*/
+
+#ifndef CO_PAR
+#define CO_PAR 8
+#endif
+
+static_assert(MAX_CO % CO_PAR == 0, "CO_PAR must divide MAX_CO");
+
+#define MAX_WEIGHTS (MAX_CO * MAX_CI * CONV_K * CONV_K)
+
+typedef int16_t act_t; // Activations
+typedef int16_t wgt_t; // Weights
+typedef int32_t acc_t; // Accumulators, biases
+
+// External function prototypes
+void conv_layer_strm(
+        int width, int height,
+        int c_in, int c_out,
+        int shift, int relu,
+        const wgt_t *weights, const acc_t *biases,
+        hls::stream<act_t> &src_fm,
+        hls::stream<act_t> &dst_fm);
+
+#endif // CONV_LAYER_H_ not defined
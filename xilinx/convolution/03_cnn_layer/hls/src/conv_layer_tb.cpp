@@ -0,0 +1,194 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Libraries. */
+
+#include <string>
+#include <iostream>
+#include <iomanip>
+
+/* Include HLS source header. */
+
+#include "conv_layer.h"
+
+using namespace std;
+
+/* Modeled accelerator clock (run_hls.tcl: 6.66 ns). */
+
+#define ACC_CLK_MHZ 150.0
+
+/* Layer configurations under test. */
+
+struct layer_cfg {
+    int width, height;
+    int c_in, c_out;
+    int shift, relu;
+};
+
+/* Host reference - direct convolution, same layouts as the accelerator. */
+
+static void conv_layer_ref(
+        const layer_cfg &cfg,
+        const act_t *src, const wgt_t *weights, const acc_t *biases,
+        act_t *dst)
+{
+    const int K = CONV_K;
+    const int out_w = cfg.width - (K - 1);
+    const int out_h = cfg.height - (K - 1);
+
+    for (int y = 0; y < out_h; y++) {
+        for (int x = 0; x < out_w; x++) {
+            for (int co = 0; co < cfg.c_out; co++) {
+                acc_t acc = biases[co];
+                for (int ci = 0; ci < cfg.c_in; ci++) {
+                    for (int i = 0; i < K; i++) {
+                        for (int j = 0; j < K; j++) {
+                            int pix = (y + i) * cfg.width + (x + j);
+                            acc += src[pix * cfg.c_in + ci] *
+                                weights[((co * cfg.c_in + ci) * K + i) * K + j];
+                        }
+                    }
+                }
+                acc >>= cfg.shift;
+                if (cfg.relu && acc < 0) acc = 0;
+                if (acc > INT16_MAX) acc = INT16_MAX;
+                if (acc < INT16_MIN) acc = INT16_MIN;
+                dst[(y * out_w + x) * cfg.c_out + co] = (act_t)acc;
+            }
+        }
+    }
+}
+
+/*
+    Cycle model of the accelerator: weight burst, c_in load cycles per
+    input pixel, ceil(c_out / CO_PAR) * c_in compute cycles and c_out store
+    cycles per output pixel.
+*/
+
+static double model_cycles(const layer_cfg &cfg)
+{
+    const int K = CONV_K;
+    const double n_in = (double)cfg.width * cfg.height;
+    const double n_out = (double)(cfg.width - (K - 1)) * (cfg.height - (K - 1));
+    const int n_groups = (cfg.c_out + CO_PAR - 1) / CO_PAR;
+
+    return (double)cfg.c_out * cfg.c_in * K * K + cfg.c_out
+        + n_in * cfg.c_in
+        + n_out * ((double)n_groups * cfg.c_in + n_groups * CO_PAR);
+}
+
+int main(void)
+{
+
+    /* Algorithm parameters declaration. */
+
+    const int n_cfgs = 3;
+    const layer_cfg cfgs[n_cfgs] = {
+        {  64,  64,  8, 16, 6, 1 },
+        {  40,  30,  3, 20, 4, 0 }, // c_out not a multiple of CO_PAR
+        {  80,  80, 16, 32, 8, 1 },
+    };
+    int err_cnt = 0;
+    int ret_val = 20;
+    uint32_t lcg = 0x2468ace0;
+
+    cout << "CO_PAR = " << CO_PAR << ", " << CO_PAR * CONV_K * CONV_K
+         << " MAC/clock @ " << (int)ACC_CLK_MHZ << " MHz" << endl << endl;
+
+    for (int c = 0; c < n_cfgs; c++) {
+        const layer_cfg &cfg = cfgs[c];
+        const int out_w = cfg.width - (CONV_K - 1);
+        const int out_h = cfg.height - (CONV_K - 1);
+        const int n_src = cfg.width * cfg.height * cfg.c_in;
+        const int n_dst = out_w * out_h * cfg.c_out;
+        const int n_wgt = cfg.c_out * cfg.c_in * CONV_K * CONV_K;
+        int cfg_err = 0;
+
+        /* Allocate I/O arrays. */
+
+        act_t * const src_fm = new act_t[n_src];
+        act_t * const ref_fm = new act_t[n_dst];
+        wgt_t * const weights = new wgt_t[n_wgt];
+        acc_t * const biases = new acc_t[cfg.c_out];
+        hls::stream<act_t> src_fm_strm("src_fm_strm");
+        hls::stream<act_t> dut_fm_strm("dut_fm_strm");
+
+        /* Generate random activations, weights and biases. */
+
+        for (int i = 0; i < n_src; i++) {
+            lcg = lcg * 1664525 + 1013904223;
+            src_fm[i] = (act_t)((lcg >> 16) & 0xff) - 128;
+            src_fm_strm << src_fm[i];
+        }
+        for (int i = 0; i < n_wgt; i++) {
+            lcg = lcg * 1664525 + 1013904223;
+            weights[i] = (wgt_t)((lcg >> 16) & 0xff) - 128;
+        }
+        for (int i = 0; i < cfg.c_out; i++) {
+            lcg = lcg * 1664525 + 1013904223;
+            biases[i] = (acc_t)((lcg >> 8) & 0xffff) - 32768;
+        }
+
+        /* Generate reference and DUT output feature maps. */
+
+        conv_layer_ref(cfg, src_fm, weights, biases, ref_fm);
+
+        conv_layer_strm(
+            cfg.width, cfg.height, cfg.c_in, cfg.c_out, cfg.shift, cfg.relu,
+            weights, biases, src_fm_strm, dut_fm_strm);
+
+        /* Check DUT vs reference result */
+
+        for (int i = 0; i < n_dst; i++) {
+            if (dut_fm_strm.read() != ref_fm[i]) cfg_err++;
+        }
+        if (!dut_fm_strm.empty()) cfg_err++;
+        err_cnt += cfg_err;
+
+        /* Performance model. */
+
+        double ops = 2.0 * CONV_K * CONV_K * cfg.c_in * cfg.c_out * out_w * out_h;
+        double cycles = model_cycles(cfg);
+        double t_acc = cycles / (ACC_CLK_MHZ * 1e6);
+
+        cout << cfg.width << "x" << cfg.height << "x" << cfg.c_in
+             << " -> " << out_w << "x" << out_h << "x" << cfg.c_out
+             << " | " << cfg_err << " mismatches"
+             << " | model " << (long)cycles << " cycles, "
+             << fixed << setprecision(3) << ops / t_acc / 1e9 << " GOPS"
+             << " (peak " << 2.0 * CO_PAR * CONV_K * CONV_K * ACC_CLK_MHZ / 1e3 << ")"
+             << endl;
+
+        /* Cleanup. */
+
+        delete [] src_fm;
+        delete [] ref_fm;
+        delete [] weights;
+        delete [] biases;
+    }
+    cout << endl;
+
+    if (err_cnt == 0) {
+        cout << "*** TEST PASSED ***" << endl;
+        ret_val = 0;
+    } else {
+        cout << "!!! TEST FAILED - " << err_cnt << " mismatches detected !!!";
+        cout << endl;
+        ret_val = -1;
+    }
+
+    return ret_val;
+}
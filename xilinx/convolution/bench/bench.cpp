@@ -0,0 +1,309 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+    Convolution benchmark - sweeps image sizes, kernel sizes and
+    implementations, i.e. the convolution_orig, convolution_strm
+    (separable) and convolution_2d_strm (KxK window) HLS bodies
+    (C-simulation) and the arm64 convolution_sw baseline. Stimuli and
+    references are generated in-process, every implementation being
+    checked against convolution_orig. The KxK kernel is the outer product
+    of the binomial taps, factored back into those taps for the separable
+    engine by conv_engine_select() as the host does.
+
+    Output is one CSV row per (impl, size, K):
+        impl,width,height,k,cycles,cycles_src,time_ms,fps,bytes_per_pixel,match
+    - cycles: modeled at ACC_CLK_MHZ for HLS bodies (cycles_src = model),
+      measured wall time times CPU_MHZ for convolution_sw (measured).
+      strm and strm2d share the II=1 model, i.e. identical by
+      construction; they differ in MACs per pixel (2*K vs K*K).
+    - time_ms: wall time of this run, i.e. C-simulation for HLS bodies.
+    - fps: from cycles, at the respective clock.
+    - bytes_per_pixel: DRAM traffic per output pixel (model).
+*/
+
+/* Libraries. */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+/* Include HLS source - template bodies are static to this unit. */
+
+#include "convolution.cpp"
+
+/* Include host convolution. */
+
+#include "convolution_sw.h"
+
+/* Include host engine selection. */
+
+#include "../02_opt/app/src/include/conv_engine.h"
+
+/* Clocks. */
+
+#define ACC_CLK_MHZ 150.0   // run_hls.tcl: 6.66 ns
+#ifndef CPU_MHZ
+#define CPU_MHZ 1200.0      // ZCU102 Cortex-A53
+#endif
+
+/* Sweep. */
+
+struct frame_size {
+    int width, height;
+};
+
+static const frame_size sizes[] = {
+    {   64,   64 },
+    {  320,  320 }, // UAV frames
+    {  640,  480 },
+    { 1280,  720 },
+    { 1920, 1080 },
+    { 3840, 2160 },
+};
+
+static const int kernels[] = { 3, 5, 7, 11 };
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/* Kernel taps - binomial row of K, i.e. a Gaussian approximation. */
+
+static void gen_coeffs(int k, data_t *coeffs)
+{
+    coeffs[0] = 1;
+    for (int i = 1; i < k; i++)
+        coeffs[i] = coeffs[i - 1] * (k - i) / i;
+}
+
+/* Modeled cycles. */
+
+static double cycles_strm(int w, int h, int k)
+{
+    // II=1 DATAFLOW, one complete frame per call: the output trails the
+    // input by 3*bw+1 rows (border_lag), drained after the last input row.
+    return (double)(h + 3 * (k / 2) + 1) * w;
+}
+
+static double cycles_orig(int w, int h, int k)
+{
+    // Sequential loop nests, one tap per clock.
+    const int bw = k / 2;
+    return (double)w * h                       // Clear_Local
+         + (double)(w - 2 * bw) * h * k        // Hconv
+         + (double)w * h                       // Clear_Dst
+         + (double)w * (h - 2 * bw) * k        // Vconv
+         + (double)w * h;                      // border pass
+}
+
+/* Modeled DRAM traffic per output pixel. */
+
+static double bytes_strm(int w, int h, int k)
+{
+    // Each pixel read and written once.
+    return 2.0 * sizeof(data_t);
+}
+
+static double bytes_orig(int w, int h, int k)
+{
+    // K src reads per horizontal tap, read-modify-write of dst per
+    // vertical tap, dst clear and border read/write over m_axi.
+    const int bw = k / 2;
+    const double n_pix = (double)w * h;
+    const double n_border = n_pix - (double)(w - 2 * bw) * (h - 2 * bw);
+    return sizeof(data_t) * (
+        (double)(w - 2 * bw) * h * k
+        + n_pix
+        + 2.0 * w * (h - 2 * bw) * k
+        + 2.0 * n_border) / n_pix;
+}
+
+static double bytes_sw(int w, int h, int k)
+{
+    // Single fused sweep, the K-row ring staying cache-resident: src read,
+    // out written once (border rows copied from the cached edge row).
+    return 2.0 * sizeof(data_t);
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/* Implementations - dispatch runtime K to template instances. */
+
+template<int K>
+static void run_orig_k(int w, int h, const data_t *src, data_t *dst, const data_t *c)
+{
+    convolution_orig<data_t, K>(w, h, src, dst, c, c, BORDER_REPLICATE, 0);
+}
+
+template<int K>
+static void run_strm2d_k(int w, int h, const data_t *src, data_t *dst, const data_t *c)
+{
+    hls::stream<data_t> src_strm("src_strm");
+    hls::stream<data_t> dst_strm("dst_strm");
+
+    for (int i = 0; i < w * h; i++)
+        src_strm << src[i];
+    convolution_2d_strm<data_t, K>(w, h, true, src_strm, dst_strm, c, BORDER_REPLICATE, 0);
+    for (int i = 0; i < w * h; i++)
+        dst[i] = dst_strm.read();
+}
+
+// c: hcoeffs then vcoeffs, K taps each.
+template<int K>
+static void run_strm_k(int w, int h, const data_t *src, data_t *dst, const data_t *c)
+{
+    hls::stream<data_t> src_strm("src_strm");
+    hls::stream<data_t> dst_strm("dst_strm");
+
+    for (int i = 0; i < w * h; i++)
+        src_strm << src[i];
+    convolution_strm<data_t, K>(w, h, true, src_strm, dst_strm, c, c + K, BORDER_REPLICATE, 0);
+    for (int i = 0; i < w * h; i++)
+        dst[i] = dst_strm.read();
+}
+
+typedef void (*conv_fn)(int, int, const data_t *, data_t *, const data_t *);
+
+static conv_fn get_orig(int k)
+{
+    switch (k) {
+    case 3:  return run_orig_k<3>;
+    case 5:  return run_orig_k<5>;
+    case 7:  return run_orig_k<7>;
+    default: return run_orig_k<11>;
+    }
+}
+
+static conv_fn get_strm(int k)
+{
+    switch (k) {
+    case 3:  return run_strm_k<3>;
+    case 5:  return run_strm_k<5>;
+    case 7:  return run_strm_k<7>;
+    default: return run_strm_k<11>;
+    }
+}
+
+static conv_fn get_strm2d(int k)
+{
+    switch (k) {
+    case 3:  return run_strm2d_k<3>;
+    case 5:  return run_strm2d_k<5>;
+    case 7:  return run_strm2d_k<7>;
+    default: return run_strm2d_k<11>;
+    }
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/*
+ *
+ *     HOST processor - Main program.
+ *
+ */
+
+int main(int argc, char *argv[])
+{
+    const char *csv_path = argc > 1 ? argv[1] : "-";
+    const int max_width = argc > 2 ? atoi(argv[2]) : 3840;
+    int n_fail = 0;
+
+    FILE *csv = strcmp(csv_path, "-") ? fopen(csv_path, "w") : stdout;
+    if (csv == NULL) {
+        fprintf(stderr, "Error: could not open file %s\n", csv_path);
+        return 1;
+    }
+
+    fprintf(csv, "impl,width,height,k,cycles,cycles_src,time_ms,fps,bytes_per_pixel,match\n");
+
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        const int w = sizes[s].width;
+        const int h = sizes[s].height;
+        if (w > max_width) continue;
+
+        /* Stimuli - random 8-bit pixels. */
+
+        std::vector<data_t> src(w * h), ref(w * h), dut(w * h);
+        uint32_t lcg = 0x13579bdf ^ (w * h);
+        for (int i = 0; i < w * h; i++) {
+            lcg = lcg * 1664525 + 1013904223;
+            src[i] = (lcg >> 16) & 0xff;
+        }
+
+        for (unsigned kk = 0; kk < sizeof(kernels) / sizeof(kernels[0]); kk++) {
+            const int k = kernels[kk];
+            data_t coeffs[UAV_FILTER_DIM], kernel[UAV_FILTER_DIM * UAV_FILTER_DIM];
+            data_t taps[2 * UAV_FILTER_DIM]; // hcoeffs, vcoeffs
+            gen_coeffs(k, coeffs);
+            for (int i = 0; i < k; i++)
+                for (int j = 0; j < k; j++)
+                    kernel[i * k + j] = coeffs[i] * coeffs[j];
+            if (conv_engine_select(kernel, k, taps, taps + k) != CONV_ENGINE_SEPARABLE) {
+                fprintf(stderr, "Error: K=%d kernel not factored\n", k);
+                return 1;
+            }
+
+            fprintf(stderr, "Running %dx%d, K=%d...\n", w, h, k);
+
+            for (int impl = 0; impl < 4; impl++) {
+                const char *name = impl == 0 ? "orig" : impl == 1 ? "strm" : impl == 2 ? "strm2d" : "sw";
+                data_t *dst = impl == 0 ? ref.data() : dut.data();
+
+                auto t0 = std::chrono::steady_clock::now();
+                if (impl == 0)
+                    get_orig(k)(w, h, src.data(), dst, coeffs);
+                else if (impl == 1)
+                    get_strm(k)(w, h, src.data(), dst, taps);
+                else if (impl == 2)
+                    get_strm2d(k)(w, h, src.data(), dst, kernel);
+                else
+                    convolution_sw(src.data(), dst, coeffs, k, w, h);
+                auto t1 = std::chrono::steady_clock::now();
+                double t_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+                bool match = impl == 0 || !memcmp(ref.data(), dut.data(), sizeof(data_t) * w * h);
+                if (!match) n_fail++;
+
+                double cycles, fps, bpp;
+                const char *cycles_src;
+                if (impl == 0) {
+                    cycles = cycles_orig(w, h, k); cycles_src = "model";
+                    fps = ACC_CLK_MHZ * 1e6 / cycles; bpp = bytes_orig(w, h, k);
+                } else if (impl == 1 || impl == 2) {
+                    cycles = cycles_strm(w, h, k); cycles_src = "model";
+                    fps = ACC_CLK_MHZ * 1e6 / cycles; bpp = bytes_strm(w, h, k);
+                } else {
+                    cycles = t_ms * 1e-3 * CPU_MHZ * 1e6; cycles_src = "measured";
+                    fps = 1e3 / t_ms; bpp = bytes_sw(w, h, k);
+                }
+
+                fprintf(csv, "%s,%d,%d,%d,%.0f,%s,%.3f,%.2f,%.2f,%d\n",
+                    name, w, h, k, cycles, cycles_src, t_ms, fps, bpp, match ? 1 : 0);
+                fflush(csv);
+            }
+        }
+    }
+
+    if (csv != stdout) fclose(csv);
+
+    if (n_fail)
+        fprintf(stderr, "!!! %d runs mismatch convolution_orig !!!\n", n_fail);
+    else
+        fprintf(stderr, "*** All runs match convolution_orig ***\n");
+
+    return n_fail ? -1 : 0;
+}
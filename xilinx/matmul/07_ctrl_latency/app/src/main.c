@@ -0,0 +1,596 @@
+/*
+ * Copyright 2019 ETH Zurich, University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Accelerator control-path latency.
+ *
+ * Each driver step of an offload is timed on its own over many iterations,
+ * against the minimal mmult_hw of this design (run-time dimension, 0 being
+ * an empty job):
+ *  - UIO open and mmap (XMmult_hw_Initialize), and release.
+ *  - AXI-Lite register read (IsReady, IsDone) and write (Set_*).
+ *  - Start alone, and Start plus the IsDone polling loop on an empty job.
+ *  - Whole jobs (programming, start, polling) over growing dimensions,
+ *    against the same multiplication on the host, i.e. the minimum job size
+ *    where offload pays off.
+ * Each step reports min / median / p99 / max and a log2 histogram in ns.
+ *
+ * Usage: app_exec [iterations]
+ */
+
+/* Libraries. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/* Include accelerator drivers. */
+#include <xmmult_hw.h>
+#include <xmmult_hw_hw.h>
+
+/* Include host timer struct. */
+#include <xil-bench.h>
+
+/*
+ * Reserved address in Contiguous Memory.
+ * To check whether CMA has been correctly allocated: 'dmesg | grep Reserved'
+ */
+
+#define CMA_ADDR 0x10000000
+
+/* Maximum dimension synthesized, see hls/src/mmult.h. */
+
+#define DATA_SIZE 64
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/*
+ * Timestamps - CLOCK_REALTIME costs a vDSO call per sample, as much as the
+ * register accesses being measured. On aarch64 the generic timer counter
+ * (100 MHz on the ZCU102, i.e. 10 ns resolution) is read directly.
+ */
+
+static inline uint64_t ticks_now(void)
+{
+#ifdef __aarch64__
+  uint64_t t;
+  __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(t) :: "memory");
+  return t;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+static inline uint64_t ticks_freq(void)
+{
+#ifdef __aarch64__
+  uint64_t f;
+  __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(f));
+  return f;
+#else
+  return 1000000000ull;
+#endif
+}
+
+static uint64_t tick_hz;
+
+static inline uint32_t ticks_ns(uint64_t t0, uint64_t t1)
+{
+  return (uint32_t)((t1 - t0) * 1000000000ull / tick_hz);
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/* Latency histogram - raw samples in ns, for percentiles, and log2 bins. */
+
+#define HIST_BINS 32    // [2^b, 2^(b+1)) ns, b = 0 also holds 0 ns
+#define HIST_BAR  40    // width of the largest bin
+
+struct lat_hist {
+  const char* name;
+  uint32_t* samples;
+  unsigned n;
+  unsigned cap;
+};
+
+typedef struct lat_hist lat_hist;
+
+static int hist_init(lat_hist* h, const char* name, unsigned cap)
+{
+  h->name = name;
+  h->n = 0;
+  h->cap = cap;
+  h->samples = (uint32_t*)malloc(cap * sizeof(uint32_t));
+  return h->samples ? 0 : -ENOMEM;
+}
+
+static inline void hist_add(lat_hist* h, uint32_t ns)
+{
+  if (h->n < h->cap)
+    h->samples[h->n++] = ns;
+}
+
+static int cmp_u32(const void* a, const void* b)
+{
+  const uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+  return (x > y) - (x < y);
+}
+
+/* Percentile in [0, 100], samples sorted. */
+
+static uint32_t hist_pct(const lat_hist* h, double pct)
+{
+  if (!h->n)
+    return 0;
+  unsigned i = (unsigned)(pct / 100.0 * (h->n - 1) + 0.5);
+  return h->samples[i];
+}
+
+static inline unsigned hist_bin(uint32_t ns)
+{
+  unsigned b = 0;
+  while (ns >>= 1) b++;
+  return b;
+}
+
+static void hist_print(lat_hist* h)
+{
+  unsigned bins[HIST_BINS] = { 0 };
+  unsigned lo = HIST_BINS, hi = 0, peak = 0;
+  double sum = 0;
+
+  if (!h->n) {
+    printf("\n  - %s: no samples\n", h->name);
+    return;
+  }
+
+  qsort(h->samples, h->n, sizeof(uint32_t), cmp_u32);
+
+  for (unsigned i = 0; i < h->n; i++) {
+    const unsigned b = hist_bin(h->samples[i]);
+    bins[b]++;
+    sum += h->samples[i];
+    if (b < lo) lo = b;
+    if (b > hi) hi = b;
+  }
+  for (unsigned b = lo; b <= hi; b++)
+    if (bins[b] > peak) peak = bins[b];
+
+  printf("\n  - %s (%u samples):\n", h->name, h->n);
+  printf("  -     - Min / median (ns):      %u / %u\n", h->samples[0], hist_pct(h, 50));
+  printf("  -     - p99 / max (ns):         %u / %u\n", hist_pct(h, 99), h->samples[h->n - 1]);
+  printf("  -     - Mean (ns):              %.1f\n", sum / h->n);
+
+  for (unsigned b = lo; b <= hi; b++) {
+    printf("  -       %10u - %10u ns %8u |", b ? 1u << b : 0, (1u << b) * 2 - 1, bins[b]);
+    for (unsigned c = 0; c < (bins[b] * HIST_BAR + peak - 1) / peak; c++)
+      putchar('#');
+    putchar('\n');
+  }
+}
+
+static void hist_free(lat_hist* h)
+{
+  free(h->samples);
+  h->samples = NULL;
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/* Host reference - same computation as the accelerator. */
+
+void mmult_sw(uint32_t* in1, uint32_t* in2, uint32_t* out_sw, uint32_t mat_dim)
+{
+  for (unsigned i = 0; i < mat_dim; i++){
+    for (unsigned j = 0; j < mat_dim; j++){
+      uint32_t result = 0;
+      for (unsigned k = 0; k < mat_dim; k++){
+        result += in1[i * mat_dim + k] * in2[j * mat_dim + k];
+      }
+      out_sw[i * mat_dim + j] = result;
+    }
+  }
+}
+
+/* Accelerator - one whole job, programming to completion. */
+
+static inline void xil_job(
+  XMmult_hw* hw_acc,
+  uint32_t const buffer_in1,
+  uint32_t const buffer_in2,
+  uint32_t const buffer_out,
+  uint32_t const mat_dim)
+{
+  XMmult_hw_Set_in1(hw_acc, buffer_in1);
+  XMmult_hw_Set_in2(hw_acc, buffer_in2);
+  XMmult_hw_Set_out_r(hw_acc, buffer_out);
+  XMmult_hw_Set_dim(hw_acc, mat_dim);
+
+  XMmult_hw_Start(hw_acc);
+  while(!XMmult_hw_IsDone(hw_acc));
+}
+
+/* - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / - / */
+
+/*
+ *
+ *     HOST processor - Main program.
+ *
+ */
+
+int main(int argc, char *argv[])
+{
+  printf("\n|-------------------|\n");
+  printf("| Test - Beginning. |");
+  printf("\n|-------------------|\n");
+
+  /* Iterations per step, fewer for UIO setup and whole jobs. */
+
+  unsigned n_iter         = 10000;
+
+  if (argc > 1)
+    n_iter = atoi(argv[1]);
+  if (n_iter < 10) {
+    printf("Usage: %s [iterations >= 10]\n", argv[0]);
+    return -EINVAL;
+  }
+
+  const unsigned n_iter_slow = n_iter / 10;
+
+  /* Job dimensions - 0 is an empty job. */
+
+  static const unsigned dims[] = { 0, 1, 2, 4, 8, 16, 32, DATA_SIZE };
+  const unsigned n_dims = sizeof(dims) / sizeof(dims[0]);
+
+  /* Steps. */
+
+  enum {
+    S_TIMER = 0, S_INIT, S_RELEASE, S_READ_READY, S_READ_DONE, S_WRITE_ONE, S_WRITE_ARGS,
+    S_START, S_START_DONE, S_N_STEPS
+  };
+
+  lat_hist steps[S_N_STEPS];
+  lat_hist jobs_acc[sizeof(dims) / sizeof(dims[0])];
+  lat_hist jobs_host[sizeof(dims) / sizeof(dims[0])];
+
+  int status = 0;
+  int fd;
+
+  tick_hz = ticks_freq();
+
+  status |= hist_init(&steps[S_TIMER],       "Timer overhead",                        n_iter);
+  status |= hist_init(&steps[S_INIT],        "UIO open + mmap (Initialize)",          n_iter_slow);
+  status |= hist_init(&steps[S_RELEASE],     "UIO munmap + close (Release)",          n_iter_slow);
+  status |= hist_init(&steps[S_READ_READY],  "Register read (IsReady)",               n_iter);
+  status |= hist_init(&steps[S_READ_DONE],   "Register read (IsDone, idle)",          n_iter);
+  status |= hist_init(&steps[S_WRITE_ONE],   "Register write (Set_in1)",              n_iter);
+  status |= hist_init(&steps[S_WRITE_ARGS],  "Programming (Set_in1/in2/out_r/dim)",   n_iter);
+  status |= hist_init(&steps[S_START],       "Start",                                 n_iter);
+  status |= hist_init(&steps[S_START_DONE],  "Start + IsDone polling (empty job)",    n_iter);
+
+  for (unsigned d = 0; d < n_dims; d++) {
+    status |= hist_init(&jobs_acc[d],  "Accelerator job, max dim",  n_iter_slow);
+    status |= hist_init(&jobs_host[d], "Host computation, max dim", n_iter_slow);
+  }
+
+  if (status) {
+    printf("ERROR: malloc() failed!\n");
+    return -ENOMEM;
+  }
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|----------------------------------------------------|\n");
+  printf("| DRAM - Declaration, allocation and initialization. |");
+  printf("\n|----------------------------------------------------|\n\n");
+
+  uint64_t map_dim = DATA_SIZE * DATA_SIZE * sizeof(uint32_t);  // Need to map at least 4KB
+
+  /* Host arrays. */
+
+  uint32_t* l3_in1      = (uint32_t*)malloc(map_dim);
+  uint32_t* l3_in2      = (uint32_t*)malloc(map_dim);
+  uint32_t* l3_golden   = (uint32_t*)malloc(map_dim);
+
+  if ( (l3_in1 == NULL) || (l3_in2 == NULL) || (l3_golden == NULL) ) {
+    printf("ERROR: malloc() failed!\n");
+    return -ENOMEM;
+  }
+
+  for(int i=0; i<DATA_SIZE*DATA_SIZE; i++){
+    l3_in1[i]   = rand() % 255;
+    l3_in2[i]   = rand() % 255;
+  }
+
+  /* Map reserved addresses in memory. */
+
+  if((fd = open("/dev/mem", O_RDWR | O_SYNC)) == -1) {
+      printf("\n\n\n/dev/mem could not be opened.\n");
+      perror("open");
+      return -1;
+  } else {
+      printf("\n\n\n/dev/mem opened.\n\n");
+  }
+
+  uint32_t* _l3_in1     = (uint32_t*) mmap(NULL, map_dim, PROT_READ | PROT_WRITE, MAP_SHARED, fd, CMA_ADDR);
+  uint32_t* _l3_in2     = (uint32_t*) mmap(NULL, map_dim, PROT_READ | PROT_WRITE, MAP_SHARED, fd, CMA_ADDR + map_dim);
+  uint32_t* _l3_test    = (uint32_t*) mmap(NULL, map_dim, PROT_READ | PROT_WRITE, MAP_SHARED, fd, CMA_ADDR + 2 * map_dim);
+
+  if( (_l3_in1 == MAP_FAILED) || (_l3_in2 == MAP_FAILED) || (_l3_test == MAP_FAILED) ){
+    printf("Mmap Failed: %s\n",strerror(errno));
+    return -1;
+  }
+
+  memcpy(_l3_in1, l3_in1, map_dim);
+  memcpy(_l3_in2, l3_in2, map_dim);
+  memset(_l3_test, 0, map_dim);
+
+  const uint32_t buffer_in1 = (uint32_t)(CMA_ADDR);
+  const uint32_t buffer_in2 = (uint32_t)(CMA_ADDR + map_dim);
+  const uint32_t buffer_out = (uint32_t)(CMA_ADDR + 2 * map_dim);
+
+  printf("Control-path latency parameters\n");
+  printf("Iterations            - %u        \n", n_iter               );
+  printf("Iterations (slow)     - %u        \n", n_iter_slow          );
+  printf("Max dimension         - %d        \n", DATA_SIZE            );
+  printf("Timer frequency       - %llu Hz   \n", (unsigned long long)tick_hz);
+
+  /* Accelerator. */
+
+  XMmult_hw hw_acc;
+  uint64_t t0, t1, t2;
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|---------------------------|\n");
+  printf("| Control path - UIO setup. |");
+  printf("\n|---------------------------|\n\n");
+
+  for (unsigned i = 0; i < n_iter; i++) {
+    t0 = ticks_now();
+    t1 = ticks_now();
+    hist_add(&steps[S_TIMER], ticks_ns(t0, t1));
+  }
+
+  /*
+   * Former argument of the following API must match the content of '/sys/class/uio/UIO_DEVICE/name'.
+   * 'UIO_DEVICE' might vary form case to case. Check it on the board after boot.
+   */
+
+  for (unsigned i = 0; i < n_iter_slow; i++) {
+    t0 = ticks_now();
+    status = XMmult_hw_Initialize(&hw_acc,"mmult_hw");
+    t1 = ticks_now();
+
+    if (status != XST_SUCCESS) {
+      printf("Init Error RM %d\n",status);
+      return status;
+    }
+
+    XMmult_hw_Release(&hw_acc);
+    t2 = ticks_now();
+
+    hist_add(&steps[S_INIT], ticks_ns(t0, t1));
+    hist_add(&steps[S_RELEASE], ticks_ns(t1, t2));
+  }
+
+  status = XMmult_hw_Initialize(&hw_acc,"mmult_hw");
+
+  if (status != XST_SUCCESS) {
+    printf("Init Error RM %d\n",status);
+    return status;
+  }
+
+  if (!XMmult_hw_IsReady(&hw_acc)) {
+    printf("Accelerator is not ready..\n");
+    return -EBUSY;
+  }
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|-----------------------------------|\n");
+  printf("| Control path - Register accesses. |");
+  printf("\n|-----------------------------------|\n\n");
+
+  volatile uint32_t sink = 0;
+
+  for (unsigned i = 0; i < n_iter; i++) {
+    t0 = ticks_now();
+    sink += XMmult_hw_IsReady(&hw_acc);
+    t1 = ticks_now();
+    hist_add(&steps[S_READ_READY], ticks_ns(t0, t1));
+  }
+
+  for (unsigned i = 0; i < n_iter; i++) {
+    t0 = ticks_now();
+    sink += XMmult_hw_IsDone(&hw_acc);
+    t1 = ticks_now();
+    hist_add(&steps[S_READ_DONE], ticks_ns(t0, t1));
+  }
+
+  for (unsigned i = 0; i < n_iter; i++) {
+    t0 = ticks_now();
+    XMmult_hw_Set_in1(&hw_acc, buffer_in1);
+    t1 = ticks_now();
+    hist_add(&steps[S_WRITE_ONE], ticks_ns(t0, t1));
+  }
+
+  for (unsigned i = 0; i < n_iter; i++) {
+    t0 = ticks_now();
+    XMmult_hw_Set_in1(&hw_acc, buffer_in1);
+    XMmult_hw_Set_in2(&hw_acc, buffer_in2);
+    XMmult_hw_Set_out_r(&hw_acc, buffer_out);
+    XMmult_hw_Set_dim(&hw_acc, 0);
+    t1 = ticks_now();
+    hist_add(&steps[S_WRITE_ARGS], ticks_ns(t0, t1));
+  }
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|-----------------------------------|\n");
+  printf("| Control path - Start and polling. |");
+  printf("\n|-----------------------------------|\n\n");
+
+  /* Empty job, programmed above. Start alone, completion awaited off the clock. */
+
+  for (unsigned i = 0; i < n_iter; i++) {
+    t0 = ticks_now();
+    XMmult_hw_Start(&hw_acc);
+    t1 = ticks_now();
+    while(!XMmult_hw_IsDone(&hw_acc));
+    hist_add(&steps[S_START], ticks_ns(t0, t1));
+  }
+
+  uint64_t n_polls = 0;
+
+  for (unsigned i = 0; i < n_iter; i++) {
+    t0 = ticks_now();
+    XMmult_hw_Start(&hw_acc);
+    while(!XMmult_hw_IsDone(&hw_acc))
+      n_polls++;
+    t1 = ticks_now();
+    hist_add(&steps[S_START_DONE], ticks_ns(t0, t1));
+  }
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|----------------------------------|\n");
+  printf("| Job size - Accelerator vs. host. |");
+  printf("\n|----------------------------------|\n\n");
+
+  for (unsigned d = 0; d < n_dims; d++) {
+    for (unsigned i = 0; i < n_iter_slow; i++) {
+      t0 = ticks_now();
+      xil_job(&hw_acc, buffer_in1, buffer_in2, buffer_out, dims[d]);
+      t1 = ticks_now();
+      mmult_sw(l3_in1, l3_in2, l3_golden, dims[d]);
+      t2 = ticks_now();
+
+      hist_add(&jobs_acc[d], ticks_ns(t0, t1));
+      hist_add(&jobs_host[d], ticks_ns(t1, t2));
+    }
+  }
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|-----------|\n");
+  printf("| Checksum. |");
+  printf("\n|-----------|\n\n");
+
+  /* Post-computation checksum - last job, i.e. DATA_SIZE. */
+
+  int err_cnt = 0;
+
+  for (int i = 0; i < DATA_SIZE * DATA_SIZE; i++)
+    if (_l3_test[i] != l3_golden[i]) err_cnt++;
+
+  if (err_cnt)
+    printf("Post-computation checksum... %d mismatches!\n", err_cnt);
+  else
+    printf("Post-computation checksum... Checksum completed SUCCESFULLY!\n");
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  /* Results - ARM measurements. */
+
+  printf("\n|---------------------------------------|\n");
+  printf("| Results - Control path latency (ARM). |");
+  printf("\n|---------------------------------------|\n");
+
+  for (int s = 0; s < S_N_STEPS; s++)
+    hist_print(&steps[s]);
+
+  printf("  -     - Polls per empty job:    %.1f\n", (double)n_polls / n_iter);
+
+  printf("\n|---------------------------------------|\n");
+  printf("| Results - Job size vs. offload (ARM). |");
+  printf("\n|---------------------------------------|\n\n");
+
+  /* Medians - offload pays off from the first dimension the accelerator wins. */
+
+  int break_even = -1;
+
+  printf("  %6s %16s %16s %8s\n", "dim", "accel (ns)", "host (ns)", "ratio");
+
+  for (unsigned d = 0; d < n_dims; d++) {
+    qsort(jobs_acc[d].samples, jobs_acc[d].n, sizeof(uint32_t), cmp_u32);
+    qsort(jobs_host[d].samples, jobs_host[d].n, sizeof(uint32_t), cmp_u32);
+
+    const uint32_t acc = hist_pct(&jobs_acc[d], 50);
+    const uint32_t host = hist_pct(&jobs_host[d], 50);
+
+    printf("  %6u %16u %16u %8.2f\n", dims[d], acc, host, host ? (double)acc / host : 0.0);
+
+    if (acc <= host) {
+      if (break_even < 0) break_even = d;
+    } else {
+      break_even = -1;
+    }
+  }
+
+  if (break_even < 0)
+    printf("\nOffload break-even: not reached up to dim %d\n", DATA_SIZE);
+  else
+    printf("\nOffload break-even: dim %u (%u MACs)\n",
+      dims[break_even], dims[break_even] * dims[break_even] * dims[break_even]);
+
+  for (unsigned d = 0; d < n_dims; d++)
+    if (dims[d] == DATA_SIZE) {
+      hist_print(&jobs_acc[d]);
+      hist_print(&jobs_host[d]);
+    }
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|----------|\n");
+  printf("| Cleanup. |");
+  printf("\n|----------|\n\n");
+
+  XMmult_hw_Release(&hw_acc);
+
+  munmap(_l3_in1,  map_dim);
+  munmap(_l3_in2,  map_dim);
+  munmap(_l3_test, map_dim);
+  close(fd);
+
+  free(l3_in1);
+  free(l3_in2);
+  free(l3_golden);
+
+  for (int s = 0; s < S_N_STEPS; s++)
+    hist_free(&steps[s]);
+  for (unsigned d = 0; d < n_dims; d++) {
+    hist_free(&jobs_acc[d]);
+    hist_free(&jobs_host[d]);
+  }
+
+  /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+  printf("\n|-------------|\n");
+  printf("| Test - End. |");
+  printf("\n|-------------|\n\n");
+
+  return 0;
+}